@@ -0,0 +1,135 @@
+/* Alarm cost benchmark for the uC/OS-II host port
+ *
+ * Description:
+ *
+ *   Measures how long the system clock interrupt spends in alt_tick() as a
+ *   function of the number of registered alarms. alt_tick() is called
+ *   directly from the highest priority task with interrupts disabled, which
+ *   is what the timer ISR does minus the interrupt entry and exit; this
+ *   includes OSTimeTick().
+ *
+ *   The registered alarms have long, different delays, so they are inserted
+ *   all over the sorted alarm list but none of them expires during the
+ *   measurement. Two cases are measured for each number of alarms:
+ *
+ *     idle - no alarm expires, the tick only has to look at the list,
+ *     due  - one more alarm expires on every tick and is put back in the
+ *            list, like the one-tick alarm of the cruise control skeleton.
+ *
+ *   Each point is the median of BENCH_RUNS runs of BENCH_TICKS ticks. The
+ *   output is CSV:
+ *
+ *     alarms,idle_ns_per_tick,due_ns_per_tick
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "includes.h"
+#include "sys/alt_alarm.h"
+#include "sys/alt_irq.h"
+
+#define   TASK_STACKSIZE       2048
+
+#define   BENCH_PRIO           1
+
+#define   MAX_ALARMS           64
+#define   BENCH_TICKS          10000
+#define   BENCH_RUNS           9
+#define   BENCH_DELAY          1000000  /* ticks, longer than one point */
+
+OS_STK    bench_stk[TASK_STACKSIZE];
+
+alt_alarm alarms[MAX_ALARMS];
+alt_alarm due_alarm;
+
+static double now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int compare_double(const void* a, const void* b)
+{
+  double x = *(const double*)a;
+  double y = *(const double*)b;
+
+  return (x > y) - (x < y);
+}
+
+alt_u32 idleCallback(void* context)
+{
+  return BENCH_DELAY;
+}
+
+alt_u32 dueCallback(void* context)
+{
+  return 1;
+}
+
+/* Median time of one alt_tick(), in ns */
+static double measureTick(void)
+{
+  double runs[BENCH_RUNS];
+  double start;
+  alt_irq_context context;
+  int run;
+  int i;
+
+  for (run = 0; run < BENCH_RUNS; run++)
+    {
+      context = alt_irq_disable_all();
+      start = now_ns();
+      for (i = 0; i < BENCH_TICKS; i++)
+	alt_tick();
+      runs[run] = (now_ns() - start) / BENCH_TICKS;
+      alt_irq_enable_all(context);
+    }
+
+  qsort(runs, BENCH_RUNS, sizeof(runs[0]), compare_double);
+  return runs[BENCH_RUNS / 2];
+}
+
+void benchTask(void* pdata)
+{
+  double idle;
+  int n;
+  int i;
+
+  printf("# alt_tick() cost, OS_LOWEST_PRIO %d\n", OS_LOWEST_PRIO);
+  printf("alarms,idle_ns_per_tick,due_ns_per_tick\n");
+
+  for (n = 1; n <= MAX_ALARMS; n++)
+    {
+      /* Restart all alarms, spread over the list in a scrambled order */
+      for (i = 0; i < n; i++)
+	{
+	  if (i < n - 1)
+	    alt_alarm_stop(&alarms[i]);
+	  alt_alarm_start(&alarms[i], BENCH_DELAY + (i * 37) % MAX_ALARMS,
+			  idleCallback, NULL);
+	}
+
+      idle = measureTick();
+
+      alt_alarm_start(&due_alarm, 1, dueCallback, NULL);
+      printf("%d,%.1f,%.1f\n", n, idle, measureTick());
+      alt_alarm_stop(&due_alarm);
+    }
+
+  exit(0);
+}
+
+int main(void)
+{
+  OSTaskCreateExt(benchTask, NULL,
+		  &bench_stk[TASK_STACKSIZE-1],
+		  BENCH_PRIO, BENCH_PRIO,
+		  &bench_stk[0],
+		  TASK_STACKSIZE, NULL, 0);
+
+  OSStart();
+  return 0;
+}
@@ -0,0 +1,148 @@
+/* Deferred log benchmark for the uC/OS-II host port
+ *
+ * Description:
+ *
+ *   Measures the cost of one log call on the calling task, as a function of
+ *   the number of arguments:
+ *
+ *     printf - fprintf() of the line to /dev/null, i.e. the formatting and
+ *              the stdio locks, but not the write itself; on the board the
+ *              JTAG UART comes on top of that,
+ *     dlog   - ALT_DLOG0() ... ALT_DLOG4() into a ring (os/alt_dlog.h).
+ *
+ *   The benchmark task empties the ring itself after every BENCH_BATCH
+ *   calls, so no record is lost and no drain task runs during the
+ *   measurement. Each point is the median of BENCH_RUNS runs of BENCH_CALLS
+ *   calls. The output is CSV:
+ *
+ *     args,printf_ns,dlog_ns
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "includes.h"
+#include "os/alt_dlog.h"
+
+#define   TASK_STACKSIZE       2048
+
+#define   BENCH_PRIO           1
+
+#define   BENCH_CALLS          (BENCH_BATCH * 100)
+#define   BENCH_BATCH          128
+#define   BENCH_RUNS           9
+
+OS_STK    bench_stk[TASK_STACKSIZE];
+
+/* Room for BENCH_BATCH records of four arguments */
+ALT_DLOG_RING(bench_log, 1024)
+
+static FILE* devnull;
+
+static double now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int compare_double(const void* a, const void* b)
+{
+  double x = *(const double*)a;
+  double y = *(const double*)b;
+
+  return (x > y) - (x < y);
+}
+
+/* One log call with n arguments, through printf or the ring */
+static void logCall(int dlog, int n, int i)
+{
+  if (dlog)
+    {
+      switch (n)
+	{
+	case 0: ALT_DLOG0(bench_log, 0); break;
+	case 1: ALT_DLOG1(bench_log, 1, i); break;
+	case 2: ALT_DLOG2(bench_log, 2, i, -i); break;
+	case 3: ALT_DLOG3(bench_log, 3, i, -i, 2 * i); break;
+	case 4: ALT_DLOG4(bench_log, 4, i, -i, 2 * i, 3 * i); break;
+	}
+    }
+  else
+    {
+      switch (n)
+	{
+	case 0: fprintf(devnull, "Tick\n"); break;
+	case 1: fprintf(devnull, "Position: %d m\n", i); break;
+	case 2: fprintf(devnull, "Velocity: %d m/s, %d\n", i, -i); break;
+	case 3: fprintf(devnull, "Accell: %d %d %d\n", i, -i, 2 * i); break;
+	case 4: fprintf(devnull, "Throttle: %d %d %d %d\n",
+			i, -i, 2 * i, 3 * i); break;
+	}
+    }
+}
+
+/* Median time of one log call with n arguments, in ns */
+static double measure(int dlog, int n)
+{
+  double runs[BENCH_RUNS];
+  double start;
+  int run;
+  int i;
+  int j;
+
+  for (run = 0; run < BENCH_RUNS; run++)
+    {
+      start = now_ns();
+      for (i = 0; i < BENCH_CALLS; i += BENCH_BATCH)
+	{
+	  for (j = 0; j < BENCH_BATCH; j++)
+	    logCall(dlog, n, i + j);
+	  bench_log.tail = bench_log.head;
+	}
+      runs[run] = (now_ns() - start) / BENCH_CALLS;
+    }
+
+  qsort(runs, BENCH_RUNS, sizeof(runs[0]), compare_double);
+  return runs[BENCH_RUNS / 2];
+}
+
+void benchTask(void* pdata)
+{
+  double printf_ns;
+  int n;
+
+  devnull = fopen("/dev/null", "w");
+  if (!devnull)
+    {
+      perror("/dev/null");
+      exit(1);
+    }
+
+  printf("# log call cost, printf to /dev/null vs. alt_dlog ring\n");
+  printf("args,printf_ns,dlog_ns\n");
+
+  for (n = 0; n <= 4; n++)
+    {
+      printf_ns = measure(0, n);
+      printf("%d,%.1f,%.1f\n", n, printf_ns, measure(1, n));
+    }
+
+  if (bench_log.lost)
+    printf("# %lu records lost\n", (unsigned long)bench_log.lost);
+
+  exit(0);
+}
+
+int main(void)
+{
+  OSTaskCreateExt(benchTask, NULL,
+		  &bench_stk[TASK_STACKSIZE-1],
+		  BENCH_PRIO, BENCH_PRIO,
+		  &bench_stk[0],
+		  TASK_STACKSIZE, NULL, 0);
+
+  OSStart();
+  return 0;
+}
@@ -0,0 +1,489 @@
+/* Batched vehicle model benchmark for the uC/OS-II host port
+ *
+ * Description:
+ *
+ *   vehicle_step() in lab2-cruise/src/cruise_model.h advances one vehicle
+ *   with a branch per input and per track band. For simulations of many
+ *   vehicles at once this keeps a fleet in structure-of-arrays form, one
+ *   INT32S array per state variable and input, and steps it without
+ *   branches:
+ *
+ *     - the brake and engine inputs become lane masks, and the two
+ *       accelerations are blended with them,
+ *     - the track band is the number of band edges (400, 800, ... 2000 m)
+ *       at or before the position, and the gravity of the band comes from
+ *       a table indexed by it, with pshufb (SSE4.1) or vpermd (AVX2),
+ *     - the wrap at the end of the track is a mask as well.
+ *
+ *   The arithmetic is the one of vehicle_step(), shifts included, so every
+ *   implementation must give the same state bit for bit. The fleet is
+ *   stepped in four ways:
+ *
+ *     model  - vehicle_step() on an array of struct vehicle_model,
+ *     scalar - the masked arithmetic, one vehicle at a time; the fallback
+ *              on hosts without SSE4.1,
+ *     sse41  - 4 vehicles per instruction,
+ *     avx2   - 8 vehicles per instruction,
+ *
+ *   the last two only if the CPU has them. Each one first runs
+ *   CHECK_PERIODS periods on a fleet with random state and inputs that
+ *   change every period, and is compared with 'model' after each one. Then
+ *   it is timed on fleets of several sizes, the median of BENCH_RUNS runs.
+ *   The output is CSV:
+ *
+ *     impl,vehicles,identical,msteps_per_s
+ *
+ *   with the throughput in millions of vehicle steps per second.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "includes.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define   FLEET_X86            1
+#else
+#define   FLEET_X86            0
+#endif
+
+#define   TASK_STACKSIZE       2048
+
+#define   BENCH_PRIO           1
+
+#define   BENCH_STEPS          (1 << 24)   /* vehicle steps per run */
+#define   BENCH_RUNS           9
+
+#define   CHECK_VEHICLES       1003        /* not a multiple of the lanes */
+#define   CHECK_PERIODS        2000
+
+/* As in cruise_skeleton.c */
+#define   THROTTLE_K           2
+#define   THROTTLE_TI          100
+#define   DEFAULT_THROTTLE     5
+#define   VEHICLE_PERIOD       300
+#define   CONTROL_PERIOD       300
+
+#include "../../lab2-cruise/src/cruise_model.h"
+
+OS_STK    bench_stk[TASK_STACKSIZE];
+
+/* Gravity per track band, in units of 1 << MODEL_Q m/s2 */
+#define   FLEET_BANDS          6
+#define   FLEET_GRAVITY(g)     ((g) * (MODEL_GRAVITY >> MODEL_Q))
+
+static const signed char fleet_gravity[8] =
+  {
+    0,                         /*    0 -  400 m, and behind the start */
+    FLEET_GRAVITY(-1),         /*  400 -  800 m, uphill */
+    FLEET_GRAVITY(-2),         /*  800 - 1200 m, steep uphill */
+    0,                         /* 1200 - 1600 m */
+    FLEET_GRAVITY(2),          /* 1600 - 2000 m, downhill */
+    FLEET_GRAVITY(1),          /* 2000 m -, steep downhill */
+    0, 0
+  };
+
+/* A fleet of vehicles, one array per field of struct vehicle_model and per
+   input of vehicle_step() */
+typedef struct
+{
+  int     n;
+  INT32S* position;
+  INT32S* velocity;
+  INT32S* acceleration;
+  INT32S* throttle;
+  INT32S* brake;
+  INT32S* engine;
+} fleet;
+
+enum impl {IMPL_MODEL, IMPL_SCALAR, IMPL_SSE41, IMPL_AVX2, IMPLS};
+
+static const char* const impl_names[IMPLS] =
+  {"model", "scalar", "sse41", "avx2"};
+
+static const int sizes[] = {1024, 16384, 262144};
+
+/* The same fleet as an array of struct vehicle_model, for IMPL_MODEL */
+static struct vehicle_model* models;
+
+static double now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int compare_double(const void* a, const void* b)
+{
+  double x = *(const double*)a;
+  double y = *(const double*)b;
+
+  return (x > y) - (x < y);
+}
+
+/* xorshift32, good enough for test inputs */
+static INT32U rnd(INT32U* state)
+{
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+  return *state;
+}
+
+static INT32S* fleetArray(int n)
+{
+  INT32S* a = calloc(n, sizeof(INT32S));
+
+  if (!a)
+    {
+      printf("out of memory\n");
+      exit(1);
+    }
+  return a;
+}
+
+static void fleetAlloc(fleet* f, int n)
+{
+  f->n = n;
+  f->position = fleetArray(n);
+  f->velocity = fleetArray(n);
+  f->acceleration = fleetArray(n);
+  f->throttle = fleetArray(n);
+  f->brake = fleetArray(n);
+  f->engine = fleetArray(n);
+}
+
+static void fleetFree(fleet* f)
+{
+  free(f->position);
+  free(f->velocity);
+  free(f->acceleration);
+  free(f->throttle);
+  free(f->brake);
+  free(f->engine);
+}
+
+/* New inputs for every vehicle: the throttle as ControlTask may write it,
+   the brake now and then, and the engine mostly on */
+static void fleetInputs(fleet* f, INT32U* seed)
+{
+  int i;
+
+  for (i = 0; i < f->n; i++)
+    {
+      f->throttle[i] = rnd(seed) % 81;
+      f->brake[i] = rnd(seed) % 8 == 0;
+      f->engine[i] = rnd(seed) % 16 != 0;
+    }
+}
+
+/* Random state anywhere on the track, going either way */
+static void fleetState(fleet* f, INT32U* seed)
+{
+  int i;
+
+  for (i = 0; i < f->n; i++)
+    {
+      f->position[i] = rnd(seed) % (MODEL_TRACK_END + 1);
+      f->velocity[i] = (INT32S)(rnd(seed) % (140 << MODEL_Q)) - (20 << MODEL_Q);
+      f->acceleration[i] = 0;
+    }
+}
+
+static void stepModel(fleet* f)
+{
+  int i;
+
+  for (i = 0; i < f->n; i++)
+    vehicle_step(&models[i], f->throttle[i], f->brake[i], f->engine[i]);
+}
+
+/* Vehicles first to last - 1 without branches */
+static void stepScalar(fleet* f, int first, int last)
+{
+  INT32S position, velocity, acceleration, band, braking, engine;
+  int i;
+
+  for (i = first; i < last; i++)
+    {
+      position = f->position[i];
+      velocity = f->velocity[i];
+      band = (position >> MODEL_Q >= 400) + (position >> MODEL_Q >= 800)
+	+ (position >> MODEL_Q >= 1200) + (position >> MODEL_Q >= 1600)
+	+ (position >> MODEL_Q >= 2000);
+      braking = -(f->brake[i] != 0);
+      engine = -(f->engine[i] != 0);
+
+      acceleration = -MODEL_WIND_FACTOR * velocity
+	+ ((f->throttle[i] << MODEL_Q) & engine)
+	+ ((INT32S)fleet_gravity[band] << MODEL_Q);
+      acceleration = (acceleration & ~braking)
+	| (-MODEL_BRAKE_FACTOR * velocity & braking);
+
+      position += (velocity * MODEL_DT) >> MODEL_Q;
+      velocity += (acceleration * MODEL_DT) >> MODEL_Q;
+      position &= -(position <= MODEL_TRACK_END);
+
+      f->position[i] = position;
+      f->velocity[i] = velocity;
+      f->acceleration[i] = acceleration;
+    }
+}
+
+#if FLEET_X86
+
+__attribute__((target("sse4.1")))
+static void stepSse41(fleet* f)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i dt = _mm_set1_epi32(MODEL_DT);
+  const __m128i end = _mm_set1_epi32(MODEL_TRACK_END);
+  const __m128i table = _mm_loadl_epi64((const __m128i*)fleet_gravity);
+  /* pshufb picks byte 0 of the table for the low byte of each lane and
+     zeroes the three others */
+  const __m128i high = _mm_set1_epi32(0xffffff00);
+  __m128i position, velocity, acceleration, braked, band, gravity;
+  __m128i braking, engine;
+  int edge;
+  int i;
+
+  for (i = 0; i + 4 <= f->n; i += 4)
+    {
+      position = _mm_loadu_si128((__m128i*)&f->position[i]);
+      velocity = _mm_loadu_si128((__m128i*)&f->velocity[i]);
+      braking = _mm_cmpeq_epi32(_mm_loadu_si128((__m128i*)&f->brake[i]), zero);
+      engine = _mm_cmpeq_epi32(_mm_loadu_si128((__m128i*)&f->engine[i]), zero);
+
+      /* band = number of edges at or before the position; the compare
+         masks are -1 */
+      band = zero;
+      for (edge = 400; edge <= 2000; edge += 400)
+	band = _mm_sub_epi32(band, _mm_cmpgt_epi32(position,
+	  _mm_set1_epi32((edge << MODEL_Q) - 1)));
+      gravity = _mm_shuffle_epi8(table, _mm_or_si128(band, high));
+      gravity = _mm_srai_epi32(_mm_slli_epi32(gravity, 24), 24 - MODEL_Q);
+
+      acceleration = _mm_sub_epi32(gravity, velocity);
+      acceleration = _mm_add_epi32(acceleration,
+	_mm_andnot_si128(engine, _mm_slli_epi32(
+	  _mm_loadu_si128((__m128i*)&f->throttle[i]), MODEL_Q)));
+      braked = _mm_sub_epi32(zero, _mm_slli_epi32(velocity, 2));
+      acceleration = _mm_blendv_epi8(braked, acceleration, braking);
+
+      position = _mm_add_epi32(position,
+	_mm_srai_epi32(_mm_mullo_epi32(velocity, dt), MODEL_Q));
+      velocity = _mm_add_epi32(velocity,
+	_mm_srai_epi32(_mm_mullo_epi32(acceleration, dt), MODEL_Q));
+      position = _mm_andnot_si128(_mm_cmpgt_epi32(position, end), position);
+
+      _mm_storeu_si128((__m128i*)&f->position[i], position);
+      _mm_storeu_si128((__m128i*)&f->velocity[i], velocity);
+      _mm_storeu_si128((__m128i*)&f->acceleration[i], acceleration);
+    }
+
+  stepScalar(f, i, f->n);
+}
+
+__attribute__((target("avx2")))
+static void stepAvx2(fleet* f)
+{
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i dt = _mm256_set1_epi32(MODEL_DT);
+  const __m256i end = _mm256_set1_epi32(MODEL_TRACK_END);
+  __m256i table;
+  __m256i position, velocity, acceleration, braked, band, gravity;
+  __m256i braking, engine;
+  int edge;
+  int i;
+
+  table = _mm256_slli_epi32(_mm256_cvtepi8_epi32(
+    _mm_loadl_epi64((const __m128i*)fleet_gravity)), MODEL_Q);
+
+  for (i = 0; i + 8 <= f->n; i += 8)
+    {
+      position = _mm256_loadu_si256((__m256i*)&f->position[i]);
+      velocity = _mm256_loadu_si256((__m256i*)&f->velocity[i]);
+      braking = _mm256_cmpeq_epi32(
+	_mm256_loadu_si256((__m256i*)&f->brake[i]), zero);
+      engine = _mm256_cmpeq_epi32(
+	_mm256_loadu_si256((__m256i*)&f->engine[i]), zero);
+
+      band = zero;
+      for (edge = 400; edge <= 2000; edge += 400)
+	band = _mm256_sub_epi32(band, _mm256_cmpgt_epi32(position,
+	  _mm256_set1_epi32((edge << MODEL_Q) - 1)));
+      gravity = _mm256_permutevar8x32_epi32(table, band);
+
+      acceleration = _mm256_sub_epi32(gravity, velocity);
+      acceleration = _mm256_add_epi32(acceleration,
+	_mm256_andnot_si256(engine, _mm256_slli_epi32(
+	  _mm256_loadu_si256((__m256i*)&f->throttle[i]), MODEL_Q)));
+      braked = _mm256_sub_epi32(zero, _mm256_slli_epi32(velocity, 2));
+      acceleration = _mm256_blendv_epi8(braked, acceleration, braking);
+
+      position = _mm256_add_epi32(position,
+	_mm256_srai_epi32(_mm256_mullo_epi32(velocity, dt), MODEL_Q));
+      velocity = _mm256_add_epi32(velocity,
+	_mm256_srai_epi32(_mm256_mullo_epi32(acceleration, dt), MODEL_Q));
+      position = _mm256_andnot_si256(_mm256_cmpgt_epi32(position, end),
+				     position);
+
+      _mm256_storeu_si256((__m256i*)&f->position[i], position);
+      _mm256_storeu_si256((__m256i*)&f->velocity[i], velocity);
+      _mm256_storeu_si256((__m256i*)&f->acceleration[i], acceleration);
+    }
+
+  stepScalar(f, i, f->n);
+}
+
+#endif /* FLEET_X86 */
+
+static int supported(int impl)
+{
+#if FLEET_X86
+  __builtin_cpu_init();
+  if (impl == IMPL_SSE41)
+    return __builtin_cpu_supports("sse4.1");
+  if (impl == IMPL_AVX2)
+    return __builtin_cpu_supports("avx2");
+  return 1;
+#else
+  return impl < IMPL_SSE41;
+#endif
+}
+
+static void step(int impl, fleet* f)
+{
+  switch (impl)
+    {
+    case IMPL_MODEL: stepModel(f); break;
+    case IMPL_SCALAR: stepScalar(f, 0, f->n); break;
+#if FLEET_X86
+    case IMPL_SSE41: stepSse41(f); break;
+    case IMPL_AVX2: stepAvx2(f); break;
+#endif
+    }
+}
+
+static void modelsLoad(const fleet* f)
+{
+  int i;
+
+  for (i = 0; i < f->n; i++)
+    {
+      models[i].position = f->position[i];
+      models[i].velocity = f->velocity[i];
+      models[i].acceleration = f->acceleration[i];
+    }
+}
+
+/* Steps the fleet and the models side by side; 1 if they never differ */
+static int check(int impl)
+{
+  INT32U seed = 2206;
+  fleet f;
+  int identical = 1;
+  int k;
+  int i;
+
+  fleetAlloc(&f, CHECK_VEHICLES);
+  fleetState(&f, &seed);
+  modelsLoad(&f);
+
+  for (k = 0; k < CHECK_PERIODS && identical; k++)
+    {
+      fleetInputs(&f, &seed);
+      step(impl, &f);
+      stepModel(&f);
+      for (i = 0; i < f.n; i++)
+	if (f.position[i] != models[i].position
+	    || f.velocity[i] != models[i].velocity
+	    || f.acceleration[i] != models[i].acceleration)
+	  {
+	    printf("# %s: vehicle %d differs in period %d\n",
+		   impl_names[impl], i, k);
+	    identical = 0;
+	    break;
+	  }
+    }
+
+  fleetFree(&f);
+  return identical;
+}
+
+/* Median throughput on n vehicles, in vehicle steps per second */
+static double measure(int impl, int n)
+{
+  double runs[BENCH_RUNS];
+  INT32U seed = 2206;
+  double start;
+  fleet f;
+  int run;
+  int k;
+
+  fleetAlloc(&f, n);
+  fleetInputs(&f, &seed);
+  for (run = 0; run < BENCH_RUNS; run++)
+    {
+      fleetState(&f, &seed);
+      modelsLoad(&f);
+      start = now_ns();
+      for (k = 0; k < BENCH_STEPS / n; k++)
+	step(impl, &f);
+      runs[run] = (double)(BENCH_STEPS / n) * n / (now_ns() - start) * 1e9;
+    }
+  fleetFree(&f);
+
+  qsort(runs, BENCH_RUNS, sizeof(runs[0]), compare_double);
+  return runs[BENCH_RUNS / 2];
+}
+
+void benchTask(void* pdata)
+{
+  int identical;
+  int impl;
+  int s;
+
+  models = calloc(sizes[sizeof(sizes) / sizeof(sizes[0]) - 1],
+		  sizeof(*models));
+  if (!models)
+    {
+      printf("out of memory\n");
+      exit(1);
+    }
+
+  printf("# batched vehicle model, %d periods checked against vehicle_step()\n",
+	 CHECK_PERIODS);
+  printf("impl,vehicles,identical,msteps_per_s\n");
+
+  for (impl = 0; impl < IMPLS; impl++)
+    {
+      if (!supported(impl))
+	{
+	  printf("# %s: not supported by this CPU\n", impl_names[impl]);
+	  continue;
+	}
+
+      identical = impl == IMPL_MODEL || check(impl);
+      for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+	printf("%s,%d,%d,%.1f\n", impl_names[impl], sizes[s], identical,
+	       measure(impl, sizes[s]) * 1e-6);
+    }
+
+  exit(0);
+}
+
+int main(void)
+{
+  OSTaskCreateExt(benchTask, NULL,
+		  &bench_stk[TASK_STACKSIZE-1],
+		  BENCH_PRIO, BENCH_PRIO,
+		  &bench_stk[0],
+		  TASK_STACKSIZE, NULL, 0);
+
+  OSStart();
+  return 0;
+}
@@ -0,0 +1,189 @@
+/* Tick interrupt benchmark for the uC/OS-II host port
+ *
+ * Description:
+ *
+ *   Runs a mostly idle schedule resembling the cruise control lab for
+ *   BENCH_SECONDS of virtual time and counts the system clock interrupts.
+ *   The work is done by
+ *
+ *     - a vehicle task that sleeps VEHICLE_PERIOD ticks at a time,
+ *     - a control task released by a periodic OSTmr timer,
+ *     - a button task released by an alt_alarm,
+ *     - a watchdog task whose semaphore pend always times out.
+ *
+ *   With the periodic tick (bin/idle_bench) the timer interrupts once per
+ *   tick. With tickless idle (OS_TICKLESS_EN, bin/idle_bench_tickless) it
+ *   should only interrupt when one of the above is due. Both must see the
+ *   same schedule, so every release is folded into a hash together with the
+ *   tick it happened on. The output is CSV:
+ *
+ *     variant,seconds,releases,timer_irqs,irqs_per_second,schedule_hash
+ *
+ *   Run it with ALT_HOST_CLOCK=virtual.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "includes.h"
+#include "system.h"
+#include "sys/alt_alarm.h"
+#include "alt_host.h"
+
+#define   TASK_STACKSIZE       2048
+
+#define   BENCH_PRIO           4
+#define   VEHICLE_PRIO         5
+#define   CONTROL_PRIO         6
+#define   BUTTON_PRIO          7
+#define   WATCHDOG_PRIO        8
+
+#define   BENCH_SECONDS        60
+#define   VEHICLE_PERIOD       300   /* ticks                     */
+#define   CONTROL_PERIOD       3     /* OSTmr ticks, i.e. 300 ms  */
+#define   BUTTON_PERIOD        250   /* ticks                     */
+#define   WATCHDOG_TIMEOUT     700   /* ticks                     */
+
+OS_STK    bench_stk[TASK_STACKSIZE];
+OS_STK    vehicle_stk[TASK_STACKSIZE];
+OS_STK    control_stk[TASK_STACKSIZE];
+OS_STK    button_stk[TASK_STACKSIZE];
+OS_STK    watchdog_stk[TASK_STACKSIZE];
+
+OS_EVENT *control_sem;
+OS_EVENT *button_sem;
+OS_EVENT *watchdog_sem;
+
+alt_alarm button_alarm;
+
+INT32U    start_time;
+INT32U    releases;
+alt_u32   schedule_hash = 2166136261u;  /* FNV-1a */
+
+/* Record that task 'prio' was released on the current tick */
+static void release(INT8U prio)
+{
+  INT32U event = ((OSTimeGet() - start_time) << 8) | prio;
+  int i;
+
+  for (i = 0; i < 4; i++)
+    {
+      schedule_hash ^= (event >> (8 * i)) & 0xff;
+      schedule_hash *= 16777619u;
+    }
+  releases++;
+}
+
+void controlTimerCallback(void* ptmr, void* callback_arg)
+{
+  OSSemPost(control_sem);
+}
+
+alt_u32 buttonAlarmCallback(void* context)
+{
+  OSSemPost(button_sem);
+  return BUTTON_PERIOD;
+}
+
+void vehicleTask(void* pdata)
+{
+  while (1)
+    {
+      OSTimeDly(VEHICLE_PERIOD);
+      release(VEHICLE_PRIO);
+    }
+}
+
+void controlTask(void* pdata)
+{
+  INT8U err;
+
+  while (1)
+    {
+      OSSemPend(control_sem, 0, &err);
+      release(CONTROL_PRIO);
+    }
+}
+
+void buttonTask(void* pdata)
+{
+  INT8U err;
+
+  while (1)
+    {
+      OSSemPend(button_sem, 0, &err);
+      release(BUTTON_PRIO);
+    }
+}
+
+void watchdogTask(void* pdata)
+{
+  INT8U err;
+
+  while (1)
+    {
+      OSSemPend(watchdog_sem, WATCHDOG_TIMEOUT, &err);
+      release(WATCHDOG_PRIO);
+    }
+}
+
+void benchTask(void* pdata)
+{
+  OS_TMR* control_timer;
+  alt_u32 irqs;
+  INT8U err;
+
+  if (!alt_host_clock_virtual())
+    {
+      fprintf(stderr, "idle_bench: run with ALT_HOST_CLOCK=virtual\n");
+      exit(1);
+    }
+
+  start_time = OSTimeGet();
+  irqs       = alt_host_irq_count(TIMER_0_IRQ);
+
+  control_sem  = OSSemCreate(0);
+  button_sem   = OSSemCreate(0);
+  watchdog_sem = OSSemCreate(0);
+
+  OSTaskCreateExt(vehicleTask, NULL, &vehicle_stk[TASK_STACKSIZE-1],
+		  VEHICLE_PRIO, VEHICLE_PRIO, &vehicle_stk[0],
+		  TASK_STACKSIZE, NULL, 0);
+  OSTaskCreateExt(controlTask, NULL, &control_stk[TASK_STACKSIZE-1],
+		  CONTROL_PRIO, CONTROL_PRIO, &control_stk[0],
+		  TASK_STACKSIZE, NULL, 0);
+  OSTaskCreateExt(buttonTask, NULL, &button_stk[TASK_STACKSIZE-1],
+		  BUTTON_PRIO, BUTTON_PRIO, &button_stk[0],
+		  TASK_STACKSIZE, NULL, 0);
+  OSTaskCreateExt(watchdogTask, NULL, &watchdog_stk[TASK_STACKSIZE-1],
+		  WATCHDOG_PRIO, WATCHDOG_PRIO, &watchdog_stk[0],
+		  TASK_STACKSIZE, NULL, 0);
+
+  control_timer = OSTmrCreate(CONTROL_PERIOD, CONTROL_PERIOD,
+			      OS_TMR_OPT_PERIODIC, controlTimerCallback,
+			      NULL, (INT8U *)"Control", &err);
+  OSTmrStart(control_timer, &err);
+  alt_alarm_start(&button_alarm, BUTTON_PERIOD, buttonAlarmCallback, NULL);
+
+  OSTimeDly(BENCH_SECONDS * OS_TICKS_PER_SEC);
+
+  irqs = alt_host_irq_count(TIMER_0_IRQ) - irqs;
+  printf("variant,seconds,releases,timer_irqs,irqs_per_second,schedule_hash\n");
+  printf("%s,%d,%lu,%lu,%.1f,%08lx\n",
+	 OS_TICKLESS_EN ? "tickless" : "periodic", BENCH_SECONDS,
+	 (unsigned long)releases, (unsigned long)irqs,
+	 (double)irqs / BENCH_SECONDS, (unsigned long)schedule_hash);
+
+  exit(0);
+}
+
+int main(void)
+{
+  OSTaskCreateExt(benchTask, NULL,
+		  &bench_stk[TASK_STACKSIZE-1],
+		  BENCH_PRIO, BENCH_PRIO,
+		  &bench_stk[0],
+		  TASK_STACKSIZE, NULL, 0);
+
+  OSStart();
+  return 0;
+}
@@ -0,0 +1,43 @@
+#ifndef __BENCH_SYSTEM_H_
+#define __BENCH_SYSTEM_H_
+
+/*
+ * system.h for the host benchmarks
+ *
+ * The benchmarks use the lab2-cruise BSP system, but with the largest
+ * priority range uC/OS-II supports with 8 bit ready tables, so that kernel
+ * costs can be measured with far more tasks and timers than the lab
+ * configuration allows. Everything else comes from the BSP system.h.
+ *
+ * BENCH_LOWEST_PRIO selects another priority range, for benchmarks that
+ * compare the kernel at different sizes.
+ */
+
+#include_next "system.h"
+
+#ifndef BENCH_LOWEST_PRIO
+#define BENCH_LOWEST_PRIO 63
+#endif
+
+#undef  OS_LOWEST_PRIO
+#define OS_LOWEST_PRIO BENCH_LOWEST_PRIO
+
+/* a TCB for every priority; the timer task takes one of OS_MAX_TASKS */
+#undef  OS_MAX_TASKS
+#define OS_MAX_TASKS (BENCH_LOWEST_PRIO - 1)
+
+/* enough timers to see how the timer task scales */
+#undef  OS_TMR_CFG_MAX
+#define OS_TMR_CFG_MAX 256
+
+/*
+ * os_dbg.c sums the size of the kernel data into the INT16U OSDataSize,
+ * which the TCBs and tables of more than 64 priorities overflow. Nothing
+ * in the benchmarks reads it.
+ */
+#if BENCH_LOWEST_PRIO > 63
+#undef  OS_DEBUG_EN
+#define OS_DEBUG_EN 0
+#endif
+
+#endif /* __BENCH_SYSTEM_H_ */
@@ -0,0 +1,131 @@
+/* Kernel initialization and task creation benchmark for the uC/OS-II host
+ * port
+ *
+ * Description:
+ *
+ *   Times, before OSStart(), what clears and copies kernel memory with
+ *   OS_MemClr(), OS_MemCopy() and OS_TaskStkClr():
+ *
+ *     osinit     - OSInit(), which clears the kernel tables and creates the
+ *                  idle, statistic and timer tasks with cleared stacks,
+ *     taskcreate - OSTaskCreateExt() of a task of TASK_STACKSIZE words
+ *                  with OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR,
+ *     taskquery  - OSTaskQuery(), a copy of the OS_TCB.
+ *
+ *   BENCH_ITERATIONS times each, with clock_gettime(). The kernel is built
+ *   with
+ *
+ *     byte - the byte and stack entry loops, OS_MEM_WORD_EN = 0
+ *            (bin/init_bench_byte),
+ *     word - 32 bit words, 4 at a time, as on the Nios2
+ *            (bin/init_bench_word),
+ *     libc - the memset() and memcpy() of the host (bin/init_bench).
+ *
+ *   byte and word are compiled with -fno-tree-loop-distribute-patterns:
+ *   gcc would otherwise turn the clear loops into memset() calls, which the
+ *   Nios2 toolchain does not. The contexts of the host port are cleared too
+ *   when they are reused for a task with stack checking, so all three are
+ *   built with 16 KB host stacks to keep that small. The output is CSV:
+ *
+ *     mode,case,iterations,min_ns,median_ns
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "includes.h"
+#include "system.h"
+
+#define   TASK_STACKSIZE       2048
+#define   TASK_PRIO            5
+
+#define   BENCH_ITERATIONS     1000
+
+#if OS_MEM_WORD_EN == 0
+#define   MODE                 "byte"
+#elif defined(OS_CPU_MEM_CLR)
+#define   MODE                 "libc"
+#else
+#define   MODE                 "word"
+#endif
+
+OS_STK    task_stk[TASK_STACKSIZE];
+
+double    samples[BENCH_ITERATIONS];
+
+static double now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int cmpDouble(const void* a, const void* b)
+{
+  double x = *(const double*)a;
+  double y = *(const double*)b;
+
+  return (x > y) - (x < y);
+}
+
+static void report(const char* name)
+{
+  qsort(samples, BENCH_ITERATIONS, sizeof(double), cmpDouble);
+  printf("%s,%s,%d,%.0f,%.0f\n", MODE, name, BENCH_ITERATIONS,
+	 samples[0], samples[BENCH_ITERATIONS / 2]);
+}
+
+void task(void* pdata)
+{
+}
+
+int main(void)
+{
+  OS_TCB tcb;
+  double t;
+  int prio;
+  int i;
+
+  printf("# OS_TCB of %lu bytes, %d tasks, %d events, %d word task stack\n",
+	 (unsigned long)sizeof(OS_TCB), OS_MAX_TASKS, OS_MAX_EVENTS,
+	 TASK_STACKSIZE);
+  printf("mode,case,iterations,min_ns,median_ns\n");
+
+  for (i = 0; i < BENCH_ITERATIONS; i++)
+    {
+      /* Give the host contexts of the system tasks back for reuse */
+      for (prio = 0; prio <= OS_LOWEST_PRIO; prio++)
+	if (OSTCBPrioTbl[prio] && OSTCBPrioTbl[prio] != OS_TCB_RESERVED)
+	  OSTaskDelHook(OSTCBPrioTbl[prio]);
+      t = now_ns();
+      OSInit();
+      samples[i] = now_ns() - t;
+    }
+  report("osinit");
+
+  for (i = 0; i < BENCH_ITERATIONS; i++)
+    {
+      t = now_ns();
+      OSTaskCreateExt(task, NULL, &task_stk[TASK_STACKSIZE-1],
+		      TASK_PRIO, TASK_PRIO, &task_stk[0], TASK_STACKSIZE,
+		      NULL, OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR);
+      samples[i] = now_ns() - t;
+      OSTaskDel(TASK_PRIO);
+    }
+  report("taskcreate");
+
+  OSTaskCreateExt(task, NULL, &task_stk[TASK_STACKSIZE-1],
+		  TASK_PRIO, TASK_PRIO, &task_stk[0], TASK_STACKSIZE,
+		  NULL, OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR);
+  for (i = 0; i < BENCH_ITERATIONS; i++)
+    {
+      t = now_ns();
+      OSTaskQuery(TASK_PRIO, &tcb);
+      samples[i] = now_ns() - t;
+    }
+  report("taskquery");
+
+  return 0;
+}
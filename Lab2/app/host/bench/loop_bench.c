@@ -0,0 +1,404 @@
+/* Vehicle/control loop latency benchmark for the uC/OS-II host port
+ *
+ * Description:
+ *
+ *   Runs the data flow of the cruise control lab for BENCH_PERIODS periods
+ *   of virtual time and measures how late each period completes. A release
+ *   task signals the vehicle and control tasks every LOOP_PERIOD ticks and
+ *   the switch and button tasks every io_period ticks. The tasks exchange
+ *   the same values as in cruise_skeleton.c, once through mailboxes and
+ *   once through state registers (OS_REG_EN):
+ *
+ *     mbox - the vehicle task reads throttle, brake and engine with
+ *            OSMboxPend() and a timeout of one tick, the control task waits
+ *            for velocity, gas, cruise and top gear without a timeout,
+ *     reg  - both tasks read the latest values with OSRegRead().
+ *
+ *   The latency of a period is the number of ticks from its release until
+ *   both the vehicle step and the new throttle are done. The tasks take no
+ *   time in virtual time, so it only counts the ticks spent waiting for a
+ *   value. A period is missed if it is not done when the next one is
+ *   released; that happens to the mailboxes when the inputs are posted less
+ *   often than the loop runs. The output is CSV:
+ *
+ *     loop,io_period,periods,missed,latency_mean_ticks,latency_max_ticks
+ *
+ *   Run it with ALT_HOST_CLOCK=virtual.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "includes.h"
+#include "alt_host.h"
+
+#define   TASK_STACKSIZE       2048
+
+#define   RELEASE_PRIO         4
+#define   VEHICLE_PRIO         10
+#define   CONTROL_PRIO         12
+#define   SWITCH_PRIO          13
+#define   BUTTON_PRIO          14
+
+#define   BENCH_PERIODS        200
+#define   LOOP_PERIOD          300   /* ticks, VEHICLE_PERIOD and CONTROL_PERIOD */
+
+enum active {on = 2, off = 1};
+
+typedef struct
+{
+  enum active gas;
+  enum active brake;
+  enum active cruise;
+} buttons_state;
+
+typedef struct
+{
+  enum active engine;
+  enum active top_gear;
+} switches_state;
+
+OS_STK    release_stk[TASK_STACKSIZE];
+OS_STK    vehicle_stk[TASK_STACKSIZE];
+OS_STK    control_stk[TASK_STACKSIZE];
+OS_STK    switch_stk[TASK_STACKSIZE];
+OS_STK    button_stk[TASK_STACKSIZE];
+
+OS_EVENT *sem_vehicle;
+OS_EVENT *sem_control;
+OS_EVENT *sem_switch;
+OS_EVENT *sem_button;
+
+/* mbox loop */
+OS_EVENT *Mbox_Throttle;
+OS_EVENT *Mbox_Velocity;
+OS_EVENT *Mbox_Brake;
+OS_EVENT *Mbox_Engine;
+OS_EVENT *Mbox_Gas;
+OS_EVENT *Mbox_Cruise;
+OS_EVENT *Mbox_TopGear;
+
+/* reg loop */
+OS_REG   *Reg_Throttle;
+OS_REG   *Reg_Velocity;
+OS_REG   *Reg_Buttons;
+OS_REG   *Reg_Switches;
+
+/* Storage of the registers */
+INT8U          throttle_reg;
+INT16S         velocity_reg;
+buttons_state  buttons_reg  = {off, off, off};
+switches_state switches_reg = {off, off};
+
+int       use_regs;
+
+/* Release tick and completion ticks of each period */
+INT32U    release_tick[BENCH_PERIODS];
+INT32U    vehicle_done[BENCH_PERIODS];
+INT32U    control_done[BENCH_PERIODS];
+int       releases;
+
+void vehicleTask(void* pdata)
+{
+  static INT8U no_throttle = 0;
+  INT8U throttle_now;
+  enum active brake = off;
+  enum active engine = off;
+  buttons_state buttons;
+  switches_state switches;
+  INT8U* throttle = &no_throttle;
+  INT16S velocity = 0;
+  void* msg;
+  INT8U err;
+  int k;
+
+  for (k = 0; k < BENCH_PERIODS; k++)
+    {
+      if (use_regs)
+	OSRegWrite(Reg_Velocity, &velocity);
+      else
+	OSMboxPost(Mbox_Velocity, &velocity);
+
+      OSSemPend(sem_vehicle, 0, &err);
+
+      if (use_regs)
+	{
+	  OSRegRead(Reg_Throttle, &throttle_now, &err);
+	  OSRegRead(Reg_Buttons, &buttons, &err);
+	  OSRegRead(Reg_Switches, &switches, &err);
+	  throttle = &throttle_now;
+	  brake    = buttons.brake;
+	  engine   = switches.engine;
+	}
+      else
+	{
+	  msg = OSMboxPend(Mbox_Throttle, 1, &err);
+	  if (err == OS_NO_ERR)
+	    throttle = (INT8U *)msg;
+	  msg = OSMboxPend(Mbox_Brake, 1, &err);
+	  if (err == OS_NO_ERR)
+	    brake = *((enum active *)msg);
+	  msg = OSMboxPend(Mbox_Engine, 1, &err);
+	  if (err == OS_NO_ERR)
+	    engine = *((enum active *)msg);
+	}
+
+      if (brake == off && engine == on)
+	velocity += *throttle / 10 - velocity / 10;
+      else
+	velocity -= velocity / 4;
+      vehicle_done[k] = OSTimeGet();
+    }
+
+  /* The velocity of the last step, for the last pass of the control task */
+  if (!use_regs)
+    OSMboxPost(Mbox_Velocity, &velocity);
+  OSTaskSuspend(OS_PRIO_SELF);
+}
+
+/* Throttle step of the control task */
+static INT8U controlLaw(INT8U throttle, INT16S velocity, enum active gas,
+			enum active top_gear)
+{
+  if (gas == on || (top_gear == on && velocity < 20))
+    return throttle < 80 ? throttle + 5 : 80;
+  return throttle > 0 ? throttle - 5 : 0;
+}
+
+void controlTask(void* pdata)
+{
+  buttons_state buttons;
+  switches_state switches;
+  enum active gas;
+  enum active top_gear;
+  INT16S velocity;
+  INT8U throttle = 0;
+  void* msg;
+  INT8U err;
+  int k;
+
+  if (use_regs)
+    {
+      for (k = 0; k < BENCH_PERIODS; k++)
+	{
+	  OSSemPend(sem_control, 0, &err);
+	  OSRegRead(Reg_Velocity, &velocity, &err);
+	  OSRegRead(Reg_Buttons, &buttons, &err);
+	  OSRegRead(Reg_Switches, &switches, &err);
+	  throttle = controlLaw(throttle, velocity, buttons.gas,
+				switches.top_gear);
+	  OSRegWrite(Reg_Throttle, &throttle);
+	  control_done[k] = OSTimeGet();
+	}
+    }
+  else
+    {
+      /* As in cruise_skeleton.c the task reads before it waits for the
+	 release, so its first pass belongs to no period */
+      for (k = -1; k < BENCH_PERIODS; k++)
+	{
+	  msg = OSMboxPend(Mbox_Velocity, 0, &err);
+	  velocity = *(INT16S *)msg;
+	  msg = OSMboxPend(Mbox_Gas, 0, &err);
+	  gas = *((enum active *)msg);
+	  msg = OSMboxPend(Mbox_Cruise, 0, &err);
+	  msg = OSMboxPend(Mbox_TopGear, 0, &err);
+	  top_gear = *((enum active *)msg);
+	  throttle = controlLaw(throttle, velocity, gas, top_gear);
+	  OSMboxPost(Mbox_Throttle, &throttle);
+	  if (k >= 0)
+	    control_done[k] = OSTimeGet();
+	  OSSemPend(sem_control, 0, &err);
+	}
+    }
+
+  OSTaskSuspend(OS_PRIO_SELF);
+}
+
+/* The switches and buttons follow a fixed script of the tick */
+void switchTask(void* pdata)
+{
+  switches_state switches;
+  INT8U err;
+
+  while (1)
+    {
+      OSSemPend(sem_switch, 0, &err);
+      switches.engine   = (OSTimeGet() / 1000) % 8 != 7 ? on : off;
+      switches.top_gear = (OSTimeGet() / 4000) % 2 ? on : off;
+      if (use_regs)
+	OSRegWrite(Reg_Switches, &switches);
+      else
+	{
+	  OSMboxPost(Mbox_Engine, &switches.engine);
+	  OSMboxPost(Mbox_TopGear, &switches.top_gear);
+	}
+    }
+}
+
+void buttonTask(void* pdata)
+{
+  buttons_state buttons;
+  INT8U err;
+
+  while (1)
+    {
+      OSSemPend(sem_button, 0, &err);
+      buttons.gas    = (OSTimeGet() / 1500) % 2 ? on : off;
+      buttons.brake  = (OSTimeGet() / 700) % 5 == 4 ? on : off;
+      buttons.cruise = off;
+      if (use_regs)
+	OSRegWrite(Reg_Buttons, &buttons);
+      else
+	{
+	  OSMboxPost(Mbox_Gas, &buttons.gas);
+	  OSMboxPost(Mbox_Brake, &buttons.brake);
+	  OSMboxPost(Mbox_Cruise, &buttons.cruise);
+	}
+    }
+}
+
+static void createTask(void (*task)(void*), OS_STK* stk, INT8U prio)
+{
+  OSTaskCreateExt(task, NULL, &stk[TASK_STACKSIZE-1], prio, prio,
+		  &stk[0], TASK_STACKSIZE, NULL, 0);
+}
+
+/* Runs one loop for BENCH_PERIODS periods and prints its row */
+static void runLoop(int regs, int io_period)
+{
+  static enum active initial_off = off;
+  INT32U latency, sum = 0, max = 0;
+  INT32U tick;
+  int missed = 0;
+  INT8U err;
+  int k;
+
+  use_regs = regs;
+  releases = 0;
+  for (k = 0; k < BENCH_PERIODS; k++)
+    vehicle_done[k] = control_done[k] = 0;
+
+  sem_vehicle = OSSemCreate(0);
+  sem_control = OSSemCreate(0);
+  sem_switch  = OSSemCreate(0);
+  sem_button  = OSSemCreate(0);
+
+  if (!regs)
+    {
+      /* As created by StartTask() in cruise_skeleton.c */
+      Mbox_Throttle = OSMboxCreate((void *)0);
+      Mbox_Velocity = OSMboxCreate((void *)0);
+      Mbox_Brake    = OSMboxCreate((void *)&initial_off);
+      Mbox_Engine   = OSMboxCreate((void *)&initial_off);
+      Mbox_Gas      = OSMboxCreate((void *)&initial_off);
+      Mbox_Cruise   = OSMboxCreate((void *)&initial_off);
+      Mbox_TopGear  = OSMboxCreate((void *)0);
+    }
+
+  createTask(vehicleTask, vehicle_stk, VEHICLE_PRIO);
+  createTask(controlTask, control_stk, CONTROL_PRIO);
+  createTask(switchTask, switch_stk, SWITCH_PRIO);
+  createTask(buttonTask, button_stk, BUTTON_PRIO);
+
+  /* Release, and give the last period time to complete */
+  for (tick = 0; tick < (BENCH_PERIODS + 1) * LOOP_PERIOD; tick++)
+    {
+      OSTimeDly(1);
+      if (tick % io_period == 0)
+	{
+	  OSSemPost(sem_switch);
+	  OSSemPost(sem_button);
+	}
+      if (tick % LOOP_PERIOD == 0 && releases < BENCH_PERIODS)
+	{
+	  release_tick[releases++] = OSTimeGet();
+	  OSSemPost(sem_vehicle);
+	  OSSemPost(sem_control);
+	}
+    }
+
+  for (k = 0; k < BENCH_PERIODS; k++)
+    {
+      latency = vehicle_done[k] > control_done[k]
+	? vehicle_done[k] : control_done[k];
+      if (vehicle_done[k] == 0 || control_done[k] == 0
+	  || latency - release_tick[k] >= LOOP_PERIOD)
+	{
+	  missed++;
+	  continue;
+	}
+      latency -= release_tick[k];
+      sum += latency;
+      if (latency > max)
+	max = latency;
+    }
+
+  printf("%s,%d,%d,%d,%.2f,%lu\n", regs ? "reg" : "mbox", io_period,
+	 BENCH_PERIODS, missed,
+	 missed < BENCH_PERIODS ? (double)sum / (BENCH_PERIODS - missed) : 0,
+	 (unsigned long)max);
+
+  OSTaskDel(VEHICLE_PRIO);
+  OSTaskDel(CONTROL_PRIO);
+  OSTaskDel(SWITCH_PRIO);
+  OSTaskDel(BUTTON_PRIO);
+
+  OSSemDel(sem_vehicle, OS_DEL_ALWAYS, &err);
+  OSSemDel(sem_control, OS_DEL_ALWAYS, &err);
+  OSSemDel(sem_switch, OS_DEL_ALWAYS, &err);
+  OSSemDel(sem_button, OS_DEL_ALWAYS, &err);
+  if (!regs)
+    {
+      OSMboxDel(Mbox_Throttle, OS_DEL_ALWAYS, &err);
+      OSMboxDel(Mbox_Velocity, OS_DEL_ALWAYS, &err);
+      OSMboxDel(Mbox_Brake, OS_DEL_ALWAYS, &err);
+      OSMboxDel(Mbox_Engine, OS_DEL_ALWAYS, &err);
+      OSMboxDel(Mbox_Gas, OS_DEL_ALWAYS, &err);
+      OSMboxDel(Mbox_Cruise, OS_DEL_ALWAYS, &err);
+      OSMboxDel(Mbox_TopGear, OS_DEL_ALWAYS, &err);
+    }
+}
+
+void releaseTask(void* pdata)
+{
+  static const int io_periods[] = {10, 100, 500};
+  INT8U err;
+  int i;
+
+  if (!alt_host_clock_virtual())
+    {
+      fprintf(stderr, "loop_bench: run with ALT_HOST_CLOCK=virtual\n");
+      exit(1);
+    }
+
+  Reg_Throttle = OSRegCreate(&throttle_reg, sizeof(throttle_reg), &err);
+  Reg_Velocity = OSRegCreate(&velocity_reg, sizeof(velocity_reg), &err);
+  Reg_Buttons  = OSRegCreate(&buttons_reg, sizeof(buttons_reg), &err);
+  Reg_Switches = OSRegCreate(&switches_reg, sizeof(switches_reg), &err);
+  if (err != OS_NO_ERR)
+    {
+      fprintf(stderr, "loop_bench: OSRegCreate() failed (%d)\n", err);
+      exit(1);
+    }
+
+  printf("# vehicle/control loop latency, LOOP_PERIOD %d ticks\n",
+	 LOOP_PERIOD);
+  printf("loop,io_period,periods,missed,latency_mean_ticks,"
+	 "latency_max_ticks\n");
+
+  for (i = 0; i < sizeof(io_periods) / sizeof(io_periods[0]); i++)
+    {
+      runLoop(0, io_periods[i]);
+      runLoop(1, io_periods[i]);
+    }
+
+  exit(0);
+}
+
+int main(void)
+{
+  createTask(releaseTask, release_stk, RELEASE_PRIO);
+
+  OSStart();
+  return 0;
+}
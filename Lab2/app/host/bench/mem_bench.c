@@ -0,0 +1,200 @@
+/* Memory partition benchmark for the uC/OS-II host port
+ *
+ * Description:
+ *
+ *   BENCH_TASKS tasks of different priorities take blocks from one
+ *   partition with OSMemGet() and put them back with OSMemPut() as fast as
+ *   they can, keeping LIVE_BLOCKS blocks each and replacing a random one at
+ *   a time. Every BURST_OPS requests a task sleeps for a tick. Meanwhile an
+ *   alarm callback, in the context of the system clock interrupt, takes
+ *   ISR_BLOCKS blocks on every tick and puts back those of the tick before.
+ *   The partition is built as
+ *
+ *     irqoff   - the free list behind disabled interrupts (bin/mem_bench),
+ *     stats    - the same with OS_MEM_STATS_EN (bin/mem_bench_stats),
+ *     lockfree - popped and pushed with OS_CPU_CAS(), with
+ *                OS_MEM_LOCK_FREE_EN and OS_MEM_STATS_EN
+ *                (bin/mem_bench_lockfree).
+ *
+ *   A block is marked with its owner while it is held and the mark is
+ *   checked when it is taken, to catch blocks handed out twice. The time is
+ *   the CPU time of the tasks, from OS_TASK_PROFILE_EN. The output is CSV:
+ *
+ *     mode,tasks,requests,ns_per_request,isr_requests,corrupt
+ *
+ *   followed by what OSMemQuery() reports with OS_MEM_STATS_EN. Run it with
+ *   the real host clock (the default).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "includes.h"
+#include "system.h"
+#include "alt_host.h"
+#include "sys/alt_alarm.h"
+
+#define   TASK_STACKSIZE       2048
+
+#define   BENCH_PRIO           4
+#define   WORKER_PRIO          5     /* first of BENCH_TASKS */
+
+#define   BENCH_TASKS          4
+#define   TASK_REQUESTS        4000000
+#define   BURST_OPS            20000
+#define   LIVE_BLOCKS          16
+#define   ISR_BLOCKS           8
+#define   PART_BLOCKS          (BENCH_TASKS * LIVE_BLOCKS + 2 * ISR_BLOCKS)
+#define   BLOCK_SIZE           32
+
+OS_STK    bench_stk[TASK_STACKSIZE];
+OS_STK    worker_stk[BENCH_TASKS][TASK_STACKSIZE];
+
+INT32U    part_mem[PART_BLOCKS][BLOCK_SIZE / sizeof(INT32U)];
+OS_MEM*   part;
+
+OS_EVENT* done_sem;
+alt_alarm isr_alarm;
+
+void*     isr_blocks[ISR_BLOCKS];
+unsigned long isr_requests;
+unsigned long corrupt;
+
+/* Word 0 of a free block is the link of the free list, word 1 the owner */
+static void* take(INT32U owner)
+{
+  INT32U* blk;
+  INT8U err;
+
+  blk = OSMemGet(part, &err);
+  if (!blk)
+    return NULL;
+  if (blk[1] != 0)
+    corrupt++;
+  blk[1] = owner;
+  return blk;
+}
+
+static void give(void* blk, INT32U owner)
+{
+  if (((INT32U*)blk)[1] != owner)
+    corrupt++;
+  ((INT32U*)blk)[1] = 0;
+  OSMemPut(part, blk);
+}
+
+alt_u32 isrCallback(void* context)
+{
+  int i;
+
+  for (i = 0; i < ISR_BLOCKS; i++)
+    {
+      if (isr_blocks[i])
+	give(isr_blocks[i], BENCH_TASKS + 1);
+      isr_blocks[i] = take(BENCH_TASKS + 1);
+      isr_requests++;
+    }
+  return 1;
+}
+
+void workerTask(void* pdata)
+{
+  void* blocks[LIVE_BLOCKS];
+  unsigned int seed = 2206 + (unsigned int)(long)pdata;
+  INT32U owner = (INT32U)(long)pdata + 1;
+  void** b;
+  long n;
+
+  memset(blocks, 0, sizeof(blocks));
+  for (n = 0; n < TASK_REQUESTS; n++)
+    {
+      seed = seed * 1664525 + 1013904223;
+      b = &blocks[(seed >> 8) % LIVE_BLOCKS];
+      if (*b)
+	give(*b, owner);
+      *b = take(owner);
+      if (!*b)
+	{
+	  printf("# OSMemGet() failed\n");
+	  exit(1);
+	}
+
+      if (n % BURST_OPS == BURST_OPS - 1)
+	OSTimeDly(1);
+    }
+  for (n = 0; n < LIVE_BLOCKS; n++)
+    give(blocks[n], owner);
+
+  OSSemPost(done_sem);
+  OSTaskSuspend(OS_PRIO_SELF);
+}
+
+void benchTask(void* pdata)
+{
+  OS_MEM_DATA data;
+  OS_TCB tcb;
+  double ns = 0;
+  INT8U err;
+  int i;
+
+  if (alt_host_clock_virtual())
+    {
+      fprintf(stderr, "mem_bench: run with the real host clock\n");
+      exit(1);
+    }
+
+  memset(part_mem, 0, sizeof(part_mem));
+  part = OSMemCreate(part_mem, PART_BLOCKS, BLOCK_SIZE, &err);
+  done_sem = OSSemCreate(0);
+  alt_alarm_start(&isr_alarm, 1, isrCallback, NULL);
+
+  for (i = 0; i < BENCH_TASKS; i++)
+    OSTaskCreateExt(workerTask, (void*)(long)i,
+		    &worker_stk[i][TASK_STACKSIZE-1],
+		    WORKER_PRIO + i, WORKER_PRIO + i, &worker_stk[i][0],
+		    TASK_STACKSIZE, NULL, 0);
+  for (i = 0; i < BENCH_TASKS; i++)
+    OSSemPend(done_sem, 0, &err);
+  alt_alarm_stop(&isr_alarm);
+
+  for (i = 0; i < BENCH_TASKS; i++)
+    {
+      OSTaskQuery(WORKER_PRIO + i, &tcb);
+      ns += tcb.OSTCBCyclesTot * (1e9 / OSCPUCyclesFreq());
+    }
+
+  /* an OSMemGet() and an OSMemPut() per request */
+  printf("# %d blocks of %d bytes, %d held by the ISR\n",
+	 PART_BLOCKS, BLOCK_SIZE, ISR_BLOCKS);
+  printf("mode,tasks,requests,ns_per_request,isr_requests,corrupt\n");
+  printf("%s,%d,%ld,%.1f,%lu,%lu\n",
+	 OS_MEM_LOCK_FREE ? "lockfree" : OS_MEM_STATS_EN ? "stats" : "irqoff",
+	 BENCH_TASKS, (long)BENCH_TASKS * TASK_REQUESTS,
+	 ns / ((double)BENCH_TASKS * TASK_REQUESTS), isr_requests, corrupt);
+
+  OSMemQuery(part, &data);
+  printf("# %lu of %lu blocks free", (unsigned long)data.OSNFree,
+	 (unsigned long)data.OSNBlks);
+#if OS_MEM_STATS_EN > 0
+  /* OSHoldMean in whole microseconds, and unrounded */
+  printf(", %lu gets, %lu failed, at most %lu used, held %lu us (%.3f us) on average",
+	 (unsigned long)data.OSNGet, (unsigned long)data.OSNFail,
+	 (unsigned long)data.OSNUsedMax, (unsigned long)data.OSHoldMean,
+	 part->OSMemUseTicks * (1e6 / OS_TICKS_PER_SEC) / data.OSNGet);
+#endif
+  printf("\n");
+
+  exit(0);
+}
+
+int main(void)
+{
+  OSTaskCreateExt(benchTask, NULL,
+		  &bench_stk[TASK_STACKSIZE-1],
+		  BENCH_PRIO, BENCH_PRIO,
+		  &bench_stk[0],
+		  TASK_STACKSIZE, NULL, 0);
+
+  OSStart();
+  return 0;
+}
@@ -0,0 +1,331 @@
+/* Fixed-point cruise model benchmark for the uC/OS-II host port
+ *
+ * Description:
+ *
+ *   Drives the vehicle model and the controller of the cruise control lab
+ *   through a fixed scenario of BENCH_PERIODS periods (engine on, top gear,
+ *   full gas, cruise control at CRUISE_TARGET m/s over the hills, braking,
+ *   gas again and coasting), in three implementations:
+ *
+ *     double - the model and the PI law in double precision; the
+ *              reference. Only what the tasks exchange is rounded as in
+ *              the lab: the velocity to whole m/s, the throttle down to
+ *              whole 0.1 V,
+ *     int    - the previous cruise_skeleton.c code: integer state, the
+ *              velocity update in double, and the PI gains computed in
+ *              integer arithmetic,
+ *     fixed  - lab2-cruise/src/cruise_model.h.
+ *
+ *   For each one it prints the largest and the mean difference of the
+ *   velocity and the throttle the tasks exchange from the reference, and
+ *   the time of one period (vehicle step plus control step) on the host,
+ *   the median of BENCH_RUNS runs. The host has an FPU, a multiplier and a
+ *   divider, so the time says little about the Nios II, where the double
+ *   and integer division code of int calls into libgcc; the cruise skeleton
+ *   built with -DCRUISE_PERF=1 counts the cycles of the fixed steps on the
+ *   board. The output is CSV:
+ *
+ *     impl,max_dv,mean_dv,max_dthrottle,mean_dthrottle,period_ns
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "includes.h"
+
+#define   TASK_STACKSIZE       2048
+
+#define   BENCH_PRIO           1
+
+#define   BENCH_PERIODS        800
+#define   BENCH_REPEAT         100
+#define   BENCH_RUNS           9
+
+#define   CRUISE_TARGET        60
+
+/* As in cruise_skeleton.c */
+#define   THROTTLE_K           2
+#define   THROTTLE_TI          100
+#define   DEFAULT_THROTTLE     5
+#define   VEHICLE_PERIOD       300
+#define   CONTROL_PERIOD       300
+
+#include "../../lab2-cruise/src/cruise_model.h"
+
+OS_STK    bench_stk[TASK_STACKSIZE];
+
+enum impl {IMPL_DOUBLE, IMPL_INT, IMPL_FIXED, IMPLS};
+
+static const char* const impl_names[IMPLS] = {"double", "int", "fixed"};
+
+/* Inputs of one period */
+typedef struct
+{
+  int gas;
+  int brake;
+  int cruise;
+} inputs;
+
+/* State of every implementation */
+typedef struct
+{
+  /* double */
+  double d_position;
+  double d_velocity;
+  double d_throttle;
+  double d_last_error;
+
+  /* int */
+  INT16U i_position;
+  INT16S i_velocity;
+  INT8U  i_throttle;
+  INT16S i_last_error;
+
+  /* fixed */
+  struct vehicle_model f_model;
+  struct pi_control    f_control;
+} state;
+
+/* Velocity and throttle as exchanged by the tasks, per period */
+static double trace[IMPLS][BENCH_PERIODS][2];
+
+static double now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int compare_double(const void* a, const void* b)
+{
+  double x = *(const double*)a;
+  double y = *(const double*)b;
+
+  return (x > y) - (x < y);
+}
+
+static void scenario(int k, inputs* in)
+{
+  in->gas    = (k < 40) || (k >= 620 && k < 700);
+  in->cruise = (k >= 40 && k < 600);
+  in->brake  = (k >= 600 && k < 620);
+}
+
+static int gravity(double position)
+{
+  if (400 <= position && position < 800)
+    return -2;
+  else if (800 <= position && position < 1200)
+    return -4;
+  else if (1600 <= position && position < 2000)
+    return 4;
+  else if (2000 <= position)
+    return 2;
+  return 0;
+}
+
+/* One period of the reference, the vehicle first as in the lab */
+static void periodDouble(state* s, const inputs* in)
+{
+  double velocity;
+  double a;
+  double e;
+
+  if (!in->brake)
+    a = -s->d_velocity + floor(s->d_throttle) + gravity(s->d_position);
+  else
+    a = -4 * s->d_velocity;
+  s->d_position += s->d_velocity * VEHICLE_PERIOD / 1000.0;
+  s->d_velocity += a * VEHICLE_PERIOD / 1000.0;
+  if (s->d_position > 2400)
+    s->d_position = 0;
+
+  velocity = floor(s->d_velocity + 0.5);
+  if (in->cruise && velocity > 20)
+    {
+      e = CRUISE_TARGET - velocity;
+      s->d_throttle += THROTTLE_K * (1 + CONTROL_PERIOD / (2.0 * THROTTLE_TI)) * e
+	+ (CONTROL_PERIOD / (2.0 * THROTTLE_TI) - 1) * s->d_last_error;
+      s->d_last_error = e;
+    }
+  else
+    {
+      s->d_throttle += in->gas ? DEFAULT_THROTTLE : -DEFAULT_THROTTLE;
+      s->d_last_error = 0;
+    }
+  s->d_throttle = s->d_throttle < 0 ? 0 : s->d_throttle > 80 ? 80 : s->d_throttle;
+}
+
+/* One period of the previous VehicleTask and ControlTask code */
+static void periodInt(state* s, const inputs* in)
+{
+  const unsigned int wind_factor = 1;
+  const unsigned int brake_factor = 4;
+  INT16S acceleration;
+  INT8U throttle = s->i_throttle;
+
+  if (throttle > 80)
+    throttle = 80;
+  if (!in->brake)
+    {
+      acceleration = -wind_factor * s->i_velocity;
+      acceleration += throttle;
+      acceleration += gravity(s->i_position);
+    }
+  else
+    acceleration = -brake_factor * s->i_velocity;
+  s->i_position = s->i_position + s->i_velocity * VEHICLE_PERIOD / 1000;
+  s->i_velocity = s->i_velocity + acceleration * VEHICLE_PERIOD / 1000.0;
+  if (s->i_position > 2400)
+    s->i_position = 0;
+
+  if (in->cruise && s->i_velocity > 20)
+    {
+      s->i_throttle = s->i_throttle + THROTTLE_K * (1 + CONTROL_PERIOD / (2 * THROTTLE_TI)) * (CRUISE_TARGET - s->i_velocity) + (CONTROL_PERIOD / (2 * THROTTLE_TI) - 1) * s->i_last_error;
+      s->i_last_error = CRUISE_TARGET - s->i_velocity;
+    }
+  else
+    {
+      s->i_last_error = 0;
+      if (in->gas)
+	s->i_throttle += DEFAULT_THROTTLE;
+      else
+	s->i_throttle = s->i_throttle > 0 ? s->i_throttle - DEFAULT_THROTTLE : 0;
+    }
+  if (s->i_throttle > 80)
+    s->i_throttle = 80;
+}
+
+/* One period of VehicleTask and ControlTask with cruise_model.h */
+static void periodFixed(state* s, const inputs* in)
+{
+  INT32S velocity;
+
+  vehicle_step(&s->f_model, control_throttle(&s->f_control), in->brake, 1);
+
+  velocity = vehicle_velocity(&s->f_model);
+  if (in->cruise && velocity > 20)
+    control_pi(&s->f_control, CRUISE_TARGET - velocity);
+  else
+    control_manual(&s->f_control, in->gas);
+}
+
+static void period(int impl, state* s, const inputs* in)
+{
+  switch (impl)
+    {
+    case IMPL_DOUBLE: periodDouble(s, in); break;
+    case IMPL_INT: periodInt(s, in); break;
+    case IMPL_FIXED: periodFixed(s, in); break;
+    }
+}
+
+/* Runs the scenario once, recording what the tasks would exchange */
+static void record(int impl)
+{
+  state s = {0};
+  inputs in;
+  int k;
+
+  for (k = 0; k < BENCH_PERIODS; k++)
+    {
+      scenario(k, &in);
+      period(impl, &s, &in);
+      switch (impl)
+	{
+	case IMPL_DOUBLE:
+	  trace[impl][k][0] = s.d_velocity;
+	  trace[impl][k][1] = s.d_throttle;
+	  break;
+	case IMPL_INT:
+	  trace[impl][k][0] = s.i_velocity;
+	  trace[impl][k][1] = s.i_throttle;
+	  break;
+	case IMPL_FIXED:
+	  trace[impl][k][0] = vehicle_velocity(&s.f_model);
+	  trace[impl][k][1] = control_throttle(&s.f_control);
+	  break;
+	}
+    }
+}
+
+/* Median time of one period, in ns */
+static double measure(int impl)
+{
+  static inputs in[BENCH_PERIODS];
+  double runs[BENCH_RUNS];
+  volatile double sink;
+  double start;
+  state s;
+  int run;
+  int r;
+  int k;
+
+  for (k = 0; k < BENCH_PERIODS; k++)
+    scenario(k, &in[k]);
+
+  for (run = 0; run < BENCH_RUNS; run++)
+    {
+      start = now_ns();
+      for (r = 0; r < BENCH_REPEAT; r++)
+	{
+	  memset(&s, 0, sizeof(s));
+	  for (k = 0; k < BENCH_PERIODS; k++)
+	    period(impl, &s, &in[k]);
+	  sink = s.d_velocity + s.i_velocity + s.f_model.velocity;
+	}
+      runs[run] = (now_ns() - start) / (BENCH_REPEAT * BENCH_PERIODS);
+    }
+  (void)sink;
+
+  qsort(runs, BENCH_RUNS, sizeof(runs[0]), compare_double);
+  return runs[BENCH_RUNS / 2];
+}
+
+void benchTask(void* pdata)
+{
+  double dv, dt, max_dv, max_dt, sum_dv, sum_dt;
+  int impl;
+  int k;
+
+  for (impl = 0; impl < IMPLS; impl++)
+    record(impl);
+
+  printf("# cruise model and controller, %d periods, difference from double\n",
+	 BENCH_PERIODS);
+  printf("impl,max_dv,mean_dv,max_dthrottle,mean_dthrottle,period_ns\n");
+
+  for (impl = 0; impl < IMPLS; impl++)
+    {
+      max_dv = max_dt = sum_dv = sum_dt = 0;
+      for (k = 0; k < BENCH_PERIODS; k++)
+	{
+	  dv = fabs(trace[impl][k][0] - trace[IMPL_DOUBLE][k][0]);
+	  dt = fabs(trace[impl][k][1] - trace[IMPL_DOUBLE][k][1]);
+	  max_dv = dv > max_dv ? dv : max_dv;
+	  max_dt = dt > max_dt ? dt : max_dt;
+	  sum_dv += dv;
+	  sum_dt += dt;
+	}
+      printf("%s,%.2f,%.2f,%.2f,%.2f,%.1f\n", impl_names[impl], max_dv,
+	     sum_dv / BENCH_PERIODS, max_dt, sum_dt / BENCH_PERIODS,
+	     measure(impl));
+    }
+
+  exit(0);
+}
+
+int main(void)
+{
+  OSTaskCreateExt(benchTask, NULL,
+		  &bench_stk[TASK_STACKSIZE-1],
+		  BENCH_PRIO, BENCH_PRIO,
+		  &bench_stk[0],
+		  TASK_STACKSIZE, NULL, 0);
+
+  OSStart();
+  return 0;
+}
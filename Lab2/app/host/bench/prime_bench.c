@@ -0,0 +1,215 @@
+/* Prime generator benchmark for the lab1_timer next_prime()
+ *
+ * Description:
+ *
+ *   lab1-io-sol/lab1_timer/main.c streams the primes by calling
+ *   next_prime() with the prime it returned last. This streams them from 0
+ *   up to limits of 10^3 to 10^7 with two implementations:
+ *
+ *     trial - the previous next_prime(): trial division of every odd
+ *             candidate by every integer up to half of it,
+ *     sieve - lab1-io-sol/lab1_timer/next_prime.c: a segmented sieve with
+ *             a 2*3*5 wheel and a trial division fallback.
+ *
+ *   'trial' takes time quadratic in the limit and stops at TRIAL_LIMIT.
+ *   For each one it prints the primes found and the median time of
+ *   BENCH_RUNS runs as CSV:
+ *
+ *     impl,limit,primes,seconds,primes_per_s
+ *
+ *   Before that the sieve is checked against a plain sieve of Eratosthenes
+ *   up to the largest limit, both streaming and for random arguments, and
+ *   by trial division for random arguments beyond the range its table of
+ *   sieving primes covers.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../../lab1-io-sol/lab1_timer/next_prime.c"
+
+#define   BENCH_RUNS           5
+#define   MAX_LIMIT            10000000
+#define   TRIAL_LIMIT          100000
+#define   CHECK_RANDOM         20000
+#define   CHECK_LARGE          200
+
+/* The previous next_prime(), unchanged but for the name */
+int nextPrimeTrial( int inval )
+{
+	int perhapsprime;
+	int testfactor;
+	int found;
+	if(inval<3) {
+		if(inval <= 0) return(1);
+		if(inval == 1) return(2);
+		if(inval == 2) return(3);
+	} else {
+		perhapsprime = ( inval + 1 ) | 1 ;
+	}
+	for( found = PRIME_FALSE; found != PRIME_TRUE; perhapsprime += 2 ) {
+		for( testfactor = 3; testfactor <= (perhapsprime >> 1); testfactor += 1 ) {
+			found = PRIME_TRUE;
+			if( (perhapsprime % testfactor) == 0 ) {
+				found = PRIME_FALSE;
+				goto check_next_prime;
+			}
+		}
+		check_next_prime:;
+		if( found == PRIME_TRUE ) {
+			return( perhapsprime );
+		}
+	}
+	return( perhapsprime );
+}
+
+enum impl {IMPL_TRIAL, IMPL_SIEVE, IMPLS};
+
+static const char* const impl_names[IMPLS] = {"trial", "sieve"};
+
+static char* composite;
+
+static double now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int compare_double(const void* a, const void* b)
+{
+  double x = *(const double*)a;
+  double y = *(const double*)b;
+
+  return (x > y) - (x < y);
+}
+
+static int isPrime(unsigned int n)
+{
+  unsigned int f;
+
+  if (n < 2)
+    return 0;
+  for (f = 2; f * f <= n; f++)
+    if (n % f == 0)
+      return 0;
+  return 1;
+}
+
+/* The next prime after n from the reference sieve */
+static int referenceNext(int n)
+{
+  do
+    n++;
+  while (composite[n]);
+  return n;
+}
+
+static int check(void)
+{
+  unsigned int seed = 2206;
+  int p, q, n, i;
+
+  composite = calloc(MAX_LIMIT + 1000, 1);
+  composite[0] = composite[1] = 1;
+  for (p = 2; (long)p * p < MAX_LIMIT + 1000; p++)
+    if (!composite[p])
+      for (q = p * p; q < MAX_LIMIT + 1000; q += p)
+	composite[q] = 1;
+
+  for (p = 1, q = 1; p <= MAX_LIMIT; p = q)
+    {
+      q = next_prime(p);
+      if (q != referenceNext(p))
+	{
+	  printf("# sieve: next_prime(%d) = %d, expected %d\n", p, q,
+		 referenceNext(p));
+	  return 0;
+	}
+    }
+
+  for (i = 0; i < CHECK_RANDOM; i++)
+    {
+      seed = seed * 1664525 + 1013904223;
+      n = (seed >> 1) % MAX_LIMIT;
+      q = next_prime(n);
+      if (q != referenceNext(n))
+	{
+	  printf("# sieve: next_prime(%d) = %d, expected %d\n", n, q,
+		 referenceNext(n));
+	  return 0;
+	}
+    }
+
+  /* Beyond the square of the last sieving prime, up to the largest int
+     prime */
+  for (i = 0; i < CHECK_LARGE; i++)
+    {
+      seed = seed * 1664525 + 1013904223;
+      n = 2147483646 - (int)((seed >> 1) % 2000000000);
+      q = next_prime(n);
+      for (p = n + 1; p < q; p++)
+	if (isPrime(p))
+	  break;
+      if (p != q || !isPrime(q))
+	{
+	  printf("# sieve: next_prime(%d) = %d is wrong\n", n, q);
+	  return 0;
+	}
+    }
+
+  free(composite);
+  return 1;
+}
+
+/* Streams the primes up to limit; returns how many */
+static int stream(int impl, int limit)
+{
+  int p = 0;
+  int count = -1;   /* next_prime(0) is 1 */
+
+  while (p <= limit)
+    {
+      p = impl == IMPL_SIEVE ? next_prime(p) : nextPrimeTrial(p);
+      count++;
+    }
+  return count - 1;
+}
+
+int main(void)
+{
+  double runs[BENCH_RUNS];
+  double start;
+  int primes;
+  int limit;
+  int impl;
+  int run;
+
+  if (!check())
+    return 1;
+
+  printf("# next_prime() streaming from 0, sieve checked up to %d\n",
+	 MAX_LIMIT);
+  printf("impl,limit,primes,seconds,primes_per_s\n");
+
+  for (impl = 0; impl < IMPLS; impl++)
+    for (limit = 1000; limit <= MAX_LIMIT; limit *= 10)
+      {
+	if (impl == IMPL_TRIAL && limit > TRIAL_LIMIT)
+	  break;
+	for (run = 0; run < BENCH_RUNS; run++)
+	  {
+	    start = now_ns();
+	    primes = stream(impl, limit);
+	    runs[run] = (now_ns() - start) * 1e-9;
+	  }
+	qsort(runs, BENCH_RUNS, sizeof(runs[0]), compare_double);
+	printf("%s,%d,%d,%.6f,%.0f\n", impl_names[impl], limit, primes,
+	       runs[BENCH_RUNS / 2], primes / runs[BENCH_RUNS / 2]);
+      }
+
+  return 0;
+}
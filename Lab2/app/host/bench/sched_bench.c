@@ -0,0 +1,158 @@
+/* Ready list benchmark for the uC/OS-II host port
+ *
+ * Description:
+ *
+ *   Measures the cost of finding the highest priority ready task and of
+ *   making a task ready and not ready, as a function of the priority of the
+ *   highest ready task. The benchmark task moves itself down the priority
+ *   range with OSTaskChangePrio(); a victim task just above the statistic
+ *   task is never scheduled, because the benchmark task always has a higher
+ *   priority. Two cases are measured for each priority:
+ *
+ *     sched   - OSSchedLock() and OSSchedUnlock(), i.e. one OS_SchedNew()
+ *               search of the ready list plus the call overhead,
+ *     rdy     - OSTaskSuspend() and OSTaskResume() of the victim, i.e.
+ *               taking it out of the ready list and putting it back, each
+ *               followed by a search.
+ *
+ *   bin/sched_bench_<n> uses the OSUnMapTbl[] lookup of the kernel with n
+ *   priorities (8 bit ready tables up to 64, 16 bit above), while
+ *   bin/sched_bench_<n>_map uses the 32 bit ready tables of
+ *   OS_RDY_BITMAP_EN. Each point is the median of BENCH_RUNS runs of
+ *   BENCH_CALLS calls. The output is CSV:
+ *
+ *     prio,sched_ns,rdy_ns
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "includes.h"
+
+#define   TASK_STACKSIZE       2048
+
+#define   BENCH_PRIO           1
+#define   VICTIM_PRIO          (OS_TASK_STAT_PRIO - 1)
+#define   LAST_BENCH_PRIO      (VICTIM_PRIO - 1)
+
+#define   BENCH_POINTS         16
+#define   BENCH_CALLS          10000
+#define   BENCH_RUNS           9
+
+OS_STK    bench_stk[TASK_STACKSIZE];
+OS_STK    victim_stk[TASK_STACKSIZE];
+
+static double now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int compare_double(const void* a, const void* b)
+{
+  double x = *(const double*)a;
+  double y = *(const double*)b;
+
+  return (x > y) - (x < y);
+}
+
+/* Never runs, the benchmark task always has a higher priority */
+void victimTask(void* pdata)
+{
+  while (1)
+    {
+      OSTaskSuspend(OS_PRIO_SELF);
+    }
+}
+
+/* Median time of one OSSchedLock()/OSSchedUnlock() pair, in ns */
+static double measureSched(void)
+{
+  double runs[BENCH_RUNS];
+  double start;
+  int run;
+  int i;
+
+  for (run = 0; run < BENCH_RUNS; run++)
+    {
+      start = now_ns();
+      for (i = 0; i < BENCH_CALLS; i++)
+	{
+	  OSSchedLock();
+	  OSSchedUnlock();
+	}
+      runs[run] = (now_ns() - start) / BENCH_CALLS;
+    }
+
+  qsort(runs, BENCH_RUNS, sizeof(runs[0]), compare_double);
+  return runs[BENCH_RUNS / 2];
+}
+
+/* Median time of one OSTaskSuspend()/OSTaskResume() pair, in ns */
+static double measureRdy(void)
+{
+  double runs[BENCH_RUNS];
+  double start;
+  int run;
+  int i;
+
+  for (run = 0; run < BENCH_RUNS; run++)
+    {
+      start = now_ns();
+      for (i = 0; i < BENCH_CALLS; i++)
+	{
+	  OSTaskSuspend(VICTIM_PRIO);
+	  OSTaskResume(VICTIM_PRIO);
+	}
+      runs[run] = (now_ns() - start) / BENCH_CALLS;
+    }
+
+  qsort(runs, BENCH_RUNS, sizeof(runs[0]), compare_double);
+  return runs[BENCH_RUNS / 2];
+}
+
+void benchTask(void* pdata)
+{
+  double sched;
+  int point;
+  int prio;
+
+  printf("# ready list cost, %s, OS_LOWEST_PRIO %d\n",
+	 OS_RDY_BITMAP_EN ? "32 bit ready tables" : "OSUnMapTbl[]",
+	 OS_LOWEST_PRIO);
+  printf("prio,sched_ns,rdy_ns\n");
+
+  OSTaskCreateExt(victimTask, NULL,
+		  &victim_stk[TASK_STACKSIZE-1],
+		  VICTIM_PRIO, VICTIM_PRIO,
+		  &victim_stk[0],
+		  TASK_STACKSIZE, NULL, 0);
+
+  for (point = 0; point < BENCH_POINTS; point++)
+    {
+      /* Spread the points evenly from BENCH_PRIO to LAST_BENCH_PRIO */
+      prio = BENCH_PRIO + point * (LAST_BENCH_PRIO - BENCH_PRIO)
+	/ (BENCH_POINTS - 1);
+      if (prio != OSTCBCur->OSTCBPrio)
+	OSTaskChangePrio(OS_PRIO_SELF, prio);
+
+      sched = measureSched();
+      printf("%d,%.1f,%.1f\n", prio, sched, measureRdy());
+    }
+
+  exit(0);
+}
+
+int main(void)
+{
+  OSTaskCreateExt(benchTask, NULL,
+		  &bench_stk[TASK_STACKSIZE-1],
+		  BENCH_PRIO, BENCH_PRIO,
+		  &bench_stk[0],
+		  TASK_STACKSIZE, NULL, 0);
+
+  OSStart();
+  return 0;
+}
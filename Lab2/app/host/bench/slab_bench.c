@@ -0,0 +1,159 @@
+/* malloc()/free() benchmark for the uC/OS-II host port
+ *
+ * Description:
+ *
+ *   BENCH_TASKS tasks of different priorities allocate and free blocks
+ *   as fast as they can. Each one keeps LIVE_BLOCKS blocks and replaces a
+ *   random one at a time; most requests are of 1 to 256 bytes, one in
+ *   LARGE_ONE_IN of LARGE_MIN to LARGE_MAX bytes. Every BURST_OPS requests
+ *   a task sleeps for a tick, so that all of them keep preempting each
+ *   other in the middle of their bursts. The allocators are
+ *
+ *     heap - the libc heap behind the lock of alt_libc_lock.c
+ *            (bin/slab_bench),
+ *     slab - the size classes of alt_slab.c in front of it, ALT_SLAB_EN
+ *            (bin/slab_bench_slab).
+ *
+ *   The first and the last byte of every block are set to the number of
+ *   its task, and checked when it is freed, to catch blocks handed out
+ *   twice. The time is the CPU time
+ *   of the tasks, from OS_TASK_PROFILE_EN. The output is CSV:
+ *
+ *     allocator,tasks,requests,ns_per_request,mrequests_per_s,corrupt
+ *
+ *   Run it with the real host clock (the default).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "includes.h"
+#include "system.h"
+#include "alt_host.h"
+#include "os/alt_slab.h"
+
+#define   TASK_STACKSIZE       2048
+
+#define   BENCH_PRIO           4
+#define   WORKER_PRIO          5     /* first of BENCH_TASKS */
+
+#define   BENCH_TASKS          4
+#define   TASK_REQUESTS        2000000
+#define   BURST_OPS            20000
+#define   LIVE_BLOCKS          64
+#define   LARGE_ONE_IN         16
+#define   LARGE_MIN            1024
+#define   LARGE_MAX            4096
+
+OS_STK    bench_stk[TASK_STACKSIZE];
+OS_STK    worker_stk[BENCH_TASKS][TASK_STACKSIZE];
+
+OS_EVENT* done_sem;
+
+unsigned long corrupt;
+
+/* A block and the size it was requested with */
+struct block {
+  unsigned char* ptr;
+  size_t size;
+};
+
+static void release(struct block* b, unsigned char tag)
+{
+  if (!b->ptr)
+    return;
+  if (b->ptr[0] != tag || b->ptr[b->size - 1] != tag)
+    corrupt++;
+  free(b->ptr);
+  b->ptr = NULL;
+}
+
+void workerTask(void* pdata)
+{
+  struct block blocks[LIVE_BLOCKS];
+  unsigned int seed = 2206 + (unsigned int)(long)pdata;
+  unsigned char tag = (unsigned char)(long)pdata + 1;
+  struct block* b;
+  long n;
+
+  memset(blocks, 0, sizeof(blocks));
+  for (n = 0; n < TASK_REQUESTS; n++)
+    {
+      seed = seed * 1664525 + 1013904223;
+      b = &blocks[(seed >> 8) % LIVE_BLOCKS];
+      release(b, tag);
+
+      if ((seed >> 20) % LARGE_ONE_IN == 0)
+	b->size = LARGE_MIN + (seed >> 4) % (LARGE_MAX - LARGE_MIN);
+      else
+	b->size = 1 + (seed >> 4) % 256;
+      b->ptr = malloc(b->size);
+      if (!b->ptr)
+	{
+	  printf("# malloc(%lu) failed\n", (unsigned long)b->size);
+	  exit(1);
+	}
+      b->ptr[0] = b->ptr[b->size - 1] = tag;
+
+      if (n % BURST_OPS == BURST_OPS - 1)
+	OSTimeDly(1);
+    }
+  for (n = 0; n < LIVE_BLOCKS; n++)
+    release(&blocks[n], tag);
+
+  OSSemPost(done_sem);
+  OSTaskSuspend(OS_PRIO_SELF);
+}
+
+void benchTask(void* pdata)
+{
+  OS_TCB tcb;
+  double ns = 0;
+  INT8U err;
+  int i;
+
+  if (alt_host_clock_virtual())
+    {
+      fprintf(stderr, "slab_bench: run with the real host clock\n");
+      exit(1);
+    }
+
+  done_sem = OSSemCreate(0);
+  for (i = 0; i < BENCH_TASKS; i++)
+    OSTaskCreateExt(workerTask, (void*)(long)i,
+		    &worker_stk[i][TASK_STACKSIZE-1],
+		    WORKER_PRIO + i, WORKER_PRIO + i, &worker_stk[i][0],
+		    TASK_STACKSIZE, NULL, 0);
+  for (i = 0; i < BENCH_TASKS; i++)
+    OSSemPend(done_sem, 0, &err);
+
+  for (i = 0; i < BENCH_TASKS; i++)
+    {
+      OSTaskQuery(WORKER_PRIO + i, &tcb);
+      ns += tcb.OSTCBCyclesTot * (1e9 / OSCPUCyclesFreq());
+    }
+
+  /* a malloc() and a free() per request */
+  printf("# %d blocks of %d to %d bytes in %d classes\n",
+	 ALT_SLAB_EN ? ALT_SLAB_BLOCKS : 0, ALT_SLAB_MIN, ALT_SLAB_MAX,
+	 ALT_SLAB_EN ? ALT_SLAB_CLASSES : 0);
+  printf("allocator,tasks,requests,ns_per_request,mrequests_per_s,corrupt\n");
+  printf("%s,%d,%ld,%.1f,%.2f,%lu\n", ALT_SLAB_EN ? "slab" : "heap",
+	 BENCH_TASKS, (long)BENCH_TASKS * TASK_REQUESTS,
+	 ns / ((double)BENCH_TASKS * TASK_REQUESTS),
+	 (double)BENCH_TASKS * TASK_REQUESTS / ns * 1e3, corrupt);
+
+  exit(0);
+}
+
+int main(void)
+{
+  OSTaskCreateExt(benchTask, NULL,
+		  &bench_stk[TASK_STACKSIZE-1],
+		  BENCH_PRIO, BENCH_PRIO,
+		  &bench_stk[0],
+		  TASK_STACKSIZE, NULL, 0);
+
+  OSStart();
+  return 0;
+}
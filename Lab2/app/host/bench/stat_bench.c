@@ -0,0 +1,141 @@
+/* CPU usage statistics benchmark for the uC/OS-II host port
+ *
+ * Description:
+ *
+ *   Compares the two ways the statistics task can measure the CPU usage:
+ *
+ *     counter - OSIdleCtr against the maximum OSStatInit() calibrates in
+ *               1/10 second (bin/stat_bench),
+ *     cycles  - the cycles the idle task ran, OS_TASK_STAT_CYCLES_EN
+ *               (bin/stat_bench_cycles).
+ *
+ *   It times OSStatInit(), then runs a load task that busy-waits for a part
+ *   of every LOAD_PERIOD ticks and sleeps for the rest, at the loads in
+ *   'loads'. For each one it averages the OSCPUUsage (or OSCPUUsageFine)
+ *   the statistics task reports over MEASURE_PERIODS periods, and compares
+ *   it with the share of the time the load task was actually running. The
+ *   output is CSV:
+ *
+ *     mode,load_pct,actual_pct,reported_pct,error_pct
+ *
+ *   followed by the peak usage and the histogram in 'cycles' mode. Run it
+ *   with the real host clock (the default): in virtual time the load task
+ *   would take no time at all.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "includes.h"
+#include "system.h"
+#include "alt_host.h"
+
+#define   TASK_STACKSIZE       2048
+
+#define   BENCH_PRIO           4
+#define   LOAD_PRIO            5
+
+#define   LOAD_PERIOD          20    /* ticks                               */
+#define   SETTLE_PERIODS       3     /* statistic task periods (1/10 s)     */
+#define   MEASURE_PERIODS      10
+
+OS_STK    bench_stk[TASK_STACKSIZE];
+OS_STK    load_stk[TASK_STACKSIZE];
+
+static const int loads[] = {0, 25, 50, 75, 90};
+
+volatile int     load_busy;      /* ticks of every LOAD_PERIOD to busy-wait */
+volatile alt_u64 busy_ns;        /* time the load task has busy-waited      */
+
+void loadTask(void* pdata)
+{
+  alt_u64 t0, t;
+  int busy;
+
+  while (1)
+    {
+      busy = load_busy;
+      t0 = alt_host_clock_now();
+      do
+	t = alt_host_clock_now();
+      while (t - t0 < (alt_u64)busy * (1000000000u / (INT32U)OS_TICKS_PER_SEC));
+      busy_ns += t - t0;
+      OSTimeDly(LOAD_PERIOD - busy);
+    }
+}
+
+/* CPU usage reported by the statistics task, in % */
+static double reported(void)
+{
+#if OS_TASK_STAT_CYCLES
+  return OSCPUUsageFine / 100.0;
+#else
+  return OSCPUUsage;
+#endif
+}
+
+void benchTask(void* pdata)
+{
+  alt_u64 t0, busy0;
+  double actual, sum;
+  int i, l;
+
+  if (alt_host_clock_virtual())
+    {
+      fprintf(stderr, "stat_bench: run with the real host clock\n");
+      exit(1);
+    }
+
+  t0 = alt_host_clock_now();
+  OSStatInit();
+  printf("# OSStatInit() returned after %.3f ms\n",
+	 (alt_host_clock_now() - t0) * 1e-6);
+
+  OSTaskCreateExt(loadTask, NULL, &load_stk[TASK_STACKSIZE-1],
+		  LOAD_PRIO, LOAD_PRIO, &load_stk[0],
+		  TASK_STACKSIZE, NULL, 0);
+
+  /* Sample half way between the updates of the statistics task */
+  OSTimeDly(OS_TICKS_PER_SEC / 20);
+
+  printf("mode,load_pct,actual_pct,reported_pct,error_pct\n");
+  for (l = 0; l < (int)(sizeof(loads) / sizeof(loads[0])); l++)
+    {
+      load_busy = LOAD_PERIOD * loads[l] / 100;
+      OSTimeDly(SETTLE_PERIODS * OS_TICKS_PER_SEC / 10);
+
+      t0 = alt_host_clock_now();
+      busy0 = busy_ns;
+      sum = 0;
+      for (i = 0; i < MEASURE_PERIODS; i++)
+	{
+	  OSTimeDly(OS_TICKS_PER_SEC / 10);
+	  sum += reported();
+	}
+      actual = 100.0 * (busy_ns - busy0) / (alt_host_clock_now() - t0);
+      printf("%s,%d,%.2f,%.2f,%.2f\n",
+	     OS_TASK_STAT_CYCLES ? "cycles" : "counter", loads[l], actual,
+	     sum / MEASURE_PERIODS, sum / MEASURE_PERIODS - actual);
+    }
+
+#if OS_TASK_STAT_CYCLES
+  printf("# peak %.2f %%, periods per %d %% band:",
+	 OSCPUUsagePeak / 100.0, 100 / OS_TASK_STAT_HIST_SIZE);
+  for (i = 0; i < OS_TASK_STAT_HIST_SIZE; i++)
+    printf(" %lu", (unsigned long)OSCPUUsageHist[i]);
+  printf("\n");
+#endif
+
+  exit(0);
+}
+
+int main(void)
+{
+  OSTaskCreateExt(benchTask, NULL,
+		  &bench_stk[TASK_STACKSIZE-1],
+		  BENCH_PRIO, BENCH_PRIO,
+		  &bench_stk[0],
+		  TASK_STACKSIZE, NULL, 0);
+
+  OSStart();
+  return 0;
+}
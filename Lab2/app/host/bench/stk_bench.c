@@ -0,0 +1,169 @@
+/* Stack check benchmark for the uC/OS-II host port
+ *
+ * Description:
+ *
+ *   BENCH_TASKS worker tasks wake up every 1, 2, 3... ticks and recurse to
+ *   a random depth, MAX_DEPTH frames at most, in frames with a local buffer
+ *   of which only the first words are written, so that their stacks have
+ *   unused words between used ones. The bench task runs below them and,
+ *   like statisticTask in TwoTasks.c, calls OSTaskStkChk() for each of them
+ *   in a loop for RUN_TICKS ticks. The stacks are checked
+ *
+ *     scan      - by counting the zero words from the bottom on every call,
+ *                 OS_TASK_STK_WATERMARK_EN = 0 (bin/stk_bench_scan),
+ *     watermark - again only if the task was switched in since the last
+ *                 check, OS_TASK_STK_WATERMARK_EN (bin/stk_bench).
+ *
+ *   Every check is done with the scheduler locked and compared with a count
+ *   of the zero words made by the bench itself. The workers get the 256 KB
+ *   host stacks of OS_TASK_OPT_STK_CHK. The output is CSV:
+ *
+ *     mode,tasks,checks,ns_per_check,ran_pct,ns_not_ran,mismatch
+ *
+ *   where ran_pct is the share of the checks for which the task was
+ *   switched in since the last one, and ns_not_ran the time of the others.
+ *   Run it with the real host clock (the default).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "includes.h"
+#include "system.h"
+#include "alt_host.h"
+
+#define   TASK_STACKSIZE       2048
+
+#define   WORKER_PRIO          5     /* first of BENCH_TASKS */
+#define   BENCH_PRIO           (WORKER_PRIO + BENCH_TASKS)
+
+#define   BENCH_TASKS          4
+#define   RUN_TICKS            2000
+#define   MAX_DEPTH            24
+#define   FRAME_WORDS          64    /* of which FRAME_USED are written */
+#define   FRAME_USED           8
+
+OS_STK    bench_stk[TASK_STACKSIZE];
+OS_STK    worker_stk[BENCH_TASKS][TASK_STACKSIZE];
+
+static double now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* Number of zero words from the bottom, as OSTaskStkChk() counts them */
+static INT32U zeroWords(INT8U prio)
+{
+  OS_TCB* ptcb = OSTCBPrioTbl[prio];
+  OS_STK* pchk = ptcb->OSTCBStkBottom;
+  INT32U nfree = 0;
+
+  while (nfree < ptcb->OSTCBStkSize && *pchk++ == 0)
+    nfree++;
+  return nfree;
+}
+
+static int recurse(int depth)
+{
+  volatile INT32U frame[FRAME_WORDS];
+  int i;
+
+  for (i = 0; i < FRAME_USED; i++)
+    frame[i] = depth + 1;
+  if (depth > 0)
+    return recurse(depth - 1) + frame[0];
+  return frame[0];
+}
+
+void workerTask(void* pdata)
+{
+  unsigned int seed = 2206 + (unsigned int)(long)pdata;
+  INT16U period = (INT16U)(long)pdata + 1;
+
+  while (1)
+    {
+      seed = seed * 1664525 + 1013904223;
+      recurse((seed >> 8) % MAX_DEPTH);
+      OSTimeDly(period);
+    }
+}
+
+void benchTask(void* pdata)
+{
+  OS_STK_DATA data;
+  INT32U ctr[BENCH_TASKS];
+  INT32U end;
+  unsigned long checks = 0;
+  unsigned long ran = 0;
+  unsigned long mismatch = 0;
+  double ns = 0;
+  double ns_not_ran = 0;
+  double t;
+  int switched;
+  int i;
+
+  if (alt_host_clock_virtual())
+    {
+      fprintf(stderr, "stk_bench: run with the real host clock\n");
+      exit(1);
+    }
+
+  for (i = 0; i < BENCH_TASKS; i++)
+    {
+      OSTaskCreateExt(workerTask, (void*)(long)i,
+		      &worker_stk[i][TASK_STACKSIZE-1],
+		      WORKER_PRIO + i, WORKER_PRIO + i, &worker_stk[i][0],
+		      TASK_STACKSIZE, NULL,
+		      OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR);
+      ctr[i] = 0;
+    }
+
+  end = OSTimeGet() + RUN_TICKS;
+  while ((INT32S)(OSTimeGet() - end) < 0)
+    {
+      for (i = 0; i < BENCH_TASKS; i++)
+	{
+	  OSSchedLock();
+	  switched = OSTCBPrioTbl[WORKER_PRIO + i]->OSTCBCtxSwCtr != ctr[i];
+	  ctr[i] = OSTCBPrioTbl[WORKER_PRIO + i]->OSTCBCtxSwCtr;
+	  t = now_ns();
+	  OSTaskStkChk(WORKER_PRIO + i, &data);
+	  t = now_ns() - t;
+	  ns += t;
+	  if (switched)
+	    ran++;
+	  else
+	    ns_not_ran += t;
+	  if (data.OSFree != zeroWords(WORKER_PRIO + i) * sizeof(OS_STK))
+	    mismatch++;
+	  OSSchedUnlock();
+	  checks++;
+	}
+    }
+
+  printf("# %d workers, %lu byte stacks\n", BENCH_TASKS,
+	 (unsigned long)(OSTCBPrioTbl[WORKER_PRIO]->OSTCBStkSize * sizeof(OS_STK)));
+  printf("mode,tasks,checks,ns_per_check,ran_pct,ns_not_ran,mismatch\n");
+  printf("%s,%d,%lu,%.1f,%.2f,%.1f,%lu\n",
+	 OS_TASK_STK_WATERMARK_EN ? "watermark" : "scan", BENCH_TASKS,
+	 checks, ns / checks, 100.0 * ran / checks,
+	 ns_not_ran / (checks - ran), mismatch);
+
+  exit(0);
+}
+
+int main(void)
+{
+  OSTaskCreateExt(benchTask, NULL,
+		  &bench_stk[TASK_STACKSIZE-1],
+		  BENCH_PRIO, BENCH_PRIO,
+		  &bench_stk[0],
+		  TASK_STACKSIZE, NULL, 0);
+
+  OSStart();
+  return 0;
+}
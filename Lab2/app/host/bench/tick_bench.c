@@ -0,0 +1,128 @@
+/* Tick cost benchmark for the uC/OS-II host port
+ *
+ * Description:
+ *
+ *   Measures how long OSTimeTick() takes as a function of the number of
+ *   delayed tasks. One task after the other is created and put to sleep
+ *   with a delay that does not expire during the measurement, so every
+ *   tick only has to find out that nothing is due. With the delayed task
+ *   list (OS_TIME_DLY_LIST_EN, bin/tick_bench) this should be constant;
+ *   walking the TCB list (bin/tick_bench_walk) grows with every task.
+ *
+ *   OSTimeTick() is called directly from the highest priority task with
+ *   interrupts disabled, which is what the timer ISR does minus the
+ *   interrupt entry and exit. Each point is the median of BENCH_RUNS runs
+ *   of BENCH_TICKS ticks. The output is CSV:
+ *
+ *     delayed_tasks,ns_per_tick
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "includes.h"
+#include "sys/alt_irq.h"
+
+#define   TASK_STACKSIZE       2048
+
+#define   BENCH_PRIO           1
+#define   FIRST_DELAYED_PRIO   (BENCH_PRIO + 1)
+#define   LAST_DELAYED_PRIO    (OS_TASK_STAT_PRIO - 1)
+#define   MAX_DELAYED          (LAST_DELAYED_PRIO - FIRST_DELAYED_PRIO + 1)
+
+#define   BENCH_TICKS          10000
+#define   BENCH_RUNS           9
+#define   BENCH_DELAY          60000  /* ticks, longer than one measurement */
+
+OS_STK    bench_stk[TASK_STACKSIZE];
+OS_STK    delayed_stk[MAX_DELAYED][TASK_STACKSIZE];
+
+static double now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int compare_double(const void* a, const void* b)
+{
+  double x = *(const double*)a;
+  double y = *(const double*)b;
+
+  return (x > y) - (x < y);
+}
+
+/* Sleeps for BENCH_DELAY ticks at a time, until woken up early */
+void delayedTask(void* pdata)
+{
+  while (1)
+    {
+      OSTimeDly(BENCH_DELAY);
+    }
+}
+
+/* Median time of one OSTimeTick(), in ns */
+static double measureTick(void)
+{
+  double runs[BENCH_RUNS];
+  double start;
+  alt_irq_context context;
+  int run;
+  int i;
+
+  for (run = 0; run < BENCH_RUNS; run++)
+    {
+      context = alt_irq_disable_all();
+      start = now_ns();
+      for (i = 0; i < BENCH_TICKS; i++)
+	OSTimeTick();
+      runs[run] = (now_ns() - start) / BENCH_TICKS;
+      alt_irq_enable_all(context);
+    }
+
+  qsort(runs, BENCH_RUNS, sizeof(runs[0]), compare_double);
+  return runs[BENCH_RUNS / 2];
+}
+
+void benchTask(void* pdata)
+{
+  INT8U prio;
+  INT8U p;
+
+  printf("# OSTimeTick() cost, %s, OS_LOWEST_PRIO %d\n",
+	 OS_TIME_DLY_LIST_EN ? "delayed task list" : "TCB list walk",
+	 OS_LOWEST_PRIO);
+  printf("delayed_tasks,ns_per_tick\n");
+
+  for (prio = FIRST_DELAYED_PRIO - 1; prio <= LAST_DELAYED_PRIO; prio++)
+    {
+      if (prio >= FIRST_DELAYED_PRIO)
+	OSTaskCreateExt(delayedTask, NULL,
+			&delayed_stk[prio - FIRST_DELAYED_PRIO][TASK_STACKSIZE-1],
+			prio, prio,
+			&delayed_stk[prio - FIRST_DELAYED_PRIO][0],
+			TASK_STACKSIZE, NULL, 0);
+
+      /* Restart all delays, then let the tasks go back to sleep */
+      for (p = FIRST_DELAYED_PRIO; p <= prio; p++)
+	OSTimeDlyResume(p);
+      OSTimeDly(1);
+
+      printf("%d,%.1f\n", prio - FIRST_DELAYED_PRIO + 1, measureTick());
+    }
+
+  exit(0);
+}
+
+int main(void)
+{
+  OSTaskCreateExt(benchTask, NULL,
+		  &bench_stk[TASK_STACKSIZE-1],
+		  BENCH_PRIO, BENCH_PRIO,
+		  &bench_stk[0],
+		  TASK_STACKSIZE, NULL, 0);
+
+  OSStart();
+  return 0;
+}
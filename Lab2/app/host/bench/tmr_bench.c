@@ -0,0 +1,132 @@
+/* Timer task benchmark for the uC/OS-II host port
+ *
+ * Description:
+ *
+ *   Measures the CPU time of one pass of the OSTmr timer task as a function
+ *   of the number of running timers. The benchmark task signals the timer
+ *   task with OSTmrSignal(); the timer task has a higher priority, so it
+ *   runs its pass right away and the call returns when it is done. The time
+ *   per call includes the two context switches.
+ *
+ *   The running timers have long, different periods, so they are spread
+ *   over the wheel but none of them expires during the measurement. Two
+ *   cases are measured for each number of timers:
+ *
+ *     idle - no timer expires, the pass only has to look at its spoke,
+ *     due  - one more timer with a period of one expires on every pass and
+ *            is linked into the wheel again.
+ *
+ *   bin/tmr_bench uses the BSP wheel size with sorted spokes,
+ *   bin/tmr_bench_wheel2 adds a second wheel (OS_TMR_CFG_WHEEL2_SIZE).
+ *   Each point is the median of BENCH_RUNS runs of BENCH_SIGNALS passes.
+ *   The output is CSV:
+ *
+ *     timers,idle_ns_per_pass,due_ns_per_pass
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "includes.h"
+
+#define   TASK_STACKSIZE       2048
+
+#define   BENCH_PRIO           1
+
+#define   MAX_TIMERS           (OS_TMR_CFG_MAX - 1)
+#define   TIMERS_STEP          16
+#define   BENCH_SIGNALS        10000
+#define   BENCH_RUNS           9
+#define   BENCH_PERIOD         1000000  /* timer ticks, longer than one point */
+
+OS_STK    bench_stk[TASK_STACKSIZE];
+
+OS_TMR*   timers[MAX_TIMERS];
+
+static double now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int compare_double(const void* a, const void* b)
+{
+  double x = *(const double*)a;
+  double y = *(const double*)b;
+
+  return (x > y) - (x < y);
+}
+
+void timerCallback(void* ptmr, void* callback_arg)
+{
+}
+
+/* Median time of one timer task pass, in ns */
+static double measurePass(void)
+{
+  double runs[BENCH_RUNS];
+  double start;
+  int run;
+  int i;
+
+  for (run = 0; run < BENCH_RUNS; run++)
+    {
+      start = now_ns();
+      for (i = 0; i < BENCH_SIGNALS; i++)
+	OSTmrSignal();
+      runs[run] = (now_ns() - start) / BENCH_SIGNALS;
+    }
+
+  qsort(runs, BENCH_RUNS, sizeof(runs[0]), compare_double);
+  return runs[BENCH_RUNS / 2];
+}
+
+void benchTask(void* pdata)
+{
+  OS_TMR* due;
+  double idle;
+  INT8U err;
+  int n;
+  int i;
+
+  printf("# OSTmr_Task() cost, OS_TMR_CFG_WHEEL_SIZE %d, "
+	 "OS_TMR_CFG_WHEEL2_SIZE %d\n",
+	 OS_TMR_CFG_WHEEL_SIZE, OS_TMR_CFG_WHEEL2_SIZE);
+  printf("timers,idle_ns_per_pass,due_ns_per_pass\n");
+
+  for (i = 0; i < MAX_TIMERS; i++)
+    timers[i] = OSTmrCreate(0, BENCH_PERIOD + (i * 37) % MAX_TIMERS,
+			    OS_TMR_OPT_PERIODIC, timerCallback, NULL,
+			    (INT8U *)"Bench", &err);
+
+  for (n = 0; n <= MAX_TIMERS; n += (n < TIMERS_STEP) ? 1 : TIMERS_STEP)
+    {
+      /* Restart the first n timers, so they expire after the point */
+      for (i = 0; i < n; i++)
+	OSTmrStart(timers[i], &err);
+
+      idle = measurePass();
+
+      due = OSTmrCreate(0, 1, OS_TMR_OPT_PERIODIC, timerCallback, NULL,
+			(INT8U *)"Due", &err);
+      OSTmrStart(due, &err);
+      printf("%d,%.1f,%.1f\n", n, idle, measurePass());
+      OSTmrDel(due, &err);
+    }
+
+  exit(0);
+}
+
+int main(void)
+{
+  OSTaskCreateExt(benchTask, NULL,
+		  &bench_stk[TASK_STACKSIZE-1],
+		  BENCH_PRIO, BENCH_PRIO,
+		  &bench_stk[0],
+		  TASK_STACKSIZE, NULL, 0);
+
+  OSStart();
+  return 0;
+}
@@ -0,0 +1,152 @@
+/* Per-task CPU usage benchmark for the uC/OS-II host port
+ *
+ * Description:
+ *
+ *   Checks the usage OSTaskCPUUsageGet() reports for each task against a
+ *   known load. LOAD_TASKS load tasks are released together every
+ *   LOAD_PERIOD ticks and busy-wait on the host clock for the share of it
+ *   in 'loads', one after the other in the order of their priorities, so
+ *   that none of them is switched out while it busy-waits. After
+ *   SETTLE_WINDOWS usage windows (OS_TASK_PROFILE_WIN statistic task
+ *   periods) the bench task averages the reported usage of each load task
+ *   over MEASURE_WINDOWS windows, and compares it with the share of the
+ *   time the task actually ran. The output is CSV:
+ *
+ *     task,prio,load_pct,actual_pct,reported_pct,error_pct
+ *
+ *   followed by the sum of the usage of all the tasks, which should be
+ *   close to 100 %. A line starting with FAIL is printed, and the exit code
+ *   is 1, for each task off by more than MAX_ERROR_PCT. Run it with the
+ *   real host clock (the default): in virtual time the load tasks would
+ *   take no time at all.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "includes.h"
+#include "system.h"
+#include "alt_host.h"
+
+#define   TASK_STACKSIZE       2048
+
+#define   BENCH_PRIO           4
+#define   LOAD_PRIO            5     /* first of LOAD_TASKS */
+
+#define   LOAD_TASKS           3
+#define   LOAD_PERIOD          20    /* ticks */
+#define   SETTLE_WINDOWS       2
+#define   MEASURE_WINDOWS      5
+#define   MAX_ERROR_PCT        1.0
+
+#define   WINDOW_TICKS         (OS_TASK_PROFILE_WIN * OS_TICKS_PER_SEC / 10)
+#define   TICK_NS              (1000000000u / (INT32U)OS_TICKS_PER_SEC)
+
+OS_STK    bench_stk[TASK_STACKSIZE];
+OS_STK    load_stk[LOAD_TASKS][TASK_STACKSIZE];
+
+static const int loads[LOAD_TASKS] = {10, 20, 30};
+
+volatile alt_u64 busy_ns[LOAD_TASKS]; /* time each load task has run */
+
+void loadTask(void* pdata)
+{
+  int i = (int)(long)pdata;
+  alt_u64 load = (alt_u64)loads[i] * LOAD_PERIOD * TICK_NS / 100;
+  alt_u64 t0, t;
+  INT32U next = OSTimeGet();
+
+  while (1)
+    {
+      t0 = alt_host_clock_now();
+      do
+	t = alt_host_clock_now();
+      while (t - t0 < load);
+      busy_ns[i] += t - t0;
+
+      /* Keep to the period even if the task was switched out */
+      next += LOAD_PERIOD;
+      if ((INT32S)(next - OSTimeGet()) > 0)
+	OSTimeDly((INT16U)(next - OSTimeGet()));
+      else
+	next = OSTimeGet();
+    }
+}
+
+void benchTask(void* pdata)
+{
+  alt_u64 t0, t1, busy0[LOAD_TASKS];
+  double actual, reported[LOAD_TASKS], total, error;
+  int failed = 0;
+  INT8U err;
+  int prio;
+  int i, w;
+
+  if (alt_host_clock_virtual())
+    {
+      fprintf(stderr, "usage_bench: run with the real host clock\n");
+      exit(1);
+    }
+
+  OSStatInit();
+
+  for (i = 0; i < LOAD_TASKS; i++)
+    OSTaskCreateExt(loadTask, (void*)(long)i,
+		    &load_stk[i][TASK_STACKSIZE-1],
+		    LOAD_PRIO + i, LOAD_PRIO + i, &load_stk[i][0],
+		    TASK_STACKSIZE, NULL, 0);
+
+  /* Sample half way between the updates of the statistics task. Each
+     sample covers the window since the one before, so the first window
+     starts at t0. */
+  OSTimeDly(SETTLE_WINDOWS * WINDOW_TICKS + OS_TICKS_PER_SEC / 20);
+
+  t0 = alt_host_clock_now();
+  for (i = 0; i < LOAD_TASKS; i++)
+    {
+      busy0[i] = busy_ns[i];
+      reported[i] = 0;
+    }
+  total = 0;
+  for (w = 0; w < MEASURE_WINDOWS; w++)
+    {
+      OSTimeDly(WINDOW_TICKS);
+      for (i = 0; i < LOAD_TASKS; i++)
+	reported[i] += OSTaskCPUUsageGet(LOAD_PRIO + i, &err) / 100.0;
+      for (prio = 0; prio <= OS_LOWEST_PRIO; prio++)
+	if (OSTCBPrioTbl[prio] && OSTCBPrioTbl[prio] != OS_TCB_RESERVED)
+	  total += OSTaskCPUUsageGet(prio, &err) / 100.0;
+    }
+  t1 = alt_host_clock_now();
+
+  printf("# %d ticks per window, %d windows\n", (int)WINDOW_TICKS,
+	 MEASURE_WINDOWS);
+  printf("task,prio,load_pct,actual_pct,reported_pct,error_pct\n");
+  for (i = 0; i < LOAD_TASKS; i++)
+    {
+      actual = 100.0 * (busy_ns[i] - busy0[i]) / (t1 - t0);
+      reported[i] /= MEASURE_WINDOWS;
+      error = reported[i] - actual;
+      printf("load%d,%d,%d,%.2f,%.2f,%.2f\n", i, LOAD_PRIO + i, loads[i],
+	     actual, reported[i], error);
+      if (error > MAX_ERROR_PCT || error < -MAX_ERROR_PCT)
+	{
+	  printf("FAIL: load%d off by %.2f %%\n", i, error);
+	  failed = 1;
+	}
+    }
+  printf("# all tasks %.2f %%\n", total / MEASURE_WINDOWS);
+
+  exit(failed);
+}
+
+int main(void)
+{
+  OSTaskCreateExt(benchTask, NULL,
+		  &bench_stk[TASK_STACKSIZE-1],
+		  BENCH_PRIO, BENCH_PRIO,
+		  &bench_stk[0],
+		  TASK_STACKSIZE, NULL, 0);
+
+  OSStart();
+  return 0;
+}
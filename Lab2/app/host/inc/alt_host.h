@@ -0,0 +1,99 @@
+#ifndef __ALT_HOST_H__
+#define __ALT_HOST_H__
+
+/******************************************************************************
+*                                                                             *
+* Host (POSIX) simulation support.                                            *
+*                                                                             *
+* Declarations shared between the host stand-ins for the HAL and the device   *
+* models that replace the Avalon peripherals. Nothing in here exists on the   *
+* board; code that has to build for both targets should only rely on the     *
+* regular HAL headers.                                                        *
+*                                                                             *
+******************************************************************************/
+
+#include "alt_types.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/*
+ * Memory mapped IO. Registers that have no device model behind them behave
+ * as plain memory, which is enough for the LED and seven segment PIOs.
+ */
+
+typedef struct alt_host_io_dev_s alt_host_io_dev;
+
+struct alt_host_io_dev_s
+{
+  alt_host_io_dev* next;
+  alt_u32          base;          /* first address decoded by the device */
+  alt_u32          span;          /* number of bytes decoded             */
+  alt_u32          (*read)  (alt_host_io_dev* dev, alt_u32 offset);
+  void             (*write) (alt_host_io_dev* dev, alt_u32 offset,
+                             alt_u32 data);
+};
+
+extern alt_u32 alt_host_io_read     (alt_u32 address, int width);
+extern void    alt_host_io_write    (alt_u32 address, int width, alt_u32 data);
+extern void    alt_host_io_register (alt_host_io_dev* dev);
+
+/*
+ * Interrupt lines. A device model raises its line when the interrupt
+ * condition is set and lowers it once the ISR has cleared it, exactly as the
+ * level sensitive IRQ inputs of the Nios II do.
+ *
+ * alt_host_irq_connect() attaches a device model to one of the host signals
+ * in alt_irq_sigset; the event function runs in interrupt context before the
+ * pending interrupts are dispatched. alt_host_irq_enter() takes such a signal
+ * synchronously from task level. alt_host_irq_count() tells how often the
+ * handler of an interrupt has been dispatched.
+ */
+
+extern void    alt_host_irq_raise   (alt_u32 irq);
+extern void    alt_host_irq_lower   (alt_u32 irq);
+extern void    alt_host_irq_connect (int sig, void (*event) (void));
+extern void    alt_host_irq_enter   (int sig);
+extern alt_u32 alt_host_irq_count   (alt_u32 irq);
+
+/*
+ * Host clock (see alt_host_clock.c). Times are in nanoseconds since start-up;
+ * the clock either follows the host's monotonic clock or, with
+ * ALT_HOST_CLOCK=virtual, only advances while the CPU is idle.
+ */
+
+extern void    alt_host_clock_init      (void);
+extern int     alt_host_clock_virtual   (void);
+extern alt_u64 alt_host_clock_now       (void);
+extern void    alt_host_clock_arm       (alt_u64 value, alt_u64 interval,
+                                         void (*expire) (void));
+extern alt_u64 alt_host_clock_remaining (void);
+extern void    alt_host_clock_spend     (alt_u64 ns);
+extern void    alt_host_clock_idle      (void);
+extern void    alt_host_clock_watch     (alt_u64 (*watch) (alt_u64 now),
+                                         alt_u64 at);
+
+/*
+ * Kernel event trace (see alt_host_trace.c). With ALT_HOST_TRACE=<file> the
+ * OSTrace ring buffer is written to <file> when the application exits.
+ */
+
+extern void    alt_host_trace_init      (void);
+
+/*
+ * Size of the host stack each task executes on. The OS_STK arrays handed to
+ * OSTaskCreate() are far too small for glibc and for the signal frames of
+ * the tick interrupt, so they are left untouched by the host port.
+ */
+
+#ifndef ALT_HOST_TASK_STK_SIZE
+#define ALT_HOST_TASK_STK_SIZE (256 * 1024)
+#endif
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __ALT_HOST_H__ */
@@ -0,0 +1,33 @@
+#ifndef __ALT_TYPES_H__
+#define __ALT_TYPES_H__
+
+/******************************************************************************
+*                                                                             *
+* Host (POSIX) stand-in for the HAL alt_types.h.                              *
+*                                                                             *
+* The Nios II definitions use 'long' for the 32 bit types, which is 64 bits   *
+* wide on an LP64 host. The HAL relies on 32 bit wrap-around (e.g. the        *
+* _alt_nticks roll-over handling in alt_tick()), so the 32 bit types are      *
+* pinned to 'int' here.                                                       *
+*                                                                             *
+******************************************************************************/
+
+/* 
+ * Don't declare these typedefs if this file is included by assembly source.
+ */
+#ifndef ALT_ASM_SRC
+typedef signed char  alt_8;
+typedef unsigned char  alt_u8;
+typedef signed short alt_16;
+typedef unsigned short alt_u16;
+typedef signed int alt_32;
+typedef unsigned int alt_u32;
+typedef long long alt_64;
+typedef unsigned long long alt_u64;
+#endif
+
+#define ALT_INLINE        __inline__
+#define ALT_ALWAYS_INLINE __attribute__ ((always_inline))
+#define ALT_WEAK          __attribute__((weak))
+
+#endif /* __ALT_TYPES_H__ */
@@ -0,0 +1,37 @@
+#ifndef __ALTERA_AVALON_PIO_HOST_H__
+#define __ALTERA_AVALON_PIO_HOST_H__
+
+/******************************************************************************
+*                                                                             *
+* Host (POSIX) model of the Avalon PIO inputs, see altera_avalon_pio_host.c.  *
+*                                                                             *
+******************************************************************************/
+
+#include "alt_types.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+extern void altera_avalon_pio_host_init   (const char* name, alt_u32 base,
+                                           alt_u32 irq, alt_u32 width,
+                                           const char* edge_type,
+                                           int bit_clearing, alt_u32 pins);
+extern void altera_avalon_pio_host_script (void);
+
+/*
+ * Attach the model to a PIO using the settings of system.h, with the input
+ * pins at 'pins' until a script changes them.
+ */
+
+#define ALTERA_AVALON_PIO_HOST_INIT(name, pins)                            \
+  altera_avalon_pio_host_init (name##_NAME, name##_BASE, name##_IRQ,       \
+                               name##_DATA_WIDTH, name##_EDGE_TYPE,        \
+                               name##_BIT_CLEARING_EDGE_REGISTER, (pins))
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __ALTERA_AVALON_PIO_HOST_H__ */
@@ -0,0 +1,25 @@
+#ifndef __ALTERA_AVALON_TIMER_HOST_H__
+#define __ALTERA_AVALON_TIMER_HOST_H__
+
+/******************************************************************************
+*                                                                             *
+* Host (POSIX) model of the Avalon interval timer, see                        *
+* altera_avalon_timer_host.c.                                                 *
+*                                                                             *
+******************************************************************************/
+
+#include "alt_types.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+extern void altera_avalon_timer_host_init (alt_u32 base, alt_u32 irq,
+                                           alt_u32 freq, alt_u32 load_value);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __ALTERA_AVALON_TIMER_HOST_H__ */
@@ -0,0 +1,60 @@
+#ifndef __IO_H__
+#define __IO_H__
+
+/******************************************************************************
+*                                                                             *
+* Host (POSIX) stand-in for the HAL io.h.                                     *
+*                                                                             *
+* On the board the IORD/IOWR macros expand to the ldwio/stwio instructions.   *
+* On the host every access is routed through alt_host_io_read() and           *
+* alt_host_io_write(), which either hit a plain register file or the device   *
+* model registered for that address range (see alt_host.h).                   *
+*                                                                             *
+******************************************************************************/
+
+#include "alt_types.h"
+#include "alt_host.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+#ifndef SYSTEM_BUS_WIDTH
+#define SYSTEM_BUS_WIDTH 32
+#endif
+
+/* Dynamic bus access functions */
+
+#define __IO_CALC_ADDRESS_DYNAMIC(BASE, OFFSET) \
+  ((alt_u32)(unsigned long)(BASE) + (OFFSET))
+
+#define IORD_32DIRECT(BASE, OFFSET) \
+  alt_host_io_read (__IO_CALC_ADDRESS_DYNAMIC ((BASE), (OFFSET)), 4)
+#define IORD_16DIRECT(BASE, OFFSET) \
+  alt_host_io_read (__IO_CALC_ADDRESS_DYNAMIC ((BASE), (OFFSET)), 2)
+#define IORD_8DIRECT(BASE, OFFSET) \
+  alt_host_io_read (__IO_CALC_ADDRESS_DYNAMIC ((BASE), (OFFSET)), 1)
+
+#define IOWR_32DIRECT(BASE, OFFSET, DATA) \
+  alt_host_io_write (__IO_CALC_ADDRESS_DYNAMIC ((BASE), (OFFSET)), 4, (DATA))
+#define IOWR_16DIRECT(BASE, OFFSET, DATA) \
+  alt_host_io_write (__IO_CALC_ADDRESS_DYNAMIC ((BASE), (OFFSET)), 2, (DATA))
+#define IOWR_8DIRECT(BASE, OFFSET, DATA) \
+  alt_host_io_write (__IO_CALC_ADDRESS_DYNAMIC ((BASE), (OFFSET)), 1, (DATA))
+
+/* Native bus access functions */
+
+#define __IO_CALC_ADDRESS_NATIVE(BASE, REGNUM) \
+  ((alt_u32)(unsigned long)(BASE) + ((REGNUM) * (SYSTEM_BUS_WIDTH/8)))
+
+#define IORD(BASE, REGNUM) \
+  alt_host_io_read (__IO_CALC_ADDRESS_NATIVE ((BASE), (REGNUM)), 4)
+#define IOWR(BASE, REGNUM, DATA) \
+  alt_host_io_write (__IO_CALC_ADDRESS_NATIVE ((BASE), (REGNUM)), 4, (DATA))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IO_H__ */
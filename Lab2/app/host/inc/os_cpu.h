@@ -0,0 +1,104 @@
+#ifndef __OS_CPU_H__
+#define __OS_CPU_H__
+
+/*
+*********************************************************************************************************
+*                                               uC/OS-II
+*                                        The Real-Time Kernel
+*
+*                         (c) Copyright 1992-1999, Jean J. Labrosse, Weston, FL
+*                                          All Rights Reserved
+*
+*                                     POSIX (ucontext) host specific code
+*
+* File         : OS_CPU.H
+* By           : based on the Nios II version by IS
+*********************************************************************************************************
+*/
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+#include "sys/alt_irq.h"
+
+#ifdef  OS_CPU_GLOBALS
+#define OS_CPU_EXT
+#else
+#define OS_CPU_EXT  extern
+#endif
+
+/*****************************************************************************************
+/                                              DATA TYPES
+/                                         (Compiler Specific)
+*****************************************************************************************/
+
+/* Same widths as the Nios2 port; 'long' would be 64 bits on an LP64 host. */
+typedef unsigned char  BOOLEAN;
+typedef unsigned char  INT8U;                    /* Unsigned  8 bit quantity                           */
+typedef signed   char  INT8S;                    /* Signed    8 bit quantity                           */
+typedef unsigned short INT16U;                   /* Unsigned 16 bit quantity                           */
+typedef signed   short INT16S;                   /* Signed   16 bit quantity                           */
+typedef unsigned int   INT32U;                   /* Unsigned 32 bit quantity                           */
+typedef signed   int   INT32S;                   /* Signed   32 bit quantity                           */
+typedef unsigned long long INT64U;               /* Unsigned 64 bit quantity                           */
+typedef float          FP32;                     /* Single precision floating point                    */
+typedef double         FP64;                     /* Double precision floating point                    */
+typedef unsigned int   OS_STK;                   /* Each stack entry is 32-bits                        */
+
+/****************************************************************************
+*                           Host Miscellaneous defines
+****************************************************************************/
+
+#define  OS_STK_GROWTH        1        /* Stack grows from HIGH to LOW memory */
+#define  OS_TASK_SW           OSCtxSw  
+#define  OS_CPU_CTZ(x)        __builtin_ctz(x)  /* Lowest set bit of a non-zero INT32U */
+#define  OS_CPU_MEM_BARRIER() __asm__ __volatile__ ("" : : : "memory")  /* All tasks share one thread */
+
+/* Atomic compare-and-swap of a 32 or 64 bit '*p' from 'old' to 'new', true if it was 'old',
+ * and atomic add; both are single instructions that a signal (an interrupt) cannot split. */
+#define  OS_CPU_CAS(p, old, new)  __sync_bool_compare_and_swap((p), (old), (new))
+#define  OS_CPU_ADD(p, v)         ((void)__sync_fetch_and_add((p), (v)))
+
+/* OS_MemClr(), OS_MemCopy() and OS_TaskStkClr() use the memset() and memcpy() of the host C
+ * library, which move the widest words the CPU has. ALT_HOST_MEM_LIBC=0 keeps the 32 bit word
+ * loops of the kernel, as on the Nios2. */
+#ifndef ALT_HOST_MEM_LIBC
+#define  ALT_HOST_MEM_LIBC        1
+#endif
+#if      ALT_HOST_MEM_LIBC > 0
+#include <string.h>
+#define  OS_CPU_MEM_CLR(p, size)        memset((p), 0, (size))
+#define  OS_CPU_MEM_COPY(pd, ps, size)  memcpy((pd), (ps), (size))
+#endif
+
+/******************************************************************************************
+ *                Disable and Enable Interrupts
+ *
+ * Only method #3 is supported, as on the Nios2. 'cpu_sr' records whether the interrupt
+ * signals were unblocked on entry, and the exit restores that state.
+ *****************************************************************************************/
+
+#define  OS_CRITICAL_METHOD    3    
+
+#if      OS_CRITICAL_METHOD != 3
+#error OS_CRITICAL_METHOD != 3 not supported, please use method 3 instead.
+#endif
+
+#define  OS_CPU_SR alt_irq_context  
+#define  OS_ENTER_CRITICAL() \
+         cpu_sr = alt_irq_disable_all ()
+#define  OS_EXIT_CRITICAL() \
+         alt_irq_enable_all (cpu_sr);
+
+/* Prototypes */
+void OSStartHighRdy(void); 
+void OSCtxSw(void); 
+void OSIntCtxSw(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __OS_CPU_H__ */
@@ -0,0 +1,188 @@
+#ifndef __ALT_IRQ_H__
+#define __ALT_IRQ_H__
+
+/******************************************************************************
+*                                                                             *
+* Host (POSIX) stand-in for the HAL sys/alt_irq.h.                            *
+*                                                                             *
+* The signals in alt_irq_sigset are the host's interrupt lines. The Nios II  *
+* status.PIE bit is a plain variable rather than the process signal mask, so *
+* that a critical section costs no system call: a signal that arrives while  *
+* PIE is clear is only recorded by the handler, and is delivered again when  *
+* interrupts are re-enabled. The interrupt controller itself (ipending and   *
+* ienable) is kept in two words that the device models update.               *
+*                                                                             *
+******************************************************************************/
+
+#include <errno.h>
+#include <signal.h>
+#include <stddef.h>
+
+#include "alt_types.h"
+#include "system.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/*
+ * Macros used by alt_irq_enabled
+ */
+
+#define ALT_IRQ_ENABLED  1
+#define ALT_IRQ_DISABLED 0  
+
+/* 
+ * Number of available interrupts.
+ */
+
+#define ALT_NIRQ 32
+
+/*
+ * Stand-in for the PIE bit of the Nios II status register. An
+ * alt_irq_context holds this bit for the state before the call to
+ * alt_irq_disable_all().
+ */
+
+#define ALT_IRQ_HOST_STATUS_PIE_MSK 0x1
+
+/*
+ * Used by alt_irq_disable_all() and alt_irq_enable_all().
+ */
+
+typedef int alt_irq_context;
+
+/* ISR Prototype */
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+typedef void (*alt_isr_func)(void* isr_context);
+#else
+typedef void (*alt_isr_func)(void* isr_context, alt_u32 id);
+#endif
+
+/*
+ * The set of host signals standing in for the CPU interrupt input, and the
+ * state of the internal interrupt controller.
+ */
+
+extern sigset_t         alt_irq_sigset;
+extern volatile alt_u32 alt_irq_ipending;
+extern volatile alt_u32 alt_irq_ienable;
+
+/*
+ * status.PIE, and the interrupt signals that were held off while it was
+ * clear. alt_irq_replay() delivers the latter.
+ */
+
+extern volatile sig_atomic_t alt_irq_pie;
+extern volatile sig_atomic_t alt_irq_deferred;
+
+extern void alt_irq_replay (void);
+
+/*
+ * Keeps the compiler from moving memory accesses of a critical section past
+ * the update of alt_irq_pie. The signal handler runs on the same thread, so
+ * no hardware barrier is needed.
+ */
+
+#define ALT_IRQ_HOST_BARRIER() __asm__ __volatile__ ("" : : : "memory")
+
+/*
+ * alt_irq_enabled can be called to determine if interrupts are enabled. The
+ * return value is zero if interrupts are disabled, and non-zero otherwise.
+ */
+
+static ALT_INLINE int ALT_ALWAYS_INLINE alt_irq_enabled (void)
+{
+  return alt_irq_pie;
+}
+
+/*
+ * alt_irq_disable_all() 
+ *
+ * This routine inhibits all interrupts by clearing PIE. The previous state
+ * is returned so that it can later be restored with alt_irq_enable_all().
+ */
+
+static ALT_INLINE alt_irq_context ALT_ALWAYS_INLINE 
+       alt_irq_disable_all (void)
+{
+  alt_irq_context context = alt_irq_pie ? ALT_IRQ_HOST_STATUS_PIE_MSK : 0;
+
+  alt_irq_pie = 0;
+  ALT_IRQ_HOST_BARRIER ();
+
+  return context;
+}
+
+/*
+ * alt_irq_enable_all() 
+ *
+ * Restores the interrupt state saved by a previous call to
+ * alt_irq_disable_all(). Interrupt signals held off in the meantime are
+ * delivered as soon as PIE is set again.
+ */
+
+static ALT_INLINE void ALT_ALWAYS_INLINE 
+       alt_irq_enable_all (alt_irq_context context)
+{
+  if (context & ALT_IRQ_HOST_STATUS_PIE_MSK)
+  {
+    ALT_IRQ_HOST_BARRIER ();
+    alt_irq_pie = 1;
+
+    if (alt_irq_deferred)
+    {
+      alt_irq_replay ();
+    }
+  }
+}
+
+/*
+ * The function alt_irq_init() is defined within the auto-generated file
+ * alt_sys_init.c. On the host it installs the interrupt signal handlers.
+ */
+
+extern void alt_irq_init (const void* base);
+
+/*
+ * alt_irq_cpu_enable_interrupts() enables the CPU to start taking interrupts.
+ */
+
+static ALT_INLINE void ALT_ALWAYS_INLINE 
+       alt_irq_cpu_enable_interrupts (void)
+{
+  alt_irq_enable_all (ALT_IRQ_HOST_STATUS_PIE_MSK);
+}
+
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+
+extern int alt_ic_isr_register(alt_u32 ic_id,
+                        alt_u32 irq,
+                        alt_isr_func isr,
+                        void *isr_context,
+                        void *flags);
+
+int alt_ic_irq_enable (alt_u32 ic_id, alt_u32 irq);
+int alt_ic_irq_disable(alt_u32 ic_id, alt_u32 irq);        
+
+alt_u32 alt_ic_irq_enabled(alt_u32 ic_id, alt_u32 irq);
+
+#endif /* ALT_ENHANCED_INTERRUPT_API_PRESENT */
+
+/*
+ * alt_irq_pending() returns a bit list of the current pending interrupts.
+ * This is used by alt_irq_handler() to determine which registered interrupt
+ * handlers should be called.
+ */
+
+static ALT_INLINE alt_u32 ALT_ALWAYS_INLINE alt_irq_pending (void)
+{
+  return alt_irq_ipending & alt_irq_ienable;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __ALT_IRQ_H__ */
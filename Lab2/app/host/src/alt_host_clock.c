@@ -0,0 +1,359 @@
+/******************************************************************************
+*                                                                             *
+* Host (POSIX) clock used by the timer models.                                *
+*                                                                             *
+* The clock runs in one of two modes, selected by the environment variable    *
+* ALT_HOST_CLOCK when the application starts:                                 *
+*                                                                             *
+*  real    (default) time is the host's monotonic clock and timeouts are      *
+*          delivered by the process interval timer (SIGALRM).                 *
+*                                                                             *
+*  virtual time only advances while the CPU is idle. As soon as every task    *
+*          is blocked, the idle task hook jumps the clock to the next         *
+*          timeout and delivers it at once, so ticks, OSTmr and alt_alarm     *
+*          callbacks run back to back instead of waiting for the wall clock. *
+*          Task code takes no time at all, which makes a run reproducible.   *
+*                                                                             *
+* A task that busy-waits for the time to change (e.g. on OSTimeGet()) never   *
+* lets the idle task run. In virtual mode the interval timer therefore keeps  *
+* a short real-time watchdog: when no timeout was delivered and no context    *
+* switch happened since its previous expiry, the CPU is considered busy and   *
+* the clock moves on to the next timeout just as it does when idle.           *
+*                                                                             *
+* ALT_HOST_STOP_AFTER=<seconds> ends the application with exit status 0 once  *
+* the clock has passed the given time, in either mode.                        *
+*                                                                             *
+* There is a single timeout, owned by the system clock timer model. Other     *
+* device models can follow it with alt_host_clock_watch(). In virtual mode a  *
+* watch also names the time of its next event, and the clock stops there too *
+* when that comes before the timeout, so that an input can interrupt an idle  *
+* period that holds off the tick. In real mode the watch is only called on    *
+* the timeouts.                                                               *
+*                                                                             *
+******************************************************************************/
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include "includes.h"
+#include "sys/alt_irq.h"
+#include "alt_host.h"
+#include "alt_types.h"
+
+/* Period of the busy CPU watchdog in virtual mode, in microseconds. */
+
+#define ALT_HOST_CLOCK_SPIN_US 200
+
+typedef struct
+{
+  int     virtual;
+  alt_u64 now;              /* virtual time, ns                          */
+  alt_u64 start;            /* host monotonic time at start-up, ns       */
+  alt_u64 stop;             /* ALT_HOST_STOP_AFTER in ns, 0 if not set   */
+  alt_u64 deadline;         /* time of the next timeout, 0 if not armed  */
+  alt_u64 interval;         /* reload of a periodic timeout, ns          */
+  alt_u64 watch_at;         /* time of the next watch event, 0 if none   */
+  alt_u32 events;           /* events delivered so far                   */
+  alt_u32 spin_events;      /* value of 'events' at the last watchdog    */
+  alt_u32 spin_switches;    /* value of OSCtxSwCtr at the last watchdog  */
+  int     due;              /* the idle hook has reached the next event  */
+  void    (*expire) (void);
+  alt_u64 (*watch) (alt_u64 now);
+} alt_host_clock_t;
+
+static alt_host_clock_t alt_host_clock;
+
+static alt_u64 alt_host_clock_monotonic (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+
+  return (alt_u64) ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static void alt_host_clock_itimer (alt_u64 value, alt_u64 interval)
+{
+  struct itimerval timer;
+
+  /* a zero it_value disarms the timer, so round short timeouts up */
+  if (value && value < 1000)
+  {
+    value = 1000;
+  }
+
+  timer.it_value.tv_sec     = value / 1000000000u;
+  timer.it_value.tv_usec    = (value % 1000000000u) / 1000;
+  timer.it_interval.tv_sec  = interval / 1000000000u;
+  timer.it_interval.tv_usec = (interval % 1000000000u) / 1000;
+
+  setitimer (ITIMER_REAL, &timer, NULL);
+}
+
+/*
+ * Virtual time of the next event: the timeout or the next watch event,
+ * whichever comes first; 0 if there is neither.
+ */
+
+static alt_u64 alt_host_clock_next (alt_host_clock_t* clock)
+{
+  alt_u64 next = clock->deadline;
+
+  if (clock->watch_at && (!next || clock->watch_at < next))
+  {
+    next = clock->watch_at;
+  }
+  if (next && next < clock->now)
+  {
+    next = clock->now;
+  }
+
+  return next;
+}
+
+/*
+ * SIGALRM event. In real mode this is the timeout itself; in virtual mode it
+ * is either the idle hook delivering the event it has reached, or the busy
+ * CPU watchdog. The owner of the timeout only sees the event if the timeout
+ * has been reached.
+ */
+
+static void alt_host_clock_event (void)
+{
+  alt_host_clock_t* clock = &alt_host_clock;
+  int               expired = 1;
+
+  if (clock->virtual)
+  {
+    if (!clock->due)
+    {
+      if (clock->events  != clock->spin_events   ||
+          OSCtxSwCtr     != clock->spin_switches ||
+          !alt_host_clock_next (clock))
+      {
+        clock->spin_events   = clock->events;
+        clock->spin_switches = OSCtxSwCtr;
+        return;
+      }
+      clock->now = alt_host_clock_next (clock);
+    }
+
+    clock->due = 0;
+    expired    = clock->deadline && clock->now >= clock->deadline;
+    if (expired)
+    {
+      clock->deadline = clock->interval ? clock->deadline + clock->interval
+                                        : 0;
+    }
+  }
+  else if (!clock->interval)
+  {
+    clock->deadline = 0;
+  }
+
+  clock->events++;
+
+  if (clock->stop && alt_host_clock_now () >= clock->stop)
+  {
+    exit (0);
+  }
+
+  if (clock->watch)
+  {
+    clock->watch_at = clock->watch (alt_host_clock_now ());
+  }
+
+  if (expired && clock->expire)
+  {
+    clock->expire ();
+  }
+}
+
+/*
+ * Read the configuration from the environment and take over SIGALRM.
+ * Called from alt_main before the device models are initialized.
+ */
+
+void alt_host_clock_init (void)
+{
+  alt_host_clock_t* clock = &alt_host_clock;
+  const char*       mode  = getenv ("ALT_HOST_CLOCK");
+  const char*       stop  = getenv ("ALT_HOST_STOP_AFTER");
+
+  memset (clock, 0, sizeof (*clock));
+
+  if (mode && !strcmp (mode, "virtual"))
+  {
+    clock->virtual = 1;
+  }
+  else if (mode && strcmp (mode, "real"))
+  {
+    fprintf (stderr, "alt_host_clock: unknown ALT_HOST_CLOCK '%s', "
+             "using real time\n", mode);
+  }
+
+  if (stop)
+  {
+    clock->stop = (alt_u64) (strtod (stop, NULL) * 1e9);
+  }
+
+  clock->start = alt_host_clock_monotonic ();
+
+  alt_host_irq_connect (SIGALRM, alt_host_clock_event);
+
+  if (clock->virtual)
+  {
+    alt_host_clock_itimer (ALT_HOST_CLOCK_SPIN_US * 1000,
+                           ALT_HOST_CLOCK_SPIN_US * 1000);
+  }
+}
+
+int alt_host_clock_virtual (void)
+{
+  return alt_host_clock.virtual;
+}
+
+/*
+ * Current time in nanoseconds since start-up.
+ */
+
+alt_u64 alt_host_clock_now (void)
+{
+  if (alt_host_clock.virtual)
+  {
+    return alt_host_clock.now;
+  }
+
+  return alt_host_clock_monotonic () - alt_host_clock.start;
+}
+
+/*
+ * Arm the timeout to call 'expire' in interrupt context after 'value' ns,
+ * and then every 'interval' ns if that is not zero. A zero 'value' disarms
+ * it.
+ */
+
+void alt_host_clock_arm (alt_u64 value, alt_u64 interval,
+                         void (*expire) (void))
+{
+  alt_host_clock_t* clock = &alt_host_clock;
+  alt_irq_context   context;
+
+  context = alt_irq_disable_all ();
+
+  clock->expire   = expire;
+  clock->interval = value ? interval : 0;
+  clock->deadline = value ? alt_host_clock_now () + value : 0;
+  clock->due      = 0;
+
+  if (!clock->virtual)
+  {
+    alt_host_clock_itimer (value, clock->interval);
+  }
+
+  alt_irq_enable_all (context);
+}
+
+/*
+ * Have 'watch' called in interrupt context with the current time whenever a
+ * timeout is delivered, before the owner of the timeout sees it. This lets a
+ * device model change its inputs on the timeline of the system clock.
+ *
+ * 'at' is the time of the first event of the model, and 'watch' returns the
+ * time of the next one, 0 if there is none. In virtual mode the clock stops
+ * at these times as well and calls 'watch' without a timeout.
+ */
+
+void alt_host_clock_watch (alt_u64 (*watch) (alt_u64 now), alt_u64 at)
+{
+  alt_irq_context context;
+
+  context = alt_irq_disable_all ();
+  alt_host_clock.watch    = watch;
+  alt_host_clock.watch_at = at;
+  alt_irq_enable_all (context);
+}
+
+/*
+ * Time left until the armed timeout, in ns; 0 if it is not armed.
+ */
+
+alt_u64 alt_host_clock_remaining (void)
+{
+  alt_host_clock_t* clock = &alt_host_clock;
+  struct itimerval  timer;
+
+  if (!clock->deadline)
+  {
+    return 0;
+  }
+
+  if (clock->virtual)
+  {
+    return clock->deadline - clock->now;
+  }
+
+  getitimer (ITIMER_REAL, &timer);
+
+  return (alt_u64) timer.it_value.tv_sec * 1000000000u +
+         (alt_u64) timer.it_value.tv_usec * 1000;
+}
+
+/*
+ * Let 'ns' pass, as the time a device access takes on the target. In
+ * virtual mode the clock moves on by that much; an event that falls in
+ * between is delivered late, by the next idle period or watchdog. In real
+ * mode it busy-waits.
+ */
+
+void alt_host_clock_spend (alt_u64 ns)
+{
+  alt_u64 end;
+
+  if (alt_host_clock.virtual)
+  {
+    alt_host_clock.now += ns;
+    return;
+  }
+
+  end = alt_host_clock_monotonic () + ns;
+  while (alt_host_clock_monotonic () < end)
+    ;
+}
+
+/*
+ * Called by the idle task with interrupts enabled. In virtual mode nothing
+ * can happen before the next timeout or watch event, so the clock is moved
+ * to it and the event is delivered right away.
+ */
+
+void alt_host_clock_idle (void)
+{
+  alt_host_clock_t* clock = &alt_host_clock;
+  alt_irq_context   context;
+
+  if (!clock->virtual)
+  {
+    return;
+  }
+
+  context = alt_irq_disable_all ();
+
+  if (!alt_host_clock_next (clock))
+  {
+    fprintf (stderr, "alt_host_clock: all tasks are blocked and no timeout "
+             "is armed\n");
+    exit (1);
+  }
+
+  clock->now = alt_host_clock_next (clock);
+  clock->due = 1;
+
+  alt_irq_enable_all (context);
+
+  alt_host_irq_enter (SIGALRM);
+}
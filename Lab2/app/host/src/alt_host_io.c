@@ -0,0 +1,77 @@
+/******************************************************************************
+*                                                                             *
+* Host (POSIX) memory mapped IO.                                              *
+*                                                                             *
+* All peripherals of the DE2 system sit in the first 64 KB of the address     *
+* space. Accesses to a range claimed by a device model are forwarded to it;   *
+* everything else in that window is backed by a plain register file, so an    *
+* IOWR followed by an IORD returns the written value.                         *
+*                                                                             *
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alt_host.h"
+#include "alt_types.h"
+
+#define ALT_HOST_IO_SPAN 0x10000
+
+static alt_u8           alt_host_io_mem[ALT_HOST_IO_SPAN];
+static alt_host_io_dev* alt_host_io_devs = NULL;
+
+static alt_host_io_dev* alt_host_io_find (alt_u32 address)
+{
+  alt_host_io_dev* dev;
+
+  for (dev = alt_host_io_devs; dev != NULL; dev = dev->next)
+  {
+    if (address - dev->base < dev->span)
+    {
+      return dev;
+    }
+  }
+
+  if (address + 4 > ALT_HOST_IO_SPAN)
+  {
+    fprintf (stderr, "alt_host_io: access to unmapped address 0x%08x\n",
+             address);
+    abort ();
+  }
+
+  return NULL;
+}
+
+alt_u32 alt_host_io_read (alt_u32 address, int width)
+{
+  alt_host_io_dev* dev = alt_host_io_find (address);
+  alt_u32          data = 0;
+
+  if (dev != NULL)
+  {
+    return dev->read (dev, address - dev->base);
+  }
+
+  memcpy (&data, &alt_host_io_mem[address], width);
+  return data;
+}
+
+void alt_host_io_write (alt_u32 address, int width, alt_u32 data)
+{
+  alt_host_io_dev* dev = alt_host_io_find (address);
+
+  if (dev != NULL)
+  {
+    dev->write (dev, address - dev->base, data);
+    return;
+  }
+
+  memcpy (&alt_host_io_mem[address], &data, width);
+}
+
+void alt_host_io_register (alt_host_io_dev* dev)
+{
+  dev->next        = alt_host_io_devs;
+  alt_host_io_devs = dev;
+}
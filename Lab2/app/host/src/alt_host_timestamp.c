@@ -0,0 +1,44 @@
+/******************************************************************************
+*                                                                             *
+* Host (POSIX) timestamp driver.                                              *
+*                                                                             *
+* Provides the HAL timestamp interface of sys/alt_timestamp.h, which on the   *
+* board is implemented by altera_avalon_timer_ts.c on the timer selected as   *
+* timestamp timer. The count is the host's monotonic clock in nanoseconds     *
+* since the last alt_timestamp_start(), in both clock modes: it measures how  *
+* long code takes, which virtual time does not.                               *
+*                                                                             *
+******************************************************************************/
+
+#include <time.h>
+
+#include "sys/alt_timestamp.h"
+#include "alt_types.h"
+
+static alt_u64 alt_host_timestamp_start;
+
+static alt_u64 alt_host_timestamp_monotonic (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+
+  return (alt_u64) ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+int alt_timestamp_start (void)
+{
+  alt_host_timestamp_start = alt_host_timestamp_monotonic ();
+  return 0;
+}
+
+alt_timestamp_type alt_timestamp (void)
+{
+  return (alt_timestamp_type) (alt_host_timestamp_monotonic () -
+                               alt_host_timestamp_start);
+}
+
+alt_u32 alt_timestamp_freq (void)
+{
+  return 1000000000u;
+}
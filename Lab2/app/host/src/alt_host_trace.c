@@ -0,0 +1,60 @@
+/******************************************************************************
+*                                                                             *
+* Host (POSIX) dump of the kernel event trace.                                *
+*                                                                             *
+* With OS_TRACE_EN the kernel records its events in the OSTrace ring buffer.  *
+* On the board the buffer is dumped from the debugger; on the host           *
+* ALT_HOST_TRACE=<file> writes it to <file> when the application exits, e.g. *
+* after ALT_HOST_STOP_AFTER. tools/trace2json.c turns the dump into a        *
+* Chrome trace.                                                               *
+*                                                                             *
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "includes.h"
+#include "alt_host.h"
+
+#if OS_TRACE_EN > 0
+
+static const char* alt_host_trace_file;
+
+static void alt_host_trace_dump (void)
+{
+  FILE* file = fopen (alt_host_trace_file, "wb");
+
+  if (!file || fwrite (&OSTrace, sizeof (OSTrace), 1, file) != 1)
+  {
+    fprintf (stderr, "alt_host_trace: cannot write '%s'\n",
+             alt_host_trace_file);
+  }
+  if (file)
+  {
+    fclose (file);
+  }
+}
+
+#endif /* OS_TRACE_EN */
+
+/*
+ * Read the configuration from the environment. Called from alt_main.
+ */
+
+void alt_host_trace_init (void)
+{
+  const char* file = getenv ("ALT_HOST_TRACE");
+
+  if (!file)
+  {
+    return;
+  }
+
+#if OS_TRACE_EN > 0
+  alt_host_trace_file = file;
+  atexit (alt_host_trace_dump);
+#else
+  fprintf (stderr, "alt_host_trace: ALT_HOST_TRACE is set, but the kernel "
+           "was built without OS_TRACE_EN\n");
+#endif
+}
@@ -0,0 +1,241 @@
+/******************************************************************************
+*                                                                             *
+* Host (POSIX) interrupt entry and internal interrupt controller.             *
+*                                                                             *
+* Takes the place of alt_irq_entry.S, alt_iic.c and alt_iic_isr_register.c.  *
+* Every host signal in alt_irq_sigset is an interrupt input of the CPU: the   *
+* signal handler first lets the connected device model update its state and  *
+* interrupt line, then runs the unmodified HAL alt_irq_handler() if any       *
+* enabled interrupt is pending. PIE is cleared while the handler runs, just   *
+* as the Nios II does on exception entry; a signal that finds PIE clear is   *
+* recorded in alt_irq_deferred and replayed when interrupts are enabled.     *
+*                                                                             *
+******************************************************************************/
+
+#include <signal.h>
+#include <stddef.h>
+
+#include "system.h"
+#include "sys/alt_irq.h"
+#include "priv/alt_irq_table.h"
+#include "alt_host.h"
+#include "alt_types.h"
+
+extern void alt_irq_handler (void);
+
+sigset_t         alt_irq_sigset;
+volatile alt_u32 alt_irq_ipending = 0;
+volatile alt_u32 alt_irq_ienable  = 0;
+
+volatile sig_atomic_t alt_irq_pie      = 0;
+volatile sig_atomic_t alt_irq_deferred = 0;
+
+/*
+ * Device model event for each interrupt signal.
+ */
+
+static void (*alt_irq_event[NSIG]) (void);
+
+/*
+ * Number of times each interrupt was dispatched, see alt_host_irq_count().
+ */
+
+static alt_u32 alt_irq_count[ALT_NIRQ];
+
+static void alt_irq_entry_count (alt_u32 active)
+{
+  alt_u32 irq;
+
+  for (irq = 0; active; irq++, active >>= 1)
+  {
+    if (active & 1)
+    {
+      alt_irq_count[irq]++;
+    }
+  }
+}
+
+static void alt_irq_entry (int sig)
+{
+  if (!alt_irq_pie)
+  {
+    alt_irq_deferred |= 1 << sig;
+    return;
+  }
+
+  alt_irq_pie = 0;
+  ALT_IRQ_HOST_BARRIER ();
+
+  if (alt_irq_event[sig])
+  {
+    alt_irq_event[sig] ();
+  }
+
+  if (alt_irq_pending ())
+  {
+    alt_irq_entry_count (alt_irq_pending ());
+    alt_irq_handler ();
+  }
+
+  ALT_IRQ_HOST_BARRIER ();
+  alt_irq_pie = 1;
+}
+
+/*
+ * Called by alt_irq_enable_all() once PIE is set again. A signal arriving
+ * from here on is taken directly, so each deferred one is entered exactly
+ * once.
+ */
+
+void alt_irq_replay (void)
+{
+  sig_atomic_t deferred = alt_irq_deferred;
+  int          sig;
+
+  alt_irq_deferred = 0;
+
+  for (sig = 1; deferred; sig++)
+  {
+    if (deferred & (1 << sig))
+    {
+      deferred &= ~(1 << sig);
+      alt_irq_entry (sig);
+    }
+  }
+}
+
+/*
+ * Install the interrupt signal handlers and enable interrupts in the CPU.
+ * SIGALRM is the interval timer driving timer_0; SIGUSR1 is raised whenever
+ * a device model asserts an interrupt line outside of interrupt context.
+ */
+
+void alt_irq_init (const void* base)
+{
+  struct sigaction action;
+
+  sigemptyset (&alt_irq_sigset);
+  sigaddset (&alt_irq_sigset, SIGALRM);
+  sigaddset (&alt_irq_sigset, SIGUSR1);
+
+  action.sa_handler = alt_irq_entry;
+  action.sa_mask    = alt_irq_sigset;
+  action.sa_flags   = SA_RESTART;
+
+  sigaction (SIGALRM, &action, NULL);
+  sigaction (SIGUSR1, &action, NULL);
+
+  alt_irq_cpu_enable_interrupts ();
+}
+
+/*
+ * Take the interrupt signal 'sig' as if it had just been delivered, without
+ * the round trip through the host kernel.
+ */
+
+void alt_host_irq_enter (int sig)
+{
+  alt_irq_entry (sig);
+}
+
+/*
+ * Number of times the handler of 'irq' has been dispatched since start-up.
+ */
+
+alt_u32 alt_host_irq_count (alt_u32 irq)
+{
+  return (irq < ALT_NIRQ) ? alt_irq_count[irq] : 0;
+}
+
+void alt_host_irq_connect (int sig, void (*event) (void))
+{
+  alt_irq_context context;
+
+  if (sigismember (&alt_irq_sigset, sig) == 1)
+  {
+    context = alt_irq_disable_all ();
+    alt_irq_event[sig] = event;
+    alt_irq_enable_all (context);
+  }
+}
+
+/*
+ * Interrupt lines. Raising a line from task level has to enter the interrupt
+ * handler, which is done by sending SIGUSR1 to the process; the signal stays
+ * pending while interrupts are disabled.
+ */
+
+void alt_host_irq_raise (alt_u32 irq)
+{
+  alt_irq_context context;
+
+  context = alt_irq_disable_all ();
+  alt_irq_ipending |= (1 << irq);
+  alt_irq_enable_all (context);
+
+  if (alt_irq_ienable & (1 << irq))
+  {
+    raise (SIGUSR1);
+  }
+}
+
+void alt_host_irq_lower (alt_u32 irq)
+{
+  alt_irq_context context;
+
+  context = alt_irq_disable_all ();
+  alt_irq_ipending &= ~(1 << irq);
+  alt_irq_enable_all (context);
+}
+
+/*
+ * Enhanced interrupt API for the internal interrupt controller.
+ */
+
+int alt_ic_isr_register(alt_u32 ic_id, alt_u32 irq, alt_isr_func isr, 
+  void *isr_context, void *flags)
+{
+  int rc = -EINVAL;  
+  alt_irq_context status;
+
+  if (irq < ALT_NIRQ)
+  {
+    status = alt_irq_disable_all();
+
+    alt_irq[irq].handler = isr;
+    alt_irq[irq].context = isr_context;
+
+    rc = (isr) ? alt_ic_irq_enable(ic_id, irq) : alt_ic_irq_disable(ic_id, irq);
+
+    alt_irq_enable_all(status);
+  }
+
+  return rc; 
+}
+
+int alt_ic_irq_enable (alt_u32 ic_id, alt_u32 irq)
+{
+  alt_irq_context status;
+
+  status = alt_irq_disable_all ();
+  alt_irq_ienable |= (1 << irq);
+  alt_irq_enable_all (status);
+
+  return 0;
+}
+
+int alt_ic_irq_disable(alt_u32 ic_id, alt_u32 irq)
+{
+  alt_irq_context status;
+
+  status = alt_irq_disable_all ();
+  alt_irq_ienable &= ~(1 << irq);
+  alt_irq_enable_all (status);
+
+  return 0;
+}
+
+alt_u32 alt_ic_irq_enabled(alt_u32 ic_id, alt_u32 irq)
+{
+  return (alt_irq_ienable & (1 << irq)) ? 1: 0;
+}
@@ -0,0 +1,173 @@
+/******************************************************************************
+*                                                                             *
+* Host (POSIX) counterpart of alt_malloc_lock.c and alt_env_lock.c.           *
+*                                                                             *
+* On the board newlib gets a reentrancy structure per task and its heap and   *
+* environment are guarded by uC/OS semaphores. glibc only protects itself     *
+* against other threads, and all tasks share the one host thread, so a tick   *
+* that preempts a task in the middle of printf() would let the next task      *
+* re-enter stdio on the same state. The application is therefore linked      *
+* with --wrap for the calls below, and each of them runs with interrupts      *
+* disabled. With ALT_SLAB_EN the malloc() family first tries the slab         *
+* allocator (see os/alt_slab.h), which has a critical section of its own.     *
+*                                                                             *
+******************************************************************************/
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "includes.h"
+#include "sys/alt_irq.h"
+#include "os/alt_slab.h"
+
+/*
+ * Semaphores used by ALT_OS_INIT(). They are created to keep the start-up
+ * sequence identical to the board, but the host never pends on them.
+ */
+
+OS_EVENT *alt_envsem;
+OS_EVENT *alt_heapsem;
+
+#define ALT_LIBC_LOCKED(call)                           \
+  do                                                    \
+  {                                                     \
+    alt_irq_context context = alt_irq_disable_all ();   \
+    call;                                               \
+    alt_irq_enable_all (context);                       \
+  } while (0)
+
+int   __real_vfprintf (FILE* stream, const char* format, va_list ap);
+int   __real_fputs    (const char* s, FILE* stream);
+int   __real_puts     (const char* s);
+int   __real_fputc    (int c, FILE* stream);
+int   __real_putchar  (int c);
+int   __real_fflush   (FILE* stream);
+size_t __real_fwrite  (const void* ptr, size_t size, size_t n, FILE* stream);
+void* __real_malloc   (size_t size);
+void* __real_calloc   (size_t n, size_t size);
+void* __real_realloc  (void* ptr, size_t size);
+void  __real_free     (void* ptr);
+
+int __wrap_vfprintf (FILE* stream, const char* format, va_list ap)
+{
+  int ret;
+  ALT_LIBC_LOCKED (ret = __real_vfprintf (stream, format, ap));
+  return ret;
+}
+
+int __wrap_vprintf (const char* format, va_list ap)
+{
+  return __wrap_vfprintf (stdout, format, ap);
+}
+
+int __wrap_fprintf (FILE* stream, const char* format, ...)
+{
+  va_list ap;
+  int     ret;
+
+  va_start (ap, format);
+  ret = __wrap_vfprintf (stream, format, ap);
+  va_end (ap);
+  return ret;
+}
+
+int __wrap_printf (const char* format, ...)
+{
+  va_list ap;
+  int     ret;
+
+  va_start (ap, format);
+  ret = __wrap_vfprintf (stdout, format, ap);
+  va_end (ap);
+  return ret;
+}
+
+int __wrap_fputs (const char* s, FILE* stream)
+{
+  int ret;
+  ALT_LIBC_LOCKED (ret = __real_fputs (s, stream));
+  return ret;
+}
+
+int __wrap_puts (const char* s)
+{
+  int ret;
+  ALT_LIBC_LOCKED (ret = __real_puts (s));
+  return ret;
+}
+
+int __wrap_fputc (int c, FILE* stream)
+{
+  int ret;
+  ALT_LIBC_LOCKED (ret = __real_fputc (c, stream));
+  return ret;
+}
+
+int __wrap_putchar (int c)
+{
+  int ret;
+  ALT_LIBC_LOCKED (ret = __real_putchar (c));
+  return ret;
+}
+
+int __wrap_fflush (FILE* stream)
+{
+  int ret;
+  ALT_LIBC_LOCKED (ret = __real_fflush (stream));
+  return ret;
+}
+
+size_t __wrap_fwrite (const void* ptr, size_t size, size_t n, FILE* stream)
+{
+  size_t ret;
+  ALT_LIBC_LOCKED (ret = __real_fwrite (ptr, size, n, stream));
+  return ret;
+}
+
+void* __wrap_malloc (size_t size)
+{
+  void* ret;
+#if ALT_SLAB_EN > 0
+  if ((ret = alt_slab_alloc (size)) != NULL)
+    return ret;
+#endif
+  ALT_LIBC_LOCKED (ret = __real_malloc (size));
+  return ret;
+}
+
+void* __wrap_calloc (size_t n, size_t size)
+{
+  void* ret;
+#if ALT_SLAB_EN > 0
+  if (size && n <= (size_t) -1 / size &&
+      (ret = alt_slab_alloc (n * size)) != NULL)
+  {
+    memset (ret, 0, n * size);
+    return ret;
+  }
+#endif
+  ALT_LIBC_LOCKED (ret = __real_calloc (n, size));
+  return ret;
+}
+
+void* __wrap_realloc (void* ptr, size_t size)
+{
+  void* ret;
+#if ALT_SLAB_EN > 0
+  if (alt_slab_size (ptr))
+    return alt_slab_realloc (ptr, size);
+#endif
+  ALT_LIBC_LOCKED (ret = __real_realloc (ptr, size));
+  return ret;
+}
+
+void __wrap_free (void* ptr)
+{
+#if ALT_SLAB_EN > 0
+  if (alt_slab_free (ptr))
+    return;
+#endif
+  ALT_LIBC_LOCKED (__real_free (ptr));
+}
@@ -0,0 +1,46 @@
+/******************************************************************************
+*                                                                             *
+* Host (POSIX) counterpart of alt_main.c.                                     *
+*                                                                             *
+* The application is linked with --wrap=main, so the C runtime enters here    *
+* and the system is brought up in the same order as on the board before the  *
+* application's own main() runs.                                              *
+*                                                                             *
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "sys/alt_irq.h"
+#include "sys/alt_sys_init.h"
+#include "os/alt_hooks.h"
+#include "alt_host.h"
+#include "alt_types.h"
+
+extern int __real_main (int argc, char** argv);
+
+int __wrap_main (int argc, char** argv)
+{
+  /* Initialize the interrupt controller. */
+  alt_irq_init (NULL);
+
+  /* Select real or virtual time, before any timer is programmed. */
+  alt_host_clock_init ();
+
+  /* Dump the kernel event trace on exit if ALT_HOST_TRACE is set. */
+  alt_host_trace_init ();
+
+  /* Initialize the operating system */
+  ALT_OS_INIT();
+
+  /* Initialize the device drivers/software components. */
+  alt_sys_init();
+
+  /* 
+   * The JTAG UART shows every character as soon as it is written; keep the
+   * same behaviour when stdout is redirected to a file or a pipe.
+   */
+  setvbuf (stdout, NULL, _IOLBF, 0);
+
+  return __real_main (argc, argv);
+}
@@ -0,0 +1,49 @@
+/******************************************************************************
+*                                                                             *
+* Host (POSIX) counterpart of the generated alt_sys_init.c.                   *
+*                                                                             *
+* The system clock timer and the key and switch PIOs are modelled; the other  *
+* PIOs are plain registers. The IRQ controller setup lives in                 *
+* alt_irq_entry.c; the JTAG UART is replaced by the host stdio.               *
+*                                                                             *
+******************************************************************************/
+
+#include "system.h"
+#include "sys/alt_irq.h"
+#include "sys/alt_sys_init.h"
+
+#include <stddef.h>
+
+/*
+ * Device headers
+ */
+
+#include "altera_avalon_timer.h"
+#include "altera_avalon_timer_host.h"
+#include "altera_avalon_pio_host.h"
+
+/*
+ * Allocate the device storage
+ */
+
+ALTERA_AVALON_TIMER_INSTANCE ( TIMER_0, timer_0);
+ALTERA_AVALON_TIMER_INSTANCE ( TIMER_1, timer_1);
+
+/*
+ * Initialize the non-interrupt controller devices.
+ * Called after alt_irq_init().
+ */
+
+void alt_sys_init( void )
+{
+    altera_avalon_timer_host_init ( TIMER_0_BASE, TIMER_0_IRQ, TIMER_0_FREQ,
+                                    TIMER_0_LOAD_VALUE);
+
+    /* The keys are low active and read high when released. */
+    ALTERA_AVALON_PIO_HOST_INIT ( D2_PIO_KEYS4, 0xf);
+    ALTERA_AVALON_PIO_HOST_INIT ( DE2_PIO_TOGGLES18, 0);
+    altera_avalon_pio_host_script ();
+
+    ALTERA_AVALON_TIMER_INIT ( TIMER_0, timer_0);
+    ALTERA_AVALON_TIMER_INIT ( TIMER_1, timer_1);
+}
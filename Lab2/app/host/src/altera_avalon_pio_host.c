@@ -0,0 +1,332 @@
+/******************************************************************************
+*                                                                             *
+* Host (POSIX) model of the Avalon PIO inputs.                                *
+*                                                                             *
+* The register map follows altera_avalon_pio_regs.h: data, direction, IRQ     *
+* mask and edge capture. The input pins only change when a script says so;    *
+* the edges selected in SOPC builder are then captured and the IRQ line is    *
+* raised while a captured edge is unmasked. Writes to the data register of    *
+* an input PIO are ignored, as on the board.                                  *
+*                                                                             *
+* ALT_HOST_PIO=<file> names the script. Each line sets the pins of one PIO    *
+* at a time given in milliseconds since start-up:                             *
+*                                                                             *
+*   # ms   PIO                value                                           *
+*   1000   D2_PIO_KEYS4       0x7     # gas pedal down, the keys are low      *
+*   1002   D2_PIO_KEYS4       0xf     # ... and bouncing                      *
+*   1004   D2_PIO_KEYS4       0x7                                             *
+*   2000   DE2_PIO_TOGGLES18  0x3     # engine on, top gear                   *
+*                                                                             *
+* The PIO is named as in system.h, with or without the "/dev/" prefix. The    *
+* lines must be in time order; anything after a '#' is a comment. With the    *
+* virtual clock the pins are set at that time (see alt_host_clock_watch()).   *
+* With the real clock they are set when the system clock timeout at or after  *
+* that time is delivered, i.e. with the resolution of one tick.               *
+*                                                                             *
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "sys/alt_irq.h"
+#include "altera_avalon_pio_regs.h"
+#include "altera_avalon_pio_host.h"
+#include "alt_host.h"
+#include "alt_types.h"
+
+#define ALTERA_AVALON_PIO_HOST_MAX    4
+#define ALTERA_AVALON_PIO_HOST_EVENTS 4096
+
+typedef struct
+{
+  alt_host_io_dev dev;
+  const char*     name;
+  alt_u32         irq;
+  alt_u32         width_mask;
+  alt_u32         rising;       /* edges captured, as bit masks        */
+  alt_u32         falling;
+  int             bit_clearing;
+  alt_u32         pins;
+  alt_u32         irq_mask;
+  alt_u32         edge_cap;
+} altera_avalon_pio_host;
+
+typedef struct
+{
+  alt_u64                 time;   /* ns */
+  altera_avalon_pio_host* pio;
+  alt_u32                 pins;
+} altera_avalon_pio_host_event;
+
+static altera_avalon_pio_host
+  altera_avalon_pio_host_devs[ALTERA_AVALON_PIO_HOST_MAX];
+static int altera_avalon_pio_host_count;
+
+/* the script, and the next event to apply */
+
+static altera_avalon_pio_host_event
+  altera_avalon_pio_host_events[ALTERA_AVALON_PIO_HOST_EVENTS];
+static int altera_avalon_pio_host_nevents;
+static int altera_avalon_pio_host_next;
+
+/*
+ * Level of the IRQ line; called with interrupts disabled.
+ */
+
+static int altera_avalon_pio_host_irq (altera_avalon_pio_host* pio)
+{
+  if (pio->edge_cap & pio->irq_mask)
+  {
+    alt_irq_ipending |= (1 << pio->irq);
+    return 1;
+  }
+
+  alt_irq_ipending &= ~(1 << pio->irq);
+  return 0;
+}
+
+static alt_u32 altera_avalon_pio_host_read (alt_host_io_dev* dev,
+                                            alt_u32 offset)
+{
+  altera_avalon_pio_host* pio = (altera_avalon_pio_host*) dev;
+
+  switch (offset / 4)
+  {
+  case 0:
+    return pio->pins;
+  case 2:
+    return pio->irq_mask;
+  case 3:
+    return pio->edge_cap;
+  default:
+    return 0;
+  }
+}
+
+static void altera_avalon_pio_host_write (alt_host_io_dev* dev,
+                                          alt_u32 offset, alt_u32 data)
+{
+  altera_avalon_pio_host* pio = (altera_avalon_pio_host*) dev;
+  alt_irq_context         context;
+  int                     level;
+
+  context = alt_irq_disable_all ();
+
+  switch (offset / 4)
+  {
+  case 2:
+    pio->irq_mask = data & pio->width_mask;
+    break;
+  case 3:
+    /* without the bit clearing option any write clears every bit */
+    pio->edge_cap = pio->bit_clearing ? pio->edge_cap & ~data : 0;
+    break;
+  default:
+    break;
+  }
+
+  level = altera_avalon_pio_host_irq (pio);
+
+  alt_irq_enable_all (context);
+
+  if (level)
+  {
+    alt_host_irq_raise (pio->irq);
+  }
+}
+
+/*
+ * Clock watch: set the pins of every event that is due, in interrupt
+ * context, and return the time of the next one. The interrupt entry
+ * dispatches the raised lines right after.
+ */
+
+static alt_u64 altera_avalon_pio_host_watch (alt_u64 now)
+{
+  altera_avalon_pio_host_event* event;
+  altera_avalon_pio_host*       pio;
+  alt_u32                       changed;
+
+  while (altera_avalon_pio_host_next < altera_avalon_pio_host_nevents)
+  {
+    event = &altera_avalon_pio_host_events[altera_avalon_pio_host_next];
+    if (event->time > now)
+    {
+      break;
+    }
+
+    pio     = event->pio;
+    changed = pio->pins ^ event->pins;
+
+    pio->edge_cap |= (changed & event->pins & pio->rising) |
+                     (changed & ~event->pins & pio->falling);
+    pio->pins      = event->pins;
+    altera_avalon_pio_host_irq (pio);
+
+    altera_avalon_pio_host_next++;
+  }
+
+  if (altera_avalon_pio_host_next < altera_avalon_pio_host_nevents)
+  {
+    return altera_avalon_pio_host_events[altera_avalon_pio_host_next].time;
+  }
+
+  return 0;
+}
+
+static altera_avalon_pio_host* altera_avalon_pio_host_find (const char* name)
+{
+  const char* dev;
+  int         i;
+
+  if (!strncmp (name, "/dev/", 5))
+  {
+    name += 5;
+  }
+
+  for (i = 0; i < altera_avalon_pio_host_count; i++)
+  {
+    dev = altera_avalon_pio_host_devs[i].name;
+    if (!strncmp (dev, "/dev/", 5))
+    {
+      dev += 5;
+    }
+    if (!strcasecmp (dev, name))
+    {
+      return &altera_avalon_pio_host_devs[i];
+    }
+  }
+
+  return NULL;
+}
+
+/*
+ * Attach a model to the registers of the PIO at 'base'.
+ */
+
+void altera_avalon_pio_host_init (const char* name, alt_u32 base,
+                                  alt_u32 irq, alt_u32 width,
+                                  const char* edge_type, int bit_clearing,
+                                  alt_u32 pins)
+{
+  altera_avalon_pio_host* pio;
+
+  if (altera_avalon_pio_host_count == ALTERA_AVALON_PIO_HOST_MAX)
+  {
+    fprintf (stderr, "altera_avalon_pio_host: too many PIOs\n");
+    abort ();
+  }
+
+  pio = &altera_avalon_pio_host_devs[altera_avalon_pio_host_count++];
+
+  pio->dev.base     = base;
+  pio->dev.span     = 6 * 4;
+  pio->dev.read     = altera_avalon_pio_host_read;
+  pio->dev.write    = altera_avalon_pio_host_write;
+  pio->name         = name;
+  pio->irq          = irq;
+  pio->width_mask   = (width < 32) ? (1u << width) - 1 : 0xffffffff;
+  pio->bit_clearing = bit_clearing;
+  pio->pins         = pins & pio->width_mask;
+
+  if (!strcmp (edge_type, "RISING") || !strcmp (edge_type, "ANY"))
+  {
+    pio->rising = pio->width_mask;
+  }
+  if (!strcmp (edge_type, "FALLING") || !strcmp (edge_type, "ANY"))
+  {
+    pio->falling = pio->width_mask;
+  }
+
+  alt_host_io_register (&pio->dev);
+}
+
+/*
+ * Load the script named by ALT_HOST_PIO, once the PIOs are attached.
+ */
+
+void altera_avalon_pio_host_script (void)
+{
+  const char*                   path = getenv ("ALT_HOST_PIO");
+  altera_avalon_pio_host_event* event;
+  FILE*                         file;
+  char                          line[256];
+  char                          name[64];
+  double                        ms;
+  long                          pins;
+  alt_u64                       last = 0;
+  int                           n    = 0;
+  char*                         comment;
+
+  if (!path)
+  {
+    return;
+  }
+
+  file = fopen (path, "r");
+  if (!file)
+  {
+    perror (path);
+    exit (1);
+  }
+
+  while (fgets (line, sizeof (line), file))
+  {
+    n++;
+    if ((comment = strchr (line, '#')) != NULL)
+    {
+      *comment = '\0';
+    }
+    if (strspn (line, " \t\r\n") == strlen (line))
+    {
+      continue;
+    }
+
+    if (altera_avalon_pio_host_nevents == ALTERA_AVALON_PIO_HOST_EVENTS)
+    {
+      fprintf (stderr, "%s:%d: more than %d events\n", path, n,
+               ALTERA_AVALON_PIO_HOST_EVENTS);
+      exit (1);
+    }
+    event = &altera_avalon_pio_host_events[altera_avalon_pio_host_nevents++];
+
+    if (sscanf (line, "%lf %63s %li", &ms, name, &pins) != 3 ||
+        ms < 0)
+    {
+      fprintf (stderr, "%s:%d: expected '<ms> <PIO> <value>'\n", path, n);
+      exit (1);
+    }
+    if ((event->pio = altera_avalon_pio_host_find (name)) == NULL)
+    {
+      fprintf (stderr, "%s:%d: no PIO model named '%s'\n", path, n, name);
+      exit (1);
+    }
+    /* round to the ns, as e.g. 37.1 ms has no exact binary value */
+    event->time = (alt_u64) (ms * 1e6 + 0.5);
+    event->pins = pins & event->pio->width_mask;
+    if (event->time < last)
+    {
+      fprintf (stderr, "%s:%d: time goes backwards\n", path, n);
+      exit (1);
+    }
+    last = event->time;
+  }
+
+  fclose (file);
+
+  /* the events at time 0 are applied with the first timeout */
+
+  for (n = 0; n < altera_avalon_pio_host_nevents; n++)
+  {
+    if (altera_avalon_pio_host_events[n].time)
+    {
+      break;
+    }
+  }
+
+  alt_host_clock_watch (altera_avalon_pio_host_watch,
+                        n < altera_avalon_pio_host_nevents ?
+                          altera_avalon_pio_host_events[n].time : 0);
+}
@@ -0,0 +1,212 @@
+/******************************************************************************
+*                                                                             *
+* Host (POSIX) model of the Avalon interval timer used as system clock.       *
+*                                                                             *
+* The register map follows altera_avalon_timer_regs.h, so the unmodified      *
+* altera_avalon_timer_sc.c driver programs it. A running counter is mapped    *
+* onto the timeout of the host clock (alt_host_clock.c); its expiry sets      *
+* status.TO and raises the IRQ line while control.ITO is set.                 *
+*                                                                             *
+* Writing a period register stops the counter. The start that follows takes  *
+* ALT_HOST_TIMER_RESTART_CYCLES of host clock time, which the counter does    *
+* not count, as the cycles the Nios II spends from the snapshot before the    *
+* restart to the start. By default that is what the driver allows for.       *
+*                                                                             *
+******************************************************************************/
+
+#include <signal.h>
+#include <stddef.h>
+
+#include "system.h"
+#include "sys/alt_irq.h"
+#include "altera_avalon_timer.h"
+#include "altera_avalon_timer_regs.h"
+#include "altera_avalon_timer_host.h"
+#include "alt_host.h"
+#include "alt_types.h"
+
+#ifndef ALT_HOST_TIMER_RESTART_CYCLES
+#define ALT_HOST_TIMER_RESTART_CYCLES ALT_AVALON_TIMER_SC_RESTART_CYCLES
+#endif
+
+typedef struct
+{
+  alt_host_io_dev dev;
+  alt_u32         irq;
+  alt_u32         freq;
+  alt_u32         status;
+  alt_u32         control;
+  alt_u32         period;
+  alt_u32         snap;
+  int             restart;    /* the period was written since the start */
+} altera_avalon_timer_host;
+
+static altera_avalon_timer_host altera_avalon_timer_host_sc;
+
+static void altera_avalon_timer_host_timeout (void)
+{
+  altera_avalon_timer_host* timer = &altera_avalon_timer_host_sc;
+
+  timer->status |= ALTERA_AVALON_TIMER_STATUS_TO_MSK;
+
+  if (!(timer->control & ALTERA_AVALON_TIMER_CONTROL_CONT_MSK))
+  {
+    timer->status &= ~ALTERA_AVALON_TIMER_STATUS_RUN_MSK;
+  }
+
+  if (timer->control & ALTERA_AVALON_TIMER_CONTROL_ITO_MSK)
+  {
+    alt_irq_ipending |= (1 << timer->irq);
+  }
+}
+
+static alt_u64 altera_avalon_timer_host_ns (altera_avalon_timer_host* timer,
+                                           alt_u32 cycles)
+{
+  return ((alt_u64) cycles * 1000000000u) / timer->freq;
+}
+
+static void altera_avalon_timer_host_arm (altera_avalon_timer_host* timer,
+                                          alt_u32 cycles, int continuous)
+{
+  alt_u64 ns = altera_avalon_timer_host_ns (timer, cycles);
+
+  if (cycles && ns == 0)
+  {
+    ns = 1;
+  }
+
+  alt_host_clock_arm (ns, continuous ? ns : 0,
+                      altera_avalon_timer_host_timeout);
+}
+
+/*
+ * Number of clock cycles left until the next timeout of a running counter.
+ */
+
+static alt_u32 altera_avalon_timer_host_remaining (altera_avalon_timer_host* timer)
+{
+  return (alt_u32) (alt_host_clock_remaining () * timer->freq / 1000000000u);
+}
+
+static void altera_avalon_timer_host_stop (altera_avalon_timer_host* timer)
+{
+  altera_avalon_timer_host_arm (timer, 0, 0);
+  timer->status &= ~ALTERA_AVALON_TIMER_STATUS_RUN_MSK;
+}
+
+static void altera_avalon_timer_host_start (altera_avalon_timer_host* timer)
+{
+  if (timer->restart)
+  {
+    alt_host_clock_spend (altera_avalon_timer_host_ns (timer, 
+                                         ALT_HOST_TIMER_RESTART_CYCLES));
+    timer->restart = 0;
+  }
+
+  altera_avalon_timer_host_arm (timer, timer->period + 1,
+                                timer->control & ALTERA_AVALON_TIMER_CONTROL_CONT_MSK);
+  timer->status |= ALTERA_AVALON_TIMER_STATUS_RUN_MSK;
+}
+
+static alt_u32 altera_avalon_timer_host_read (alt_host_io_dev* dev,
+                                              alt_u32 offset)
+{
+  altera_avalon_timer_host* timer = (altera_avalon_timer_host*) dev;
+
+  switch (offset / 4)
+  {
+  case ALTERA_AVALON_TIMER_STATUS_REG:
+    return timer->status;
+  case ALTERA_AVALON_TIMER_CONTROL_REG:
+    return timer->control;
+  case ALTERA_AVALON_TIMER_PERIODL_REG:
+    return timer->period & ALTERA_AVALON_TIMER_PERIODL_MSK;
+  case ALTERA_AVALON_TIMER_PERIODH_REG:
+    return (timer->period >> 16) & ALTERA_AVALON_TIMER_PERIODH_MSK;
+  case ALTERA_AVALON_TIMER_SNAPL_REG:
+    return timer->snap & ALTERA_AVALON_TIMER_SNAPL_MSK;
+  case ALTERA_AVALON_TIMER_SNAPH_REG:
+    return (timer->snap >> 16) & ALTERA_AVALON_TIMER_SNAPH_MSK;
+  default:
+    return 0;
+  }
+}
+
+static void altera_avalon_timer_host_write (alt_host_io_dev* dev,
+                                            alt_u32 offset, alt_u32 data)
+{
+  altera_avalon_timer_host* timer = (altera_avalon_timer_host*) dev;
+  alt_irq_context           context;
+
+  context = alt_irq_disable_all ();
+
+  switch (offset / 4)
+  {
+  case ALTERA_AVALON_TIMER_STATUS_REG:
+    /* any write clears the timeout bit, and with it the interrupt */
+    timer->status &= ~ALTERA_AVALON_TIMER_STATUS_TO_MSK;
+    alt_irq_ipending &= ~(1 << timer->irq);
+    break;
+  case ALTERA_AVALON_TIMER_CONTROL_REG:
+    timer->control = data & (ALTERA_AVALON_TIMER_CONTROL_ITO_MSK |
+                             ALTERA_AVALON_TIMER_CONTROL_CONT_MSK);
+    if (data & ALTERA_AVALON_TIMER_CONTROL_STOP_MSK)
+    {
+      altera_avalon_timer_host_stop (timer);
+    }
+    else if (data & ALTERA_AVALON_TIMER_CONTROL_START_MSK)
+    {
+      altera_avalon_timer_host_start (timer);
+    }
+    break;
+  case ALTERA_AVALON_TIMER_PERIODL_REG:
+    /* writing a period register stops the counter */
+    timer->period = (timer->period & 0xffff0000) | 
+                    (data & ALTERA_AVALON_TIMER_PERIODL_MSK);
+    timer->restart = 1;
+    altera_avalon_timer_host_stop (timer);
+    break;
+  case ALTERA_AVALON_TIMER_PERIODH_REG:
+    timer->period = (timer->period & 0x0000ffff) | 
+                    ((data & ALTERA_AVALON_TIMER_PERIODH_MSK) << 16);
+    timer->restart = 1;
+    altera_avalon_timer_host_stop (timer);
+    break;
+  case ALTERA_AVALON_TIMER_SNAPL_REG:
+  case ALTERA_AVALON_TIMER_SNAPH_REG:
+    /* the counter reads one less than the cycles left until it times out */
+    timer->snap = timer->period;
+    if (timer->status & ALTERA_AVALON_TIMER_STATUS_RUN_MSK)
+    {
+      timer->snap = altera_avalon_timer_host_remaining (timer);
+      timer->snap = timer->snap ? timer->snap - 1 : 0;
+    }
+    break;
+  default:
+    break;
+  }
+
+  alt_irq_enable_all (context);
+}
+
+/*
+ * Attach the model to the registers of the timer at 'base'. The period
+ * registers come out of reset holding the load value chosen in SOPC builder.
+ */
+
+void altera_avalon_timer_host_init (alt_u32 base, alt_u32 irq, alt_u32 freq,
+                                    alt_u32 load_value)
+{
+  altera_avalon_timer_host* timer = &altera_avalon_timer_host_sc;
+
+  timer->dev.base  = base;
+  timer->dev.span  = 6 * 4;
+  timer->dev.read  = altera_avalon_timer_host_read;
+  timer->dev.write = altera_avalon_timer_host_write;
+  timer->irq       = irq;
+  timer->freq      = freq;
+  timer->period    = load_value;
+
+  alt_host_io_register (&timer->dev);
+}
@@ -0,0 +1,410 @@
+/***********************************************************************************************
+ *                                               uC/OS-II
+ *                                         The Real-Time Kernel
+ * File         : os_cpu_c.c
+ * For          : uC/OS Real-time multitasking kernel, POSIX (ucontext) host port
+ * Based on     : the Nios2 port (os_cpu_c.c/os_cpu_a.S) done by IS
+ *
+ * Functions defined in this module:
+ *
+ *   OSTaskStkInit(), OSCtxSw(), OSIntCtxSw(), OSStartHighRdy() and the CPU hooks.
+ *
+ * Every task runs on its own host stack, described by an OS_HOST_CTX. The OS_STK array given
+ * to OSTaskCreate() is not used, and OSTCBStkPtr points to the OS_HOST_CTX instead of to a
+ * saved register frame. For tasks created with OS_TASK_OPT_STK_CHK, OSTaskCreateHook() points
+ * the stack of the TCB at the host stack instead, so that OSTaskStkChk() measures what the
+ * task really uses, in 32 bit words of x86-64 frames, signal frames of interrupts included.
+ * Interrupts are disabled whenever the kernel switches, so both the task level and the
+ * interrupt level switch reduce to a swapcontext() between the two saved contexts.
+ ***********************************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <ucontext.h>
+
+#define  OS_CPU_GLOBALS
+#include "includes.h"                   /* Standard includes for uC/OS-II */
+
+#include "system.h"
+
+#if OS_TICKLESS_EN > 0
+#include "altera_avalon_timer.h"
+#endif
+#include "alt_host.h"
+
+typedef struct os_host_ctx {
+    ucontext_t           uc;            /* Saved host context of the task                     */
+    struct os_host_ctx  *next;          /* Link in the list of recycled contexts              */
+    void               (*task)(void *pd);
+    void                *pdata;
+    char                 stk[ALT_HOST_TASK_STK_SIZE];
+} OS_HOST_CTX;
+
+static OS_HOST_CTX *OSHostCtxFreeList;  /* Contexts of deleted tasks, ready for reuse         */
+
+#if OS_TMR_EN > 0
+static  INT16U  OSTmrCtr;
+#endif
+
+/***********************************************************************************************
+ *                                    CALL THE TASK INITILISATION FUNCTION
+ *
+ * Description: Entry point of every task context. As in the Nios2 port, interrupts are enabled
+ *              before the task is called; a task that returns is deleted.
+ ***********************************************************************************************/
+
+static void OSStartTsk (void)
+{
+    OS_HOST_CTX *ctx = (OS_HOST_CTX *)OSTCBCur->OSTCBStkPtr;
+
+    alt_irq_cpu_enable_interrupts();
+    ctx->task(ctx->pdata);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+/***********************************************************************************************
+ *                                        INITIALIZE A TASK'S STACK
+ *
+ * Description: This function is called by either OSTaskCreate() or OSTaskCreateExt() to
+ *              initialize the context of the task being created.
+ *
+ * Arguments  : task          is a pointer to the task code
+ *
+ *              pdata         is a pointer to a user supplied data area that will be passed to the task
+ *                            when the task first executes.
+ *
+ *              ptos          is a pointer to the top of stack. Only the initial frame is written
+ *                            there; the task executes on its host stack.
+ *
+ *              opt           specifies options that can be used to alter the behavior of OSTaskStkInit().
+ *                            (see uCOS_II.H for OS_TASK_OPT_???).
+ *
+ * Returns    : A pointer to the host context of the task, which the kernel stores in OSTCBStkPtr.
+ *              NULL is returned when no host stack could be allocated.
+ ***********************************************************************************************/
+
+OS_STK *OSTaskStkInit(void (*task)(void *pd), void *pdata, OS_STK *pstk, INT16U opt)
+{
+    OS_HOST_CTX  *ctx;
+    INT32U       *stk;
+
+    /*
+     * Lay down the same 13 word frame as the Nios2 port at the top of the OS_STK array, so
+     * that the array looks as it does on the board.
+     */
+    stk     = (INT32U *)pstk - 13;
+    stk[12] = (INT32U)(unsigned long)task;            /* task address (ra)                    */
+    stk[11] = (INT32U)(unsigned long)pdata;           /* first register argument (r4)         */
+    stk[0]  = (INT32U)(unsigned long)OSStartTsk;      /* exception return address (ea)        */
+
+    ctx = OSHostCtxFreeList;
+    if (ctx != (OS_HOST_CTX *)0) {
+        OSHostCtxFreeList = ctx->next;
+        if (opt & OS_TASK_OPT_STK_CHK) {            /* Stack checking counts the zero words   */
+            memset(ctx->stk, 0, sizeof(ctx->stk));
+        }
+    } else {
+        ctx = (OS_HOST_CTX *)calloc(1, sizeof(OS_HOST_CTX));
+        if (ctx == (OS_HOST_CTX *)0) {
+            return ((OS_STK *)0);
+        }
+    }
+
+    ctx->next  = (OS_HOST_CTX *)0;
+    ctx->task  = task;
+    ctx->pdata = pdata;
+
+    getcontext(&ctx->uc);
+    ctx->uc.uc_stack.ss_sp   = ctx->stk;
+    ctx->uc.uc_stack.ss_size = sizeof(ctx->stk);
+    ctx->uc.uc_link          = (ucontext_t *)0;
+    sigdelset(&ctx->uc.uc_sigmask, SIGALRM);        /* Not inherited from a signal handler    */
+    sigdelset(&ctx->uc.uc_sigmask, SIGUSR1);
+    makecontext(&ctx->uc, OSStartTsk, 0);
+
+    return ((OS_STK *)ctx);
+}
+
+/*********************************************************************************************************
+ *                                PERFORM A CONTEXT SWITCH
+ *                                           void OSCtxSw(void)    - from task level
+ *                                           void OSIntCtxSw(void) - from interrupt level
+ *
+ * Note(s): 1) Upon entry, 
+ *             OSTCBCur     points to the OS_TCB of the task to suspend
+ *             OSTCBHighRdy points to the OS_TCB of the task to resume
+ *
+ *          2) At interrupt level this runs inside the signal handler, on the stack of the preempted
+ *             task. The handler returns when that task is resumed.
+ *********************************************************************************************************/
+
+void OSCtxSw (void)
+{
+    OS_HOST_CTX  *from = (OS_HOST_CTX *)OSTCBCur->OSTCBStkPtr;
+    OS_HOST_CTX  *to;
+
+    OSTaskSwHook();
+
+    OSTCBCur  = OSTCBHighRdy;
+    OSPrioCur = OSPrioHighRdy;
+
+    to = (OS_HOST_CTX *)OSTCBHighRdy->OSTCBStkPtr;
+    swapcontext(&from->uc, &to->uc);
+}
+
+void OSIntCtxSw (void)
+{
+    OSCtxSw();
+}
+
+/*********************************************************************************************************
+ *                                        START THE HIGHEST PRIORITY TASK
+ *                                           void OSStartHighRdy(void)
+ *
+ * Note(s): 1) The context of the caller (main) is abandoned, just as the Nios2 port abandons the
+ *             stack it was called on.
+ *********************************************************************************************************/
+
+void OSStartHighRdy (void)
+{
+    alt_irq_disable_all();              /* OSStartTsk() enables interrupts again                  */
+
+    OSTaskSwHook();
+
+    OSRunning = OS_TRUE;
+    OSTCBCur  = OSTCBHighRdy;
+    OSPrioCur = OSPrioHighRdy;
+
+    setcontext(&((OS_HOST_CTX *)OSTCBHighRdy->OSTCBStkPtr)->uc);
+}
+
+#if OS_CPU_HOOKS_EN
+/*
+*********************************************************************************************************
+*                                          TASK CREATION HOOK
+*
+* Description: This function is called when a task is created. With OS_TASK_OPT_STK_CHK, the stack of
+*              the TCB is pointed at the host stack of the task, which OSTaskStkInit() cleared.
+*
+* Arguments  : ptcb   is a pointer to the task control block of the task being created.
+*
+* Note(s)    : 1) Interrupts are disabled during this call.
+*********************************************************************************************************
+*/
+void OSTaskCreateHook (OS_TCB *ptcb)
+{
+    OS_HOST_CTX  *ctx = (OS_HOST_CTX *)ptcb->OSTCBStkPtr;
+
+    if (ptcb->OSTCBOpt & OS_TASK_OPT_STK_CHK) {
+        ptcb->OSTCBStkBottom = (OS_STK *)ctx->stk;
+        ptcb->OSTCBStkSize   = sizeof(ctx->stk) / sizeof(OS_STK);
+    }
+}
+
+
+/*
+*********************************************************************************************************
+*                                           TASK DELETION HOOK
+*
+* Description: This function is called when a task is deleted. The host context of the task is put
+*              on the free list; a task deleting itself keeps running on it until it switches out,
+*              which happens before any other task can create a new one.
+*
+* Arguments  : ptcb   is a pointer to the task control block of the task being deleted.
+*
+* Note(s)    : 1) Interrupts are disabled during this call.
+*********************************************************************************************************
+*/
+void OSTaskDelHook (OS_TCB *ptcb)
+{
+    OS_HOST_CTX  *ctx = (OS_HOST_CTX *)ptcb->OSTCBStkPtr;
+
+    ctx->next         = OSHostCtxFreeList;
+    OSHostCtxFreeList = ctx;
+}
+
+/*
+*********************************************************************************************************
+*                                           TASK SWITCH HOOK
+*
+* Description: This function is called when a task switch is performed.  This allows you to perform other
+*              operations during a context switch.
+*
+* Arguments  : none
+*
+* Note(s)    : 1) Interrupts are disabled during this call.
+*              2) It is assumed that the global pointer 'OSTCBHighRdy' points to the TCB of the task that
+*                 will be 'switched in' (i.e. the highest priority task) and, 'OSTCBCur' points to the
+*                 task being switched out (i.e. the preempted task).
+*********************************************************************************************************
+*/
+void OSTaskSwHook (void)
+{
+#if OS_TASK_PROFILE_EN > 0
+    INT32U  cycles;
+#endif
+
+#if OS_TICKLESS_EN > 0
+    if (OSTCBCur->OSTCBPrio == OS_TASK_IDLE_PRIO) {  /* Account for the ticks held off while idle */
+        alt_avalon_timer_sc_wake();
+    }
+#endif
+
+#if OS_TASK_PROFILE_EN > 0
+    cycles = OSCPUCyclesGet();
+    if (OSRunning == OS_TRUE) {                      /* Not when the first task is started         */
+        OSTCBCur->OSTCBCyclesTot += cycles - OSTCBCur->OSTCBCyclesStart;
+    }
+    OSTCBHighRdy->OSTCBCyclesStart = cycles;
+#endif
+}
+
+/*
+*********************************************************************************************************
+*                                           STATISTIC TASK HOOK
+*
+* Description: This function is called every second by uC/OS-II's statistics task.  This allows your
+*              application to add functionality to the statistics task.
+*
+* Arguments  : none
+*********************************************************************************************************
+*/
+void OSTaskStatHook (void)
+{
+}
+
+#if OS_TASK_PROFILE_EN > 0
+/*
+*********************************************************************************************************
+*                                            CPU CYCLE COUNTER
+*
+* Description: OSCPUCyclesGet() returns a free running 32 bit cycle count, used by OSTaskSwHook() to
+*              accumulate the cycles each task runs for in OSTCBCyclesTot, and OSCPUCyclesFreq() the
+*              number of those cycles per second.  On the host the count is the host clock (real or
+*              virtual time, see alt_host_clock.c) in cycles of a CPU running at ALT_CPU_FREQ, so that
+*              the counts have the same scale as on the board.
+*
+* Arguments  : none
+*********************************************************************************************************
+*/
+INT32U OSCPUCyclesGet (void)
+{
+    return ((INT32U)(alt_host_clock_now() / (1000000000u / ALT_CPU_FREQ)));
+}
+
+INT32U OSCPUCyclesFreq (void)
+{
+    return (ALT_CPU_FREQ);
+}
+#endif
+
+/*
+*********************************************************************************************************
+*                                               TICK HOOK
+*
+* Description: This function is called every tick.
+*
+* Arguments  : none
+*
+* Note(s)    : 1) Interrupts may or may not be ENABLED during this call.
+*********************************************************************************************************
+*/
+void OSTimeTickHook (void)
+{
+#if OS_TMR_EN > 0
+    OSTmrCtr++;
+    if (OSTmrCtr >= (OS_TICKS_PER_SEC / OS_TMR_CFG_TICKS_PER_SEC)) {
+        OSTmrCtr = 0;
+        OSTmrSignal();
+    }
+#endif  
+}
+
+/*
+*********************************************************************************************************
+*                                         TICKLESS IDLE HOOKS
+*
+* Description: OSTimeTickNextHook() returns the number of ticks until OSTimeTickHook() has work to do,
+*              that is until it signals a timer that expires.  OSTimeTickSkipHook() is called for ticks
+*              that passed without calling OSTimeTickHook().  See OSTimeTickNext() and OSTimeTickSkip().
+*
+*              OSTimeTickSyncHook() is called on interrupt entry (see os/alt_hooks.h), and OSTimeTickRearmHook()
+*              when an alarm or a timer has been started.  They let the system clock account for the ticks of
+*              an idle period that have passed, and bring its interrupt forward to a new first expiry.
+*
+* Note(s)    : 1) Interrupts are disabled during the calls to OSTimeTickNextHook() and OSTimeTickSkipHook().
+*********************************************************************************************************
+*/
+#if OS_TICKLESS_EN > 0
+INT32U OSTimeTickNextHook (void)
+{
+#if OS_TMR_EN > 0
+    INT32U  signals;
+    INT32U  period = OS_TICKS_PER_SEC / OS_TMR_CFG_TICKS_PER_SEC;
+#endif
+
+#if OS_TMR_EN > 0
+    signals = OSTmrSignalNext();
+    if (signals > (0xFFFFFFFFL - period) / period) {
+        return (0xFFFFFFFFL);
+    }
+    return ((period - OSTmrCtr) + (signals - 1) * period);
+#else
+    return (0xFFFFFFFFL);
+#endif
+}
+
+void OSTimeTickSkipHook (INT32U ticks)
+{
+#if OS_TMR_EN > 0
+    INT32U  period = OS_TICKS_PER_SEC / OS_TMR_CFG_TICKS_PER_SEC;
+
+
+    ticks   += OSTmrCtr;
+    OSTmrSignalSkip(ticks / period);   /* None of the signals left out expires a timer             */
+    OSTmrCtr = (INT16U)(ticks % period);
+#else
+    ticks = ticks;                     /* Prevent compiler warning                                 */
+#endif
+}
+
+void OSTimeTickSyncHook (void)
+{
+    alt_avalon_timer_sc_sync();
+}
+
+void OSTimeTickRearmHook (void)
+{
+    alt_avalon_timer_sc_rearm();
+}
+#endif
+
+void OSInitHookBegin(void)
+{
+#if OS_TMR_EN > 0
+    OSTmrCtr = 0;
+#endif
+}
+
+void OSInitHookEnd(void)
+{
+}
+
+/*
+ * With OS_TICKLESS_EN the system clock is first told to hold off its interrupt up to the next tick
+ * that has work to do. In virtual time mode the idle task then hands the CPU to the host clock,
+ * which moves on to the next timeout (see alt_host_clock.c).
+ */
+void OSTaskIdleHook(void)
+{
+#if OS_TICKLESS_EN > 0
+    alt_avalon_timer_sc_idle();
+#endif
+    alt_host_clock_idle();
+}
+
+void OSTCBInitHook(OS_TCB *ptcb)
+{
+}
+
+#endif
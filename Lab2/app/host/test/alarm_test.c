@@ -0,0 +1,146 @@
+/* Alarm started by an interrupt handler while every task is delayed
+ *
+ * Description:
+ *
+ *   Registers an ISR for the keys and drives them through
+ *   test/alarm_test.pio while the only task sleeps for END_MS. Each key
+ *   press records the tick the ISR sees and starts an alt_alarm of
+ *   ALARM_TICKS ticks, whose callback records the tick it runs at. The
+ *   test then checks that the ISR saw the time of the press in the
+ *   script, and that the callback ran ALARM_TICKS + 1 ticks later, as
+ *   alt_alarm_start() promises.
+ *
+ *   With the tickless kernel (bin/alarm_test_tickless) the tick interrupt
+ *   is held off until the task wakes up, so this checks that the ISR sees
+ *   the ticks of the idle period that have passed, and that the alarm
+ *   brings the next tick interrupt forward. It prints one line per press
+ *   and per failed check, and exits with 1 if a check failed. Run it in
+ *   virtual time with the script, as 'make test' does:
+ *
+ *     ALT_HOST_CLOCK=virtual ALT_HOST_PIO=test/alarm_test.pio \
+ *       bin/alarm_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "includes.h"
+#include "system.h"
+#include "altera_avalon_pio_regs.h"
+#include "sys/alt_alarm.h"
+#include "sys/alt_irq.h"
+
+#define   TASK_STACKSIZE       2048
+#define   CHECK_PRIO           5
+
+#define   END_MS               1000  /* after the last line of the script */
+#define   ALARM_TICKS          20
+#define   MAX_PRESSES          8
+
+/* The presses in the script, in ms */
+static const INT32U expected[] = { 100, 250, 600 };
+
+#define   EXPECTED             (sizeof(expected) / sizeof(expected[0]))
+
+typedef struct
+{
+  alt_alarm alarm;
+  INT32U    isr_tick;         /* tick seen by the ISR */
+  INT32U    alarm_tick;       /* tick the alarm ran at, 0 if it did not */
+} press;
+
+OS_STK    check_stk[TASK_STACKSIZE];
+
+static press presses[MAX_PRESSES];
+static int npresses;
+
+static alt_u32 alarmCallback(void* context)
+{
+  press* p = context;
+
+  p->alarm_tick = alt_nticks();
+  return 0;
+}
+
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+static void keysIsr(void* context)
+#else
+static void keysIsr(void* context, alt_u32 id)
+#endif
+{
+  press* p;
+
+  IOWR_ALTERA_AVALON_PIO_EDGE_CAP(D2_PIO_KEYS4_BASE, 0xf);
+
+  if (npresses < MAX_PRESSES)
+    {
+      p = &presses[npresses];
+      p->isr_tick = alt_nticks();
+      p->alarm_tick = 0;
+      alt_alarm_start(&p->alarm, ALARM_TICKS, alarmCallback, p);
+    }
+  npresses++;
+}
+
+void checkTask(void* pdata)
+{
+  INT32U tick;
+  int failed = 0;
+  int i;
+
+  OSTimeDly(alt_ticks_per_second() * END_MS / 1000);
+
+  for (i = 0; i < npresses && i < MAX_PRESSES; i++)
+    printf("press,%lu,%lu\n", (unsigned long)presses[i].isr_tick,
+	   (unsigned long)presses[i].alarm_tick);
+
+  if (npresses != EXPECTED)
+    {
+      printf("FAIL: %d presses, expected %d\n", npresses, (int)EXPECTED);
+      failed = 1;
+    }
+
+  for (i = 0; i < npresses && i < (int)EXPECTED; i++)
+    {
+      tick = alt_ticks_per_second() * expected[i] / 1000;
+      if (presses[i].isr_tick != tick)
+	{
+	  printf("FAIL: press %d seen at tick %lu, expected %lu\n", i,
+		 (unsigned long)presses[i].isr_tick, (unsigned long)tick);
+	  failed = 1;
+	}
+      if (presses[i].alarm_tick != presses[i].isr_tick + ALARM_TICKS + 1)
+	{
+	  printf("FAIL: alarm %d ran at tick %lu, expected %lu\n", i,
+		 (unsigned long)presses[i].alarm_tick,
+		 (unsigned long)(presses[i].isr_tick + ALARM_TICKS + 1));
+	  failed = 1;
+	}
+    }
+
+  printf("%s\n", failed ? "FAIL" : "PASS");
+  exit(failed);
+}
+
+int main(void)
+{
+  IOWR_ALTERA_AVALON_PIO_EDGE_CAP(D2_PIO_KEYS4_BASE, 0xf);
+  IOWR_ALTERA_AVALON_PIO_IRQ_MASK(D2_PIO_KEYS4_BASE, 0xf);
+
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+  if (alt_ic_isr_register(D2_PIO_KEYS4_IRQ_INTERRUPT_CONTROLLER_ID,
+			  D2_PIO_KEYS4_IRQ, keysIsr, NULL, NULL) < 0)
+#else
+  if (alt_irq_register(D2_PIO_KEYS4_IRQ, NULL, keysIsr) < 0)
+#endif
+    {
+      printf("FAIL: alt_ic_isr_register\n");
+      return 1;
+    }
+
+  OSTaskCreateExt(checkTask, NULL, &check_stk[TASK_STACKSIZE-1],
+		  CHECK_PRIO, CHECK_PRIO, &check_stk[0], TASK_STACKSIZE,
+		  NULL, 0);
+
+  OSStart();
+  return 1;
+}
@@ -0,0 +1,172 @@
+/* Debounce test of os/alt_input.h on the host PIO model
+ *
+ * Description:
+ *
+ *   Opens the keys and the switches as cruise_skeleton.c does and drives
+ *   them through test/input_test.pio: a key press and a release that
+ *   bounce, a switch that bounces on, and glitches shorter than
+ *   ALT_INPUT_DEBOUNCE_MS on another key and switch. One task per input
+ *   records every change alt_input_wait() returns, with the debounced
+ *   state and the tick it woke up at. The test then checks that each
+ *   bounce gave exactly one change, no later than ALT_INPUT_DEBOUNCE_MS
+ *   plus LATE_TICKS after the inputs settled, and that the glitches gave
+ *   none.
+ *
+ *   It prints one line per change and per failed check, and exits with 1
+ *   if a check failed. Run it in virtual time with the script, as
+ *   'make test' does:
+ *
+ *     ALT_HOST_CLOCK=virtual ALT_HOST_PIO=test/input_test.pio \
+ *       bin/input_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "includes.h"
+#include "system.h"
+#include "os/alt_input.h"
+
+#define   TASK_STACKSIZE       2048
+
+#define   KEYS_PRIO            5
+#define   SWITCHES_PRIO        6
+#define   CHECK_PRIO           7
+
+#define   KEYS_USED            0xf
+#define   SWITCHES_USED        0x3
+
+#define   END_MS               1500  /* after the last line of the script */
+#define   LATE_TICKS           2     /* allowed on top of the debounce */
+#define   MAX_CHANGES          16
+
+typedef struct
+{
+  const char* name;
+  OS_FLAGS    which;          /* inputs that changed */
+  alt_u32     state;          /* debounced state after the change */
+  INT32U      tick;
+} change;
+
+/* What the script should give: the input that changes, its new state and
+   the tick at which the inputs settled */
+static const change expected[] = {
+  {"keys", 0x8, 0x8, 104},
+  {"keys", 0x8, 0x0, 302},
+  {"switches", 0x1, 0x1, 704},
+};
+
+#define   EXPECTED             (sizeof(expected) / sizeof(expected[0]))
+
+OS_STK    keys_stk[TASK_STACKSIZE];
+OS_STK    switches_stk[TASK_STACKSIZE];
+OS_STK    check_stk[TASK_STACKSIZE];
+
+static alt_input keys_input;
+static alt_input switches_input;
+
+static change changes[MAX_CHANGES];
+static int nchanges;
+
+static void record(const char* name, alt_input* input, OS_FLAGS which)
+{
+  if (nchanges < MAX_CHANGES)
+    {
+      changes[nchanges].name = name;
+      changes[nchanges].which = which;
+      changes[nchanges].state = alt_input_state(input);
+      changes[nchanges].tick = OSTimeGet();
+    }
+  nchanges++;
+}
+
+void inputTask(void* pdata)
+{
+  alt_input* input = pdata;
+  const char* name = input == &keys_input ? "keys" : "switches";
+  OS_FLAGS which;
+  INT8U err;
+
+  while (1)
+    {
+      which = alt_input_wait(input, input->mask, 0, &err);
+      record(name, input, which);
+    }
+}
+
+void checkTask(void* pdata)
+{
+  const change* want;
+  const change* got;
+  INT32U settle = alt_ticks_per_second() * ALT_INPUT_DEBOUNCE_MS / 1000;
+  int failed = 0;
+  int i;
+
+  OSTimeDly(alt_ticks_per_second() * END_MS / 1000);
+
+  for (i = 0; i < nchanges && i < MAX_CHANGES; i++)
+    printf("%s,%lu,0x%lx,%lu\n", changes[i].name,
+	   (unsigned long)changes[i].which, (unsigned long)changes[i].state,
+	   (unsigned long)changes[i].tick);
+
+  if (nchanges != EXPECTED)
+    {
+      printf("FAIL: %d changes, expected %d\n", nchanges, (int)EXPECTED);
+      failed = 1;
+    }
+
+  for (i = 0; i < nchanges && i < (int)EXPECTED; i++)
+    {
+      want = &expected[i];
+      got = &changes[i];
+      if (strcmp(got->name, want->name) || got->which != want->which
+	  || got->state != want->state)
+	{
+	  printf("FAIL: change %d is %s 0x%lx to 0x%lx, expected %s 0x%lx "
+		 "to 0x%lx\n", i, got->name, (unsigned long)got->which,
+		 (unsigned long)got->state, want->name,
+		 (unsigned long)want->which, (unsigned long)want->state);
+	  failed = 1;
+	}
+      else if (got->tick < want->tick + settle
+	       || got->tick > want->tick + settle + LATE_TICKS)
+	{
+	  printf("FAIL: change %d at tick %lu, expected %lu to %lu\n", i,
+		 (unsigned long)got->tick,
+		 (unsigned long)(want->tick + settle),
+		 (unsigned long)(want->tick + settle + LATE_TICKS));
+	  failed = 1;
+	}
+    }
+
+  printf("%s\n", failed ? "FAIL" : "PASS");
+  exit(failed);
+}
+
+int main(void)
+{
+  if (alt_input_open(&keys_input, D2_PIO_KEYS4_BASE,
+		     D2_PIO_KEYS4_IRQ_INTERRUPT_CONTROLLER_ID,
+		     D2_PIO_KEYS4_IRQ, KEYS_USED, KEYS_USED,
+		     ALT_INPUT_EDGE_ACTIVE) < 0
+      || alt_input_open(&switches_input, DE2_PIO_TOGGLES18_BASE,
+			DE2_PIO_TOGGLES18_IRQ_INTERRUPT_CONTROLLER_ID,
+			DE2_PIO_TOGGLES18_IRQ, SWITCHES_USED, 0,
+			ALT_INPUT_EDGE_ANY) < 0)
+    {
+      printf("FAIL: alt_input_open\n");
+      return 1;
+    }
+
+  OSTaskCreateExt(inputTask, &keys_input, &keys_stk[TASK_STACKSIZE-1],
+		  KEYS_PRIO, KEYS_PRIO, &keys_stk[0], TASK_STACKSIZE, NULL, 0);
+  OSTaskCreateExt(inputTask, &switches_input,
+		  &switches_stk[TASK_STACKSIZE-1], SWITCHES_PRIO,
+		  SWITCHES_PRIO, &switches_stk[0], TASK_STACKSIZE, NULL, 0);
+  OSTaskCreateExt(checkTask, NULL, &check_stk[TASK_STACKSIZE-1],
+		  CHECK_PRIO, CHECK_PRIO, &check_stk[0], TASK_STACKSIZE,
+		  NULL, 0);
+
+  OSStart();
+  return 1;
+}
@@ -0,0 +1,180 @@
+/* Drift of the system clock over many restarts of the counter
+ *
+ * Description:
+ *
+ *   A sleeper task delays for a pseudo-random 1 to MAX_DLY ticks over
+ *   and over, while the keys are pressed in the middle of ticks by
+ *   test/timer_test.pio. The ISR of the keys posts a semaphore to a
+ *   waiter task and starts an alt_alarm of a few ticks, unless the one it
+ *   started before is still running. With the tickless kernel
+ *   (bin/timer_test_tickless) every idle period, every wake-up by a key
+ *   and every alarm restarts the counter of the system clock, and the host
+ *   timer model charges each restart the cycles it takes on the Nios II
+ *   (ALT_HOST_TIMER_RESTART_CYCLES).
+ *
+ *   Each time the sleeper wakes up it compares the tick count with the
+ *   host clock; the ticks may come up to MAX_ERROR_NS late, but never
+ *   early. At the end alt_avalon_timer_sc_time() must be within
+ *   MAX_ERROR_NS of the host clock as well. A driver that loses the cycles
+ *   of a restart, or makes up for too many, is off by more than that after
+ *   a handful of restarts. It prints the ticks, the passes of the idle
+ *   task, the key presses and alarms, and the errors, then PASS, or a line
+ *   per failed check and FAIL with exit status 1. Run it in virtual time
+ *   with the script, as 'make test' does:
+ *
+ *     ALT_HOST_CLOCK=virtual ALT_HOST_PIO=test/timer_test.pio \
+ *       bin/timer_test_tickless
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "includes.h"
+#include "system.h"
+#include "altera_avalon_pio_regs.h"
+#include "altera_avalon_timer.h"
+#include "sys/alt_alarm.h"
+#include "sys/alt_irq.h"
+#include "alt_host.h"
+
+#define   TASK_STACKSIZE       2048
+#define   WAITER_PRIO          5
+#define   SLEEPER_PRIO         6
+
+#define   END_MS               2000
+#define   MAX_DLY              7     /* ticks */
+#define   MAX_ALARM            5     /* ticks */
+#define   MAX_ERROR_NS         10000
+
+OS_STK    waiter_stk[TASK_STACKSIZE];
+OS_STK    sleeper_stk[TASK_STACKSIZE];
+
+static OS_EVENT* key_sem;
+static alt_alarm key_alarm;
+static INT32U    seed = 1;
+static INT32U    wakeups;
+static INT32U    alarms;
+static int       alarm_running;
+
+/* Linear congruential generator, as in the C standard */
+static INT32U pick(INT32U max)
+{
+  seed = seed * 1103515245 + 12345;
+  return 1 + (seed >> 16) % max;
+}
+
+/* Time of the host clock past the start of the current tick, in ns */
+static alt_64 tickError(void)
+{
+  alt_u64 tick_ns = 1000000000u / alt_ticks_per_second();
+
+  return (alt_64)(alt_host_clock_now() - (alt_u64)alt_nticks() * tick_ns);
+}
+
+static alt_u32 alarmCallback(void* context)
+{
+  alarms++;
+  alarm_running = 0;
+  return 0;
+}
+
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+static void keysIsr(void* context)
+#else
+static void keysIsr(void* context, alt_u32 id)
+#endif
+{
+  IOWR_ALTERA_AVALON_PIO_EDGE_CAP(D2_PIO_KEYS4_BASE, 0xf);
+
+  if (!alarm_running)
+    {
+      alarm_running = 1;
+      alt_alarm_start(&key_alarm, pick(MAX_ALARM), alarmCallback, NULL);
+    }
+  OSSemPost(key_sem);
+}
+
+void waiterTask(void* pdata)
+{
+  INT8U err;
+
+  while (1)
+    {
+      OSSemPend(key_sem, 0, &err);
+      wakeups++;
+    }
+}
+
+void sleeperTask(void* pdata)
+{
+  INT32U end = alt_ticks_per_second() * END_MS / 1000;
+  alt_64 error, max_error = 0, min_error = 0;
+  alt_64 time_error;
+  alt_u64 cycles;
+  int failed = 0;
+
+  while (OSTimeGet() < end)
+    {
+      OSTimeDly(pick(MAX_DLY));
+      error = tickError();
+      if (error > max_error)
+	max_error = error;
+      if (error < min_error)
+	min_error = error;
+    }
+
+  cycles = alt_host_clock_now() * alt_avalon_timer_sc_freq() / 1000000000u;
+  time_error = (alt_32)((alt_u32)cycles - alt_avalon_timer_sc_time());
+  time_error = time_error * 1000000000 / alt_avalon_timer_sc_freq();
+
+  printf("ticks,idle,wakeups,alarms,"
+	 "min_error_ns,max_error_ns,time_error_ns\n");
+  printf("%lu,%lu,%lu,%lu,%lld,%lld,%lld\n", (unsigned long)OSTimeGet(),
+	 (unsigned long)OSIdleCtr, (unsigned long)wakeups,
+	 (unsigned long)alarms, (long long)min_error, (long long)max_error,
+	 (long long)time_error);
+
+  if (min_error < 0 || max_error > MAX_ERROR_NS)
+    {
+      printf("FAIL: the ticks are off the host clock by %lld to %lld ns\n",
+	     (long long)min_error, (long long)max_error);
+      failed = 1;
+    }
+  if (time_error < -MAX_ERROR_NS || time_error > MAX_ERROR_NS)
+    {
+      printf("FAIL: alt_avalon_timer_sc_time() is off by %lld ns\n",
+	     (long long)time_error);
+      failed = 1;
+    }
+
+  printf("%s\n", failed ? "FAIL" : "PASS");
+  exit(failed);
+}
+
+int main(void)
+{
+  key_sem = OSSemCreate(0);
+
+  IOWR_ALTERA_AVALON_PIO_EDGE_CAP(D2_PIO_KEYS4_BASE, 0xf);
+  IOWR_ALTERA_AVALON_PIO_IRQ_MASK(D2_PIO_KEYS4_BASE, 0xf);
+
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+  if (alt_ic_isr_register(D2_PIO_KEYS4_IRQ_INTERRUPT_CONTROLLER_ID,
+			  D2_PIO_KEYS4_IRQ, keysIsr, NULL, NULL) < 0)
+#else
+  if (alt_irq_register(D2_PIO_KEYS4_IRQ, NULL, keysIsr) < 0)
+#endif
+    {
+      printf("FAIL: alt_ic_isr_register\n");
+      return 1;
+    }
+
+  OSTaskCreateExt(waiterTask, NULL, &waiter_stk[TASK_STACKSIZE-1],
+		  WAITER_PRIO, WAITER_PRIO, &waiter_stk[0], TASK_STACKSIZE,
+		  NULL, 0);
+  OSTaskCreateExt(sleeperTask, NULL, &sleeper_stk[TASK_STACKSIZE-1],
+		  SLEEPER_PRIO, SLEEPER_PRIO, &sleeper_stk[0], TASK_STACKSIZE,
+		  NULL, 0);
+
+  OSStart();
+  return 1;
+}
@@ -0,0 +1,343 @@
+/* Monte-Carlo scenario runner for the cruise controller
+ *
+ * Description:
+ *
+ *   Runs the vehicle model and the control law of the cruise control lab
+ *   (lab2-cruise/src/cruise_model.h, as used by cruise_skeleton.c) through
+ *   N random drive scenarios, without the kernel and as fast as the host
+ *   allows, spread over a pool of threads. Usage:
+ *
+ *     cruise_mc [-n scenarios] [-j threads] [-s seed] [-k THROTTLE_K]
+ *               [-t THROTTLE_TI] > scenarios.csv
+ *
+ *   A scenario starts at rest at a random position on the track with the
+ *   engine on. The driver holds the gas for a while, shifts into top gear
+ *   on the way, may coast for a moment, and then presses the cruise
+ *   control button for the rest of the scenario. As in ControlTask, cruise
+ *   control takes the velocity at that moment as target, and only engages
+ *   in top gear above 20 m/s. A while after the button, one scenario in
+ *   three has a disturbance:
+ *
+ *     none       - cruise control holds to the end,
+ *     brake      - the driver lets go of the cruise control button, as
+ *                  ButtonIOTask ignores the brake while it is held,
+ *                  brakes for a few periods, holds the gas again and
+ *                  presses the button again, which takes the new velocity
+ *                  as target,
+ *     engine_off - the engine switch is off for a few periods while cruise
+ *                  control stays engaged, so the PI law winds up.
+ *
+ *   Each scenario depends on the seed and its number only, so the output
+ *   does not depend on the number of threads.
+ *
+ *   One line of CSV is printed per scenario:
+ *
+ *     scenario,start_m,gas_s,top_gear_s,cruise_s,disturbance,disturb_s,
+ *     target,settling_s,overshoot,ss_error
+ *
+ *   with the times in seconds from the start, and from the moment cruise
+ *   control last engaged or, after engine_off, the engine came back on:
+ *
+ *     settling_s - time until the velocity stays within SETTLE_BAND m/s of
+ *                  the target for good, -1 if it never does,
+ *     overshoot  - largest velocity above the target, in m/s,
+ *     ss_error   - mean absolute error over the last SS_WINDOW seconds.
+ *
+ *   The target and overshoot are those of the last engagement. The
+ *   scenarios that never engage cruise control have empty metrics. The
+ *   number of control steps per second is reported on stderr.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* uC/OS-II types used by cruise_model.h, as in os_cpu.h */
+typedef int32_t INT32S;
+
+/* As in cruise_skeleton.c, except that the gains are read at run time */
+#define   VEHICLE_PERIOD       300
+#define   CONTROL_PERIOD       300
+#define   DEFAULT_THROTTLE     5
+#define   THROTTLE_K           throttle_k
+#define   THROTTLE_TI          throttle_ti
+
+static int throttle_k = 2;
+static int throttle_ti = 100;
+
+#include "../../lab2-cruise/src/cruise_model.h"
+
+#define   PERIOD_S             (VEHICLE_PERIOD / 1000.0)
+
+#define   SETTLE_BAND          2     /* m/s */
+#define   SS_WINDOW            30    /* s */
+#define   CHUNK                64    /* scenarios a thread takes at once */
+
+enum disturbance
+{
+  NONE,
+  BRAKE,
+  ENGINE_OFF
+};
+
+static const char* disturbance_names[] = {"none", "brake", "engine_off"};
+
+typedef struct
+{
+  int start;          /* m */
+  int gas;            /* periods the gas is held */
+  int top_gear;       /* period of the shift into top gear */
+  int cruise;         /* period cruise control is pressed */
+  int kind;           /* enum disturbance */
+  int disturb;        /* period the disturbance starts */
+  int disturb_len;    /* periods of brake or of the engine off */
+  int regas;          /* BRAKE: periods the gas is held after the brake */
+  int recruise;       /* BRAKE: period cruise control is pressed again */
+  int periods;        /* length of the scenario */
+  int from;           /* period settling_s counts from */
+  int engaged;        /* period cruise control engaged, -1 if never */
+  int target;         /* m/s */
+  int settled;        /* period the velocity settled, -1 if never */
+  int overshoot;      /* m/s */
+  double ss_error;    /* m/s */
+} scenario;
+
+static scenario* scenarios;
+static int count = 10000;
+static unsigned long seed = 1;
+
+static int next_scenario;
+static long long steps;
+
+/* splitmix64, one generator per scenario */
+static uint64_t rnd(uint64_t* state)
+{
+  uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+static int uniform(uint64_t* state, int lo, int hi)
+{
+  return lo + (int)(rnd(state) % (uint64_t)(hi - lo + 1));
+}
+
+static void draw(scenario* s, int n)
+{
+  uint64_t state = seed * 0x100000001b3ull + n;
+
+  s->start = uniform(&state, 0, 2399);
+  s->gas = uniform(&state, 10, 60);
+  s->top_gear = uniform(&state, 0, s->gas);
+  s->cruise = s->gas + uniform(&state, 0, 10);
+  s->periods = s->cruise + uniform(&state, 200, 600);
+
+  s->kind = uniform(&state, NONE, ENGINE_OFF);
+  s->disturb = s->cruise + uniform(&state, 30, 80);
+  s->disturb_len = s->kind == BRAKE ? uniform(&state, 1, 3)
+				    : uniform(&state, 3, 20);
+  s->regas = uniform(&state, 10, 60);
+  s->recruise = s->disturb + s->disturb_len + s->regas
+		+ uniform(&state, 0, 10);
+  if (s->kind == BRAKE)
+    s->periods += s->recruise - s->cruise;
+}
+
+/* One scenario, period by period as VehicleTask and ControlTask */
+static void run(scenario* s)
+{
+  struct vehicle_model m = {0, 0, 0};
+  struct pi_control c = {0, 0};
+  INT32S velocity = 0;
+  int window = s->periods - SS_WINDOW / PERIOD_S;
+  double error_sum = 0;
+  int error_count = 0;
+  int engaged = 0;
+  int disturbed;
+  int released;
+  int top_gear;
+  int cruise;
+  int engine;
+  int brake;
+  int gas;
+  int k;
+
+  m.position = (INT32S)s->start << MODEL_Q;
+  s->engaged = -1;
+  s->settled = -1;
+  s->overshoot = 0;
+
+  for (k = 0; k < s->periods; k++)
+    {
+      disturbed = k >= s->disturb && k < s->disturb + s->disturb_len;
+      released = s->kind == BRAKE && k >= s->disturb && k < s->recruise;
+      brake = s->kind == BRAKE && disturbed;
+      engine = !(s->kind == ENGINE_OFF && disturbed);
+      cruise = k >= s->cruise && !released;
+      gas = k < s->gas || (released && !disturbed);
+
+      vehicle_step(&m, control_throttle(&c), brake, engine);
+      velocity = vehicle_velocity(&m);
+      top_gear = k >= s->top_gear;
+
+      if (!cruise)
+	{
+	  /* Released, as ControlTask drops the target */
+	  engaged = 0;
+	  control_manual(&c, gas);
+	  continue;
+	}
+
+      if (!engaged)
+	{
+	  if (!top_gear || velocity <= 20)
+	    {
+	      control_manual(&c, gas);
+	      continue;
+	    }
+	  /* Only the metrics of the last engagement are kept */
+	  engaged = 1;
+	  s->engaged = k;
+	  s->from = k;
+	  s->target = velocity;
+	  s->settled = -1;
+	  s->overshoot = 0;
+	}
+
+      if (s->kind == ENGINE_OFF && k == s->disturb + s->disturb_len)
+	s->from = k;
+
+      control_pi(&c, s->target - velocity);
+
+      if (abs(velocity - s->target) > SETTLE_BAND)
+	s->settled = -1;
+      else if (s->settled < 0)
+	s->settled = k;
+      if (velocity - s->target > s->overshoot)
+	s->overshoot = velocity - s->target;
+      if (k >= window)
+	{
+	  error_sum += abs(velocity - s->target);
+	  error_count++;
+	}
+    }
+
+  s->ss_error = error_count ? error_sum / error_count : 0;
+}
+
+static void* worker(void* arg)
+{
+  long long done = 0;
+  int first;
+  int n;
+
+  while ((first = __atomic_fetch_add(&next_scenario, CHUNK,
+				     __ATOMIC_RELAXED)) < count)
+    {
+      for (n = first; n < first + CHUNK && n < count; n++)
+	{
+	  draw(&scenarios[n], n);
+	  run(&scenarios[n]);
+	  done += scenarios[n].periods;
+	}
+    }
+
+  __atomic_fetch_add(&steps, done, __ATOMIC_RELAXED);
+  return NULL;
+}
+
+static double now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void usage(const char* prog)
+{
+  fprintf(stderr, "usage: %s [-n scenarios] [-j threads] [-s seed] "
+	  "[-k THROTTLE_K] [-t THROTTLE_TI] > scenarios.csv\n", prog);
+  exit(1);
+}
+
+int main(int argc, char** argv)
+{
+  pthread_t* threads;
+  scenario* s;
+  double start, elapsed;
+  long nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+  int opt;
+  int i;
+
+  while ((opt = getopt(argc, argv, "n:j:s:k:t:")) != -1)
+    {
+      switch (opt)
+	{
+	case 'n': count = atoi(optarg); break;
+	case 'j': nthreads = atol(optarg); break;
+	case 's': seed = strtoul(optarg, NULL, 0); break;
+	case 'k': throttle_k = atoi(optarg); break;
+	case 't': throttle_ti = atoi(optarg); break;
+	default: usage(argv[0]);
+	}
+    }
+  if (optind != argc || count < 1 || nthreads < 1 || throttle_ti < 1)
+    usage(argv[0]);
+
+  scenarios = calloc(count, sizeof(*scenarios));
+  threads = calloc(nthreads, sizeof(*threads));
+  if (!scenarios || !threads)
+    {
+      perror(argv[0]);
+      return 1;
+    }
+
+  start = now();
+  for (i = 0; i < nthreads; i++)
+    {
+      errno = pthread_create(&threads[i], NULL, worker, NULL);
+      if (errno)
+	{
+	  perror(argv[0]);
+	  return 1;
+	}
+    }
+  for (i = 0; i < nthreads; i++)
+    pthread_join(threads[i], NULL);
+  elapsed = now() - start;
+
+  printf("# THROTTLE_K %d, THROTTLE_TI %d, seed %lu\n",
+	 throttle_k, throttle_ti, seed);
+  printf("scenario,start_m,gas_s,top_gear_s,cruise_s,disturbance,disturb_s,"
+	 "target,settling_s,overshoot,ss_error\n");
+  for (i = 0; i < count; i++)
+    {
+      s = &scenarios[i];
+      printf("%d,%d,%.1f,%.1f,%.1f,", i, s->start, s->gas * PERIOD_S,
+	     s->top_gear * PERIOD_S, s->cruise * PERIOD_S);
+      if (s->kind == NONE)
+	printf("none,,");
+      else
+	printf("%s,%.1f,", disturbance_names[s->kind], s->disturb * PERIOD_S);
+      if (s->engaged < 0)
+	printf(",,,\n");
+      else
+	printf("%d,%.1f,%d,%.2f\n", s->target,
+	       s->settled < 0 ? -1
+	       : (s->settled > s->from ? s->settled - s->from : 0) * PERIOD_S,
+	       s->overshoot, s->ss_error);
+    }
+
+  fprintf(stderr, "%d scenarios, %lld control steps in %.3f s on %ld "
+	  "threads: %.1f M steps/s\n", count, steps, elapsed, nthreads,
+	  steps / elapsed * 1e-6);
+  return 0;
+}
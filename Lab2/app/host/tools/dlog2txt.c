@@ -0,0 +1,131 @@
+/* Deferred log decoder
+ *
+ * Description:
+ *
+ *   Turns the binary frames written by the alt_dlog drain task (see
+ *   os/alt_dlog.h in the BSP) back into text. Ordinary text output passes
+ *   through unchanged, so the whole stdout of the board or of a host
+ *   executable can be piped through it:
+ *
+ *     nios2-terminal | dlog2txt [-t]
+ *     bin/cruise | bin/dlog2txt [-t]
+ *
+ *   A NUL byte starts a frame:
+ *
+ *     'D' id len <len characters>          - format string of 'id'
+ *     'L' id n <tick> <arg 0> ... <arg n-1> - record, 32 bit values
+ *     'X' <count>                           - records lost, 32 bit count
+ *
+ *   The 32 bit values are little endian. Each record is printed with its
+ *   format and its arguments as int; with -t the line starts with the tick
+ *   of the record. Lost records are reported on stderr.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define   FRAME_DEF            'D'
+#define   FRAME_LOG            'L'
+#define   FRAME_LOST           'X'
+
+#define   MAX_FORMATS          256
+#define   MAX_ARGS             4
+
+static char* formats[MAX_FORMATS];
+static const char* prog;
+
+/* Reads n bytes of the current frame, fails on a truncated stream */
+static void get(unsigned char* buf, size_t n)
+{
+  if (n > 0 && fread(buf, n, 1, stdin) != 1)
+    {
+      fprintf(stderr, "%s: truncated frame\n", prog);
+      exit(1);
+    }
+}
+
+static unsigned long get32(const unsigned char* p)
+{
+  return (unsigned long)p[0] | ((unsigned long)p[1] << 8)
+    | ((unsigned long)p[2] << 16) | ((unsigned long)p[3] << 24);
+}
+
+static int sign32(unsigned long value)
+{
+  return value & 0x80000000ul ? (int)(value - 0x100000000ll) : (int)value;
+}
+
+int main(int argc, char** argv)
+{
+  unsigned char buf[4 + 4 * MAX_ARGS];
+  int arg[MAX_ARGS];
+  int ticks = 0;
+  unsigned id, n, i;
+  int c;
+
+  prog = argv[0];
+  if (argc == 2 && strcmp(argv[1], "-t") == 0)
+    ticks = 1;
+  else if (argc != 1)
+    {
+      fprintf(stderr, "usage: %s [-t] < log > text\n", prog);
+      return 1;
+    }
+
+  while ((c = getchar()) != EOF)
+    {
+      if (c != 0)
+	{
+	  putchar(c);
+	  continue;
+	}
+
+      get(buf, 1);
+      switch (buf[0])
+	{
+	case FRAME_DEF:
+	  get(buf, 2);
+	  id = buf[0];
+	  free(formats[id]);
+	  formats[id] = malloc(buf[1] + 1);
+	  get((unsigned char*)formats[id], buf[1]);
+	  formats[id][buf[1]] = '\0';
+	  break;
+
+	case FRAME_LOG:
+	  get(buf, 2);
+	  id = buf[0];
+	  n  = buf[1];
+	  if (n > MAX_ARGS)
+	    {
+	      fprintf(stderr, "%s: record with %u arguments\n", prog, n);
+	      return 1;
+	    }
+	  get(buf, 4 + 4 * n);
+	  for (i = 0; i < MAX_ARGS; i++)
+	    arg[i] = i < n ? sign32(get32(buf + 4 + 4 * i)) : 0;
+
+	  if (ticks)
+	    printf("[%lu] ", get32(buf));
+	  if (formats[id])
+	    printf(formats[id], arg[0], arg[1], arg[2], arg[3]);
+	  else
+	    printf("<format %u> %d %d %d %d\n", id,
+		   arg[0], arg[1], arg[2], arg[3]);
+	  break;
+
+	case FRAME_LOST:
+	  get(buf, 4);
+	  fflush(stdout);
+	  fprintf(stderr, "%s: %lu records lost\n", prog, get32(buf));
+	  break;
+
+	default:
+	  fprintf(stderr, "%s: unknown frame type 0x%02x\n", prog, buf[0]);
+	  return 1;
+	}
+    }
+
+  return 0;
+}
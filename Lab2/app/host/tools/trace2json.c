@@ -0,0 +1,275 @@
+/* Kernel event trace decoder
+ *
+ * Description:
+ *
+ *   Turns a dump of the OSTrace ring buffer (OS_TRACE_EN, see os_trace.c)
+ *   into the Chrome trace event format, which can be opened in Perfetto
+ *   (ui.perfetto.dev) or chrome://tracing. On the board the buffer is dumped
+ *   from nios2-elf-gdb with
+ *
+ *     dump binary value trace.bin OSTrace
+ *
+ *   and on the host with ALT_HOST_TRACE=trace.bin. Usage:
+ *
+ *     trace2json trace.bin [prio=name ...] > trace.json
+ *
+ *   Every task is a thread, named after its priority unless a name is given
+ *   on the command line, and shows a slice for each time it ran. Interrupts
+ *   are slices on a thread of their own. Posts, pends (only those that had
+ *   to wait) and timer expiries are instant events on the thread they
+ *   happened on, with the index of the event in OSEventTbl[] or of the timer
+ *   in OSTmrTbl[] as argument.
+ *
+ *   The dump is read as written by a little endian CPU, like the Nios II and
+ *   x86 hosts. The layout must match OS_TRACE in ucos_ii.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define   TRACE_MAGIC          0x45435254u  /* "TRCE" */
+#define   TRACE_HDR_SIZE       20
+#define   TRACE_REC_SIZE       8
+
+#define   TRACE_TASK_SW        1
+#define   TRACE_INT_ENTER      2
+#define   TRACE_INT_EXIT       3
+#define   TRACE_SEM_POST       4
+#define   TRACE_SEM_PEND       5
+#define   TRACE_MBOX_POST      6
+#define   TRACE_MBOX_PEND      7
+#define   TRACE_Q_POST         8
+#define   TRACE_Q_PEND         9
+#define   TRACE_TMR_EXPIRE     10
+
+#define   MAX_PRIO             256
+#define   ISR_TID              MAX_PRIO     /* thread of the interrupts */
+
+static const char* names[MAX_PRIO];
+static int used[MAX_PRIO];
+static int first_event = 1;
+
+static unsigned long get32(const unsigned char* p)
+{
+  return (unsigned long)p[0] | ((unsigned long)p[1] << 8)
+    | ((unsigned long)p[2] << 16) | ((unsigned long)p[3] << 24);
+}
+
+static unsigned get16(const unsigned char* p)
+{
+  return (unsigned)p[0] | ((unsigned)p[1] << 8);
+}
+
+/* Starts the next element of the traceEvents array */
+static void event(const char* name, const char* ph, int tid, double ts)
+{
+  printf("%s\n{\"name\":\"%s\",\"ph\":\"%s\",\"pid\":1,\"tid\":%d,"
+	 "\"ts\":%.3f", first_event ? "" : ",", name, ph, tid, ts);
+  first_event = 0;
+}
+
+static void threadName(int tid, const char* name, int sort_index)
+{
+  event("thread_name", "M", tid, 0);
+  printf(",\"args\":{\"name\":\"%s\"}}", name);
+  event("thread_sort_index", "M", tid, 0);
+  printf(",\"args\":{\"sort_index\":%d}}", sort_index);
+}
+
+static const char* taskName(int prio)
+{
+  static char buf[MAX_PRIO][16];
+
+  if (names[prio])
+    return names[prio];
+  sprintf(buf[prio], "prio %d", prio);
+  return buf[prio];
+}
+
+/* Instant event of a kernel service, on the task or interrupt thread */
+static void instant(const char* name, const char* arg_name, unsigned arg,
+		    int tid, double ts)
+{
+  event(name, "i", tid, ts);
+  printf(",\"s\":\"t\",\"args\":{\"%s\":%u}}", arg_name, arg);
+}
+
+int main(int argc, char** argv)
+{
+  static const char* services[] = {
+    NULL, NULL, NULL, NULL,
+    "OSSemPost", "OSSemPend", "OSMboxPost", "OSMboxPend",
+    "OSQPost", "OSQPend"
+  };
+  unsigned char* dump;
+  const unsigned char* rec;
+  unsigned long size, ctr, freq, n, i;
+  unsigned long time, prev_time = 0;
+  double cycles = 0, ts = 0, start = 0;
+  unsigned type, prio, arg, lowest, tmr;
+  int cur = -1;
+  int isr_depth = 0;
+  long len;
+  FILE* file;
+  int a;
+
+  if (argc < 2)
+    {
+      fprintf(stderr, "usage: %s dump [prio=name ...] > trace.json\n",
+	      argv[0]);
+      return 1;
+    }
+  for (a = 2; a < argc; a++)
+    {
+      char* eq = strchr(argv[a], '=');
+
+      prio = atoi(argv[a]);
+      if (!eq || prio >= MAX_PRIO)
+	{
+	  fprintf(stderr, "%s: bad task name '%s'\n", argv[0], argv[a]);
+	  return 1;
+	}
+      names[prio] = eq + 1;
+    }
+
+  file = fopen(argv[1], "rb");
+  if (!file)
+    {
+      perror(argv[1]);
+      return 1;
+    }
+  fseek(file, 0, SEEK_END);
+  len = ftell(file);
+  rewind(file);
+  dump = malloc(len > 0 ? len : 1);
+  if (len < TRACE_HDR_SIZE || fread(dump, len, 1, file) != 1
+      || get32(dump) != TRACE_MAGIC)
+    {
+      fprintf(stderr, "%s: '%s' is not an OSTrace dump\n", argv[0], argv[1]);
+      return 1;
+    }
+  fclose(file);
+
+  size   = get32(dump + 4);
+  ctr    = get32(dump + 8);
+  freq   = get32(dump + 12);
+  lowest = get16(dump + 16);
+  tmr    = get16(dump + 18);
+  if (size == 0 || (size & (size - 1)) != 0
+      || (unsigned long)len < TRACE_HDR_SIZE + size * TRACE_REC_SIZE)
+    {
+      fprintf(stderr, "%s: '%s' is truncated\n", argv[0], argv[1]);
+      return 1;
+    }
+  if (freq == 0)
+    {
+      fprintf(stderr, "%s: no time stamp frequency, assuming 1 MHz\n",
+	      argv[0]);
+      freq = 1000000;
+    }
+  if (lowest < MAX_PRIO && !names[lowest])
+    names[lowest] = "uC/OS-II Idle";
+  if (lowest >= 1 && lowest - 1 < MAX_PRIO && !names[lowest - 1])
+    names[lowest - 1] = "uC/OS-II Stat";
+  if (tmr < MAX_PRIO && !names[tmr])
+    names[tmr] = "uC/OS-II Tmr";
+
+  /* The ring holds the last 'size' of the 'ctr' events recorded */
+  n = ctr < size ? ctr : size;
+
+  printf("{\"displayTimeUnit\":\"ns\",\"otherData\":"
+	 "{\"events\":%lu,\"lost\":%lu,\"freq\":%lu},\n\"traceEvents\":[",
+	 n, ctr - n, freq);
+
+  for (i = 0; i < n; i++)
+    {
+      rec  = dump + TRACE_HDR_SIZE
+	+ ((ctr - n + i) & (size - 1)) * TRACE_REC_SIZE;
+      time = get32(rec);
+      type = rec[4];
+      prio = rec[5];
+      arg  = get16(rec + 6);
+
+      /* The 32 bit time stamps wrap, but not between two events */
+      if (i > 0)
+	cycles += (double)((time - prev_time) & 0xfffffffful);
+      prev_time = time;
+      ts = cycles * 1e6 / freq;
+
+      if (cur < 0)
+	{
+	  cur   = prio;
+	  start = ts;
+	}
+
+      switch (type)
+	{
+	case TRACE_TASK_SW:
+	  if (arg == (unsigned)cur || arg >= MAX_PRIO)
+	    break;
+	  event(taskName(cur), "X", cur, start);
+	  printf(",\"dur\":%.3f}", ts - start);
+	  used[cur] = 1;
+	  cur   = arg;
+	  start = ts;
+	  break;
+
+	case TRACE_INT_ENTER:
+	  event("ISR", "B", ISR_TID, ts);
+	  printf(",\"args\":{\"nesting\":%u}}", arg);
+	  isr_depth++;
+	  break;
+
+	case TRACE_INT_EXIT:
+	  if (isr_depth == 0)     /* entered before the oldest record */
+	    break;
+	  event("ISR", "E", ISR_TID, ts);
+	  printf("}");
+	  isr_depth--;
+	  break;
+
+	case TRACE_SEM_POST:
+	case TRACE_SEM_PEND:
+	case TRACE_MBOX_POST:
+	case TRACE_MBOX_PEND:
+	case TRACE_Q_POST:
+	case TRACE_Q_PEND:
+	  instant(services[type], "event", arg,
+		  isr_depth ? ISR_TID : (int)prio, ts);
+	  used[prio] = 1;
+	  break;
+
+	case TRACE_TMR_EXPIRE:
+	  instant("OSTmr expiry", "timer", arg, prio, ts);
+	  used[prio] = 1;
+	  break;
+
+	default:
+	  fprintf(stderr, "%s: unknown event type %u\n", argv[0], type);
+	  break;
+	}
+    }
+
+  /* Close what is still running at the last record */
+  if (cur >= 0)
+    {
+      event(taskName(cur), "X", cur, start);
+      printf(",\"dur\":%.3f}", ts - start);
+      used[cur] = 1;
+    }
+  for (; isr_depth > 0; isr_depth--)
+    {
+      event("ISR", "E", ISR_TID, ts);
+      printf("}");
+    }
+
+  for (a = 0; a < MAX_PRIO; a++)
+    if (used[a])
+      threadName(a, taskName(a), a);
+  threadName(ISR_TID, "Interrupts", -1);
+
+  printf("\n]}\n");
+  free(dump);
+  return 0;
+}
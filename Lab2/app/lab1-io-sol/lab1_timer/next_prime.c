@@ -3,47 +3,203 @@
   *
   * Return the first prime number larger than the integer
   * given as a parameter. The integer must be positive.
+  *
+  * The primes come from a segmented sieve of Eratosthenes that keeps its
+  * state between calls, so that calling next_prime() with the prime it
+  * returned last streams the primes one after the other:
+  *
+  *  - a segment holds SEG_BITS odd numbers, one bit each,
+  *  - it starts from a 2*3*5 wheel pattern, i.e. with the multiples of 3
+  *    and 5 already crossed off,
+  *  - the multiples of the sieving primes 7, 11, ... up to the square root
+  *    of the end of the segment are then crossed off; each sieving prime
+  *    remembers its next multiple, so the following segment needs no
+  *    division at all.
+  *
+  * The Nios II/e has no divider, so this replaces a '%' per candidate and
+  * factor by a few shifts and adds per crossed off multiple. A call for a
+  * number outside the current segment sieves a new segment there, which
+  * costs one division per sieving prime. Beyond the square of the last
+  * prime that fits in the table, candidates are trial divided by the
+  * primes found so far instead, up to their square root.
+  *
+  * The state is static: next_prime() is not reentrant. inval must be
+  * smaller than 2147483647, the largest int prime.
   */
+
+#include "next_prime.h"
+
 #define PRIME_FALSE      0
 #define PRIME_TRUE       1
-int next_prime( int inval )
+
+#define SEG_WORDS        60                 /* a multiple of WHEEL_WORDS */
+#define SEG_BITS         (SEG_WORDS * 32)   /* odd numbers per segment */
+#define WHEEL_WORDS      15                 /* 480 bits, the period of the
+                                               3 and 5 pattern in words */
+#define SIEVE_PRIMES     1024               /* primes up to 8167 */
+
+static unsigned int seg[SEG_WORDS];      /* bit set: maybe prime */
+static unsigned int seg_lo;              /* number of bit 0, 0 if none */
+static unsigned int wheel[WHEEL_WORDS];  /* segment pattern for seg_lo */
+
+static unsigned int sieve_prime[SIEVE_PRIMES];
+static unsigned int sieve_next[SIEVE_PRIMES];  /* next odd multiple */
+static int sieve_found;                  /* primes in the table */
+static int sieve_used;                   /* primes sieving the segment */
+
+/* Answers below the first sieving prime, 7 */
+static const int small_next[7] = { 1, 2, 3, 5, 5, 7, 7 };
+
+/* Finds the next sieving prime by trial division by the previous ones */
+static int add_sieve_prime( void )
 {
-	int perhapsprime;
-	int testfactor;
-	int found; 
-	if(inval<3) {
-/* Constant to help readability. */
-/* Constant to help readability. */
-/* Holds a tentative prime while we check it. */
-/* Holds various factors for which we test perhapsprime. */
-/* Flag, false until we find a prime. */
-/* Initial sanity check of parameter. */
-		if(inval <= 0) return(1); /* Return 1 for zero or negative input. */
-		if(inval == 1) return(2); /* Easy special case. */
-		if(inval == 2) return(3); /* Easy special case. */
-	} else {
-  /* Testing an even number for primeness is pointless, since
-    * all even numbers are divisible by 2. Therefore, we make sure
-    * that perhapsprime is larger than the parameter, and odd. */
-		perhapsprime = ( inval + 1 ) | 1 ;
-	}
-/* While prime not found, loop. */
-	for( found = PRIME_FALSE; found != PRIME_TRUE; perhapsprime += 2 ) {
-  /* Check factors from 3 up to perhapsprime/2. */
-		for( testfactor = 3; testfactor <= (perhapsprime >> 1); testfactor += 1 ) {
-			found = PRIME_TRUE;       /* Assume we will find a prime. */
-			if( (perhapsprime % testfactor) == 0 ) {                    /* If testfactor divides perhapsprime... */
-				found = PRIME_FALSE;    /* ...then, perhapsprime was non-prime. */
-				goto check_next_prime; /* Break the inner loop, go test a new perhapsprime. */
-			}
+	unsigned int perhapsprime;
+	int i;
+
+	if( sieve_found == SIEVE_PRIMES ) return( PRIME_FALSE );
+
+	perhapsprime = sieve_found ? sieve_prime[sieve_found - 1] + 2 : 7;
+	for( ;; perhapsprime += 2 ) {
+		if( perhapsprime % 3 == 0 || perhapsprime % 5 == 0 ) continue;
+		for( i = 0; i < sieve_found; i++ ) {
+			if( sieve_prime[i] * sieve_prime[i] > perhapsprime ) break;
+			if( perhapsprime % sieve_prime[i] == 0 ) break;
 		}
-	
-		check_next_prime:; /* This label is used to break the inner loop. */
-		if( found == PRIME_TRUE ) {
-	   	return( perhapsprime ); /* Return the prime we found. */
+		if( i == sieve_found ||
+		    sieve_prime[i] * sieve_prime[i] > perhapsprime ) break;
+	}
+
+	sieve_prime[sieve_found++] = perhapsprime;
+	return( PRIME_TRUE );
+}
+
+/* The 3 and 5 pattern of the odd numbers from lo on */
+static void make_wheel( unsigned int lo )
+{
+	unsigned int r3 = lo % 3;
+	unsigned int r5 = lo % 5;
+	int bit;
+
+	for( bit = 0; bit < WHEEL_WORDS * 32; bit++ ) {
+		if( bit % 32 == 0 ) wheel[bit / 32] = 0;
+		if( r3 != 0 && r5 != 0 ) wheel[bit / 32] |= 1u << (bit % 32);
+		r3 = r3 + 2 >= 3 ? r3 + 2 - 3 : r3 + 2;
+		r5 = r5 + 2 >= 5 ? r5 + 2 - 5 : r5 + 2;
+	}
+}
+
+/*
+ * Sieves the segment of the odd numbers from lo on. With 'jump' set the
+ * segment does not follow the previous one, and the wheel and the next
+ * multiples are computed again. Returns PRIME_FALSE if the table of
+ * sieving primes is too small for it.
+ */
+static int sieve_segment( unsigned int lo, int jump )
+{
+	unsigned int hi = lo + 2 * (SEG_BITS - 1);
+	unsigned int p, m, bit;
+	int i;
+
+	seg_lo = 0;
+	if( jump ) {
+		make_wheel( lo );
+		sieve_used = 0;
+	}
+
+	for( i = 0; i < SEG_WORDS; i++ )
+		seg[i] = wheel[i % WHEEL_WORDS];
+
+	/* Enable the primes whose square is now in reach, starting from their
+	   square or, after a jump, from their first odd multiple from lo on */
+	for( ;; ) {
+		if( sieve_used == sieve_found && !add_sieve_prime() ) {
+			p = sieve_prime[sieve_found - 1];
+			if( p * p < hi ) return( PRIME_FALSE );
+			break;
+		}
+		p = sieve_prime[sieve_used];
+		if( p * p > hi ) break;
+		m = p * p;
+		if( m < lo ) {
+			m = (lo + p - 1) / p * p;
+			if( !(m & 1) ) m += p;
 		}
+		sieve_next[sieve_used++] = m;
+	}
+
+	for( i = 0; i < sieve_used; i++ ) {
+		p = sieve_prime[i] * 2;
+		for( m = sieve_next[i]; m <= hi; m += p ) {
+			bit = (m - lo) >> 1;
+			seg[bit >> 5] &= ~(1u << (bit & 31));
+		}
+		sieve_next[i] = m;
+	}
+
+	seg_lo = lo;
+	return( PRIME_TRUE );
+}
+
+/* First bit set from 'bit' on, SEG_BITS if none */
+static int scan_segment( int bit )
+{
+	int word = bit >> 5;
+	unsigned int bits = seg[word] & (~0u << (bit & 31));
+
+	while( bits == 0 ) {
+		if( ++word == SEG_WORDS ) return( SEG_BITS );
+		bits = seg[word];
+	}
+	for( bit = word * 32; !(bits & 1); bit++ ) bits >>= 1;
+	return( bit );
+}
+
+/* Fallback: trial division by 3, 5 and the sieving primes, then by the
+   odd numbers after them, up to the square root */
+static int trial_prime( unsigned int perhapsprime )
+{
+	unsigned int testfactor;
+	int i;
+
+	for( ;; perhapsprime += 2 ) {
+		if( perhapsprime % 3 == 0 || perhapsprime % 5 == 0 ) continue;
+		for( i = 0; i < sieve_found; i++ ) {
+			testfactor = sieve_prime[i];
+			if( testfactor * testfactor > perhapsprime ) return( perhapsprime );
+			if( perhapsprime % testfactor == 0 ) break;
+		}
+		if( i < sieve_found ) continue;
+		for( testfactor = sieve_prime[sieve_found - 1] + 2;
+		     testfactor * testfactor <= perhapsprime; testfactor += 2 ) {
+			if( perhapsprime % testfactor == 0 ) break;
+		}
+		if( testfactor * testfactor > perhapsprime ) return( perhapsprime );
+	}
+}
+
+int next_prime( int inval )
+{
+	unsigned int perhapsprime;
+	int bit;
+
+	/* Initial sanity check of parameter. */
+	if( inval <= 0 ) return( 1 ); /* Return 1 for zero or negative input. */
+	if( inval < 7 ) return( small_next[inval] );
+
+	/* The first odd number after inval, in the current segment or in one
+	   sieved there */
+	perhapsprime = ( (unsigned int)inval + 1 ) | 1;
+	if( seg_lo == 0 || perhapsprime < seg_lo ||
+	    perhapsprime > seg_lo + 2 * (SEG_BITS - 1) ) {
+		if( !sieve_segment( perhapsprime, PRIME_TRUE ) )
+			return( trial_prime( perhapsprime ) );
+	}
+
+	for( bit = (perhapsprime - seg_lo) >> 1; ; bit = 0 ) {
+		bit = scan_segment( bit );
+		if( bit < SEG_BITS ) return( seg_lo + 2 * bit );
+		perhapsprime = seg_lo + 2 * SEG_BITS;
+		if( !sieve_segment( perhapsprime, PRIME_FALSE ) )
+			return( trial_prime( perhapsprime ) );
 	}
-	return( perhapsprime );
 }
-/* When the loop ends,
-   perhapsprime is a real prime. */
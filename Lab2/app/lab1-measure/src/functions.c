@@ -5,28 +5,64 @@
   Johan Wennlund, 2008-09-19
   George Ungureanu, 2018-08-27
 
+  Sums an N x N int matrix with different loop shapes and times each one:
+
+    rows     - row-major order, the original sumMatrix,
+    columns  - column-major order, a stride of N ints per element,
+    unroll4  - row-major, unrolled by 4,
+    unroll8  - row-major, unrolled by 8,
+    pointer  - a single pointer walking the whole matrix,
+    tiled    - TILE x TILE blocks, row-major inside each block,
+    sse2     - 4 ints per instruction (host only),
+    avx2     - 8 ints per instruction (host only, if the CPU has it).
+
+  N goes from MIN_SIZE to MAX_SIZE in powers of two, or until the matrix
+  does not fit in memory. Each variant is timed TRIALS times; the timer
+  overhead is subtracted from every trial. The result is printed as CSV,
+  times in microseconds:
+
+    variant,n,median_us,p95_us,ns_per_element
+
+  The Nios II/e of the lab has no data cache, so the loop overhead rather
+  than the access order should decide there; on the host the order and the
+  vector width should. The same source builds for the host port
+  (app/host, 'make bench') as bin/matrix_bench.
 */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include "system.h"
 #include <time.h>
 #include <sys/alt_timestamp.h>
 #include "alt_types.h"
 
-#define M 64
+#if defined(ALT_HOST_PORT) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HOST_SIMD 1
+#else
+#define HOST_SIMD 0
+#endif
 
-int matrix[M][M]; 
+#define MIN_SIZE 16
+#define MAX_SIZE 4096
+#define TRIALS   21
+#define TILE     16
+
+int *matrix;
 
 /* Initialize the matrix */
 
-void initMatrix (int matrix[][M]);
-int  sumMatrix  (int matrix[][M], int size);
+void initMatrix (int *matrix, int size);
+
+typedef unsigned int (*sum_function)(const int *matrix, int size);
 
 alt_u32 ticks;
 alt_u32 time_1;
 alt_u32 time_2;
 alt_u32 timer_overhead;
 
+alt_u32 trials[TRIALS];
+
 float microseconds(int ticks)
 {
   return (float) 1000000 * (float) ticks / (float) alt_timestamp_freq();
@@ -44,12 +80,204 @@ void stop_measurement()
   ticks = time_2 - time_1;
 }
 
+/* The sums wrap around in unsigned arithmetic, so that every variant
+   gives the same result whatever the order */
+
+unsigned int sumRows (const int *matrix, int size)
+{
+  int i, j;
+  unsigned int Sum = 0;
+
+  for (i = 0; i < size; i ++) {
+    for (j = 0; j < size; j ++) {
+      Sum += matrix[i * size + j];
+    }
+  }
+  return Sum;
+}
+
+unsigned int sumColumns (const int *matrix, int size)
+{
+  int i, j;
+  unsigned int Sum = 0;
+
+  for (j = 0; j < size; j ++) {
+    for (i = 0; i < size; i ++) {
+      Sum += matrix[i * size + j];
+    }
+  }
+  return Sum;
+}
+
+unsigned int sumUnroll4 (const int *matrix, int size)
+{
+  const int *row;
+  int i, j;
+  unsigned int Sum = 0;
+
+  for (i = 0; i < size; i ++) {
+    row = &matrix[i * size];
+    for (j = 0; j < size; j += 4) {
+      Sum += row[j] + row[j + 1] + row[j + 2] + row[j + 3];
+    }
+  }
+  return Sum;
+}
+
+unsigned int sumUnroll8 (const int *matrix, int size)
+{
+  const int *row;
+  int i, j;
+  unsigned int Sum = 0;
+
+  for (i = 0; i < size; i ++) {
+    row = &matrix[i * size];
+    for (j = 0; j < size; j += 8) {
+      Sum += row[j] + row[j + 1] + row[j + 2] + row[j + 3]
+        + row[j + 4] + row[j + 5] + row[j + 6] + row[j + 7];
+    }
+  }
+  return Sum;
+}
+
+unsigned int sumPointer (const int *matrix, int size)
+{
+  const int *p = matrix;
+  const int *end = matrix + size * size;
+  unsigned int Sum = 0;
+
+  while (p < end)
+    Sum += *p++;
+  return Sum;
+}
+
+unsigned int sumTiled (const int *matrix, int size)
+{
+  int ii, jj, i, j;
+  unsigned int Sum = 0;
+
+  for (ii = 0; ii < size; ii += TILE) {
+    for (jj = 0; jj < size; jj += TILE) {
+      for (i = ii; i < ii + TILE; i ++) {
+        for (j = jj; j < jj + TILE; j ++) {
+          Sum += matrix[i * size + j];
+        }
+      }
+    }
+  }
+  return Sum;
+}
+
+#if HOST_SIMD
+
+__attribute__((target("sse2")))
+unsigned int sumSse2 (const int *matrix, int size)
+{
+  const __m128i *p = (const __m128i *) matrix;
+  const __m128i *end = (const __m128i *) (matrix + size * size);
+  __m128i acc = _mm_setzero_si128();
+  unsigned int lanes[4];
+
+  while (p < end)
+    acc = _mm_add_epi32(acc, _mm_loadu_si128(p++));
+  _mm_storeu_si128((__m128i *) lanes, acc);
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+__attribute__((target("avx2")))
+unsigned int sumAvx2 (const int *matrix, int size)
+{
+  const __m256i *p = (const __m256i *) matrix;
+  const __m256i *end = (const __m256i *) (matrix + size * size);
+  __m256i acc0 = _mm256_setzero_si256();
+  __m256i acc1 = _mm256_setzero_si256();
+  unsigned int lanes[8];
+  int i;
+
+  /* two accumulators hide the latency of the adds; size >= MIN_SIZE
+     makes the element count a multiple of 16 */
+  while (p < end) {
+    acc0 = _mm256_add_epi32(acc0, _mm256_loadu_si256(p++));
+    acc1 = _mm256_add_epi32(acc1, _mm256_loadu_si256(p++));
+  }
+  _mm256_storeu_si256((__m256i *) lanes, _mm256_add_epi32(acc0, acc1));
+  for (i = 1; i < 8; i++)
+    lanes[0] += lanes[i];
+  return lanes[0];
+}
+
+#endif /* HOST_SIMD */
+
+struct variant {
+  const char *name;
+  sum_function sum;
+};
+
+struct variant variants[] = {
+  {"rows", sumRows},
+  {"columns", sumColumns},
+  {"unroll4", sumUnroll4},
+  {"unroll8", sumUnroll8},
+  {"pointer", sumPointer},
+  {"tiled", sumTiled},
+#if HOST_SIMD
+  {"sse2", sumSse2},
+  {"avx2", sumAvx2},
+#endif
+};
+
+#define VARIANTS (int) (sizeof(variants) / sizeof(variants[0]))
+
+int supported (struct variant *v)
+{
+#if HOST_SIMD
+  if (v->sum == sumAvx2)
+    return __builtin_cpu_supports("avx2");
+#endif
+  return 1;
+}
+
+int compareTicks (const void *a, const void *b)
+{
+  alt_u32 x = *(const alt_u32 *) a;
+  alt_u32 y = *(const alt_u32 *) b;
+
+  return (x > y) - (x < y);
+}
+
+/* Times one variant TRIALS times and prints its line */
+void measure (struct variant *v, int size, unsigned int expected)
+{
+  volatile unsigned int a;
+  int t;
+
+  for (t = 0; t < TRIALS; t++) {
+    start_measurement();
+    a = v->sum(matrix, size);
+    stop_measurement();
+    trials[t] = ticks > timer_overhead ? ticks - timer_overhead : 0;
+    if (a != expected)
+      printf("# %s: wrong result %u for n %d\n", v->name, a, size);
+  }
+
+  qsort(trials, TRIALS, sizeof(trials[0]), compareTicks);
+  printf("%s,%d,%.2f,%.2f,%.3f\n", v->name, size,
+         microseconds(trials[TRIALS / 2]),
+         microseconds(trials[(TRIALS - 1) * 95 / 100]),
+         1000.0 * microseconds(trials[TRIALS / 2]) / ((float) size * size));
+}
+
 int main ()
 {
-  
-  int a;
-  
-  printf("Processor Type: %s\n", NIOS2_CPU_IMPLEMENTATION);
+  unsigned int expected;
+  int size;
+  int v;
+
+#ifdef ALT_HOST_PORT
+  printf("# Processor Type: host\n");
+#else
+  printf("# Processor Type: %s\n", NIOS2_CPU_IMPLEMENTATION);
+#endif
 
   /* Check if timer available */
   if (alt_timestamp_start() < 0)
@@ -57,57 +285,49 @@ int main ()
   else
     {
       /* Print frequency and period */
-      printf("Timestamp frequency: %3.1f MHz\n", (float)alt_timestamp_freq()/1000000.0);
-      printf("Timestamp period:    %f ms\n\n", 1000.0/(float)alt_timestamp_freq());  
+      printf("# Timestamp frequency: %3.1f MHz\n", (float)alt_timestamp_freq()/1000000.0);
 
       /* Calculate Timer Overhead */
       // Average of 10 measurements */
       int i;
       timer_overhead = 0;
-      for (i = 0; i < 10; i++) {      
+      for (i = 0; i < 10; i++) {
         start_measurement();
         stop_measurement();
         timer_overhead = timer_overhead + time_2 - time_1;
       }
       timer_overhead = timer_overhead / 10;
-        
-      printf("Timer overhead in ticks: %d\n", (int) timer_overhead);
-      printf("Timer overhead in ms:    %f\n\n", 
-	     1000.0 * (float)timer_overhead/(float)alt_timestamp_freq());
-    
-      printf("Measuring sumMatrix...");
-      initMatrix(matrix);     
-      start_measurement();
-      a = sumMatrix (matrix, M);
-      stop_measurement();    
-      printf("Result: %d\n", a);
-      printf("%5.2f us", microseconds(ticks - timer_overhead));
-      printf("(%d ticks)\n", (int) (ticks - timer_overhead)); 
-
-      printf("Done!\n");
-
-    }    
-  return 0;
-}
 
-void initMatrix (int matrix[M][M]){
-  int i, j;
+      printf("# Timer overhead in ticks: %d\n", (int) timer_overhead);
+
+      printf("variant,n,median_us,p95_us,ns_per_element\n");
+      for (size = MIN_SIZE; size <= MAX_SIZE; size *= 2) {
+        matrix = malloc((size_t) size * size * sizeof(int));
+        if (!matrix) {
+          printf("# n %d: out of memory\n", size);
+          break;
+        }
+        initMatrix(matrix, size);
+        expected = sumRows(matrix, size);
+
+        for (v = 0; v < VARIANTS; v++)
+          if (supported(&variants[v]))
+            measure(&variants[v], size, expected);
+        free(matrix);
+      }
+
+      printf("# Done!\n");
 
-  for (i = 0; i < M; i++) {
-    for (j = 0; j < M; j++) {
-      matrix[i][j] = i+j;
     }
-  }
+  return 0;
 }
 
-int sumMatrix (int matrix[M][M], int size)
-{
-  int i, j, Sum = 0;
+void initMatrix (int *matrix, int size){
+  int i, j;
 
-  for (i = 0; i < size; i ++) {
-    for (j = 0; j < size; j ++) {
-      Sum += matrix[i][j];
+  for (i = 0; i < size; i++) {
+    for (j = 0; j < size; j++) {
+      matrix[i * size + j] = i+j;
     }
   }
-  return Sum;
 }
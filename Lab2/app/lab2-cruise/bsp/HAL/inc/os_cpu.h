@@ -82,6 +82,7 @@ typedef unsigned short INT16U;                   /* Unsigned 16 bit quantity
 typedef signed   short INT16S;                   /* Signed   16 bit quantity                           */
 typedef unsigned long  INT32U;                   /* Unsigned 32 bit quantity                           */
 typedef signed   long  INT32S;                   /* Signed   32 bit quantity                           */
+typedef unsigned long long INT64U;               /* Unsigned 64 bit quantity                           */
 typedef float          FP32;                     /* Single precision floating point                    */
 typedef double         FP64;                     /* Double precision floating point                    */
 typedef unsigned int   OS_STK;                   /* Each stack entry is 32-bits                        */
@@ -93,6 +94,19 @@ typedef unsigned int   OS_STK;                   /* Each stack entry is 32-bits
 #define  OS_STK_GROWTH        1        /* Stack grows from HIGH to LOW memory */
 #define  OS_TASK_SW           OSCtxSw  
 
+/* OS_CPU_CTZ() is not defined: the Nios2 has no count trailing zeros instruction, so the
+ * kernel searches the OS_RDY_BITMAP_EN ready tables with OSUnMapTbl[] instead. */
+
+/* Keeps the compiler from moving memory accesses across it. The Nios2 is a single
+ * in-order CPU, so no fence instruction is needed between tasks and ISRs. */
+#define  OS_CPU_MEM_BARRIER() __asm__ __volatile__ ("" : : : "memory")
+
+/* OS_CPU_CAS() is not defined: the Nios2 has no atomic read-modify-write instruction, so
+ * OSMemGet() and OSMemPut() keep disabling interrupts even with OS_MEM_LOCK_FREE_EN. */
+
+/* OS_CPU_MEM_CLR() and OS_CPU_MEM_COPY() are not defined: OS_MemClr() and OS_MemCopy() move
+ * aligned 32 bit words themselves, as newlib's memset() and memcpy() would, without the call. */
+
 /******************************************************************************************
  *                Disable and Enable Interrupts - 2 methods
  *
@@ -119,6 +119,14 @@ static ALT_INLINE alt_u32 ALT_ALWAYS_INLINE alt_nticks (void)
 
 extern void alt_tick (void);
 
+/*
+ * alt_tick_next() and alt_tick_skip() are used by a system clock driver that
+ * holds off its interrupt while the system is idle, see alt_tick.c.
+ */
+
+extern alt_u32 alt_tick_next (void);
+extern void    alt_tick_skip (alt_u32 nticks);
+
 #ifdef __cplusplus
 }
 #endif
@@ -53,10 +53,38 @@ volatile alt_u32 _alt_nticks = 0;
 /*
  * "alt_alarm_list" is the head of a linked list of registered alarms. This is
  * initialised to be an empty list.
+ *
+ * The list is kept sorted by expiry time, so that alt_tick() only has to look
+ * at the alarms at its head. Times are compared modulo 2^32 (see
+ * alt_alarm_expired()), so an alarm can be at most 2^31 - 1 ticks ahead of
+ * the tick counter.
  */
 
 ALT_LLIST_HEAD(alt_alarm_list);
 
+/*
+ * alt_alarm_insert() adds "alarm" to the list of registered alarms, behind
+ * all alarms that expire at the same time or earlier. Alarms that expire
+ * soon are the ones most often inserted, so the search starts at the head.
+ *
+ * alt_alarm_insert() is expected to run with interrupts disabled.
+ */
+
+void alt_alarm_insert (alt_alarm* alarm)
+{
+  alt_llist* entry = alt_alarm_list.next;
+
+  while ((entry != &alt_alarm_list) &&
+         ((alt_32) (((alt_alarm*) entry)->time - alarm->time) <= 0))
+  {
+    entry = entry->next;
+  }
+
+  /* insert in front of "entry" */
+
+  alt_llist_insert (entry->previous, &alarm->llist);
+}
+
 /*
  * alt_alarm_stop() is called to remove an alarm from the list of registered 
  * alarms. Alternatively an alarm can unregister itself by returning zero when 
@@ -86,7 +114,6 @@ void alt_alarm_stop (alt_alarm* alarm)
 
 void alt_tick (void)
 {
-  alt_alarm* next;
   alt_alarm* alarm = (alt_alarm*) alt_alarm_list.next;
 
   alt_u32    next_callback;
@@ -95,49 +122,35 @@ void alt_tick (void)
 
   _alt_nticks++;
 
-  /* process the registered callbacks */
+  /* 
+   * Process the registered callbacks. The list is sorted by expiry time, so
+   * this stops at the first alarm that has not expired.
+   */
 
-  while (alarm != (alt_alarm*) &alt_alarm_list)
+  while ((alarm != (alt_alarm*) &alt_alarm_list) &&
+         alt_alarm_expired (alarm, _alt_nticks))
   {
-    next = (alt_alarm*) alarm->llist.next;
+    next_callback = alarm->callback (alarm->context);
 
-    /* 
-     * Upon the tick-counter rolling over it is safe to clear the 
-     * roll-over flag; once the flag is cleared this (or subsequnt)
-     * tick events are enabled to generate an alarm event. 
-     */
-    if ((alarm->rollover) && (_alt_nticks == 0))
+    /* deactivate the alarm if the return value is zero */
+
+    if (next_callback == 0)
     {
-      alarm->rollover = 0;
+      alt_alarm_stop (alarm);
     }
-    
-    /* if the alarm period has expired, make the callback */    
-    if ((alarm->time <= _alt_nticks) && (alarm->rollover == 0))
+
+    /* 
+     * Otherwise move it to its new place in the list, unless the callback
+     * has stopped it. 
+     */
+
+    else if (alarm->llist.next != &alarm->llist)
     {
-      next_callback = alarm->callback (alarm->context);
-
-      /* deactivate the alarm if the return value is zero */
-
-      if (next_callback == 0)
-      {
-        alt_alarm_stop (alarm);
-      }
-      else
-      {
-        alarm->time += next_callback;
-        
-        /* 
-         * If the desired alarm time causes a roll-over, set the rollover
-         * flag. This will prevent the subsequent tick event from causing
-         * an alarm too early.
-         */
-        if(alarm->time < _alt_nticks)
-        {
-          alarm->rollover = 1;
-        }
-      }
+      alt_llist_remove (&alarm->llist);
+      alarm->time += next_callback;
+      alt_alarm_insert (alarm);
     }
-    alarm = next;
+    alarm = (alt_alarm*) alt_alarm_list.next;
   }
 
   /* 
@@ -147,3 +160,59 @@ void alt_tick (void)
   ALT_OS_TIME_TICK();
 }
 
+/*
+ * alt_tick_next() is called by a system clock driver that can hold off its
+ * interrupt while the system is idle. It returns the number of ticks until
+ * the next call to alt_tick() that has work to do: the first alarm that
+ * expires, or the next tick the operating system has to process. The result
+ * is at least one; 0xffffffff means that nothing is waiting for a tick.
+ *
+ * alt_tick_next() is expected to run with interrupts disabled.
+ */
+
+alt_u32 alt_tick_next (void)
+{
+  alt_alarm* alarm = (alt_alarm*) alt_alarm_list.next;
+  alt_u32    next  = 0xffffffff;
+#ifdef ALT_OS_TIME_TICK_NEXT
+  alt_u32    remain;
+#endif
+
+  /* the alarm at the head of the list expires first */
+
+  if (alarm != (alt_alarm*) &alt_alarm_list)
+  {
+    next = alt_alarm_expired (alarm, _alt_nticks + 1) ? 
+             1 : alarm->time - _alt_nticks;
+  }
+
+#ifdef ALT_OS_TIME_TICK_NEXT
+  remain = ALT_OS_TIME_TICK_NEXT();
+
+  if (remain < next)
+  {
+    next = remain;
+  }
+#endif
+
+  return next;
+}
+
+/*
+ * alt_tick_skip() is called by the system clock driver for "nticks" ticks
+ * that passed without an interrupt. "nticks" must be less than the value
+ * alt_tick_next() returned before the interrupt was held off, so no alarm
+ * can expire within them; the tick that ends the idle period is passed to
+ * alt_tick() as usual.
+ *
+ * alt_tick_skip() is expected to run with interrupts disabled.
+ */
+
+void alt_tick_skip (alt_u32 nticks)
+{
+  _alt_nticks += nticks;
+
+#ifdef ALT_OS_TIME_TICK_SKIP
+  ALT_OS_TIME_TICK_SKIP (nticks);
+#endif
+}
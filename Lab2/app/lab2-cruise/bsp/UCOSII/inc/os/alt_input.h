@@ -0,0 +1,118 @@
+#ifndef __ALT_INPUT_H__
+#define __ALT_INPUT_H__
+
+/******************************************************************************
+*                                                                             *
+* Debounced PIO inputs for uC/OS-II.                                          *
+*                                                                             *
+******************************************************************************/
+
+/*
+ * Polling the keys and switches from a periodic task costs a wake-up every
+ * period whether anything changed or not, and a change is seen up to one
+ * period late. An alt_input instead waits for the edge capture interrupt of
+ * its PIO:
+ *
+ * 1. The ISR clears the edge capture register and starts the debounce alarm,
+ *    unless it is running already.
+ * 2. The alarm samples the data register on every system clock tick. Once
+ *    the inputs have read the same for ALT_INPUT_DEBOUNCE_MS, the sample is
+ *    taken as the new state and the alarm stops.
+ * 3. The inputs that differ from the previous state are posted to the event
+ *    flag group of the alt_input, one flag per PIO bit. Nothing is posted
+ *    when the inputs settle back to where they were.
+ *
+ * A PIO that only captures the edge of an input becoming active (e.g. the
+ * falling edge of the active low DE2 keys) raises no interrupt on release,
+ * so with ALT_INPUT_EDGE_ACTIVE the alarm keeps sampling for as long as any
+ * input is active.
+ *
+ * The state is kept active high: the bits in 'invert' are inverted when the
+ * data register is read. Only the bits in 'mask' are used; they must be
+ * among the OS_FLAGS_NBITS low bits, as each one maps onto the flag of the
+ * same number.
+ *
+ * Example:
+ *
+ * static alt_input keys;
+ *
+ * alt_input_open (&keys, D2_PIO_KEYS4_BASE,
+ *                 D2_PIO_KEYS4_IRQ_INTERRUPT_CONTROLLER_ID, D2_PIO_KEYS4_IRQ,
+ *                 0xf, 0xf, ALT_INPUT_EDGE_ACTIVE);
+ * while (1)
+ * {
+ *   state = alt_input_state (&keys);
+ *   ...
+ *   alt_input_wait (&keys, 0xf, 0, &err);
+ * }
+ */
+
+#include "includes.h"
+#include "alt_types.h"
+#include "sys/alt_alarm.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/*
+ * Time an input has to stay put before a change is accepted.
+ */
+
+#ifndef ALT_INPUT_DEBOUNCE_MS
+#define ALT_INPUT_DEBOUNCE_MS 5
+#endif
+
+/*
+ * Edges captured by the PIO, as selected in SOPC builder.
+ */
+
+#define ALT_INPUT_EDGE_ANY    0  /* both edges, "ANY"                   */
+#define ALT_INPUT_EDGE_ACTIVE 1  /* only the edge to the active level   */
+
+typedef struct alt_input_s alt_input;
+
+struct alt_input_s
+{
+  alt_u32          base;        /* PIO base address                      */
+  alt_u32          mask;        /* inputs in use                         */
+  alt_u32          invert;      /* inputs that are active low            */
+  int              edge;        /* ALT_INPUT_EDGE_ANY or _ACTIVE         */
+  OS_FLAG_GRP*     flags;       /* set for each input that changed       */
+  volatile alt_u32 state;       /* debounced inputs, 1 = active          */
+  alt_u32          sample;      /* sample taken on the previous tick     */
+  alt_u32          stable;      /* ticks 'sample' has been unchanged     */
+  alt_u32          settle;      /* ticks needed to accept a change       */
+  alt_u32          running;     /* the debounce alarm is registered      */
+  alt_alarm        alarm;
+};
+
+/*
+ * alt_input_open() reads the initial state, creates the flag group and
+ * registers the ISR; it returns 0, or a negative value if the flag group or
+ * the interrupt could not be set up.
+ *
+ * alt_input_state() returns the debounced state.
+ *
+ * alt_input_wait() pends until one of the inputs in 'which' has changed and
+ * returns those that did, consuming their flags. 'timeout' and 'perr' are
+ * those of OSFlagPend().
+ */
+
+extern int      alt_input_open  (alt_input* input, alt_u32 base,
+                                 alt_u32 ic_id, alt_u32 irq, alt_u32 mask,
+                                 alt_u32 invert, int edge);
+extern OS_FLAGS alt_input_wait  (alt_input* input, OS_FLAGS which,
+                                 INT16U timeout, INT8U* perr);
+
+static ALT_INLINE alt_u32 ALT_ALWAYS_INLINE alt_input_state (alt_input* input)
+{
+  return input->state;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __ALT_INPUT_H__ */
@@ -0,0 +1,96 @@
+#ifndef __ALT_SLAB_H__
+#define __ALT_SLAB_H__
+
+/******************************************************************************
+*                                                                             *
+* Size class slab allocator for uC/OS-II.                                     *
+*                                                                             *
+******************************************************************************/
+
+/*
+ * Every malloc() of newlib runs its general purpose allocator on top of
+ * alt_sbrk(), behind the single alt_heapsem semaphore of alt_malloc_lock.c:
+ * a task that is preempted inside malloc() holds up every other task that
+ * allocates. With ALT_SLAB_EN set, malloc(), calloc(), realloc() and free()
+ * serve small blocks from uC/OS-II memory partitions instead:
+ *
+ * 1. There is one partition per size class, ALT_SLAB_CLASSES powers of two
+ *    from ALT_SLAB_MIN bytes on, with ALT_SLAB_BLOCKS blocks each, all in
+ *    one static arena. The partitions are created by ALT_OS_INIT() right
+ *    after OSInit().
+ * 2. A request takes a block of the smallest class it fits in with
+ *    OSMemGet(), which only disables the interrupts to pop the free list of
+ *    that class. If that class is used up the next larger ones are tried.
+ * 3. Larger requests, and those no class has a block left for, go to the
+ *    newlib heap as before. So do requests made before ALT_OS_INIT().
+ * 4. free() tells the two apart by the address: a block in the arena is put
+ *    back into the partition of its class with OSMemPut().
+ *
+ * The blocks of the arena are aligned to ALT_SLAB_MIN bytes, up to 16. They
+ * are never split or merged, so the arena does not fragment; OSMemQuery()
+ * on alt_slab_partition() shows how much of a class is in use.
+ *
+ * malloc() is still not safe in an ISR, as any request may end up in the
+ * heap once its class is used up.
+ *
+ * On the host port the wrappers of src/alt_libc_lock.c do the same.
+ */
+
+#include <stddef.h>
+
+#include "includes.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+#ifndef ALT_SLAB_EN
+#define ALT_SLAB_EN      0
+#endif
+
+#ifndef ALT_SLAB_MIN
+#define ALT_SLAB_MIN     16     /* size of the smallest class, power of 2 */
+#endif
+
+#ifndef ALT_SLAB_CLASSES
+#define ALT_SLAB_CLASSES 5      /* 16 to 256 bytes                        */
+#endif
+
+#ifndef ALT_SLAB_BLOCKS
+#define ALT_SLAB_BLOCKS  32     /* blocks per class                       */
+#endif
+
+#define ALT_SLAB_MAX     (ALT_SLAB_MIN << (ALT_SLAB_CLASSES - 1))
+
+/*
+ * alt_slab_init() creates the partitions; it is called by ALT_OS_INIT().
+ *
+ * alt_slab_alloc() returns a block of at least 'size' bytes, or NULL if the
+ * request has to go to the heap.
+ *
+ * alt_slab_size() returns the size of the class of 'ptr', or 0 if 'ptr' is
+ * not a block of the arena.
+ *
+ * alt_slab_free() puts 'ptr' back and returns 1 if it is a block of the
+ * arena, and returns 0 otherwise.
+ *
+ * alt_slab_realloc() is realloc() of a block of the arena: it returns the
+ * block itself if 'size' still fits, or moves it to one from malloc().
+ *
+ * alt_slab_partition() returns the partition of class 'c', 0 being the
+ * smallest, for OSMemQuery().
+ */
+
+extern void    alt_slab_init      (void);
+extern void*   alt_slab_alloc     (size_t size);
+extern size_t  alt_slab_size      (void* ptr);
+extern int     alt_slab_free      (void* ptr);
+extern void*   alt_slab_realloc   (void* ptr, size_t size);
+extern OS_MEM* alt_slab_partition (int c);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __ALT_SLAB_H__ */
@@ -0,0 +1,115 @@
+#ifndef __ALT_STKPROF_H__
+#define __ALT_STKPROF_H__
+
+/******************************************************************************
+*                                                                             *
+* Stack profiling for uC/OS-II.                                               *
+*                                                                             *
+******************************************************************************/
+
+/*
+ * Task stacks are usually sized by guessing, and a guess that is safe for
+ * every task wastes most of the memory. The stack profiler measures the
+ * deepest use of each task while the application runs through a workload,
+ * and prints a header with a stack size per task:
+ *
+ * 1. The application creates its tasks with OS_TASK_OPT_STK_CHK and large
+ *    stacks, and registers them with alt_stkprof_add().
+ * 2. One of the tasks, e.g. the one that created the others, calls
+ *    alt_stkprof_run() instead of going on with its work, so that the
+ *    profiler takes no TCB of its own. It samples the deepest use of every
+ *    registered task with OSTaskStkChk() every ALT_STKPROF_PERIOD ticks.
+ *    OSTaskStkChk() sees the deepest use since the task was created, so the
+ *    samples only matter for tasks that are deleted before the end; a task
+ *    that deletes itself should call alt_stkprof_sample() first.
+ * 3. After the given number of ticks it prints the header to stdout. Each
+ *    task gets the deepest use plus ALT_STKPROF_MARGIN percent, rounded up
+ *    to 8 words and at least ALT_STKPROF_MIN words. Going by priority, the
+ *    stacks that still fit in ALT_STKPROF_FAST_SIZE bytes are placed in the
+ *    ALT_STKPROF_FAST_SECTION section, i.e. the on-chip memory.
+ *
+ * On the host port the stacks of the tasks are host stacks with x86-64
+ * frames, and interrupts run on them with the signal frame of the host;
+ * the process exits after the report. Those sizes say little about the
+ * Nios II frames, so a header made on the host gives them to the host
+ * build only: on the board every stack keeps at least
+ * ALT_STKPROF_UNCHECKED words, with its margin over the host profile in
+ * the comment, until a header made on the board replaces it. On the board
+ * the calling task deletes itself after the report.
+ *
+ * With "CRUISE" as the prefix and "CONTROL" as the name of a task, the
+ * header is
+ *
+ *   #ifndef __CRUISE_STACKS_H__
+ *   #define __CRUISE_STACKS_H__
+ *   ...
+ *   #define CONTROL_STACKSIZE         416  -- 1204 bytes used
+ *   #define CONTROL_STACK_SECTION     CRUISE_STACKS_FAST
+ *   ...
+ *
+ * where CRUISE_STACKS_FAST is the section attribute, left empty on the
+ * host port, and the stack is declared as
+ *
+ *   OS_STK Control_Stack[CONTROL_STACKSIZE] CONTROL_STACK_SECTION;
+ */
+
+#include "alt_types.h"
+#include "system.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+#ifndef ALT_STKPROF_TASKS
+#define ALT_STKPROF_TASKS        16      /* tasks that can be registered    */
+#endif
+
+#ifndef ALT_STKPROF_PERIOD
+#define ALT_STKPROF_PERIOD       100     /* ticks between two samples       */
+#endif
+
+#ifndef ALT_STKPROF_MARGIN
+#define ALT_STKPROF_MARGIN       25      /* percent on top of the deepest use */
+#endif
+
+#ifndef ALT_STKPROF_MIN
+#define ALT_STKPROF_MIN          256     /* smallest stack, in OS_STK words */
+#endif
+
+#ifndef ALT_STKPROF_UNCHECKED
+#define ALT_STKPROF_UNCHECKED    2048    /* board stacks of a host profile  */
+#endif
+
+#ifndef ALT_STKPROF_FAST_SIZE
+#ifdef ONCHIP_MEMORY_SPAN
+#define ALT_STKPROF_FAST_SIZE    ONCHIP_MEMORY_SPAN
+#else
+#define ALT_STKPROF_FAST_SIZE    0
+#endif
+#endif
+
+#ifndef ALT_STKPROF_FAST_SECTION
+#define ALT_STKPROF_FAST_SECTION ".onchip_memory"
+#endif
+
+/*
+ * alt_stkprof_add() registers the task of priority 'prio' under 'name',
+ * which prefixes its macros in the header. It returns -1 if
+ * ALT_STKPROF_TASKS tasks are registered already.
+ *
+ * alt_stkprof_sample() samples the deepest use of every registered task.
+ *
+ * alt_stkprof_run() samples for 'ticks' ticks and prints the header with
+ * the given prefix; it does not return.
+ */
+
+extern int  alt_stkprof_add    (alt_u8 prio, const char* name);
+extern void alt_stkprof_sample (void);
+extern void alt_stkprof_run    (alt_u32 ticks, const char* prefix);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __ALT_STKPROF_H__ */
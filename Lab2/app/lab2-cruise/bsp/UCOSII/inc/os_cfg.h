@@ -45,6 +45,26 @@ extern "C"
                                        /* ---------------------- MISCELLANEOUS ----------------------- */
 #define OS_APP_HOOKS_EN           1    /* Application-defined hooks are called from the uC/OS-II hooks */
 #define OS_EVENT_MULTI_EN         1    /* Include code for OSEventPendMulti()                          */
+#ifndef OS_MEM_WORD_EN                 /* OS_MemClr(), OS_MemCopy() and OS_TaskStkClr() move 32 bit    */
+#define OS_MEM_WORD_EN            1    /* ... words, 4 at a time (0 = a byte or stack entry at a time) */
+#endif
+#ifndef OS_RDY_BITMAP_EN               /* Use 32 bit ready and event wait lists searched with          */
+#define OS_RDY_BITMAP_EN          0    /* ... OS_CPU_CTZ(), which also makes OS_LOWEST_PRIO > 63 cheap */
+#endif
+#ifndef OS_TRACE_EN                    /* Record context switches, interrupts, posts, pends and timer  */
+#define OS_TRACE_EN               0    /* ... expiries in the OSTrace ring buffer (see OS_TRACE.C)     */
+#endif
+#ifndef OS_TRACE_BUF_SIZE
+#define OS_TRACE_BUF_SIZE      4096    /* Number of records in the trace ring buffer (power of 2)      */
+#endif
+
+                                       /* --------------------- MEMORY MANAGEMENT -------------------- */
+#ifndef OS_MEM_LOCK_FREE_EN            /*     Pop and push the free lists of the memory partitions     */
+#define OS_MEM_LOCK_FREE_EN       0    /*     ... with OS_CPU_CAS() where the port has it              */
+#endif
+#ifndef OS_MEM_STATS_EN                /*     Keep the high water mark, failures and mean hold time of */
+#define OS_MEM_STATS_EN           0    /*     ... the blocks of each partition                         */
+#endif
 
                                        /* -------------------- MESSAGE MAILBOXES --------------------- */
 #define OS_MBOX_PEND_ABORT_EN     1    /*     Include code for OSMboxPendAbort()                       */
@@ -55,6 +75,41 @@ extern "C"
                                        /* ------------------------ SEMAPHORES ------------------------ */
 #define OS_SEM_PEND_ABORT_EN      1    /*    Include code for OSSemPendAbort()                         */
 
+                                       /* ---------------------- STATE REGISTERS --------------------- */
+#ifndef OS_REG_EN                      /* Enable (1) or Disable (0) code generation for STATE REGISTERS*/
+#define OS_REG_EN                 1    /* ... latest values read without a pend (see OS_REG.C)         */
+#endif
+#ifndef OS_MAX_REGS
+#define OS_MAX_REGS               8    /*     Max. number of state registers in your application       */
+#endif
+
+                                       /* --------------------- TASK MANAGEMENT ---------------------- */
+#ifndef OS_TASK_PROFILE_WIN            /*     Number of statistic task periods (1/10 s) over which the */
+#define OS_TASK_PROFILE_WIN      10    /*     ... CPU usage of each task is measured (0 = not measured)*/
+#endif
+#ifndef OS_TASK_STAT_CYCLES_EN         /*     Measure the CPU usage from the cycles the idle task ran, */
+#define OS_TASK_STAT_CYCLES_EN    0    /*     ... no OSStatInit() calibration (needs OS_TASK_PROFILE_EN)*/
+#endif
+#ifndef OS_TASK_STAT_HIST_SIZE
+#define OS_TASK_STAT_HIST_SIZE   10    /*     Number of bands in the histogram of the CPU usage        */
+#endif
+#ifndef OS_TASK_STK_WATERMARK_EN       /*     OSTaskStkChk() reuses the last result for a task that was*/
+#define OS_TASK_STK_WATERMARK_EN  1    /*     ... not switched in since (needs OS_TASK_PROFILE_EN)     */
+#endif
+
+                                       /* --------------------- TIME MANAGEMENT ---------------------- */
+#ifndef OS_TIME_DLY_LIST_EN            /*     Keep delayed tasks in a list sorted by expiry, so that   */
+#define OS_TIME_DLY_LIST_EN       1    /*     ... OSTimeTick() only visits the tasks that expire       */
+#endif
+#ifndef OS_TICKLESS_EN                 /*     Stop the tick interrupt while the idle task runs, up to  */
+#define OS_TICKLESS_EN            0    /*     ... the next tick that has work to do                    */
+#endif
+
+                                       /* --------------------- TIMER MANAGEMENT --------------------- */
+#ifndef OS_TMR_CFG_WHEEL2_SIZE         /*     Size of a second timer wheel for timers that expire in a */
+#define OS_TMR_CFG_WHEEL2_SIZE    0    /*     ... later turn of the first one (power of 2, 0 = none)   */
+#endif
+
                                                                                                                      
 #include "system.h"
 
@@ -78,13 +78,20 @@ extern "C" {
 #define  OS_TASK_STAT_PRIO  (OS_LOWEST_PRIO - 1)        /* Statistic task priority                     */
 #define  OS_TASK_IDLE_PRIO  (OS_LOWEST_PRIO)            /* IDLE      task priority                     */
 
-#if OS_LOWEST_PRIO <= 63
-#define  OS_EVENT_TBL_SIZE ((OS_LOWEST_PRIO) / 8 + 1)   /* Size of event table                         */
-#define  OS_RDY_TBL_SIZE   ((OS_LOWEST_PRIO) / 8 + 1)   /* Size of ready table                         */
+#if OS_RDY_BITMAP_EN > 0                                /* Ready list and event wait list entries ...  */
+typedef  INT32U  OS_PRIO;                               /* ... hold 32 priorities each                 */
+#define  OS_PRIO_SHIFT                5u
+#elif OS_LOWEST_PRIO <= 63
+typedef  INT8U   OS_PRIO;                               /* ... hold  8 priorities each                 */
+#define  OS_PRIO_SHIFT                3u
 #else
-#define  OS_EVENT_TBL_SIZE ((OS_LOWEST_PRIO) / 16 + 1)  /* Size of event table                         */
-#define  OS_RDY_TBL_SIZE   ((OS_LOWEST_PRIO) / 16 + 1)  /* Size of ready table                         */
+typedef  INT16U  OS_PRIO;                               /* ... hold 16 priorities each                 */
+#define  OS_PRIO_SHIFT                4u
 #endif
+#define  OS_PRIO_MASK      ((1u << OS_PRIO_SHIFT) - 1u) /* Bit of a priority within its entry          */
+
+#define  OS_EVENT_TBL_SIZE ((OS_LOWEST_PRIO >> OS_PRIO_SHIFT) + 1)  /* Size of event table             */
+#define  OS_RDY_TBL_SIZE   ((OS_LOWEST_PRIO >> OS_PRIO_SHIFT) + 1)  /* Size of ready table             */
 
 #define  OS_TASK_IDLE_ID          65535u                /* ID numbers for Idle, Stat and Timer tasks   */
 #define  OS_TASK_STAT_ID          65534u
@@ -92,6 +99,16 @@ extern "C" {
 
 #define  OS_EVENT_EN           (((OS_Q_EN > 0) && (OS_MAX_QS > 0)) || (OS_MBOX_EN > 0) || (OS_SEM_EN > 0) || (OS_MUTEX_EN > 0))
 
+#define  OS_TASK_CPU_USAGE_EN  ((OS_TASK_STAT_EN > 0) && (OS_TASK_PROFILE_EN > 0) && (OS_TASK_PROFILE_WIN > 0))
+
+#define  OS_TASK_STAT_CYCLES   ((OS_TASK_STAT_EN > 0) && (OS_TASK_STAT_CYCLES_EN > 0))
+
+#if (OS_MEM_LOCK_FREE_EN > 0) && defined(OS_CPU_CAS)
+#define  OS_MEM_LOCK_FREE      1                        /* Free lists of the partitions use OS_CPU_CAS() */
+#else
+#define  OS_MEM_LOCK_FREE      0
+#endif
+
 #define  OS_TCB_RESERVED        ((OS_TCB *)1)
 
 /*$PAGE*/
@@ -332,6 +349,10 @@ extern "C" {
 #define OS_ERR_TMR_STOPPED          142u
 #define OS_ERR_TMR_NO_CALLBACK      143u
 
+#define OS_ERR_REG_INVALID_PREG     150u
+#define OS_ERR_REG_INVALID_SIZE     151u
+#define OS_ERR_REG_DEPLETED         152u
+
 /*
 *********************************************************************************************************
 *                                    OLD ERROR CODE NAMES (< V2.84)
@@ -390,13 +411,8 @@ typedef struct os_event {
     INT8U    OSEventType;                    /* Type of event control block (see OS_EVENT_TYPE_xxxx)    */
     void    *OSEventPtr;                     /* Pointer to message or queue structure                   */
     INT16U   OSEventCnt;                     /* Semaphore Count (not used if other EVENT type)          */
-#if OS_LOWEST_PRIO <= 63
-    INT8U    OSEventGrp;                     /* Group corresponding to tasks waiting for event to occur */
-    INT8U    OSEventTbl[OS_EVENT_TBL_SIZE];  /* List of tasks waiting for event to occur                */
-#else
-    INT16U   OSEventGrp;                     /* Group corresponding to tasks waiting for event to occur */
-    INT16U   OSEventTbl[OS_EVENT_TBL_SIZE];  /* List of tasks waiting for event to occur                */
-#endif
+    OS_PRIO  OSEventGrp;                     /* Group corresponding to tasks waiting for event to occur */
+    OS_PRIO  OSEventTbl[OS_EVENT_TBL_SIZE];  /* List of tasks waiting for event to occur                */
 
 #if OS_EVENT_NAME_SIZE > 1
     INT8U    OSEventName[OS_EVENT_NAME_SIZE];
@@ -461,13 +477,8 @@ typedef struct os_flag_node {               /* Event Flag Wait List Node
 #if OS_MBOX_EN > 0
 typedef struct os_mbox_data {
     void   *OSMsg;                         /* Pointer to message in mailbox                            */
-#if OS_LOWEST_PRIO <= 63
-    INT8U   OSEventTbl[OS_EVENT_TBL_SIZE]; /* List of tasks waiting for event to occur                 */
-    INT8U   OSEventGrp;                    /* Group corresponding to tasks waiting for event to occur  */
-#else
-    INT16U  OSEventTbl[OS_EVENT_TBL_SIZE]; /* List of tasks waiting for event to occur                 */
-    INT16U  OSEventGrp;                    /* Group corresponding to tasks waiting for event to occur  */
-#endif
+    OS_PRIO OSEventTbl[OS_EVENT_TBL_SIZE]; /* List of tasks waiting for event to occur                 */
+    OS_PRIO OSEventGrp;                    /* Group corresponding to tasks waiting for event to occur  */
 } OS_MBOX_DATA;
 #endif
 
@@ -487,6 +498,15 @@ typedef struct os_mem {                   /* MEMORY CONTROL BLOCK
 #if OS_MEM_NAME_SIZE > 1
     INT8U   OSMemName[OS_MEM_NAME_SIZE];  /* Memory partition name                                     */
 #endif
+#if OS_MEM_LOCK_FREE
+    volatile INT64U OSMemHead;            /* Free list: tag << 32 | offset of first block + 1 (0=none) */
+#endif
+#if OS_MEM_STATS_EN > 0
+    INT64U  OSMemUseTicks;                /* Sum over the ticks of the number of blocks used           */
+    INT32U  OSMemNGet;                    /* Number of blocks handed out                               */
+    INT32U  OSMemNFail;                   /* Number of OSMemGet() that found no free block             */
+    INT32U  OSMemNUsedMax;                /* Highest number of blocks used at once                     */
+#endif
 } OS_MEM;
 
 
@@ -497,9 +517,29 @@ typedef struct os_mem_data {
     INT32U  OSNBlks;                   /* Total number of blocks in the partition                      */
     INT32U  OSNFree;                   /* Number of memory blocks free                                 */
     INT32U  OSNUsed;                   /* Number of memory blocks used                                 */
+#if OS_MEM_STATS_EN > 0
+    INT32U  OSNUsedMax;                /* Highest number of memory blocks used at once                 */
+    INT32U  OSNGet;                    /* Number of memory blocks handed out                           */
+    INT32U  OSNFail;                   /* Number of requests that found no free memory block           */
+    INT32U  OSHoldMean;                /* Mean time a memory block is held, in microseconds            */
+#endif
 } OS_MEM_DATA;
 #endif
 
+/*
+*********************************************************************************************************
+*                                      STATE REGISTER DATA STRUCTURES
+*********************************************************************************************************
+*/
+
+#if (OS_REG_EN > 0) && (OS_MAX_REGS > 0)
+typedef struct os_reg {                   /* STATE REGISTER CONTROL BLOCK                              */
+    void            *OSRegData;           /* Storage of the value, or next free register when unused  */
+    INT16U           OSRegSize;           /* Size (in bytes) of the value                              */
+    volatile INT32U  OSRegSeq;            /* Twice the number of writes, odd while a write is going on */
+} OS_REG;
+#endif
+
 /*$PAGE*/
 /*
 *********************************************************************************************************
@@ -509,13 +549,8 @@ typedef struct os_mem_data {
 
 #if OS_MUTEX_EN > 0
 typedef struct os_mutex_data {
-#if OS_LOWEST_PRIO <= 63
-    INT8U   OSEventTbl[OS_EVENT_TBL_SIZE];  /* List of tasks waiting for event to occur                */
-    INT8U   OSEventGrp;                     /* Group corresponding to tasks waiting for event to occur */
-#else
-    INT16U  OSEventTbl[OS_EVENT_TBL_SIZE];  /* List of tasks waiting for event to occur                */
-    INT16U  OSEventGrp;                     /* Group corresponding to tasks waiting for event to occur */
-#endif
+    OS_PRIO OSEventTbl[OS_EVENT_TBL_SIZE];  /* List of tasks waiting for event to occur                */
+    OS_PRIO OSEventGrp;                     /* Group corresponding to tasks waiting for event to occur */
     BOOLEAN OSValue;                        /* Mutex value (OS_FALSE = used, OS_TRUE = available)      */
     INT8U   OSOwnerPrio;                    /* Mutex owner's task priority or 0xFF if no owner         */
     INT8U   OSMutexPIP;                     /* Priority Inheritance Priority or 0xFF if no owner       */
@@ -544,13 +579,8 @@ typedef struct os_q_data {
     void          *OSMsg;               /* Pointer to next message to be extracted from queue          */
     INT16U         OSNMsgs;             /* Number of messages in message queue                         */
     INT16U         OSQSize;             /* Size of message queue                                       */
-#if OS_LOWEST_PRIO <= 63
-    INT8U          OSEventTbl[OS_EVENT_TBL_SIZE];  /* List of tasks waiting for event to occur         */
-    INT8U          OSEventGrp;          /* Group corresponding to tasks waiting for event to occur     */
-#else
-    INT16U         OSEventTbl[OS_EVENT_TBL_SIZE];  /* List of tasks waiting for event to occur         */
-    INT16U         OSEventGrp;          /* Group corresponding to tasks waiting for event to occur     */
-#endif
+    OS_PRIO        OSEventTbl[OS_EVENT_TBL_SIZE];  /* List of tasks waiting for event to occur         */
+    OS_PRIO        OSEventGrp;          /* Group corresponding to tasks waiting for event to occur     */
 } OS_Q_DATA;
 #endif
 
@@ -563,13 +593,8 @@ typedef struct os_q_data {
 #if OS_SEM_EN > 0
 typedef struct os_sem_data {
     INT16U  OSCnt;                          /* Semaphore count                                         */
-#if OS_LOWEST_PRIO <= 63
-    INT8U   OSEventTbl[OS_EVENT_TBL_SIZE];  /* List of tasks waiting for event to occur                */
-    INT8U   OSEventGrp;                     /* Group corresponding to tasks waiting for event to occur */
-#else
-    INT16U  OSEventTbl[OS_EVENT_TBL_SIZE];  /* List of tasks waiting for event to occur                */
-    INT16U  OSEventGrp;                     /* Group corresponding to tasks waiting for event to occur */
-#endif
+    OS_PRIO OSEventTbl[OS_EVENT_TBL_SIZE];  /* List of tasks waiting for event to occur                */
+    OS_PRIO OSEventGrp;                     /* Group corresponding to tasks waiting for event to occur */
 } OS_SEM_DATA;
 #endif
 
@@ -626,20 +651,22 @@ typedef struct os_tcb {
     OS_FLAGS         OSTCBFlagsRdy;         /* Event flags that made task ready to run                 */
 #endif
 
+#if OS_TIME_DLY_LIST_EN > 0
+    struct os_tcb   *OSTCBDlyNext;          /* Pointer to next     TCB in the delayed task list        */
+    struct os_tcb   *OSTCBDlyPrev;          /* Pointer to previous TCB in the delayed task list        */
+    INT32U           OSTCBDlyTick;          /* Value of OSTickCtr at which the delay expires           */
+#endif
     INT16U           OSTCBDly;              /* Nbr ticks to delay task or, timeout waiting for event   */
+                                            /* ... not counted down with OS_TIME_DLY_LIST_EN, see      */
+                                            /* ... OSTaskQuery() for the ticks left                    */
     INT8U            OSTCBStat;             /* Task      status                                        */
     INT8U            OSTCBStatPend;         /* Task PEND status                                        */
     INT8U            OSTCBPrio;             /* Task priority (0 == highest)                            */
 
     INT8U            OSTCBX;                /* Bit position in group  corresponding to task priority   */
     INT8U            OSTCBY;                /* Index into ready table corresponding to task priority   */
-#if OS_LOWEST_PRIO <= 63
-    INT8U            OSTCBBitX;             /* Bit mask to access bit position in ready table          */
-    INT8U            OSTCBBitY;             /* Bit mask to access bit position in ready group          */
-#else
-    INT16U           OSTCBBitX;             /* Bit mask to access bit position in ready table          */
-    INT16U           OSTCBBitY;             /* Bit mask to access bit position in ready group          */
-#endif
+    OS_PRIO          OSTCBBitX;             /* Bit mask to access bit position in ready table          */
+    OS_PRIO          OSTCBBitY;             /* Bit mask to access bit position in ready group          */
 
 #if OS_TASK_DEL_EN > 0
     INT8U            OSTCBDelReq;           /* Indicates whether a task needs to delete itself         */
@@ -651,6 +678,16 @@ typedef struct os_tcb {
     INT32U           OSTCBCyclesStart;      /* Snapshot of cycle counter at start of task resumption   */
     OS_STK          *OSTCBStkBase;          /* Pointer to the beginning of the task stack              */
     INT32U           OSTCBStkUsed;          /* Number of bytes used from the stack                     */
+#if OS_TASK_STK_WATERMARK_EN > 0
+    INT32U           OSTCBStkFree;          /* Free stack elements found by the last OSTaskStkChk()    */
+    INT32U           OSTCBStkChkCtr;        /* OSTCBCtxSwCtr at that check                             */
+#endif
+#endif
+
+#if OS_TASK_CPU_USAGE_EN
+    INT32U           OSTCBCyclesWin[OS_TASK_PROFILE_WIN];  /* OSTCBCyclesTot at each window period     */
+    INT32U           OSTCBCyclesRun;        /* Cycles the task ran in the last window                  */
+    INT16U           OSTCBCPUUsage;         /* CPU usage over the window (units are 0.01 %)            */
 #endif
 
 #if OS_TASK_NAME_SIZE > 1
@@ -697,6 +734,55 @@ typedef  struct  os_tmr_wheel {
 } OS_TMR_WHEEL;
 #endif
 
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                           EVENT TRACE DATA
+*
+* Note(s): 1) The ring buffer is meant to be dumped as is, e.g. with 'dump binary value trace.bin OSTrace'
+*             in nios2-elf-gdb, and decoded on the host (see app/host/tools/trace2json.c).  The layout
+*             must therefore not change without updating the decoder.
+*********************************************************************************************************
+*/
+
+#if OS_TRACE_EN > 0
+#define  OS_TRACE_MAGIC       0x45435254L   /* "TRCE" in little endian byte order                      */
+
+#define  OS_TRACE_TASK_SW              1u   /* Context switch to the task at priority OSTraceArg        */
+#define  OS_TRACE_INT_ENTER            2u   /* ISR entered, OSTraceArg is the new nesting level         */
+#define  OS_TRACE_INT_EXIT             3u   /* ISR left,    OSTraceArg is the new nesting level         */
+#define  OS_TRACE_SEM_POST             4u   /* OSTraceArg is the index of the event in OSEventTbl[]     */
+#define  OS_TRACE_SEM_PEND             5u   /* ... the pends are recorded when the task has to wait     */
+#define  OS_TRACE_MBOX_POST            6u
+#define  OS_TRACE_MBOX_PEND            7u
+#define  OS_TRACE_Q_POST               8u
+#define  OS_TRACE_Q_PEND               9u
+#define  OS_TRACE_TMR_EXPIRE          10u   /* OSTraceArg is the index of the timer in OSTmrTbl[]       */
+
+typedef struct os_trace_rec {
+    INT32U           OSTraceTime;           /* OSCPUCyclesGet() when the event happened                 */
+    INT8U            OSTraceType;           /* Event type (see OS_TRACE_xxx)                            */
+    INT8U            OSTracePrio;           /* Priority of the running task (OSPrioCur)                 */
+    INT16U           OSTraceArg;            /* Event argument, depends on the type                      */
+} OS_TRACE_REC;
+
+typedef struct os_trace {
+    INT32U           OSTraceMagic;          /* OS_TRACE_MAGIC                                           */
+    INT32U           OSTraceSize;           /* Number of records in OSTraceTbl[] (OS_TRACE_BUF_SIZE)    */
+    INT32U           OSTraceCtr;            /* Number of events recorded, the next goes to Ctr % Size   */
+    INT32U           OSTraceFreq;           /* Frequency of the OSTraceTime counter (Hz)                */
+    INT16U           OSTraceLowestPrio;     /* OS_LOWEST_PRIO, to name the idle and statistic tasks     */
+    INT16U           OSTraceTmrPrio;        /* OS_TASK_TMR_PRIO, 0xFFFF without timer management        */
+    OS_TRACE_REC     OSTraceTbl[OS_TRACE_BUF_SIZE];
+} OS_TRACE;
+
+#define  OS_TRACE(type, arg)            OS_TraceRec((INT8U)(type), (INT16U)(arg))
+#else
+#define  OS_TRACE(type, arg)
+#endif
+
+#define  OS_TRACE_EVENT(type, pevent)   OS_TRACE((type), (pevent) - &OSEventTbl[0])
+
 /*$PAGE*/
 /*
 *********************************************************************************************************
@@ -724,6 +810,19 @@ OS_EXT  BOOLEAN           OSStatRdy;                /* Flag indicating that the
 OS_EXT  OS_STK            OSTaskStatStk[OS_TASK_STAT_STK_SIZE];      /* Statistics task stack          */
 #endif
 
+#if OS_TASK_STAT_CYCLES
+OS_EXT  INT16U            OSCPUUsageFine;           /* CPU usage in the last period (units are 0.01 %) */
+OS_EXT  INT16U            OSCPUUsagePeak;           /* Highest OSCPUUsageFine since OSStatInit()       */
+OS_EXT  INT32U            OSCPUUsageHist[OS_TASK_STAT_HIST_SIZE]; /* Periods per band of CPU usage     */
+OS_EXT  INT32U            OSStatCycles;             /* Cycle counter at the start of the period        */
+OS_EXT  INT32U            OSStatIdleCycles;         /* Idle task's OSTCBCyclesTot at the same time     */
+#endif
+
+#if OS_TASK_CPU_USAGE_EN
+OS_EXT  INT32U            OSCyclesWin[OS_TASK_PROFILE_WIN]; /* Cycle counter at each window period     */
+OS_EXT  INT8U             OSCyclesWinIx;            /* Oldest entry of the window, replaced next       */
+#endif
+
 OS_EXT  INT8U             OSIntNesting;             /* Interrupt nesting level                         */
 
 OS_EXT  INT8U             OSLockNesting;            /* Multitasking lock nesting level                 */
@@ -731,13 +830,8 @@ OS_EXT  INT8U             OSLockNesting;            /* Multitasking lock nesting
 OS_EXT  INT8U             OSPrioCur;                /* Priority of current task                        */
 OS_EXT  INT8U             OSPrioHighRdy;            /* Priority of highest priority task               */
 
-#if OS_LOWEST_PRIO <= 63
-OS_EXT  INT8U             OSRdyGrp;                        /* Ready list group                         */
-OS_EXT  INT8U             OSRdyTbl[OS_RDY_TBL_SIZE];       /* Table of tasks which are ready to run    */
-#else
-OS_EXT  INT16U            OSRdyGrp;                        /* Ready list group                         */
-OS_EXT  INT16U            OSRdyTbl[OS_RDY_TBL_SIZE];       /* Table of tasks which are ready to run    */
-#endif
+OS_EXT  OS_PRIO           OSRdyGrp;                        /* Ready list group                         */
+OS_EXT  OS_PRIO           OSRdyTbl[OS_RDY_TBL_SIZE];       /* Table of tasks which are ready to run    */
 
 OS_EXT  BOOLEAN           OSRunning;                       /* Flag indicating that kernel is running   */
 
@@ -759,11 +853,21 @@ OS_EXT  OS_TCB            OSTCBTbl[OS_MAX_TASKS + OS_N_SYS_TASKS];   /* Table of
 OS_EXT  INT8U             OSTickStepState;          /* Indicates the state of the tick step feature    */
 #endif
 
+#if OS_TIME_DLY_LIST_EN > 0
+OS_EXT  OS_TCB           *OSTCBDlyList;             /* Delayed tasks, sorted by OSTCBDlyTick           */
+OS_EXT  INT32U            OSTickCtr;                /* Ticks processed by OSTimeTick()                 */
+#endif
+
 #if (OS_MEM_EN > 0) && (OS_MAX_MEM_PART > 0)
 OS_EXT  OS_MEM           *OSMemFreeList;            /* Pointer to free list of memory partitions       */
 OS_EXT  OS_MEM            OSMemTbl[OS_MAX_MEM_PART];/* Storage for memory partition manager            */
 #endif
 
+#if (OS_REG_EN > 0) && (OS_MAX_REGS > 0)
+OS_EXT  OS_REG           *OSRegFreeList;            /* Pointer to free list of state registers         */
+OS_EXT  OS_REG            OSRegTbl[OS_MAX_REGS];    /* Table of state registers                        */
+#endif
+
 #if (OS_Q_EN > 0) && (OS_MAX_QS > 0)
 OS_EXT  OS_Q             *OSQFreeList;              /* Pointer to list of free QUEUE control blocks    */
 OS_EXT  OS_Q              OSQTbl[OS_MAX_QS];        /* Table of QUEUE control blocks                   */
@@ -786,6 +890,13 @@ OS_EXT  OS_TMR           *OSTmrFreeList;            /* Pointer to free list of t
 OS_EXT  OS_STK            OSTmrTaskStk[OS_TASK_TMR_STK_SIZE];
 
 OS_EXT  OS_TMR_WHEEL      OSTmrWheelTbl[OS_TMR_CFG_WHEEL_SIZE];
+#if OS_TMR_CFG_WHEEL2_SIZE > 0
+OS_EXT  OS_TMR_WHEEL      OSTmrWheel2Tbl[OS_TMR_CFG_WHEEL2_SIZE];
+#endif
+#endif
+
+#if OS_TRACE_EN > 0
+OS_EXT  OS_TRACE          OSTrace;                  /* Event trace ring buffer                         */
 #endif
 
 extern  INT8U   const     OSUnMapTbl[256];          /* Priority->Index    lookup table                 */
@@ -959,6 +1070,27 @@ INT8U         OSMemQuery              (OS_MEM          *pmem,
 
 #endif
 
+/*
+*********************************************************************************************************
+*                                            STATE REGISTERS
+*********************************************************************************************************
+*/
+
+#if (OS_REG_EN > 0) && (OS_MAX_REGS > 0)
+
+OS_REG       *OSRegCreate             (void            *pdata,
+                                       INT16U           size,
+                                       INT8U           *perr);
+
+INT32U        OSRegRead               (OS_REG          *preg,
+                                       void            *pdata,
+                                       INT8U           *perr);
+
+INT8U         OSRegWrite              (OS_REG          *preg,
+                                       void            *pdata);
+
+#endif
+
 /*
 *********************************************************************************************************
 *                                MUTUAL EXCLUSION SEMAPHORE MANAGEMENT
@@ -1159,6 +1291,11 @@ INT8U         OSTaskQuery             (INT8U            prio,
                                        OS_TCB          *p_task_data);
 #endif
 
+#if OS_TASK_CPU_USAGE_EN
+INT16U        OSTaskCPUUsageGet       (INT8U            prio,
+                                       INT8U           *perr);
+#endif
+
 /*$PAGE*/
 /*
 *********************************************************************************************************
@@ -1186,6 +1323,11 @@ void          OSTimeSet               (INT32U           ticks);
 
 void          OSTimeTick              (void);
 
+#if OS_TICKLESS_EN > 0
+INT32U        OSTimeTickNext          (void);
+void          OSTimeTickSkip          (INT32U           ticks);
+#endif
+
 /*
 *********************************************************************************************************
 *                                            TIMER MANAGEMENT
@@ -1224,6 +1366,11 @@ BOOLEAN      OSTmrStop                (OS_TMR          *ptmr,
                                        INT8U           *perr);
 
 INT8U        OSTmrSignal              (void);
+
+#if OS_TICKLESS_EN > 0
+INT32U       OSTmrSignalNext          (void);
+void         OSTmrSignalSkip          (INT32U           signals);
+#endif
 #endif
 
 /*
@@ -1295,12 +1442,20 @@ void          OS_MemCopy              (INT8U           *pdest,
 
 #if (OS_MEM_EN > 0) && (OS_MAX_MEM_PART > 0)
 void          OS_MemInit              (void);
+
+#if OS_MEM_STATS_EN > 0
+void          OS_MemTick              (INT32U           ticks);
+#endif
 #endif
 
 #if OS_Q_EN > 0
 void          OS_QInit                (void);
 #endif
 
+#if (OS_REG_EN > 0) && (OS_MAX_REGS > 0)
+void          OS_RegInit              (void);
+#endif
+
 void          OS_Sched                (void);
 
 #if (OS_EVENT_NAME_SIZE > 1) || (OS_FLAG_NAME_SIZE > 1) || (OS_MEM_NAME_SIZE > 1) || (OS_TASK_NAME_SIZE > 1)
@@ -1326,6 +1481,26 @@ void          OS_TaskStkClr           (OS_STK          *pbos,
 void          OS_TaskStatStkChk       (void);
 #endif
 
+#if OS_TASK_CPU_USAGE_EN
+void          OS_TaskStatCycles       (void);
+#endif
+
+#if OS_TASK_STAT_CYCLES
+void          OS_TaskStatIdle         (void);
+#endif
+
+#if OS_TRACE_EN > 0
+void          OS_TraceInit            (void);
+
+void          OS_TraceRec             (INT8U            type,
+                                       INT16U           arg);
+#endif
+
+void          OS_TimeDlyInsert        (OS_TCB          *ptcb,
+                                       INT16U           ticks);
+
+void          OS_TimeDlyRemove        (OS_TCB          *ptcb);
+
 INT8U         OS_TCBInit              (INT8U            prio,
                                        OS_STK          *ptos,
                                        OS_STK          *pbos,
@@ -1368,12 +1543,24 @@ OS_STK       *OSTaskStkInit           (void           (*task)(void *p_arg),
 void          OSTaskSwHook            (void);
 #endif
 
+#if OS_TASK_PROFILE_EN > 0
+INT32U        OSCPUCyclesGet          (void);
+INT32U        OSCPUCyclesFreq         (void);
+#endif
+
 void          OSTCBInitHook           (OS_TCB          *ptcb);
 
 #if OS_TIME_TICK_HOOK_EN > 0
 void          OSTimeTickHook          (void);
 #endif
 
+#if OS_TICKLESS_EN > 0
+INT32U        OSTimeTickNextHook      (void);
+void          OSTimeTickSkipHook      (INT32U           ticks);
+void          OSTimeTickSyncHook      (void);
+void          OSTimeTickRearmHook     (void);
+#endif
+
 /*$PAGE*/
 /*
 *********************************************************************************************************
@@ -1529,6 +1716,24 @@ void          OSCtxSw                 (void);
     #endif
 #endif
 
+/*
+*********************************************************************************************************
+*                                            STATE REGISTERS
+*********************************************************************************************************
+*/
+
+#ifndef OS_REG_EN
+#error  "OS_CFG.H, Missing OS_REG_EN: Enable (1) or Disable (0) code generation for STATE REGISTERS"
+#else
+    #ifndef OS_MAX_REGS
+    #error  "OS_CFG.H, Missing OS_MAX_REGS: Max. number of state registers"
+    #else
+        #if     OS_MAX_REGS > 65500u
+        #error  "OS_CFG.H, OS_MAX_REGS must be <= 65500"
+        #endif
+    #endif
+#endif
+
 /*
 *********************************************************************************************************
 *                                       MUTUAL EXCLUSION SEMAPHORES
@@ -1698,6 +1903,14 @@ void          OSCtxSw                 (void);
 #error  "OS_CFG.H, Missing OS_TASK_QUERY_EN: Include code for OSTaskQuery()"
 #endif
 
+#ifndef OS_TASK_PROFILE_WIN
+#error  "OS_CFG.H, Missing OS_TASK_PROFILE_WIN: Number of statistic task periods in the CPU usage window"
+#else
+    #if     OS_TASK_PROFILE_WIN > 255
+    #error  "OS_CFG.H,         OS_TASK_PROFILE_WIN must be <= 255"
+    #endif
+#endif
+
 /*
 *********************************************************************************************************
 *                                             TIME MANAGEMENT
@@ -1756,6 +1969,22 @@ void          OSCtxSw                 (void);
         #if OS_TMR_CFG_WHEEL_SIZE > 1024
         #error  "OS_CFG.H, OS_TMR_CFG_WHEEL_SIZE should be between 2 and 1024"
         #endif
+
+        #if (OS_TMR_CFG_WHEEL_SIZE & (OS_TMR_CFG_WHEEL_SIZE - 1)) != 0
+        #error  "OS_CFG.H, OS_TMR_CFG_WHEEL_SIZE should be a power of 2"
+        #endif
+    #endif
+
+    #ifndef OS_TMR_CFG_WHEEL2_SIZE
+    #error  "OS_CFG.H, Missing OS_TMR_CFG_WHEEL2_SIZE: Sets the size of the second timer wheel (0 = none)"
+    #else
+        #if OS_TMR_CFG_WHEEL2_SIZE > 1024
+        #error  "OS_CFG.H, OS_TMR_CFG_WHEEL2_SIZE should be between 0 and 1024"
+        #endif
+
+        #if (OS_TMR_CFG_WHEEL2_SIZE & (OS_TMR_CFG_WHEEL2_SIZE - 1)) != 0
+        #error  "OS_CFG.H, OS_TMR_CFG_WHEEL2_SIZE should be a power of 2"
+        #endif
     #endif
 
     #ifndef OS_TMR_CFG_NAME_SIZE
@@ -1837,6 +2066,78 @@ void          OSCtxSw                 (void);
 #endif
 
 
+#ifndef OS_TIME_DLY_LIST_EN
+#error  "OS_CFG.H, Missing OS_TIME_DLY_LIST_EN: Keep delayed tasks in a list sorted by expiry time"
+#endif
+
+
+#ifndef OS_TICKLESS_EN
+#error  "OS_CFG.H, Missing OS_TICKLESS_EN: Stop the tick interrupt while the idle task runs"
+#endif
+
+
+#ifndef OS_RDY_BITMAP_EN
+#error  "OS_CFG.H, Missing OS_RDY_BITMAP_EN: Use 32 bit ready and event tables searched with OS_CPU_CTZ()"
+#endif
+
+
+#ifndef OS_MEM_LOCK_FREE_EN
+#error  "OS_CFG.H, Missing OS_MEM_LOCK_FREE_EN: Pop and push the free lists of memory partitions with OS_CPU_CAS()"
+#endif
+
+
+#ifndef OS_MEM_STATS_EN
+#error  "OS_CFG.H, Missing OS_MEM_STATS_EN: Keep statistics of the blocks of each memory partition"
+#endif
+
+
+#ifndef OS_MEM_WORD_EN
+#error  "OS_CFG.H, Missing OS_MEM_WORD_EN: Clear and copy kernel memory a 32 bit word at a time"
+#endif
+
+
+#ifndef OS_TASK_STK_WATERMARK_EN
+#error  "OS_CFG.H, Missing OS_TASK_STK_WATERMARK_EN: Reuse the stack check of a task that was not switched in"
+#else
+    #if (OS_TASK_STK_WATERMARK_EN > 0) && (OS_TASK_PROFILE_EN == 0)
+    #error  "OS_CFG.H, OS_TASK_STK_WATERMARK_EN needs OS_TASK_PROFILE_EN to count the switches to each task"
+    #endif
+#endif
+
+
+#ifndef OS_TASK_STAT_CYCLES_EN
+#error  "OS_CFG.H, Missing OS_TASK_STAT_CYCLES_EN: Measure the CPU usage from the cycles the idle task ran"
+#else
+    #if (OS_TASK_STAT_CYCLES_EN > 0) && (OS_TASK_PROFILE_EN == 0)
+    #error  "OS_CFG.H, OS_TASK_STAT_CYCLES_EN needs OS_TASK_PROFILE_EN to count the cycles of the idle task"
+    #endif
+    #if (OS_TASK_STAT_CYCLES_EN > 0) && (OS_TASK_STAT_HIST_SIZE < 1)
+    #error  "OS_CFG.H, OS_TASK_STAT_HIST_SIZE must be > 0"
+    #endif
+#endif
+
+
+#ifndef OS_TRACE_EN
+#error  "OS_CFG.H, Missing OS_TRACE_EN: Record kernel events in the OSTrace ring buffer"
+#elif   OS_TRACE_EN > 0
+    #if     OS_TASK_PROFILE_EN == 0
+    #error  "OS_CFG.H, OS_TASK_PROFILE_EN must be enabled for the time stamps of the event trace"
+    #endif
+
+    #ifndef OS_TRACE_BUF_SIZE
+    #error  "OS_CFG.H, Missing OS_TRACE_BUF_SIZE: Number of records in the trace ring buffer"
+    #else
+        #if OS_TRACE_BUF_SIZE < 2
+        #error  "OS_CFG.H, OS_TRACE_BUF_SIZE should be at least 2"
+        #endif
+
+        #if (OS_TRACE_BUF_SIZE & (OS_TRACE_BUF_SIZE - 1)) != 0
+        #error  "OS_CFG.H, OS_TRACE_BUF_SIZE should be a power of 2"
+        #endif
+    #endif
+#endif
+
+
 #ifndef OS_TIME_TICK_HOOK_EN
 #error  "OS_CFG.H, Missing OS_TIME_TICK_HOOK_EN: Allows you to include the code for OSTimeTickHook() or not"
 #endif
@@ -0,0 +1,176 @@
+/******************************************************************************
+*                                                                             *
+* Deferred binary logging for uC/OS-II: the drain task.                       *
+*                                                                             *
+* See os/alt_dlog.h for the API and the frame format.                         *
+*                                                                             *
+******************************************************************************/
+
+#include <stdio.h>
+
+#include "includes.h"
+#include "os/alt_dlog.h"
+
+static OS_STK             alt_dlog_stk[ALT_DLOG_STK_SIZE];
+
+static const char* const* alt_dlog_formats;
+static alt_u32            alt_dlog_count;
+static alt_dlog_ring*     alt_dlog_rings;
+
+/* formats that have been sent to the host already */
+
+static alt_u8             alt_dlog_sent[256];
+
+static void alt_dlog_put32 (alt_u8* p, alt_u32 value)
+{
+  p[0] = value;
+  p[1] = value >> 8;
+  p[2] = value >> 16;
+  p[3] = value >> 24;
+}
+
+/*
+ * Writes one frame with a single call, with the scheduler locked: there is
+ * no lock on the newlib FILE, so a higher priority task that prints to
+ * stdout could otherwise put its text inside the frame. The JTAG UART
+ * driver polls, so the lock is held at most until the frame is out.
+ */
+
+static void alt_dlog_write (const void* frame, size_t len)
+{
+  OSSchedLock ();
+  fwrite (frame, len, 1, stdout);
+  OSSchedUnlock ();
+}
+
+/*
+ * Sends the format string of 'id' unless that has been done already.
+ */
+
+static void alt_dlog_define (alt_u32 id)
+{
+  alt_u8      frame[4 + 255];
+  const char* format;
+  size_t      len;
+
+  if (id >= alt_dlog_count || alt_dlog_sent[id])
+  {
+    return;
+  }
+
+  format = alt_dlog_formats[id];
+  for (len = 0; len < 255 && format[len]; len++)
+  {
+    frame[4 + len] = format[len];
+  }
+
+  frame[0] = 0;
+  frame[1] = ALT_DLOG_FRAME_DEF;
+  frame[2] = id;
+  frame[3] = len;
+  alt_dlog_write (frame, 4 + len);
+
+  alt_dlog_sent[id] = 1;
+}
+
+/*
+ * Sends the records of one ring, and the number of records it lost since
+ * the last time.
+ */
+
+static void alt_dlog_drain (alt_dlog_ring* ring)
+{
+  alt_u8   frame[8 + 4 * 4];
+  alt_u32* buf  = ring->buf;
+  alt_u32  mask = ring->mask;
+  alt_u32  tail = ring->tail;
+  alt_u32  head = ring->head;
+  alt_u32  id;
+  alt_u32  n;
+  alt_u32  i;
+  alt_u32  lost;
+
+  ALT_DLOG_BARRIER ();
+
+  while (tail != head)
+  {
+    id = buf[tail & mask] >> 8;
+    n  = buf[tail & mask] & 0xff;
+
+    alt_dlog_define (id);
+
+    frame[0] = 0;
+    frame[1] = ALT_DLOG_FRAME_LOG;
+    frame[2] = id;
+    frame[3] = n;
+    for (i = 0; i < n + 1; i++)
+    {
+      alt_dlog_put32 (&frame[4 + 4 * i], buf[(tail + 1 + i) & mask]);
+    }
+    tail += 2 + n;
+
+    /* the words are copied, the writer may use them again */
+
+    ALT_DLOG_BARRIER ();
+    ring->tail = tail;
+
+    alt_dlog_write (frame, 8 + 4 * n);
+  }
+
+  lost = ring->lost;
+  if (lost != ring->lost_sent)
+  {
+    frame[0] = 0;
+    frame[1] = ALT_DLOG_FRAME_LOST;
+    alt_dlog_put32 (&frame[2], lost - ring->lost_sent);
+    alt_dlog_write (frame, 6);
+    ring->lost_sent = lost;
+  }
+}
+
+static void alt_dlog_task (void* pdata)
+{
+  alt_dlog_ring* ring;
+
+  while (1)
+  {
+    OSTimeDly (ALT_DLOG_PERIOD);
+
+    for (ring = alt_dlog_rings; ring != NULL; ring = ring->next)
+    {
+      alt_dlog_drain (ring);
+    }
+
+    OSSchedLock ();
+    fflush (stdout);
+    OSSchedUnlock ();
+  }
+}
+
+int alt_dlog_init (const char* const* formats, alt_u32 count, alt_u8 prio)
+{
+  alt_dlog_formats = formats;
+  alt_dlog_count   = count;
+
+  return OSTaskCreateExt (alt_dlog_task,
+                          NULL,
+                          &alt_dlog_stk[ALT_DLOG_STK_SIZE - 1],
+                          prio,
+                          prio,
+                          &alt_dlog_stk[0],
+                          ALT_DLOG_STK_SIZE,
+                          NULL,
+                          OS_TASK_OPT_STK_CHK);
+}
+
+void alt_dlog_register (alt_dlog_ring* ring)
+{
+#if OS_CRITICAL_METHOD == 3
+  OS_CPU_SR cpu_sr = 0;
+#endif
+
+  OS_ENTER_CRITICAL ();
+  ring->next     = alt_dlog_rings;
+  alt_dlog_rings = ring;
+  OS_EXIT_CRITICAL ();
+}
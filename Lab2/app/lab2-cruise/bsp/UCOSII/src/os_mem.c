@@ -28,6 +28,22 @@
 #if (OS_MEM_EN > 0) && (OS_MAX_MEM_PART > 0)
 /*
 *********************************************************************************************************
+*                                           LOCAL FUNCTIONS
+*********************************************************************************************************
+*/
+
+#if OS_MEM_LOCK_FREE
+static  INT64U  OS_MemHead(OS_MEM *pmem, INT64U head, void *pblk);
+static  void   *OS_MemPop(OS_MEM *pmem);
+static  void    OS_MemPush(OS_MEM *pmem, void *pblk);
+#endif
+
+#if OS_MEM_STATS_EN > 0
+static  void    OS_MemUsed(OS_MEM *pmem);
+#endif
+/*$PAGE*/
+/*
+*********************************************************************************************************
 *                                        CREATE A MEMORY PARTITION
 *
 * Description : Create a fixed-sized memory partition that will be managed by uC/OS-II.
@@ -76,7 +92,7 @@ OS_MEM  *OSMemCreate (void *addr, INT32U nblks, INT32U blksize, INT8U *perr)
         *perr = OS_ERR_MEM_INVALID_ADDR;
         return ((OS_MEM *)0);
     }
-    if (((INT32U)addr & (sizeof(void *) - 1)) != 0){  /* Must be pointer size aligned                  */
+    if (((INT32U)(unsigned long)addr & (sizeof(void *) - 1)) != 0){ /* Must be pointer size aligned           */
         *perr = OS_ERR_MEM_INVALID_ADDR;
         return ((OS_MEM *)0);
     }
@@ -100,11 +116,11 @@ OS_MEM  *OSMemCreate (void *addr, INT32U nblks, INT32U blksize, INT8U *perr)
         return ((OS_MEM *)0);
     }
     plink = (void **)addr;                            /* Create linked list of free memory blocks      */
-    pblk  = (INT8U *)((INT32U)addr + blksize);
+    pblk  = (INT8U *)addr + blksize;
     for (i = 0; i < (nblks - 1); i++) {
        *plink = (void *)pblk;                         /* Save pointer to NEXT block in CURRENT block   */
         plink = (void **)pblk;                        /* Position to  NEXT      block                  */
-        pblk  = (INT8U *)((INT32U)pblk + blksize);    /* Point to the FOLLOWING block                  */
+        pblk += blksize;                              /* Point to the FOLLOWING block                  */
     }
     *plink              = (void *)0;                  /* Last memory block points to NULL              */
     pmem->OSMemAddr     = addr;                       /* Store start address of memory partition       */
@@ -112,6 +128,15 @@ OS_MEM  *OSMemCreate (void *addr, INT32U nblks, INT32U blksize, INT8U *perr)
     pmem->OSMemNFree    = nblks;                      /* Store number of free blocks in MCB            */
     pmem->OSMemNBlks    = nblks;
     pmem->OSMemBlkSize  = blksize;                    /* Store block size of each memory blocks        */
+#if OS_MEM_LOCK_FREE
+    pmem->OSMemHead     = 1;                          /* First block, tag 0                            */
+#endif
+#if OS_MEM_STATS_EN > 0
+    pmem->OSMemUseTicks  = 0;
+    pmem->OSMemNGet      = 0;
+    pmem->OSMemNFail     = 0;
+    pmem->OSMemNUsedMax  = 0;
+#endif
     *perr               = OS_ERR_NONE;
     return (pmem);
 }
@@ -133,13 +158,25 @@ OS_MEM  *OSMemCreate (void *addr, INT32U nblks, INT32U blksize, INT8U *perr)
 *
 * Returns     : A pointer to a memory block if no error is detected
 *               A pointer to NULL if an error is detected
+*
+* Note(s)     : 1) With OS_MEM_LOCK_FREE_EN and a port that defines OS_CPU_CAS(), the block is popped off
+*                  the free list with a compare-and-swap instead of with interrupts disabled, so ISRs and
+*                  tasks can get and put blocks without adding to the interrupt latency.  The head of the
+*                  list carries a tag that every pop and push changes, so that a task that is preempted
+*                  between reading the head and swapping it cannot install a stale next block.
+*               2) The free count is decremented, never below 0, before the block is popped, and OSMemPut()
+*                  increments it after the block is pushed.  So the count never exceeds the number of blocks
+*                  on the list, a caller that took one from the count always finds a block, and OSMemPut()
+*                  does not see a full partition while a block is held.
 *********************************************************************************************************
 */
 
 void  *OSMemGet (OS_MEM *pmem, INT8U *perr)
 {
     void      *pblk;
-#if OS_CRITICAL_METHOD == 3                           /* Allocate storage for CPU status register      */
+#if OS_MEM_LOCK_FREE
+    INT32U     nfree;
+#elif OS_CRITICAL_METHOD == 3                         /* Allocate storage for CPU status register      */
     OS_CPU_SR  cpu_sr = 0;
 #endif
 
@@ -154,16 +191,41 @@ void  *OSMemGet (OS_MEM *pmem, INT8U *perr)
         return ((void *)0);
     }
 #endif
+#if OS_MEM_LOCK_FREE
+    do {
+        nfree = pmem->OSMemNFree;
+    } while (nfree > 0 && !OS_CPU_CAS(&pmem->OSMemNFree, nfree, nfree - 1)); /* See Note #2            */
+    if (nfree > 0) {                                  /* See if there was a free memory block          */
+        pblk = OS_MemPop(pmem);                       /* Yes, one less memory block in this partition  */
+#if OS_MEM_STATS_EN > 0
+        OS_CPU_ADD(&pmem->OSMemNGet, 1);
+        OS_MemUsed(pmem);
+#endif
+        *perr = OS_ERR_NONE;                          /*      No error                                 */
+        return (pblk);                                /*      Return memory block to caller            */
+    }
+#if OS_MEM_STATS_EN > 0
+    OS_CPU_ADD(&pmem->OSMemNFail, 1);
+#endif
+#else
     OS_ENTER_CRITICAL();
     if (pmem->OSMemNFree > 0) {                       /* See if there are any free memory blocks       */
         pblk                = pmem->OSMemFreeList;    /* Yes, point to next free memory block          */
         pmem->OSMemFreeList = *(void **)pblk;         /*      Adjust pointer to new free list          */
         pmem->OSMemNFree--;                           /*      One less memory block in this partition  */
+#if OS_MEM_STATS_EN > 0
+        pmem->OSMemNGet++;
+        OS_MemUsed(pmem);
+#endif
         OS_EXIT_CRITICAL();
         *perr = OS_ERR_NONE;                          /*      No error                                 */
         return (pblk);                                /*      Return memory block to caller            */
     }
+#if OS_MEM_STATS_EN > 0
+    pmem->OSMemNFail++;
+#endif
     OS_EXIT_CRITICAL();
+#endif
     *perr = OS_ERR_MEM_NO_FREE_BLKS;                  /* No,  Notify caller of empty memory partition  */
     return ((void *)0);                               /*      Return NULL pointer to caller            */
 }
@@ -308,7 +370,7 @@ void  OSMemNameSet (OS_MEM *pmem, INT8U *pname, INT8U *perr)
 
 INT8U  OSMemPut (OS_MEM *pmem, void *pblk)
 {
-#if OS_CRITICAL_METHOD == 3                      /* Allocate storage for CPU status register           */
+#if (OS_CRITICAL_METHOD == 3) && (OS_MEM_LOCK_FREE == 0) /* Allocate storage for CPU status register   */
     OS_CPU_SR  cpu_sr = 0;
 #endif
 
@@ -322,6 +384,13 @@ INT8U  OSMemPut (OS_MEM *pmem, void *pblk)
         return (OS_ERR_MEM_INVALID_PBLK);
     }
 #endif
+#if OS_MEM_LOCK_FREE
+    if (pmem->OSMemNFree >= pmem->OSMemNBlks) {  /* Make sure all blocks not already returned, the     */
+        return (OS_ERR_MEM_FULL);                /* ... count is at most the blocks on the list        */
+    }
+    OS_MemPush(pmem, pblk);                      /* Insert released block into free block list         */
+    OS_CPU_ADD(&pmem->OSMemNFree, 1);            /* One more memory block, after it is on the list     */
+#else
     OS_ENTER_CRITICAL();
     if (pmem->OSMemNFree >= pmem->OSMemNBlks) {  /* Make sure all blocks not already returned          */
         OS_EXIT_CRITICAL();
@@ -331,6 +400,7 @@ INT8U  OSMemPut (OS_MEM *pmem, void *pblk)
     pmem->OSMemFreeList = pblk;
     pmem->OSMemNFree++;                          /* One more memory block in this partition            */
     OS_EXIT_CRITICAL();
+#endif
     return (OS_ERR_NONE);                        /* Notify caller that memory block was released       */
 }
 /*$PAGE*/
@@ -349,12 +419,20 @@ INT8U  OSMemPut (OS_MEM *pmem, void *pblk)
 * Returns     : OS_ERR_NONE               if no errors were found.
 *               OS_ERR_MEM_INVALID_PMEM   if you passed a NULL pointer for 'pmem'
 *               OS_ERR_MEM_INVALID_PDATA  if you passed a NULL pointer to the data recipient.
+*
+* Note(s)     : 1) With OS_MEM_STATS_EN the mean hold time follows from Little's law: it is the sum over
+*                  time of the number of blocks used, divided by the number of blocks handed out.  The
+*                  sum is sampled by OS_MemTick() once per tick, so it is only meaningful over many ticks;
+*                  blocks that are still held count with the time they have been held so far.
 *********************************************************************************************************
 */
 
 #if OS_MEM_QUERY_EN > 0
 INT8U  OSMemQuery (OS_MEM *pmem, OS_MEM_DATA *p_mem_data)
 {
+#if OS_MEM_STATS_EN > 0
+    INT64U     ticks;
+#endif
 #if OS_CRITICAL_METHOD == 3                      /* Allocate storage for CPU status register           */
     OS_CPU_SR  cpu_sr = 0;
 #endif
@@ -371,12 +449,27 @@ INT8U  OSMemQuery (OS_MEM *pmem, OS_MEM_DATA *p_mem_data)
 #endif
     OS_ENTER_CRITICAL();
     p_mem_data->OSAddr     = pmem->OSMemAddr;
+#if OS_MEM_LOCK_FREE
+    p_mem_data->OSFreeList = ((INT32U)pmem->OSMemHead == 0) ? (void *)0
+                           : (INT8U *)pmem->OSMemAddr + ((INT32U)pmem->OSMemHead - 1);
+#else
     p_mem_data->OSFreeList = pmem->OSMemFreeList;
+#endif
     p_mem_data->OSBlkSize  = pmem->OSMemBlkSize;
     p_mem_data->OSNBlks    = pmem->OSMemNBlks;
     p_mem_data->OSNFree    = pmem->OSMemNFree;
+#if OS_MEM_STATS_EN > 0
+    ticks                  = pmem->OSMemUseTicks;
+    p_mem_data->OSNUsedMax = pmem->OSMemNUsedMax;
+    p_mem_data->OSNGet     = pmem->OSMemNGet;
+    p_mem_data->OSNFail    = pmem->OSMemNFail;
+#endif
     OS_EXIT_CRITICAL();
     p_mem_data->OSNUsed    = p_mem_data->OSNBlks - p_mem_data->OSNFree;
+#if OS_MEM_STATS_EN > 0
+    p_mem_data->OSHoldMean = (p_mem_data->OSNGet > 0)
+                           ? (INT32U)(ticks * (1000000L / OS_TICKS_PER_SEC) / p_mem_data->OSNGet) : 0;
+#endif
     return (OS_ERR_NONE);
 }
 #endif                                           /* OS_MEM_QUERY_EN                                    */
@@ -431,4 +524,122 @@ void  OS_MemInit (void)
     OSMemFreeList       = &OSMemTbl[0];                   /* Point to beginning of free list           */
 #endif
 }
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                      LOCK-FREE FREE LIST OF BLOCKS
+*
+* Description : OS_MemPop() takes the first block off the free list of a partition, or returns NULL if the
+*               list is empty.  OS_MemPush() puts a block in front of it.  Both swap the head of the list
+*               with OS_CPU_CAS() and retry if an ISR or a preempting task changed it in the meantime.
+*
+*               OS_MemHead() returns the head that follows 'head' with 'pblk' as first block: the tag in
+*               the upper 32 bits is incremented and the lower 32 bits hold the offset of the block in the
+*               partition plus 1, or 0 for an empty list.
+*
+* Arguments   : pmem    is a pointer to the memory partition control block
+*
+*               pblk    is a pointer to the memory block
+*
+* Note(s)     : 1) OS_MemPop() may read the link of a block that has just been taken by someone else.  The
+*                  tag of the head has changed then, so the value read is never installed.
+*               2) These functions are INTERNAL to uC/OS-II and your application should not call them.
+*********************************************************************************************************
+*/
+
+#if OS_MEM_LOCK_FREE
+static  INT64U  OS_MemHead (OS_MEM *pmem, INT64U head, void *pblk)
+{
+    INT64U  off;
+
+
+    off = (pblk == (void *)0) ? 0 : (INT64U)((INT8U *)pblk - (INT8U *)pmem->OSMemAddr) + 1;
+    return ((((head >> 32) + 1) << 32) | off);
+}
+
+static  void  *OS_MemPop (OS_MEM *pmem)
+{
+    INT64U  head;
+    void   *pblk;
+    void   *pnext;
+
+
+    do {
+        head = pmem->OSMemHead;
+        if ((INT32U)head == 0) {                 /* See if the list is empty                           */
+            return ((void *)0);
+        }
+        pblk  = (INT8U *)pmem->OSMemAddr + ((INT32U)head - 1);
+        pnext = *(void **)pblk;                  /* Next block, valid if the head is still 'head'      */
+    } while (!OS_CPU_CAS(&pmem->OSMemHead, head, OS_MemHead(pmem, head, pnext)));
+    return (pblk);
+}
+
+static  void  OS_MemPush (OS_MEM *pmem, void *pblk)
+{
+    INT64U  head;
+
+
+    do {
+        head = pmem->OSMemHead;
+        *(void **)pblk = ((INT32U)head == 0) ? (void *)0
+                       : (INT8U *)pmem->OSMemAddr + ((INT32U)head - 1);
+    } while (!OS_CPU_CAS(&pmem->OSMemHead, head, OS_MemHead(pmem, head, pblk)));
+}
+#endif
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                       UPDATE PARTITION STATISTICS
+*
+* Description : OS_MemUsed() is called by OSMemGet() with OS_MEM_STATS_EN after a block was handed out, to
+*               update the highest number of blocks used at once.
+*
+*               OS_MemTick() is called by OSTimeTick() and OSTimeTickSkip() with OS_MEM_STATS_EN.  It adds
+*               the number of blocks used in each partition, times 'ticks', to OSMemUseTicks, from which
+*               OSMemQuery() derives the mean hold time.  Partitions are never deleted and are created in
+*               the order of OSMemTbl[], so it stops at the first entry that was not created.
+*
+* Arguments   : pmem    is a pointer to the memory partition control block
+*
+*               ticks   is the number of ticks that passed
+*
+* Note(s)     : 1) Without OS_MEM_LOCK_FREE, OS_MemUsed() is called with interrupts disabled.  Otherwise
+*                  a get or put between updating OSMemNFree and reading it may be counted in the high
+*                  water mark of this get.
+*               2) These functions are INTERNAL to uC/OS-II and your application should not call them.
+*********************************************************************************************************
+*/
+
+#if OS_MEM_STATS_EN > 0
+static  void  OS_MemUsed (OS_MEM *pmem)
+{
+    INT32U  used;
+#if OS_MEM_LOCK_FREE
+    INT32U  max;
+#endif
+
+
+    used = pmem->OSMemNBlks - pmem->OSMemNFree;
+#if OS_MEM_LOCK_FREE
+    do {
+        max = pmem->OSMemNUsedMax;
+    } while (used > max && !OS_CPU_CAS(&pmem->OSMemNUsedMax, max, used));
+#else
+    if (used > pmem->OSMemNUsedMax) {
+        pmem->OSMemNUsedMax = used;
+    }
+#endif
+}
+
+void  OS_MemTick (INT32U ticks)
+{
+    OS_MEM  *pmem;
+
+
+    for (pmem = &OSMemTbl[0]; pmem < &OSMemTbl[OS_MAX_MEM_PART] && pmem->OSMemNBlks != 0; pmem++) {
+        pmem->OSMemUseTicks += (INT64U)(pmem->OSMemNBlks - pmem->OSMemNFree) * ticks;
+    }
+}
+#endif
 #endif                                                    /* OS_MEM_EN                                 */
@@ -430,7 +430,8 @@ void  *OSQPend (OS_EVENT *pevent, INT16U timeout, INT8U *perr)
     }
     OSTCBCur->OSTCBStat     |= OS_STAT_Q;        /* Task will have to pend for a message to be posted  */
     OSTCBCur->OSTCBStatPend  = OS_STAT_PEND_OK;
-    OSTCBCur->OSTCBDly       = timeout;          /* Load timeout into TCB                              */
+    OS_TimeDlyInsert(OSTCBCur, timeout);         /* Load timeout into TCB                              */
+    OS_TRACE_EVENT(OS_TRACE_Q_PEND, pevent);
     OS_EventTaskWait(pevent);                    /* Suspend task until event or timeout occurs         */
     OS_EXIT_CRITICAL();
     OS_Sched();                                  /* Find next highest priority task ready to run       */
@@ -586,6 +587,7 @@ INT8U  OSQPost (OS_EVENT *pevent, void *pmsg)
         return (OS_ERR_EVENT_TYPE);
     }
     OS_ENTER_CRITICAL();
+    OS_TRACE_EVENT(OS_TRACE_Q_POST, pevent);
     if (pevent->OSEventGrp != 0) {                     /* See if any task pending on queue             */
                                                        /* Ready highest priority task waiting on event */
         (void)OS_EventTaskRdy(pevent, pmsg, OS_STAT_Q, OS_STAT_PEND_OK);
@@ -648,6 +650,7 @@ INT8U  OSQPostFront (OS_EVENT *pevent, void *pmsg)
         return (OS_ERR_EVENT_TYPE);
     }
     OS_ENTER_CRITICAL();
+    OS_TRACE_EVENT(OS_TRACE_Q_POST, pevent);
     if (pevent->OSEventGrp != 0) {                    /* See if any task pending on queue              */
                                                       /* Ready highest priority task waiting on event  */
         (void)OS_EventTaskRdy(pevent, pmsg, OS_STAT_Q, OS_STAT_PEND_OK);
@@ -719,6 +722,7 @@ INT8U  OSQPostOpt (OS_EVENT *pevent, void *pmsg, INT8U opt)
         return (OS_ERR_EVENT_TYPE);
     }
     OS_ENTER_CRITICAL();
+    OS_TRACE_EVENT(OS_TRACE_Q_POST, pevent);
     if (pevent->OSEventGrp != 0x00) {                 /* See if any task pending on queue              */
         if ((opt & OS_POST_OPT_BROADCAST) != 0x00) {  /* Do we need to post msg to ALL waiting tasks ? */
             while (pevent->OSEventGrp != 0) {         /* Yes, Post to ALL tasks waiting on queue       */
@@ -779,13 +783,8 @@ INT8U  OSQQuery (OS_EVENT *pevent, OS_Q_DATA *p_q_data)
 {
     OS_Q      *pq;
     INT8U      i;
-#if OS_LOWEST_PRIO <= 63
-    INT8U     *psrc;
-    INT8U     *pdest;
-#else
-    INT16U    *psrc;
-    INT16U    *pdest;
-#endif
+    OS_PRIO   *psrc;
+    OS_PRIO   *pdest;
 #if OS_CRITICAL_METHOD == 3                            /* Allocate storage for CPU status register     */
     OS_CPU_SR  cpu_sr = 0;
 #endif
@@ -60,17 +60,10 @@ INT8U  OSTaskChangePrio (INT8U oldprio, INT8U newprio)
     INT8U      y_new;
     INT8U      x_new;
     INT8U      y_old;
-#if OS_LOWEST_PRIO <= 63
-    INT8U      bity_new;
-    INT8U      bitx_new;
-    INT8U      bity_old;
-    INT8U      bitx_old;
-#else
-    INT16U     bity_new;
-    INT16U     bitx_new;
-    INT16U     bity_old;
-    INT16U     bitx_old;
-#endif
+    OS_PRIO    bity_new;
+    OS_PRIO    bitx_new;
+    OS_PRIO    bity_old;
+    OS_PRIO    bitx_old;
 #if OS_CRITICAL_METHOD == 3
     OS_CPU_SR  cpu_sr = 0;                                  /* Storage for CPU status register         */
 #endif
@@ -104,17 +97,10 @@ INT8U  OSTaskChangePrio (INT8U oldprio, INT8U newprio)
         OS_EXIT_CRITICAL();                                 /* No, can't change its priority!          */
         return (OS_ERR_TASK_NOT_EXIST);
     }
-#if OS_LOWEST_PRIO <= 63
-    y_new                 = (INT8U)(newprio >> 3);          /* Yes, compute new TCB fields             */
-    x_new                 = (INT8U)(newprio & 0x07);
-    bity_new              = (INT8U)(1 << y_new);
-    bitx_new              = (INT8U)(1 << x_new);
-#else
-    y_new                 = (INT8U)((newprio >> 4) & 0x0F);
-    x_new                 = (INT8U)( newprio & 0x0F);
-    bity_new              = (INT16U)(1 << y_new);
-    bitx_new              = (INT16U)(1 << x_new);
-#endif
+    y_new                 = (INT8U)(newprio >> OS_PRIO_SHIFT);  /* Yes, compute new TCB fields         */
+    x_new                 = (INT8U)(newprio &  OS_PRIO_MASK);
+    bity_new              = (OS_PRIO)(1u << y_new);
+    bitx_new              = (OS_PRIO)(1u << x_new);
 
     OSTCBPrioTbl[oldprio] = (OS_TCB *)0;                    /* Remove TCB from old priority            */
     OSTCBPrioTbl[newprio] =  ptcb;                          /* Place pointer to TCB @ new priority     */
@@ -481,7 +467,7 @@ INT8U  OSTaskDel (INT8U prio)
     }
 #endif
 
-    ptcb->OSTCBDly      = 0;                            /* Prevent OSTimeTick() from updating          */
+    OS_TimeDlyRemove(ptcb);                             /* Prevent OSTimeTick() from updating          */
     ptcb->OSTCBStat     = OS_STAT_RDY;                  /* Prevent task from being resumed             */
     ptcb->OSTCBStatPend = OS_STAT_PEND_OK;
     if (OSLockNesting < 255u) {                         /* Make sure we don't context switch           */
@@ -851,6 +837,17 @@ INT8U  OSTaskResume (INT8U prio)
 *              OS_ERR_TASK_NOT_EXIST  if the desired task has not been created or is assigned to a Mutex PIP
 *              OS_ERR_TASK_OPT        if you did NOT specified OS_TASK_OPT_STK_CHK when the task was created
 *              OS_ERR_PDATA_NULL      if 'p_stk_data' is a NULL pointer
+*
+* Note(s)    : 1) With OS_TASK_STK_WATERMARK_EN, the number of free entries found is kept in the TCB with
+*                 the number of times the task was switched in, OSTCBCtxSwCtr.  A task's stack only
+*                 changes while the task runs, i.e. while it is the current task or after it was
+*                 switched in again, so until then the next check returns the same result without
+*                 scanning.  The stack is not assumed to be used downwards word by word: locals that are
+*                 never written leave zero entries below used ones, so a task that ran is scanned again
+*                 from the bottom.
+*              2) The result for the current task, e.g. for OS_PRIO_SELF or from an ISR, is not kept.
+*              3) A stack that is written by another task (through a pointer to one of its locals) while
+*                 the task does not run is not seen until the task runs again.
 *********************************************************************************************************
 */
 #if (OS_TASK_STAT_STK_CHK_EN > 0) && (OS_TASK_CREATE_EXT_EN > 0)
@@ -860,6 +857,10 @@ INT8U  OSTaskStkChk (INT8U prio, OS_STK_DATA *p_stk_data)
     OS_STK    *pchk;
     INT32U     nfree;
     INT32U     size;
+#if OS_TASK_STK_WATERMARK_EN > 0
+    INT32U     ctr;
+    BOOLEAN    keep;
+#endif
 #if OS_CRITICAL_METHOD == 3                            /* Allocate storage for CPU status register     */
     OS_CPU_SR  cpu_sr = 0;
 #endif
@@ -898,6 +899,17 @@ INT8U  OSTaskStkChk (INT8U prio, OS_STK_DATA *p_stk_data)
     nfree = 0;
     size  = ptcb->OSTCBStkSize;
     pchk  = ptcb->OSTCBStkBottom;
+#if OS_TASK_STK_WATERMARK_EN > 0
+    ctr   = ptcb->OSTCBCtxSwCtr;
+    keep  = (ptcb != OSTCBCur) ? OS_TRUE : OS_FALSE;   /* See Note #2                                  */
+    if (keep == OS_TRUE && ctr == ptcb->OSTCBStkChkCtr) {
+        nfree = ptcb->OSTCBStkFree;                    /* Not switched in since the last check         */
+        OS_EXIT_CRITICAL();
+        p_stk_data->OSFree = nfree * sizeof(OS_STK);
+        p_stk_data->OSUsed = (size - nfree) * sizeof(OS_STK);
+        return (OS_ERR_NONE);
+    }
+#endif
     OS_EXIT_CRITICAL();
 #if OS_STK_GROWTH == 1
     while (*pchk++ == (OS_STK)0) {                    /* Compute the number of zero entries on the stk */
@@ -907,6 +919,17 @@ INT8U  OSTaskStkChk (INT8U prio, OS_STK_DATA *p_stk_data)
     while (*pchk-- == (OS_STK)0) {
         nfree++;
     }
+#endif
+#if OS_TASK_STK_WATERMARK_EN > 0
+    if (keep == OS_TRUE) {
+        OS_ENTER_CRITICAL();
+        if (OSTCBPrioTbl[prio] == ptcb &&              /* Keep it unless the task was switched in or   */
+            ptcb->OSTCBCtxSwCtr == ctr) {              /* ... deleted while its stack was scanned      */
+            ptcb->OSTCBStkFree   = nfree;
+            ptcb->OSTCBStkChkCtr = ctr;
+        }
+        OS_EXIT_CRITICAL();
+    }
 #endif
     p_stk_data->OSFree = nfree * sizeof(OS_STK);          /* Compute number of free bytes on the stack */
     p_stk_data->OSUsed = (size - nfree) * sizeof(OS_STK); /* Compute number of bytes used on the stack */
@@ -1007,6 +1030,11 @@ INT8U  OSTaskSuspend (INT8U prio)
 *              OS_ERR_PRIO            if the desired task has not been created
 *              OS_ERR_TASK_NOT_EXIST  if the task is assigned to a Mutex PIP
 *              OS_ERR_PDATA_NULL      if 'p_task_data' is a NULL pointer
+*
+* Note(s)    : 1) With OS_TIME_DLY_LIST_EN, OSTimeTick() no longer counts down the OSTCBDly of every
+*                 delayed task: OSTCBDly keeps the delay the task was given, and the delay expires when
+*                 OSTickCtr reaches OSTCBDlyTick.  The copy gets the number of ticks left in OSTCBDly
+*                 instead, as without the list.
 *********************************************************************************************************
 */
 
@@ -1014,6 +1042,9 @@ INT8U  OSTaskSuspend (INT8U prio)
 INT8U  OSTaskQuery (INT8U prio, OS_TCB *p_task_data)
 {
     OS_TCB    *ptcb;
+#if OS_TIME_DLY_LIST_EN > 0
+    INT32S     left;
+#endif
 #if OS_CRITICAL_METHOD == 3                      /* Allocate storage for CPU status register           */
     OS_CPU_SR  cpu_sr = 0;
 #endif
@@ -1045,6 +1076,12 @@ INT8U  OSTaskQuery (INT8U prio, OS_TCB *p_task_data)
     }
                                                  /* Copy TCB into user storage area                    */
     OS_MemCopy((INT8U *)p_task_data, (INT8U *)ptcb, sizeof(OS_TCB));
+#if OS_TIME_DLY_LIST_EN > 0
+    if (ptcb->OSTCBDly != 0) {                   /* Ticks left of the delay, see Note #1               */
+        left = (INT32S)(ptcb->OSTCBDlyTick - OSTickCtr);
+        p_task_data->OSTCBDly = (left > 0) ? (INT16U)left : 0;
+    }
+#endif
     OS_EXIT_CRITICAL();
     return (OS_ERR_NONE);
 }
@@ -1052,6 +1089,69 @@ INT8U  OSTaskQuery (INT8U prio, OS_TCB *p_task_data)
 /*$PAGE*/
 /*
 *********************************************************************************************************
+*                                        GET THE CPU USAGE OF A TASK
+*
+* Description: This function is called to obtain the share of the CPU a task has used over the last
+*              OS_TASK_PROFILE_WIN statistic task periods, as measured by OS_TaskStatCycles().
+*
+* Arguments  : prio     is the priority of the task.  If you specify OS_PRIO_SELF, you will obtain the CPU
+*                       usage of the calling task.
+*
+*              perr     is a pointer to an error code that can contain one of the following values:
+*
+*                       OS_ERR_NONE                if the requested task exists
+*                       OS_ERR_PRIO_INVALID        if you specified an invalid priority:
+*                                                  A higher value than the idle task or not OS_PRIO_SELF.
+*                       OS_ERR_TASK_NOT_EXIST      if the task has not been created or is assigned to a
+*                                                  Mutex PIP
+*
+* Returns    : The CPU usage of the task in units of 0.01 % (0..10000), or 0 if an error occurred.
+*
+* Note(s)    : 1) The usage is updated every statistic task period, i.e. every 1/10 second.
+*********************************************************************************************************
+*/
+
+#if OS_TASK_CPU_USAGE_EN
+INT16U  OSTaskCPUUsageGet (INT8U prio, INT8U *perr)
+{
+    OS_TCB    *ptcb;
+    INT16U     usage;
+#if OS_CRITICAL_METHOD == 3                      /* Allocate storage for CPU status register           */
+    OS_CPU_SR  cpu_sr = 0;
+#endif
+
+
+
+#if OS_ARG_CHK_EN > 0
+    if (perr == (INT8U *)0) {                    /* Validate 'perr'                                    */
+        return (0);
+    }
+    if (prio > OS_LOWEST_PRIO) {                 /* Task priority valid ?                              */
+        if (prio != OS_PRIO_SELF) {
+            *perr = OS_ERR_PRIO_INVALID;
+            return (0);
+        }
+    }
+#endif
+    OS_ENTER_CRITICAL();
+    if (prio == OS_PRIO_SELF) {                  /* See if caller desires its own usage                */
+        prio = OSTCBCur->OSTCBPrio;
+    }
+    ptcb = OSTCBPrioTbl[prio];
+    if ((ptcb == (OS_TCB *)0) || (ptcb == OS_TCB_RESERVED)) {
+        OS_EXIT_CRITICAL();                      /* Task must exist and not be assigned to a Mutex     */
+        *perr = OS_ERR_TASK_NOT_EXIST;
+        return (0);
+    }
+    usage = ptcb->OSTCBCPUUsage;
+    OS_EXIT_CRITICAL();
+    *perr = OS_ERR_NONE;
+    return (usage);
+}
+#endif
+/*$PAGE*/
+/*
+*********************************************************************************************************
 *                                        CLEAR TASK STACK
 *
 * Description: This function is used to clear the stack of a task (i.e. write all zeros)
@@ -1070,6 +1170,9 @@ INT8U  OSTaskQuery (INT8U prio, OS_TCB *p_task_data)
 *                       specific.  See OS_TASK_OPT_??? in uCOS-II.H.
 *
 * Returns    : none
+*
+* Note(s)    : 1) With OS_MEM_WORD_EN the stack is cleared with OS_CPU_MEM_CLR() if the port provides it,
+*                 or else 4 stack entries per iteration.
 *********************************************************************************************************
 */
 #if (OS_TASK_STAT_STK_CHK_EN > 0) && (OS_TASK_CREATE_EXT_EN > 0)
@@ -1077,15 +1180,25 @@ void  OS_TaskStkClr (OS_STK *pbos, INT32U size, INT16U opt)
 {
     if ((opt & OS_TASK_OPT_STK_CHK) != 0x0000) {       /* See if stack checking has been enabled       */
         if ((opt & OS_TASK_OPT_STK_CLR) != 0x0000) {   /* See if stack needs to be cleared             */
-#if OS_STK_GROWTH == 1
-            while (size > 0) {                         /* Stack grows from HIGH to LOW memory          */
-                size--;
-                *pbos++ = (OS_STK)0;                   /* Clear from bottom of stack and up!           */
-            }
+#if OS_STK_GROWTH == 0
+            pbos = pbos - size + 1;                    /* Stack grows from LOW to HIGH memory, clear   */
+#endif                                                 /* ... from the top of stack and up             */
+#if (OS_MEM_WORD_EN > 0) && defined(OS_CPU_MEM_CLR)
+            OS_CPU_MEM_CLR(pbos, size * sizeof(OS_STK));
 #else
-            while (size > 0) {                         /* Stack grows from LOW to HIGH memory          */
+#if OS_MEM_WORD_EN > 0
+            while (size >= 4) {                        /* Clear 4 entries at a time                    */
+                pbos[0]  = (OS_STK)0;
+                pbos[1]  = (OS_STK)0;
+                pbos[2]  = (OS_STK)0;
+                pbos[3]  = (OS_STK)0;
+                pbos    += 4;
+                size    -= 4;
+            }
+#endif
+            while (size > 0) {                         /* Clear from bottom of stack and up!           */
                 size--;
-                *pbos-- = (OS_STK)0;                   /* Clear from bottom of stack and down          */
+                *pbos++ = (OS_STK)0;
             }
 #endif
         }
@@ -72,6 +72,47 @@ extern "C"
 extern void alt_avalon_timer_sc_init (void* base, alt_u32 irq_controller_id, 
                                       alt_u32 irq, alt_u32 freq);
 
+/*
+ * alt_avalon_timer_sc_idle() and alt_avalon_timer_sc_wake() are called by the
+ * operating system port to hold off the system clock interrupt while the idle
+ * task runs, alt_avalon_timer_sc_sync() on interrupt entry and
+ * alt_avalon_timer_sc_rearm() when an alarm or timer is started. See
+ * altera_avalon_timer_sc.c.
+ */
+
+/*
+ * ALT_AVALON_TIMER_SC_RESTART_CYCLES is the number of timer cycles from the
+ * snapshot alt_avalon_timer_sc_idle() and the others take just before they
+ * restart the counter to the write that starts it again. The counter does 
+ * not count them, so the driver adds them to the time itself. The default is
+ * for the Nios II/e of the lab running from the clock of the timer, with the
+ * driver built -Os: about 20 instructions of six cycles each. That is an
+ * estimate from the code, not a measurement; to measure it, run the tickless
+ * kernel against a timestamp timer and divide the drift by the number of
+ * restarts. Define it in the BSP flags to match another CPU or clock. Too 
+ * small, the system clock falls behind a little at each restart; too large,
+ * it runs ahead.
+ */
+
+#ifndef ALT_AVALON_TIMER_SC_RESTART_CYCLES
+#define ALT_AVALON_TIMER_SC_RESTART_CYCLES 120
+#endif
+
+extern void alt_avalon_timer_sc_idle  (void);
+extern void alt_avalon_timer_sc_wake  (void);
+extern void alt_avalon_timer_sc_sync  (void);
+extern void alt_avalon_timer_sc_rearm (void);
+
+/*
+ * alt_avalon_timer_sc_time() returns the number of system clock timer cycles
+ * since it was started, for use as a cycle counter when there is no
+ * timestamp timer. alt_avalon_timer_sc_freq() is the number of those cycles
+ * per second.
+ */
+
+extern alt_u32 alt_avalon_timer_sc_time (void);
+extern alt_u32 alt_avalon_timer_sc_freq (void);
+
 /*
  * Variables used to store the timestamp parameters, when the device is to be
  * accessed using the high resolution timestamp driver.
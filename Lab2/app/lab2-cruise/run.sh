@@ -26,6 +26,12 @@ CPU_NAME=nios2
 BSP_PATH=../../bsp/il2206-pre-built-ucosii
 SRC_PATH=./src
 
+# Kernel extensions that are in the BSP folder but not in the ucosii
+# software package. nios2-bsp regenerates the BSP makefile from the
+# package, so they are compiled with the application instead.
+EXT_PATH=bsp/UCOSII/src
+EXT_SRCS="alt_dlog.c alt_input.c alt_slab.c alt_stkprof.c os_reg.c os_trace.c"
+
 # Project internal folders
 mkdir -p gen
 mkdir -p bin
@@ -52,6 +58,7 @@ nios2-app-generate-makefile \
     --bsp-dir ../bsp \
     --elf-name ../bin/$APP_NAME.elf \
     --src-dir ../$SRC_PATH \
+    --src-files $(for f in $EXT_SRCS; do echo ../$EXT_PATH/$f; done) \
     --set APP_CFLAGS_OPTIMIZATION -O0
 
 make | tee -a log.txt 
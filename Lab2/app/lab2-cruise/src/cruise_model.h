@@ -0,0 +1,158 @@
+/* Fixed-point vehicle model and PI controller for the IL 2206 cruise control
+ *
+ * Description:
+ *
+ *   The Nios II of the lab system has no FPU, multiplier or divider, so
+ *   every float or double operation, and every multiplication or division
+ *   by a variable, is a call into the libgcc soft routines. The vehicle
+ *   model and the controller are therefore kept in Q format, i.e. as
+ *   integers scaled by a power of two:
+ *
+ *     MODEL_Q   - fraction bits of the vehicle state (position, velocity
+ *                 and acceleration),
+ *     CONTROL_Q - fraction bits of the controller gains and throttle.
+ *
+ *   All scale factors are folded into constants at compile time. A value is
+ *   only ever multiplied by such a constant and rescaled with a shift, so
+ *   there is no floating point and no division. Whether gcc turns the
+ *   multiplications into shifts and adds or into __mulsi3 calls depends on
+ *   the optimization level; building cruise_skeleton.c with -DCRUISE_PERF=1
+ *   counts the cycles of one step on the board.
+ *
+ *   The header is included by cruise_skeleton.c, which defines the periods
+ *   and gains below before including it, and by host/bench/model_bench.c,
+ *   which compares it with a double precision reference.
+ */
+#ifndef CRUISE_MODEL_H
+#define CRUISE_MODEL_H
+
+#if !defined(VEHICLE_PERIOD) || !defined(CONTROL_PERIOD) || \
+    !defined(THROTTLE_K) || !defined(THROTTLE_TI) || !defined(DEFAULT_THROTTLE)
+#error "define the periods and the controller gains before cruise_model.h"
+#endif
+
+#define MODEL_Q 10
+#define CONTROL_Q 8
+
+/* Rounding to the nearest integer of a Q value */
+#define Q_ROUND(x, q) (((x) + (1 << ((q) - 1))) >> (q))
+
+/* Model constants; the vehicle period in seconds is 0.3 = 307 / 1024 */
+#define MODEL_DT ((VEHICLE_PERIOD * (1 << MODEL_Q) + 500) / 1000)
+#define MODEL_WIND_FACTOR 1
+#define MODEL_BRAKE_FACTOR 4
+#define MODEL_GRAVITY ((INT32S)2 << MODEL_Q)
+#define MODEL_TRACK_END ((INT32S)2400 << MODEL_Q)
+
+/*
+ * Gains of the incremental PI controller,
+ *
+ *   throttle += K (1 + T / (2 Ti)) e(k) + (T / (2 Ti) - 1) e(k - 1)
+ *
+ * with T = CONTROL_PERIOD. In integer arithmetic T / (2 Ti) = 1.5 became 1,
+ * which dropped the second term altogether.
+ */
+#define CONTROL_T_2TI ((CONTROL_PERIOD << CONTROL_Q) / (2 * THROTTLE_TI))
+#define CONTROL_GAIN_E (THROTTLE_K * ((1 << CONTROL_Q) + CONTROL_T_2TI))
+#define CONTROL_GAIN_LAST (CONTROL_T_2TI - (1 << CONTROL_Q))
+#define CONTROL_MAX_THROTTLE ((INT32S)80 << CONTROL_Q)
+#define CONTROL_STEP ((INT32S)DEFAULT_THROTTLE << CONTROL_Q)
+
+struct vehicle_model
+{
+  INT32S position;     /* m, Q MODEL_Q     */
+  INT32S velocity;     /* m/s, Q MODEL_Q   */
+  INT32S acceleration; /* m/s2, Q MODEL_Q  */
+};
+
+struct pi_control
+{
+  INT32S throttle;   /* 0.1 V, Q CONTROL_Q */
+  INT32S last_error; /* m/s               */
+};
+
+/*
+ * One period of the vehicle: the acceleration from the current state and
+ * inputs, then the new position and velocity. 'throttle' is in 0.1 V, i.e.
+ * the value written to Reg_Throttle.
+ */
+static inline void vehicle_step(struct vehicle_model *m, INT32S throttle,
+                                int brake, int engine)
+{
+  INT32S position = m->position >> MODEL_Q;
+  INT32S acceleration;
+
+  if (!brake)
+  {
+    acceleration = -MODEL_WIND_FACTOR * m->velocity;
+    if (engine)
+      acceleration += throttle << MODEL_Q;
+
+    if (400 <= position && position < 800)
+      acceleration -= MODEL_GRAVITY; // traveling uphill
+    else if (800 <= position && position < 1200)
+      acceleration -= 2 * MODEL_GRAVITY; // traveling steep uphill
+    else if (1600 <= position && position < 2000)
+      acceleration += 2 * MODEL_GRAVITY; // traveling downhill
+    else if (2000 <= position)
+      acceleration += MODEL_GRAVITY; // traveling steep downhill
+  }
+  else
+    acceleration = -MODEL_BRAKE_FACTOR * m->velocity;
+
+  m->acceleration = acceleration;
+  m->position += (m->velocity * MODEL_DT) >> MODEL_Q;
+  m->velocity += (acceleration * MODEL_DT) >> MODEL_Q;
+
+  // reset the position to the beginning of the track
+  if (m->position > MODEL_TRACK_END)
+    m->position = 0;
+}
+
+static inline INT32S vehicle_position(const struct vehicle_model *m)
+{
+  return m->position >> MODEL_Q;
+}
+
+static inline INT32S vehicle_velocity(const struct vehicle_model *m)
+{
+  return Q_ROUND(m->velocity, MODEL_Q);
+}
+
+static inline INT32S vehicle_acceleration(const struct vehicle_model *m)
+{
+  return Q_ROUND(m->acceleration, MODEL_Q);
+}
+
+/* Keeps the throttle between 0 and 8.0 V */
+static inline void control_clamp(struct pi_control *c)
+{
+  if (c->throttle < 0)
+    c->throttle = 0;
+  else if (c->throttle > CONTROL_MAX_THROTTLE)
+    c->throttle = CONTROL_MAX_THROTTLE;
+}
+
+/* One period of the PI controller, 'error' = target - current velocity */
+static inline void control_pi(struct pi_control *c, INT32S error)
+{
+  c->throttle += CONTROL_GAIN_E * error + CONTROL_GAIN_LAST * c->last_error;
+  c->last_error = error;
+  control_clamp(c);
+}
+
+/* Manual driving: the gas pedal adds DEFAULT_THROTTLE per period, else it
+   is taken off again */
+static inline void control_manual(struct pi_control *c, int gas)
+{
+  c->throttle += gas ? CONTROL_STEP : -CONTROL_STEP;
+  c->last_error = 0;
+  control_clamp(c);
+}
+
+static inline INT32S control_throttle(const struct pi_control *c)
+{
+  return c->throttle >> CONTROL_Q;
+}
+
+#endif /* CRUISE_MODEL_H */
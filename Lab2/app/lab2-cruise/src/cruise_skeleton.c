@@ -24,6 +24,9 @@
 #include "altera_avalon_pio_regs.h"
 #include "sys/alt_irq.h"
 #include "sys/alt_alarm.h"
+#include "os/alt_dlog.h"
+#include "os/alt_input.h"
+#include "os/alt_stkprof.h"
 #include <stdint.h>
 
 #define DEBUG 1
@@ -76,16 +79,53 @@
  * Definition of Tasks
  */
 
+/*
+ * The stack sizes come from cruise_stacks.h, generated by building with
+ * -DCRUISE_STKPROF=1: then every task gets TASK_STACKSIZE words, and
+ * StartTask profiles them instead of deleting itself. After STKPROF_TICKS
+ * ticks it prints the header with the deepest use of each task plus a
+ * margin (see os/alt_stkprof.h). On the host port,
+ * 'make stacks' does this under the workload of
+ * host/scripts/cruise_stkprof.pio.
+ */
+
 #define TASK_STACKSIZE 2048
 
-OS_STK StartTask_Stack[TASK_STACKSIZE];
-OS_STK ControlTask_Stack[TASK_STACKSIZE];
-OS_STK VehicleTask_Stack[TASK_STACKSIZE];
-OS_STK ButtonIOTask_Stack[TASK_STACKSIZE];
-OS_STK SwitchIOTask_Stack[TASK_STACKSIZE];
-OS_STK WatchdogTask_Stack[TASK_STACKSIZE];
-OS_STK OverloadDetectionTask_Stack[TASK_STACKSIZE];
-OS_STK OverloadMakerTask_Stack[TASK_STACKSIZE];
+#ifndef CRUISE_STKPROF
+#define CRUISE_STKPROF 0
+#endif
+
+#if CRUISE_STKPROF
+#define STKPROF_TICKS 20000
+
+#define STARTTASK_STACKSIZE TASK_STACKSIZE
+#define CONTROLTASK_STACKSIZE TASK_STACKSIZE
+#define VEHICLETASK_STACKSIZE TASK_STACKSIZE
+#define BUTTONIOTASK_STACKSIZE TASK_STACKSIZE
+#define SWITCHIOTASK_STACKSIZE TASK_STACKSIZE
+#define WATCHDOG_STACKSIZE TASK_STACKSIZE
+#define OVERLOADDETECTION_STACKSIZE TASK_STACKSIZE
+#define OVERLOADMAKER_STACKSIZE TASK_STACKSIZE
+#define STARTTASK_STACK_SECTION
+#define CONTROLTASK_STACK_SECTION
+#define VEHICLETASK_STACK_SECTION
+#define BUTTONIOTASK_STACK_SECTION
+#define SWITCHIOTASK_STACK_SECTION
+#define WATCHDOG_STACK_SECTION
+#define OVERLOADDETECTION_STACK_SECTION
+#define OVERLOADMAKER_STACK_SECTION
+#else
+#include "cruise_stacks.h"
+#endif
+
+OS_STK StartTask_Stack[STARTTASK_STACKSIZE] STARTTASK_STACK_SECTION;
+OS_STK ControlTask_Stack[CONTROLTASK_STACKSIZE] CONTROLTASK_STACK_SECTION;
+OS_STK VehicleTask_Stack[VEHICLETASK_STACKSIZE] VEHICLETASK_STACK_SECTION;
+OS_STK ButtonIOTask_Stack[BUTTONIOTASK_STACKSIZE] BUTTONIOTASK_STACK_SECTION;
+OS_STK SwitchIOTask_Stack[SWITCHIOTASK_STACKSIZE] SWITCHIOTASK_STACK_SECTION;
+OS_STK WatchdogTask_Stack[WATCHDOG_STACKSIZE] WATCHDOG_STACK_SECTION;
+OS_STK OverloadDetectionTask_Stack[OVERLOADDETECTION_STACKSIZE] OVERLOADDETECTION_STACK_SECTION;
+OS_STK OverloadMakerTask_Stack[OVERLOADMAKER_STACKSIZE] OVERLOADMAKER_STACK_SECTION;
 
 // Task Priorities
 
@@ -97,48 +137,96 @@ OS_STK OverloadMakerTask_Stack[TASK_STACKSIZE];
 #define SWITCH_IO_TASK_PRIO 13
 #define BUTTON_IO_TASK_PRIO 14
 #define OVERLOAD_DETECTION_PRIO 15
+#define LOG_DRAIN_PRIO 16
 
 // Task Periods
 
 #define CONTROL_PERIOD 300
 #define VEHICLE_PERIOD 300
 
-#define SWITCH_IO_POLL_PERIOD 10
-#define BUTTON_IO_POLL_PERIOD 10
 #define OVERLOAD_DETECTION_PERIOD 10
 #define WATCHDOG_PERIOD 300
 #define OVERLOAD_MAKER_PERIOD 300
 
+// Fixed-point vehicle model and controller
+#include "cruise_model.h"
+
+/*
+ * Building with -DCRUISE_PERF=1 (e.g. --set APP_CFLAGS_DEFINED_SYMBOLS
+ * -DCRUISE_PERF=1 for nios2-app-generate-makefile in run.sh) counts the
+ * cycles of vehicle_step() and of the control law in sections 1 and 2 of
+ * the PERFORMANCE_COUNTER. After PERF_STEPS vehicle periods VehicleTask
+ * prints the report; the cycles of one step are the clock cycles of a
+ * section over its occurrences. A step preempted by an interrupt is
+ * counted with it.
+ */
+#ifndef CRUISE_PERF
+#define CRUISE_PERF 0
+#endif
+
+#if CRUISE_PERF
+#ifdef ALT_HOST_PORT
+#error "CRUISE_PERF needs the PERFORMANCE_COUNTER of the board"
+#endif
+#include "altera_avalon_performance_counter.h"
+
+#define PERF_STEPS 100
+#define PERF_VEHICLE 1
+#define PERF_CONTROL 2
+#define STEP_BEGIN(section) PERF_BEGIN(PERFORMANCE_COUNTER_BASE, section)
+#define STEP_END(section) PERF_END(PERFORMANCE_COUNTER_BASE, section)
+#else
+#define STEP_BEGIN(section)
+#define STEP_END(section)
+#endif
+
 /*
  * Definition of Kernel Objects 
  */
 
-// Mailboxes
-OS_EVENT *Mbox_Throttle;
-OS_EVENT *Mbox_Velocity;
-OS_EVENT *Mbox_Brake;
-OS_EVENT *Mbox_Engine;
+// State registers, read without waiting for a new value
+OS_REG *Reg_Throttle;
+OS_REG *Reg_Velocity;
+OS_REG *Reg_Buttons;  /* struct buttons_state */
+OS_REG *Reg_Switches; /* struct switches_state */
 
-OS_EVENT *Mbox_Cruise;
-OS_EVENT *Mbox_TopGear;
-OS_EVENT *Mbox_Gas;
+// Debounced keys and switches, see os/alt_input.h
+alt_input keys_input;
+alt_input switches_input;
+
+#define KEYS_USED (GAS_PEDAL_FLAG | BRAKE_PEDAL_FLAG | CRUISE_CONTROL_FLAG)
+#define SWITCHES_USED (ENGINE_FLAG | TOP_GEAR_FLAG | SW_4 | SW_5 | SW_6 | \
+                       SW_7 | SW_8 | SW_9)
 
 // Semaphores
 OS_EVENT *sem_vehicle;
 OS_EVENT *sem_control;
-OS_EVENT *sem_button;
-OS_EVENT *sem_switch;
 OS_EVENT *sem_watchdog;
 OS_EVENT *sem_overload;
 OS_EVENT *sem_overload_maker;
 
 OS_EVENT *sem_overload_ok;
 
+// Deferred log of the vehicle model, see os/alt_dlog.h
+enum log_id
+{
+  LOG_POSITION,
+  LOG_VELOCITY,
+  LOG_ACCELERATION,
+  LOG_THROTTLE
+};
+
+static const char *const log_formats[] = {
+    "Position: %d m\n",
+    "Velocity: %d m/s\n",
+    "Accell: %d m/s2\n",
+    "Throttle: %d V\n"};
+
+ALT_DLOG_RING(vehicle_log, 64)
+
 // SW-Timer
 OS_TMR *timer_vehicle;
 OS_TMR *timer_control;
-OS_TMR *timer_button;
-OS_TMR *timer_switch;
 OS_TMR *timer_overload;
 OS_TMR *timer_watchdog;
 OS_TMR *timer_overloadmaker;
@@ -152,6 +240,19 @@ enum active
   off = 1
 };
 
+struct buttons_state
+{
+  enum active cruise;
+  enum active brake;
+  enum active gas;
+};
+
+struct switches_state
+{
+  enum active engine;
+  enum active top_gear;
+};
+
 /*
  * Global variables
  */
@@ -173,16 +274,6 @@ void control_callback(void *ptmr, void *arg)
   OSSemPost(sem_control);
 }
 
-void button_callback(void *ptmr, void *arg)
-{
-  OSSemPost(sem_button);
-}
-
-void switch_callback(void *ptmr, void *arg)
-{
-  OSSemPost(sem_switch);
-}
-
 void watchdog_callback(void *ptmr, void *arg)
 {
   OSSemPost(sem_watchdog);
@@ -203,12 +294,12 @@ void overloadmaker_callback(void *ptmr, void *arg){
 
 int buttons_pressed(void)
 {
-  return ~IORD_ALTERA_AVALON_PIO_DATA(D2_PIO_KEYS4_BASE);
+  return alt_input_state(&keys_input);
 }
 
 int switches_pressed(void)
 {
-  return IORD_ALTERA_AVALON_PIO_DATA(DE2_PIO_TOGGLES18_BASE);
+  return alt_input_state(&switches_input);
 }
 
 /*
@@ -354,83 +445,64 @@ void show_position(INT16U position)
 void VehicleTask(void *pdata)
 {
   uint8_t perr;
-  // constants that should not be modified
-  const unsigned int wind_factor = 1;
-  const unsigned int brake_factor = 4;
-  const unsigned int gravity_factor = 2;
   // variables relevant to the model and its simulation on top of the RTOS
   INT8U err;
-  void *msg;
-  INT8U *throttle;
-  INT16S acceleration;
+  INT8U throttle = 0;
+  struct buttons_state buttons;
+  struct switches_state switches;
+  struct vehicle_model model = {0, 0, 0};
   INT16U position = 0;
   INT16S velocity = 0;
   enum active brake_pedal = off;
   enum active engine = off;
+#if CRUISE_PERF
+  int perf_steps = 0;
+#endif
 
   printf("Vehicle task created!\n");
 
   while (1)
   {
-    err = OSMboxPost(Mbox_Velocity, (void *)&velocity);
+    err = OSRegWrite(Reg_Velocity, (void *)&velocity);
 
     OSSemPend(sem_vehicle, 0, &perr);
 
-    /* Non-blocking read of mailbox: 
-       - message in mailbox: update throttle
-       - no message:         use old throttle
-       */
-    msg = OSMboxPend(Mbox_Throttle, 1, &err);
-    if (err == OS_NO_ERR)
-      throttle = (INT8U *)msg;
-    /* Same for the brake signal that bypass the control law */
-    msg = OSMboxPend(Mbox_Brake, 1, &err);
-    if (err == OS_NO_ERR)
-      brake_pedal = *((enum active *)msg);
-    /* Same for the engine signal that bypass the control law */
-    msg = OSMboxPend(Mbox_Engine, 1, &err);
-    if (err == OS_NO_ERR)
-      engine = *((enum active *)msg);
+    /* Non-blocking read of the latest throttle, and of the brake and
+       engine signals that bypass the control law */
+    OSRegRead(Reg_Throttle, &throttle, &err);
+    OSRegRead(Reg_Buttons, &buttons, &err);
+    OSRegRead(Reg_Switches, &switches, &err);
+    brake_pedal = buttons.brake;
+    engine = switches.engine;
 
     // vehichle cannot effort more than 80 units of throttle
-    if (*throttle > 80)
-      *throttle = 80;
-
-    // brakes + wind
-    if (brake_pedal == off)
+    if (throttle > 80)
+      throttle = 80;
+
+    // brakes + wind + gravity, see cruise_model.h. If the engine and the
+    // brakes are activated at the same time, we assume that the brake
+    // dynamics dominates.
+    STEP_BEGIN(PERF_VEHICLE);
+    vehicle_step(&model, throttle, brake_pedal == on, engine == on);
+    STEP_END(PERF_VEHICLE);
+
+#if CRUISE_PERF
+    if (++perf_steps == PERF_STEPS)
     {
-      // wind resistance
-      acceleration = -wind_factor * velocity;
-      // actuate with engines
-      if (engine == on)
-        acceleration += (*throttle);
-
-      // gravity effects
-      if (400 <= position && position < 800)
-        acceleration -= gravity_factor; // traveling uphill
-      else if (800 <= position && position < 1200)
-        acceleration -= 2 * gravity_factor; // traveling steep uphill
-      else if (1600 <= position && position < 2000)
-        acceleration += 2 * gravity_factor; //traveling downhill
-      else if (2000 <= position)
-        acceleration += gravity_factor; // traveling steep downhill
+      PERF_STOP_MEASURING(PERFORMANCE_COUNTER_BASE);
+      perf_print_formatted_report((void *)PERFORMANCE_COUNTER_BASE,
+                                  alt_get_cpu_freq(), 2,
+                                  "vehicle_step", "control");
     }
-    // if the engine and the brakes are activated at the same time,
-    // we assume that the brake dynamics dominates, so both cases fall
-    // here.
-    else
-      acceleration = -brake_factor * velocity;
+#endif
 
-    printf("Position: %d m\n", position);
-    printf("Velocity: %d m/s\n", velocity);
-    printf("Accell: %d m/s2\n", acceleration);
-    printf("Throttle: %d V\n", *throttle);
+    ALT_DLOG1(vehicle_log, LOG_POSITION, position);
+    ALT_DLOG1(vehicle_log, LOG_VELOCITY, velocity);
+    ALT_DLOG1(vehicle_log, LOG_ACCELERATION, vehicle_acceleration(&model));
+    ALT_DLOG1(vehicle_log, LOG_THROTTLE, throttle);
 
-    position = position + velocity * VEHICLE_PERIOD / 1000;
-    velocity = velocity + acceleration * VEHICLE_PERIOD / 1000.0;
-    // reset the position to the beginning of the track
-    if (position > 2400)
-      position = 0;
+    position = vehicle_position(&model);
+    velocity = vehicle_velocity(&model);
 
     show_velocity_on_sevenseg((INT8S)velocity);
     show_position(position);
@@ -445,11 +517,12 @@ void VehicleTask(void *pdata)
 void ControlTask(void *pdata)
 {
   INT8U err;
-  INT8U throttle; /* Value between 0 and 80, which is interpreted as between 0.0V and 8.0V */
-  void *msg;
-  INT16S *current_velocity;
+  INT8U throttle = 0; /* Value between 0 and 80, which is interpreted as between 0.0V and 8.0V */
+  struct pi_control control = {0, 0};
+  INT16S current_velocity;
+  struct buttons_state buttons;
+  struct switches_state switches;
   INT16S target_velocity = -1;
-  INT16S last_error = 0;
   uint8_t perr;
 
   enum active gas_pedal = off;
@@ -460,30 +533,25 @@ void ControlTask(void *pdata)
 
   while (1)
   {
-    msg = OSMboxPend(Mbox_Velocity, 0, &err);
-    current_velocity = (INT16S *)msg;
-
-    msg = OSMboxPend(Mbox_Gas, 0, &err);
-    gas_pedal = *((enum active *)msg);
-
-    msg = OSMboxPend(Mbox_Cruise, 0, &err);
-    cruise_control = *((enum active *)msg);
-
-    msg = OSMboxPend(Mbox_TopGear, 0, &err);
-    top_gear = *((enum active *)msg);
-
-    if (cruise_control == on && target_velocity == -1 && *current_velocity > 20)
+    OSRegRead(Reg_Velocity, &current_velocity, &err);
+    OSRegRead(Reg_Buttons, &buttons, &err);
+    OSRegRead(Reg_Switches, &switches, &err);
+    gas_pedal = buttons.gas;
+    cruise_control = buttons.cruise;
+    top_gear = switches.top_gear;
+
+    if (cruise_control == on && target_velocity == -1 && current_velocity > 20)
     {
-      target_velocity = *current_velocity;
+      target_velocity = current_velocity;
     }
 
     green_leds &= ~LED_GREEN_0;
 
-    if (top_gear == on && *current_velocity > 20)
+    if (top_gear == on && current_velocity > 20)
     {
       if (cruise_control == on && target_velocity == -1)
       {
-        target_velocity = *current_velocity;
+        target_velocity = current_velocity;
       }
       else if (cruise_control == off)
       {
@@ -492,44 +560,34 @@ void ControlTask(void *pdata)
 
       if (cruise_control == on)
       {
-
-        throttle = throttle + THROTTLE_K * (1 + CONTROL_PERIOD / (2 * THROTTLE_TI)) * (target_velocity - *current_velocity) + (CONTROL_PERIOD / (2 * THROTTLE_TI) - 1) * last_error;
-
-        last_error = target_velocity - *current_velocity;
+        STEP_BEGIN(PERF_CONTROL);
+        control_pi(&control, target_velocity - current_velocity);
+        STEP_END(PERF_CONTROL);
 
         show_target_velocity(target_velocity);
         green_leds |= LED_GREEN_0;
       }
       else
       {
-        last_error = 0;
         show_target_velocity(0);
-        if (gas_pedal == on)
-        {
-          throttle += DEFAULT_THROTTLE;
-        }
-        else
-        {
-          throttle = throttle > 0 ? throttle - DEFAULT_THROTTLE : 0;
-        }
+        STEP_BEGIN(PERF_CONTROL);
+        control_manual(&control, gas_pedal == on);
+        STEP_END(PERF_CONTROL);
       }
     }
     else
     {
-      last_error = 0;
       show_target_velocity(0);
-      if (gas_pedal == on)
-      {
-        throttle += DEFAULT_THROTTLE;
-      }
-      else
-      {
-        throttle = throttle > 0 ? throttle - DEFAULT_THROTTLE : 0;
-      }
+      STEP_BEGIN(PERF_CONTROL);
+      control_manual(&control, gas_pedal == on);
+      STEP_END(PERF_CONTROL);
     }
 
+    // between 0 and 80, see cruise_model.h
+    throttle = control_throttle(&control);
+
     //IOWR_ALTERA_AVALON_PIO_DATA(DE2_PIO_GREENLED9_BASE, green_leds);
-    err = OSMboxPost(Mbox_Throttle, (void *)&throttle);
+    err = OSRegWrite(Reg_Throttle, (void *)&throttle);
 
     OSSemPend(sem_control, 0, &perr);
   }
@@ -541,6 +599,7 @@ void SwitchIOTask(void *pdata)
   int switch_io;
   enum active top_gear;
   enum active engine;
+  struct switches_state switches;
   while (1)
   {
     switch_io = switches_pressed();
@@ -594,14 +653,16 @@ void SwitchIOTask(void *pdata)
       by64 += 32;
     }
 
-    float percentage = 300 * (((float)by64) / ((float)64));
-    overload_sleep = (int)percentage;
+    // 300 * by64 / 64 ticks, without the soft float
+    overload_sleep = (300 * by64) >> 6;
 
-    OSMboxPost(Mbox_Engine, &engine);
-    OSMboxPost(Mbox_TopGear, &top_gear);
+    switches.engine = engine;
+    switches.top_gear = top_gear;
+    OSRegWrite(Reg_Switches, &switches);
     IOWR_ALTERA_AVALON_PIO_DATA(DE2_PIO_REDLED18_BASE, red_leds);
 
-    OSSemPend(sem_switch, 0, &perr);
+    /* Sleep until a switch has been flipped */
+    alt_input_wait(&switches_input, SWITCHES_USED, 0, &perr);
   }
 }
 
@@ -613,6 +674,7 @@ void ButtonIOTask(void *pdata)
   enum active cruise;
   enum active brake;
   enum active gas;
+  struct buttons_state state;
 
   while (1)
   {
@@ -652,12 +714,14 @@ void ButtonIOTask(void *pdata)
       gas = off;
     }
 
-    OSMboxPost(Mbox_Gas, &gas);
-    OSMboxPost(Mbox_Brake, &brake);
-    OSMboxPost(Mbox_Cruise, &cruise);
+    state.cruise = cruise;
+    state.brake = brake;
+    state.gas = gas;
+    OSRegWrite(Reg_Buttons, &state);
     IOWR_ALTERA_AVALON_PIO_DATA(DE2_PIO_GREENLED9_BASE, green_leds);
 
-    OSSemPend(sem_button, 0, &perr);
+    /* Sleep until a key has been pressed or released */
+    alt_input_wait(&keys_input, KEYS_USED, 0, &perr);
   }
 }
 
@@ -673,7 +737,14 @@ void WatchdogTask(void *pdata)
 
     if (perr == OS_ERR_TIMEOUT)
     {
+#if OS_TASK_CPU_USAGE_EN
+      INT16U usage = OSTaskCPUUsageGet(OVERLOAD_MAKER_PRIO, &perr);
+
+      printf("Overload detected! CPU %d %%, OverloadMaker %u.%02u %%\n",
+             OSCPUUsage, usage / 100, usage % 100);
+#else
       printf("Overload detected!\n");
+#endif
     }
   }
 }
@@ -721,6 +792,11 @@ void StartTask(void *pdata)
   void *context;
 
   static alt_alarm alarm; /* Is needed for timer ISR function */
+  /* Storage of the state registers, with their initial values */
+  static INT8U throttle_reg = 0;
+  static INT16S velocity_reg = 0;
+  static struct buttons_state buttons_reg = {off, off, off};     /* Pedals released */
+  static struct switches_state switches_reg = {off, off};        /* Engine off */
 
   /* Base resolution for SW timer : HW_TIMER_PERIOD ms */
   delay = alt_ticks_per_second() * HW_TIMER_PERIOD / 1000;
@@ -737,6 +813,11 @@ void StartTask(void *pdata)
     printf("No system clock available!n");
   }
 
+#if CRUISE_PERF
+  PERF_RESET(PERFORMANCE_COUNTER_BASE);
+  PERF_START_MEASURING(PERFORMANCE_COUNTER_BASE);
+#endif
+
   /* 
    * Create and start Software Timer 
    */
@@ -745,15 +826,28 @@ void StartTask(void *pdata)
    * Creation of Kernel Objects
    */
 
-  // Mailboxes
-  Mbox_Throttle = OSMboxCreate((void *)0); /* Empty Mailbox - Throttle */
-  Mbox_Velocity = OSMboxCreate((void *)0); /* Empty Mailbox - Velocity */
-  Mbox_Brake = OSMboxCreate((void *)1);    /* Empty Mailbox - Velocity */
-  Mbox_Engine = OSMboxCreate((void *)1);   /* Empty Mailbox - Engine */
-
-  Mbox_Gas = OSMboxCreate((void *)1);
-  Mbox_Cruise = OSMboxCreate((void *)1);
-  Mbox_TopGear = OSMboxCreate((void *)0);
+  // State registers
+  Reg_Throttle = OSRegCreate(&throttle_reg, sizeof(throttle_reg), &err);
+  Reg_Velocity = OSRegCreate(&velocity_reg, sizeof(velocity_reg), &err);
+  Reg_Buttons = OSRegCreate(&buttons_reg, sizeof(buttons_reg), &err);
+  Reg_Switches = OSRegCreate(&switches_reg, sizeof(switches_reg), &err);
+
+  // Edge capture interrupts of the keys (low active, falling edge only)
+  // and of the switches (both edges)
+  if (alt_input_open(&keys_input, D2_PIO_KEYS4_BASE,
+                     D2_PIO_KEYS4_IRQ_INTERRUPT_CONTROLLER_ID,
+                     D2_PIO_KEYS4_IRQ, KEYS_USED, KEYS_USED,
+                     ALT_INPUT_EDGE_ACTIVE) < 0)
+  {
+    printf("Could not set up the keys!\n");
+  }
+  if (alt_input_open(&switches_input, DE2_PIO_TOGGLES18_BASE,
+                     DE2_PIO_TOGGLES18_IRQ_INTERRUPT_CONTROLLER_ID,
+                     DE2_PIO_TOGGLES18_IRQ, SWITCHES_USED, 0,
+                     ALT_INPUT_EDGE_ANY) < 0)
+  {
+    printf("Could not set up the switches!\n");
+  }
 
   /*
    * Create statistics task
@@ -761,6 +855,15 @@ void StartTask(void *pdata)
 
   OSStatInit();
 
+  /*
+   * Start the task that prints the deferred log
+   */
+
+  alt_dlog_register(&vehicle_log);
+  err = alt_dlog_init(log_formats,
+                      sizeof(log_formats) / sizeof(log_formats[0]),
+                      LOG_DRAIN_PRIO);
+
   /* 
    * Creating Tasks in the system 
    */
@@ -769,12 +872,12 @@ void StartTask(void *pdata)
       ControlTask, // Pointer to task code
       NULL,        // Pointer to argument that is
       // passed to task
-      &ControlTask_Stack[TASK_STACKSIZE - 1], // Pointer to top
+      &ControlTask_Stack[CONTROLTASK_STACKSIZE - 1], // Pointer to top
       // of task stack
       CONTROLTASK_PRIO,
       CONTROLTASK_PRIO,
       (void *)&ControlTask_Stack[0],
-      TASK_STACKSIZE,
+      CONTROLTASK_STACKSIZE,
       (void *)0,
       OS_TASK_OPT_STK_CHK);
 
@@ -782,72 +885,84 @@ void StartTask(void *pdata)
       VehicleTask, // Pointer to task code
       NULL,        // Pointer to argument that is
       // passed to task
-      &VehicleTask_Stack[TASK_STACKSIZE - 1], // Pointer to top
+      &VehicleTask_Stack[VEHICLETASK_STACKSIZE - 1], // Pointer to top
       // of task stack
       VEHICLETASK_PRIO,
       VEHICLETASK_PRIO,
       (void *)&VehicleTask_Stack[0],
-      TASK_STACKSIZE,
+      VEHICLETASK_STACKSIZE,
       (void *)0,
       OS_TASK_OPT_STK_CHK);
 
   err = OSTaskCreateExt(
       ButtonIOTask,
       NULL,
-      &ButtonIOTask_Stack[TASK_STACKSIZE - 1],
+      &ButtonIOTask_Stack[BUTTONIOTASK_STACKSIZE - 1],
       BUTTON_IO_TASK_PRIO,
       BUTTON_IO_TASK_PRIO,
       (void *)&ButtonIOTask_Stack[0],
-      TASK_STACKSIZE,
+      BUTTONIOTASK_STACKSIZE,
       (void *)0,
       OS_TASK_OPT_STK_CHK);
 
   err = OSTaskCreateExt(
       SwitchIOTask,
       NULL,
-      &SwitchIOTask_Stack[TASK_STACKSIZE - 1],
+      &SwitchIOTask_Stack[SWITCHIOTASK_STACKSIZE - 1],
       SWITCH_IO_TASK_PRIO,
       SWITCH_IO_TASK_PRIO,
       (void *)&SwitchIOTask_Stack[0],
-      TASK_STACKSIZE,
+      SWITCHIOTASK_STACKSIZE,
       (void *)0,
       OS_TASK_OPT_STK_CHK);
 
   err = OSTaskCreateExt(
       WatchdogTask,
       NULL,
-      &WatchdogTask_Stack[TASK_STACKSIZE - 1],
+      &WatchdogTask_Stack[WATCHDOG_STACKSIZE - 1],
       WATCHDOG_PRIO,
       WATCHDOG_PRIO,
       (void *)&WatchdogTask_Stack[0],
-      TASK_STACKSIZE,
+      WATCHDOG_STACKSIZE,
       (void *)0,
       OS_TASK_OPT_STK_CHK);
 
   err = OSTaskCreateExt(
       OverloadDetectionTask,
       NULL,
-      &OverloadDetectionTask_Stack[TASK_STACKSIZE - 1],
+      &OverloadDetectionTask_Stack[OVERLOADDETECTION_STACKSIZE - 1],
       OVERLOAD_DETECTION_PRIO,
       OVERLOAD_DETECTION_PRIO,
       (void *)&OverloadDetectionTask_Stack[0],
-      TASK_STACKSIZE,
+      OVERLOADDETECTION_STACKSIZE,
       (void *)0,
       OS_TASK_OPT_STK_CHK);
 
   err = OSTaskCreateExt(
       OverloadMaker,
       NULL,
-      &OverloadMakerTask_Stack[TASK_STACKSIZE - 1],
+      &OverloadMakerTask_Stack[OVERLOADMAKER_STACKSIZE - 1],
       OVERLOAD_MAKER_PRIO,
       OVERLOAD_MAKER_PRIO,
       (void *)&OverloadMakerTask_Stack[0],
-      TASK_STACKSIZE,
+      OVERLOADMAKER_STACKSIZE,
       (void *)0,
       OS_TASK_OPT_STK_CHK);
 
   printf("All Tasks and Kernel Objects generated!\n");
 
+#if CRUISE_STKPROF
+  alt_stkprof_add(STARTTASK_PRIO, "STARTTASK");
+  alt_stkprof_add(CONTROLTASK_PRIO, "CONTROLTASK");
+  alt_stkprof_add(VEHICLETASK_PRIO, "VEHICLETASK");
+  alt_stkprof_add(BUTTON_IO_TASK_PRIO, "BUTTONIOTASK");
+  alt_stkprof_add(SWITCH_IO_TASK_PRIO, "SWITCHIOTASK");
+  alt_stkprof_add(WATCHDOG_PRIO, "WATCHDOG");
+  alt_stkprof_add(OVERLOAD_DETECTION_PRIO, "OVERLOADDETECTION");
+  alt_stkprof_add(OVERLOAD_MAKER_PRIO, "OVERLOADMAKER");
+  alt_stkprof_run(STKPROF_TICKS, "CRUISE"); /* in place of this task */
+#endif
+
   /* Task deletes itself */
 
   OSTaskDel(OS_PRIO_SELF);
@@ -869,12 +984,12 @@ int main(void)
       StartTask, // Pointer to task code
       NULL,      // Pointer to argument that is
       // passed to task
-      (void *)&StartTask_Stack[TASK_STACKSIZE - 1], // Pointer to top
+      (void *)&StartTask_Stack[STARTTASK_STACKSIZE - 1], // Pointer to top
       // of task stack
       STARTTASK_PRIO,
       STARTTASK_PRIO,
       (void *)&StartTask_Stack[0],
-      TASK_STACKSIZE,
+      STARTTASK_STACKSIZE,
       (void *)0,
       OS_TASK_OPT_STK_CHK | OS_TASK_OPT_STK_CLR);
 
@@ -884,8 +999,6 @@ int main(void)
 
   sem_vehicle = OSSemCreate(0);
   sem_control = OSSemCreate(0);
-  sem_switch = OSSemCreate(0);
-  sem_button = OSSemCreate(0);
   sem_watchdog = OSSemCreate(0);
   sem_overload = OSSemCreate(0);
   sem_overload_ok = OSSemCreate(0);
@@ -893,16 +1006,12 @@ int main(void)
 
   timer_vehicle = OSTmrCreate(0, VEHICLE_PERIOD, OS_TMR_OPT_PERIODIC, vehicle_callback, NULL, name1, &perr);
   timer_control = OSTmrCreate(0, CONTROL_PERIOD, OS_TMR_OPT_PERIODIC, control_callback, NULL, name2, &perr);
-  timer_button = OSTmrCreate(0, BUTTON_IO_POLL_PERIOD, OS_TMR_OPT_PERIODIC, button_callback, NULL, name2, &perr);
-  timer_switch = OSTmrCreate(0, SWITCH_IO_POLL_PERIOD, OS_TMR_OPT_PERIODIC, switch_callback, NULL, name2, &perr);
   timer_watchdog = OSTmrCreate(0, WATCHDOG_PERIOD, OS_TMR_OPT_PERIODIC, watchdog_callback, NULL, name2, &perr);
   timer_overload = OSTmrCreate(0, OVERLOAD_DETECTION_PERIOD, OS_TMR_OPT_PERIODIC, overload_callback, NULL, name2, &perr);
   timer_overloadmaker = OSTmrCreate(0, OVERLOAD_MAKER_PERIOD, OS_TMR_OPT_PERIODIC, overloadmaker_callback, NULL, name2, &perr);
 
   OSTmrStart(timer_vehicle, &perr);
   OSTmrStart(timer_control, &perr);
-  OSTmrStart(timer_button, &perr);
-  OSTmrStart(timer_switch, &perr);
   OSTmrStart(timer_watchdog, &perr);
   OSTmrStart(timer_overload, &perr);
   OSTmrStart(timer_overloadmaker, &perr);
@@ -0,0 +1,60 @@
+/* Generated by alt_stkprof after 20000 ticks on the host port, do not edit.
+ *
+ * Stack sizes in OS_STK words: the deepest use seen plus 25 %, rounded
+ * up to 8 words and at least 256 words. Stacks that fit in 25600 bytes, by
+ * priority, go in .onchip_memory.
+ *
+ * The profile has not been run on the board, so there every stack
+ * keeps at least 2048 words until a board run replaces this header.
+ * The comments of the board sizes give their margin over the deepest
+ * use on the host.
+ */
+
+#ifndef __CRUISE_STACKS_H__
+#define __CRUISE_STACKS_H__
+
+#ifdef ALT_HOST_PORT
+
+#define WATCHDOG_STACKSIZE               1120  /* 3576 bytes used */
+#define WATCHDOG_STACK_SECTION
+#define OVERLOADMAKER_STACKSIZE          1168  /* 3720 bytes used */
+#define OVERLOADMAKER_STACK_SECTION
+#define STARTTASK_STACKSIZE              1200  /* 3816 bytes used */
+#define STARTTASK_STACK_SECTION
+#define VEHICLETASK_STACKSIZE            1032  /* 3288 bytes used */
+#define VEHICLETASK_STACK_SECTION
+#define CONTROLTASK_STACKSIZE             256  /* 376 bytes used */
+#define CONTROLTASK_STACK_SECTION
+#define SWITCHIOTASK_STACKSIZE            256  /* 232 bytes used */
+#define SWITCHIOTASK_STACK_SECTION
+#define BUTTONIOTASK_STACKSIZE            256  /* 232 bytes used */
+#define BUTTONIOTASK_STACK_SECTION
+#define OVERLOADDETECTION_STACKSIZE      1120  /* 3576 bytes used */
+#define OVERLOADDETECTION_STACK_SECTION
+
+#else /* !ALT_HOST_PORT */
+
+#define CRUISE_STACKS_FAST __attribute__ ((section (".onchip_memory")))
+
+#define WATCHDOG_STACKSIZE               2048  /* 3576 bytes used on the host, +129 % */
+#define WATCHDOG_STACK_SECTION          CRUISE_STACKS_FAST
+#define OVERLOADMAKER_STACKSIZE          2048  /* 3720 bytes used on the host, +120 % */
+#define OVERLOADMAKER_STACK_SECTION     CRUISE_STACKS_FAST
+#define STARTTASK_STACKSIZE              2048  /* 3816 bytes used on the host, +114 % */
+#define STARTTASK_STACK_SECTION         CRUISE_STACKS_FAST
+#define VEHICLETASK_STACKSIZE            2048  /* 3288 bytes used on the host, +149 % */
+#define VEHICLETASK_STACK_SECTION
+#define CONTROLTASK_STACKSIZE            2048  /* 376 bytes used on the host, +2078 % */
+#define CONTROLTASK_STACK_SECTION
+#define SWITCHIOTASK_STACKSIZE           2048  /* 232 bytes used on the host, +3431 % */
+#define SWITCHIOTASK_STACK_SECTION
+#define BUTTONIOTASK_STACKSIZE           2048  /* 232 bytes used on the host, +3431 % */
+#define BUTTONIOTASK_STACK_SECTION
+#define OVERLOADDETECTION_STACKSIZE      2048  /* 3576 bytes used on the host, +129 % */
+#define OVERLOADDETECTION_STACK_SECTION
+
+/* 24576 bytes in .onchip_memory */
+
+#endif /* ALT_HOST_PORT */
+
+#endif /* __CRUISE_STACKS_H__ */
@@ -0,0 +1,346 @@
+// File: KernelBench.c
+//
+// Microbenchmarks of the uC/OS-II primitives used in the labs. They time
+// what the one-off experiments in ../dump (ContextSwitch.c, Handshake.c
+// and SharedMemory.c) look at, repeatably and as CSV. Every case is run
+// BENCH_ITERATIONS times and timed with the HAL timestamp timer; as in
+// lab1-measure/src/functions.c the overhead of reading it is measured
+// first and subtracted from every sample. The cases are:
+//
+//   sem_pingpong        - OSSemPost() to a higher priority task, which posts
+//                         back: two context switches,
+//   mbox_roundtrip      - the same with a message through two mailboxes,
+//   q_postpend          - OSQPost() and OSQPend() of one message, one task,
+//   mutex_uncontended   - OSMutexPend() and OSMutexPost() of a free mutex,
+//   mutex_contended     - OSMutexPend() of a mutex held by a lower priority
+//                         task, which inherits the priority and releases it,
+//   flag_post_<n>       - OSFlagPost() that readies n lower priority waiters,
+//   timedly             - OSTimeDly(1) wake latency: from the tick, as time
+//                         stamped by an alarm callback in the tick
+//                         interrupt, to the task running again.
+//
+// The output is CSV, with the times in ns:
+//
+//   case,iterations,min_ns,median_ns,p99_ns,max_ns
+//
+// On the board this needs timer_1 as timestamp timer, see run-de2-35.sh;
+// the host port (app/host, 'make bench') builds it as bin/kernel_bench.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "includes.h"
+#include "sys/alt_timestamp.h"
+#include "sys/alt_alarm.h"
+#include "alt_types.h"
+
+#define   TASK_STACKSIZE       2048
+
+/* Definition of Task Priorities */
+#define   MUTEX_PIP            2   // priority inherited by the mutex owner
+#define   SEM_PONG_PRIO        3
+#define   MBOX_PONG_PRIO       4
+#define   BENCH_PRIO           5
+#define   HOLDER_PRIO          10
+#define   WAITER_PRIO          11  // first of FLAG_WAITERS
+
+#define   FLAG_WAITERS         4
+
+#define   BENCH_ITERATIONS     1000
+#define   TIMEDLY_ITERATIONS   100
+#define   OVERHEAD_RUNS        100
+
+OS_STK    bench_stk[TASK_STACKSIZE];
+OS_STK    sem_pong_stk[TASK_STACKSIZE];
+OS_STK    mbox_pong_stk[TASK_STACKSIZE];
+OS_STK    holder_stk[TASK_STACKSIZE];
+OS_STK    waiter_stk[FLAG_WAITERS][TASK_STACKSIZE];
+
+OS_EVENT* ping_sem;
+OS_EVENT* pong_sem;
+OS_EVENT* request_mbox;
+OS_EVENT* reply_mbox;
+OS_EVENT* queue;
+void*     queue_msgs[4];
+OS_EVENT* mutex;
+OS_EVENT* hold_sem;
+OS_EVENT* held_sem;
+OS_FLAG_GRP* flags;
+OS_EVENT* flag_done;
+
+alt_u32 samples[BENCH_ITERATIONS];
+alt_u32 timer_overhead;
+int flag_waiters;
+
+alt_alarm tick_alarm;
+volatile alt_u32 tick_time;      // timestamp of the last tick
+
+/* Partner tasks */
+
+void semPongTask(void* pdata)
+{
+  INT8U err;
+
+  while (1)
+    {
+      OSSemPend(ping_sem, 0, &err);
+      OSSemPost(pong_sem);
+    }
+}
+
+void mboxPongTask(void* pdata)
+{
+  INT8U err;
+  void* msg;
+
+  while (1)
+    {
+      msg = OSMboxPend(request_mbox, 0, &err);
+      OSMboxPost(reply_mbox, msg);
+    }
+}
+
+/* Takes the mutex when told to, and gives it up as soon as the benchmark
+   task, which is higher priority, has blocked on it */
+void holderTask(void* pdata)
+{
+  INT8U err;
+
+  while (1)
+    {
+      OSSemPend(hold_sem, 0, &err);
+      OSMutexPend(mutex, 0, &err);
+      OSSemPost(held_sem);
+      OSMutexPost(mutex);
+    }
+}
+
+void waiterTask(void* pdata)
+{
+  OS_FLAGS bit = 1 << (long)pdata;
+  INT8U err;
+
+  while (1)
+    {
+      OSFlagPend(flags, bit, OS_FLAG_WAIT_SET_ALL + OS_FLAG_CONSUME, 0, &err);
+      OSSemPost(flag_done);
+    }
+}
+
+/* Runs in the tick interrupt, before OSTimeTick() readies the delayed
+   tasks, and again on every tick */
+alt_u32 tickAlarm(void* context)
+{
+  tick_time = alt_timestamp();
+  return 1;
+}
+
+/* Cases: each one runs one iteration and returns the time it took */
+
+alt_u32 semPingPong(void)
+{
+  alt_u32 t0, t1;
+  INT8U err;
+
+  t0 = alt_timestamp();
+  OSSemPost(ping_sem);
+  OSSemPend(pong_sem, 0, &err);
+  t1 = alt_timestamp();
+  return t1 - t0;
+}
+
+alt_u32 mboxRoundTrip(void)
+{
+  alt_u32 t0, t1;
+  INT8U err;
+
+  t0 = alt_timestamp();
+  OSMboxPost(request_mbox, samples);
+  OSMboxPend(reply_mbox, 0, &err);
+  t1 = alt_timestamp();
+  return t1 - t0;
+}
+
+alt_u32 queuePostPend(void)
+{
+  alt_u32 t0, t1;
+  INT8U err;
+
+  t0 = alt_timestamp();
+  OSQPost(queue, samples);
+  OSQPend(queue, 0, &err);
+  t1 = alt_timestamp();
+  return t1 - t0;
+}
+
+alt_u32 mutexUncontended(void)
+{
+  alt_u32 t0, t1;
+  INT8U err;
+
+  t0 = alt_timestamp();
+  OSMutexPend(mutex, 0, &err);
+  OSMutexPost(mutex);
+  t1 = alt_timestamp();
+  return t1 - t0;
+}
+
+alt_u32 mutexContended(void)
+{
+  alt_u32 t0, t1;
+  INT8U err;
+
+  OSSemPost(hold_sem);
+  OSSemPend(held_sem, 0, &err);   // the holder now owns the mutex
+
+  t0 = alt_timestamp();
+  OSMutexPend(mutex, 0, &err);
+  t1 = alt_timestamp();
+
+  OSMutexPost(mutex);
+  return t1 - t0;
+}
+
+alt_u32 flagPost(void)
+{
+  alt_u32 t0, t1;
+  INT8U err;
+  int i;
+
+  t0 = alt_timestamp();
+  OSFlagPost(flags, (1 << flag_waiters) - 1, OS_FLAG_SET, &err);
+  t1 = alt_timestamp();
+
+  for (i = 0; i < flag_waiters; i++)
+    OSSemPend(flag_done, 0, &err);
+  return t1 - t0;
+}
+
+alt_u32 timeDly(void)
+{
+  alt_u32 t1;
+
+  OSTimeDly(1);
+  t1 = alt_timestamp();
+  return t1 - tick_time;
+}
+
+/* Harness */
+
+int compareSamples(const void* a, const void* b)
+{
+  alt_u32 x = *(const alt_u32*)a;
+  alt_u32 y = *(const alt_u32*)b;
+
+  return (x > y) - (x < y);
+}
+
+unsigned long nanoseconds(alt_u32 ticks)
+{
+  return (unsigned long)((alt_u64)ticks * 1000000000u / alt_timestamp_freq());
+}
+
+void measureTimer(void)
+{
+  alt_u32 t0, t1;
+  int i;
+
+  alt_timestamp_start();
+  timer_overhead = 0;
+  for (i = 0; i < OVERHEAD_RUNS; i++)
+    {
+      t0 = alt_timestamp();
+      t1 = alt_timestamp();
+      timer_overhead += t1 - t0;
+    }
+  timer_overhead /= OVERHEAD_RUNS;
+}
+
+void run(const char* name, alt_u32 (*bench)(void), int iterations)
+{
+  alt_u32 ticks;
+  int i;
+
+  alt_timestamp_start();
+  for (i = 0; i < iterations; i++)
+    {
+      ticks = bench();
+      samples[i] = ticks > timer_overhead ? ticks - timer_overhead : 0;
+    }
+
+  qsort(samples, iterations, sizeof(samples[0]), compareSamples);
+  printf("%s,%d,%lu,%lu,%lu,%lu\n", name, iterations,
+	 nanoseconds(samples[0]),
+	 nanoseconds(samples[iterations / 2]),
+	 nanoseconds(samples[(iterations - 1) * 99 / 100]),
+	 nanoseconds(samples[iterations - 1]));
+}
+
+void benchTask(void* pdata)
+{
+  char name[32];
+
+  if (alt_timestamp_start() < 0)
+    {
+      printf("No timestamp device available!\n");
+      exit(1);
+    }
+  measureTimer();
+
+  printf("# uC/OS-II primitives, timestamp %lu Hz, overhead %lu ns, "
+	 "tick %lu ns\n", (unsigned long)alt_timestamp_freq(),
+	 nanoseconds(timer_overhead),
+	 (unsigned long)(1000000000ul / OS_TICKS_PER_SEC));
+  printf("case,iterations,min_ns,median_ns,p99_ns,max_ns\n");
+
+  run("sem_pingpong", semPingPong, BENCH_ITERATIONS);
+  run("mbox_roundtrip", mboxRoundTrip, BENCH_ITERATIONS);
+  run("q_postpend", queuePostPend, BENCH_ITERATIONS);
+  run("mutex_uncontended", mutexUncontended, BENCH_ITERATIONS);
+  run("mutex_contended", mutexContended, BENCH_ITERATIONS);
+  for (flag_waiters = 1; flag_waiters <= FLAG_WAITERS; flag_waiters *= 2)
+    {
+      sprintf(name, "flag_post_%d", flag_waiters);
+      run(name, flagPost, BENCH_ITERATIONS);
+    }
+  alt_alarm_start(&tick_alarm, 1, tickAlarm, NULL);
+  run("timedly", timeDly, TIMEDLY_ITERATIONS);
+  alt_alarm_stop(&tick_alarm);
+
+  exit(0);
+}
+
+void createTask(void (*task)(void*), void* pdata, OS_STK* stk, INT8U prio)
+{
+  OSTaskCreateExt(task, pdata,
+		  &stk[TASK_STACKSIZE-1],
+		  prio, prio,
+		  &stk[0],
+		  TASK_STACKSIZE, NULL, 0);
+}
+
+int main(void)
+{
+  INT8U err;
+  int i;
+
+  ping_sem = OSSemCreate(0);
+  pong_sem = OSSemCreate(0);
+  request_mbox = OSMboxCreate(NULL);
+  reply_mbox = OSMboxCreate(NULL);
+  queue = OSQCreate(queue_msgs, sizeof(queue_msgs) / sizeof(queue_msgs[0]));
+  mutex = OSMutexCreate(MUTEX_PIP, &err);
+  hold_sem = OSSemCreate(0);
+  held_sem = OSSemCreate(0);
+  flags = OSFlagCreate(0, &err);
+  flag_done = OSSemCreate(0);
+
+  createTask(benchTask, NULL, bench_stk, BENCH_PRIO);
+  createTask(semPongTask, NULL, sem_pong_stk, SEM_PONG_PRIO);
+  createTask(mboxPongTask, NULL, mbox_pong_stk, MBOX_PONG_PRIO);
+  createTask(holderTask, NULL, holder_stk, HOLDER_PRIO);
+  for (i = 0; i < FLAG_WAITERS; i++)
+    createTask(waiterTask, (void*)(long)i, waiter_stk[i], WAITER_PRIO + i);
+
+  OSStart();
+  return 0;
+}
@@ -0,0 +1,366 @@
+// File: MemoryBench.c
+//
+// Characterizes the three memories of the lab system (system.h):
+//
+//   onchip - ONCHIP_MEMORY, 25 KB of FPGA block RAM,
+//   sram   - SRAM, 512 KB, where the linker script puts code, data, heap
+//            and stacks,
+//   sdram  - SDRAM, 8 MB, which also holds the reset vector and
+//            .exceptions (ALT_CPU_EXCEPTION_ADDR).
+//
+// Each one is run through four kernels on a buffer in its free part:
+//
+//   read   - sequential 32-bit reads, unrolled by 4,
+//   write  - sequential 32-bit writes, unrolled by 4,
+//   chase  - dependent loads along a random cycle through the buffer, i.e.
+//            the latency of a load that misses any prefetch,
+//   stride - reads of every STRIDE-th word, wrapping around, to show what
+//            row or line changes cost.
+//
+// The time is the median of TRIALS runs of alt_timestamp(), with the timer
+// overhead subtracted as in lab1-measure/src/functions.c. The regions are
+// also counted in sections 1 to 3 of the PERFORMANCE_COUNTER, whose report
+// is printed at the end. The output is CSV:
+//
+//   region,kernel,bytes,ns,mb_per_s,ns_per_access
+//
+// followed by a placement report: which region .exceptions, the tick and
+// scheduler code (OSTimeTick(), OS_Sched()) and the hot task stacks should
+// be linked to, from the measured access times and the free room.
+//
+// On the board the Nios II/e has no cache, so every region gets the same
+// BOARD_BYTES buffer and the numbers are the memories themselves. On the
+// host port (app/host, 'make bench' builds bin/memory_bench) the regions
+// are malloc'd buffers of the span of each memory, which end up in the L1,
+// L2 and last level cache or DRAM; there the placement report only shows
+// how it would read.
+//
+// Built for the board with
+//   APP_NAME=memory_bench SRC_PATH=./bench/memory ./run-de2-35.sh
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "includes.h"
+#include "system.h"
+#include "sys/alt_timestamp.h"
+#include "alt_types.h"
+
+#ifndef ALT_HOST_PORT
+#include "altera_avalon_performance_counter.h"
+#endif
+
+#define   REGIONS              3
+#define   TRIALS               5
+#define   STRIDE               16          // words, 64 bytes
+#define   BOARD_BYTES          (16 * 1024)
+
+/* Candidates for the on-chip memory. The size of .exceptions comes from
+   the linker script on the board; the others are estimates. */
+#define   EXCEPTIONS_BYTES     1024
+#define   SCHED_CODE_BYTES     2048
+#define   TASK_STACK_BYTES     (2048 * sizeof(OS_STK))
+#define   HOT_STACKS           3
+
+enum kernel {K_READ, K_WRITE, K_CHASE, K_STRIDE, KERNELS};
+
+const char* const kernel_names[KERNELS] = {"read", "write", "chase", "stride"};
+
+typedef struct
+{
+  const char* name;
+  alt_u32     span;        // size of the memory
+  alt_u32     free;        // room left by the linked program
+  alt_u32*    buffer;
+  alt_u32     bytes;
+  alt_u32     ps[KERNELS]; // median time of one access, in ps
+} region;
+
+#ifndef ALT_HOST_PORT
+/* Linker script symbols, see bsp/linker.x */
+extern char _alt_partition_onchip_memory_end[];
+extern char _alt_partition_sdram_end[];
+extern char __ram_exceptions_start[];
+extern char __ram_exceptions_end[];
+#endif
+
+region regions[REGIONS] =
+  {
+    {"onchip", ONCHIP_MEMORY_SPAN},
+    {"sram", SRAM_SPAN},
+    {"sdram", SDRAM_SPAN},
+  };
+
+alt_u32 timer_overhead;
+alt_u32 trials[TRIALS];
+volatile alt_u32 sink;
+
+/* Kernels, each over 'words' 32-bit words */
+
+void readWords(alt_u32* buffer, alt_u32 words)
+{
+  alt_u32 sum = 0;
+  alt_u32 i;
+
+  for (i = 0; i < words; i += 4)
+    sum += buffer[i] + buffer[i + 1] + buffer[i + 2] + buffer[i + 3];
+  sink = sum;
+}
+
+void writeWords(alt_u32* buffer, alt_u32 words)
+{
+  alt_u32 i;
+
+  for (i = 0; i < words; i += 4)
+    {
+      buffer[i] = i;
+      buffer[i + 1] = i;
+      buffer[i + 2] = i;
+      buffer[i + 3] = i;
+    }
+}
+
+void chaseWords(alt_u32* buffer, alt_u32 words)
+{
+  alt_u32 next = 0;
+  alt_u32 i;
+
+  for (i = 0; i < words; i++)
+    next = buffer[next];
+  sink = next;
+}
+
+void strideWords(alt_u32* buffer, alt_u32 words)
+{
+  alt_u32 sum = 0;
+  alt_u32 start, i;
+
+  for (start = 0; start < STRIDE; start++)
+    for (i = start; i < words; i += STRIDE)
+      sum += buffer[i];
+  sink = sum;
+}
+
+/* A single random cycle through all the words (Sattolo's algorithm), so
+   that the chase visits each one once */
+void makeCycle(alt_u32* buffer, alt_u32 words)
+{
+  alt_u32 seed = 2206;
+  alt_u32 i, j, t;
+
+  for (i = 0; i < words; i++)
+    buffer[i] = i;
+  for (i = words - 1; i > 0; i--)
+    {
+      seed = seed * 1664525 + 1013904223;
+      j = (seed >> 8) % i;
+      t = buffer[i];
+      buffer[i] = buffer[j];
+      buffer[j] = t;
+    }
+}
+
+int compareTicks(const void* a, const void* b)
+{
+  alt_u32 x = *(const alt_u32*)a;
+  alt_u32 y = *(const alt_u32*)b;
+
+  return (x > y) - (x < y);
+}
+
+alt_u32 nanoseconds(alt_u32 ticks)
+{
+  return (alt_u32)((alt_u64)ticks * 1000000000u / alt_timestamp_freq());
+}
+
+void measureTimer(void)
+{
+  alt_u32 t0, t1;
+  int i;
+
+  alt_timestamp_start();
+  timer_overhead = 0;
+  for (i = 0; i < 10; i++)
+    {
+      t0 = alt_timestamp();
+      t1 = alt_timestamp();
+      timer_overhead += t1 - t0;
+    }
+  timer_overhead /= 10;
+}
+
+/* Median time of one run of a kernel over the region, in ns */
+alt_u32 measure(region* r, int kernel)
+{
+  alt_u32 words = r->bytes / 4;
+  alt_u32 t0, t1;
+  int t;
+
+  if (kernel == K_CHASE)
+    makeCycle(r->buffer, words);
+
+  for (t = 0; t < TRIALS; t++)
+    {
+      alt_timestamp_start();
+      t0 = alt_timestamp();
+      switch (kernel)
+	{
+	case K_READ: readWords(r->buffer, words); break;
+	case K_WRITE: writeWords(r->buffer, words); break;
+	case K_CHASE: chaseWords(r->buffer, words); break;
+	case K_STRIDE: strideWords(r->buffer, words); break;
+	}
+      t1 = alt_timestamp();
+      trials[t] = t1 - t0 > timer_overhead ? t1 - t0 - timer_overhead : 0;
+    }
+
+  qsort(trials, TRIALS, sizeof(trials[0]), compareTicks);
+  return nanoseconds(trials[TRIALS / 2]);
+}
+
+/* Finds the free part of each memory and sets up its buffer */
+int setupRegions(void)
+{
+  int i;
+
+#ifndef ALT_HOST_PORT
+  regions[0].free = ONCHIP_MEMORY_BASE + ONCHIP_MEMORY_SPAN
+    - (alt_u32)_alt_partition_onchip_memory_end;
+  regions[0].buffer = (alt_u32*)(((alt_u32)_alt_partition_onchip_memory_end + 3) & ~3);
+  regions[1].buffer = malloc(BOARD_BYTES);
+  regions[1].free = regions[1].buffer ? BOARD_BYTES : 0;
+  regions[2].free = SDRAM_BASE + SDRAM_SPAN - (alt_u32)_alt_partition_sdram_end;
+  regions[2].buffer = (alt_u32*)(((alt_u32)_alt_partition_sdram_end + 3) & ~3);
+
+  for (i = 0; i < REGIONS; i++)
+    regions[i].bytes = BOARD_BYTES;
+#else
+  for (i = 0; i < REGIONS; i++)
+    {
+      regions[i].bytes = regions[i].span & ~63;
+      regions[i].free = regions[i].span;
+      regions[i].buffer = malloc(regions[i].bytes);
+    }
+#endif
+
+  for (i = 0; i < REGIONS; i++)
+    if (!regions[i].buffer || regions[i].free < regions[i].bytes)
+      {
+	printf("%s: no room for %lu bytes\n", regions[i].name,
+	       (unsigned long)regions[i].bytes);
+	return -1;
+      }
+  return 0;
+}
+
+/* The region with the smallest access time of 'kernel' that still has
+   'bytes' free */
+region* fastest(int kernel, alt_u32 bytes)
+{
+  region* best = NULL;
+  int i;
+
+  for (i = 0; i < REGIONS; i++)
+    if (regions[i].free >= bytes
+	&& (!best || regions[i].ps[kernel] < best->ps[kernel]))
+      best = &regions[i];
+  return best;
+}
+
+/* Recommends a region for 'bytes' now in region 'now', and takes the room;
+   a move has to gain at least 10% */
+void recommend(const char* what, int now, int kernel, alt_u32 bytes)
+{
+  region* r = fastest(kernel, bytes);
+
+  if (!r || (alt_u64)r->ps[kernel] * 10 > (alt_u64)regions[now].ps[kernel] * 9)
+    printf("# %-22s %6lu bytes: keep in %s\n", what,
+	   (unsigned long)bytes, regions[now].name);
+  else
+    {
+      printf("# %-22s %6lu bytes: %s -> %s, %s %.3f -> %.3f ns per word\n",
+	     what, (unsigned long)bytes, regions[now].name, r->name,
+	     kernel_names[kernel], regions[now].ps[kernel] / 1000.0,
+	     r->ps[kernel] / 1000.0);
+      r->free -= bytes;
+    }
+}
+
+/* Code is fetched in sequence, so it goes by the read time; stacks are
+   written and read back near their top, so they go by the write time.
+   Placed most frequent first, as long as there is room. */
+void report(void)
+{
+  alt_u32 exceptions = EXCEPTIONS_BYTES;
+  char what[32];
+  int i;
+
+#ifndef ALT_HOST_PORT
+  exceptions = __ram_exceptions_end - __ram_exceptions_start;
+#endif
+
+  printf("# placement\n");
+  recommend(".exceptions", 2, K_READ, exceptions);
+  recommend("OSTimeTick, OS_Sched", 1, K_READ, SCHED_CODE_BYTES);
+  for (i = 0; i < HOT_STACKS; i++)
+    {
+      sprintf(what, "hot task stack %d", i + 1);
+      recommend(what, 1, K_WRITE, TASK_STACK_BYTES);
+    }
+}
+
+int main(void)
+{
+  region* r;
+  alt_u32 ns;
+  int kernel;
+  int i;
+
+  if (alt_timestamp_start() < 0)
+    {
+      printf("No timestamp device available!\n");
+      return 1;
+    }
+  measureTimer();
+  if (setupRegions() < 0)
+    return 1;
+
+#ifndef ALT_HOST_PORT
+  PERF_RESET(PERFORMANCE_COUNTER_BASE);
+  PERF_START_MEASURING(PERFORMANCE_COUNTER_BASE);
+#endif
+
+  printf("# memory regions, timestamp %lu Hz, overhead %lu ns\n",
+	 (unsigned long)alt_timestamp_freq(),
+	 (unsigned long)nanoseconds(timer_overhead));
+  printf("region,kernel,bytes,ns,mb_per_s,ns_per_access\n");
+
+  for (i = 0; i < REGIONS; i++)
+    {
+      r = &regions[i];
+#ifndef ALT_HOST_PORT
+      PERF_BEGIN(PERFORMANCE_COUNTER_BASE, i + 1);
+#endif
+      for (kernel = 0; kernel < KERNELS; kernel++)
+	{
+	  ns = measure(r, kernel);
+	  r->ps[kernel] = (alt_u32)((alt_u64)ns * 1000 / (r->bytes / 4));
+	  printf("%s,%s,%lu,%lu,%.1f,%.3f\n", r->name, kernel_names[kernel],
+		 (unsigned long)r->bytes, (unsigned long)ns,
+		 ns ? r->bytes * 1000.0 / ns : 0.0, r->ps[kernel] / 1000.0);
+	}
+#ifndef ALT_HOST_PORT
+      PERF_END(PERFORMANCE_COUNTER_BASE, i + 1);
+#endif
+    }
+
+  report();
+
+#ifndef ALT_HOST_PORT
+  PERF_STOP_MEASURING(PERFORMANCE_COUNTER_BASE);
+  perf_print_formatted_report((void*)PERFORMANCE_COUNTER_BASE,
+			      alt_get_cpu_freq(), REGIONS,
+			      regions[0].name, regions[1].name,
+			      regions[2].name);
+#endif
+  return 0;
+}
@@ -66,11 +66,21 @@ struct alt_alarm_s
                           * zero indicates that the alarm should be removed 
                           * from the list. 
                           */
-  alt_u8 rollover;       /* set when desired alarm time + current time causes
-                            overflow, to prevent premature alarm */
   void* context;         /* Argument for the callback */
 };
 
+/*
+ * alt_alarm_expired() tells whether "alarm" is due at tick "nticks". The
+ * difference of the two times is taken modulo 2^32, so this holds across a
+ * roll-over of the tick counter.
+ */
+
+static ALT_INLINE int ALT_ALWAYS_INLINE 
+alt_alarm_expired (struct alt_alarm_s* alarm, alt_u32 nticks)
+{
+  return (alt_32) (alarm->time - nticks) <= 0;
+}
+
 /*
  * "_alt_tick_rate" is a global variable used to store the system clock rate 
  * in ticks per second. This is initialised to zero, which coresponds to there
@@ -90,10 +100,15 @@ extern alt_u32 _alt_tick_rate;
 
 extern volatile alt_u32 _alt_nticks;
 
-/* The list of registered alarms. */
+/* 
+ * The list of registered alarms, sorted by expiry time. alt_alarm_insert()
+ * adds an alarm at its place in the list.
+ */
 
 extern alt_llist alt_alarm_list;
 
+extern void alt_alarm_insert (struct alt_alarm_s* alarm);
+
 #ifdef __cplusplus
 }
 #endif
@@ -34,6 +34,7 @@
 
 #include "sys/alt_alarm.h"
 #include "sys/alt_irq.h"
+#include "os/alt_hooks.h"
 
 /*
  * alt_alarm_start is called to register an alarm with the system. The 
@@ -56,6 +57,8 @@
  * value from the callback function. A return value of zero indicates that the
  * alarm should be unregistered. 
  * 
+ * "nticks" and the return values of the callback must be less than 2^31.
+ *
  * alt_alarm_start() will fail if  the timer facility has not been enabled 
  * (i.e. there is no system clock). Failure is indicated by a negative return 
  * value.
@@ -82,20 +85,15 @@ int alt_alarm_start (alt_alarm* alarm, alt_u32 nticks,
       alarm->time = nticks + current_nticks + 1; 
       
       /* 
-       * If the desired alarm time causes a roll-over, set the rollover
-       * flag. This will prevent the subsequent tick event from causing
-       * an alarm too early.
+       * Keep the list sorted by expiry time. The roll-over of the tick 
+       * counter is taken care of by comparing times modulo 2^32.
        */
-      if(alarm->time < current_nticks)
-      {
-        alarm->rollover = 1;
-      }
-      else
-      {
-        alarm->rollover = 0;
-      }
-    
-      alt_llist_insert (&alt_alarm_list, &alarm->llist);
+      alt_alarm_insert (alarm);
+
+      /* the system clock may be holding off ticks past the new expiry */
+#ifdef ALT_OS_TIME_TICK_REARM
+      ALT_OS_TIME_TICK_REARM ();
+#endif
       alt_irq_enable_all (irq_context);
 
       return 0;
@@ -20,6 +20,14 @@
 
 #include "system.h"
 
+#if (OS_TICKLESS_EN > 0) || (OS_TASK_PROFILE_EN > 0)
+#include "altera_avalon_timer.h"
+#endif
+
+#if OS_TASK_PROFILE_EN > 0
+#include "sys/alt_timestamp.h"
+#endif
+
 extern void OSStartTsk;                 /* The entry point for all tasks. */
 
 #if OS_TMR_EN > 0
@@ -155,6 +163,23 @@ void OSTaskDelHook (OS_TCB *ptcb)
 */
 void OSTaskSwHook (void)
 {
+#if OS_TASK_PROFILE_EN > 0
+    INT32U  cycles;
+#endif
+
+#if OS_TICKLESS_EN > 0
+    if (OSTCBCur->OSTCBPrio == OS_TASK_IDLE_PRIO) {  /* Account for the ticks held off while idle */
+        alt_avalon_timer_sc_wake();
+    }
+#endif
+
+#if OS_TASK_PROFILE_EN > 0
+    cycles = OSCPUCyclesGet();
+    if (OSRunning == OS_TRUE) {                      /* Not when the first task is started         */
+        OSTCBCur->OSTCBCyclesTot += cycles - OSTCBCur->OSTCBCyclesStart;
+    }
+    OSTCBHighRdy->OSTCBCyclesStart = cycles;
+#endif
 }
 
 /*
@@ -171,6 +196,63 @@ void OSTaskStatHook (void)
 {
 }
 
+#if OS_TASK_PROFILE_EN > 0
+/*
+*********************************************************************************************************
+*                                            CPU CYCLE COUNTER
+*
+* Description: OSCPUCyclesGet() returns a free running 32 bit cycle count, used by OSTaskSwHook() to
+*              accumulate the cycles each task runs for in OSTCBCyclesTot, and OSCPUCyclesFreq() the
+*              number of those cycles per second.
+*
+*              With a timestamp timer (ALT_TIMESTAMP_CLK) this is alt_timestamp().  The timestamp timer
+*              is not continuous: after its full period it stops and alt_timestamp() returns 0, so it is
+*              restarted then and the full period is added to the count.  Without a timestamp timer the
+*              cycles are derived from the system clock timer by alt_avalon_timer_sc_time(), which
+*              reads its counter and adds it to the time of the last load, without a multiply or a
+*              divide.  The cycles are only scaled to a usage by the statistic task.
+*
+* Arguments  : none
+*
+* Note(s)    : 1) Interrupts are disabled during this call when it is called by the kernel.
+*********************************************************************************************************
+*/
+#if ALT_TIMESTAMP_CLK_BASE != none_BASE
+static  INT32U  OSCPUCyclesBase;                /* Cycles counted by earlier runs of the timestamp timer */
+static  BOOLEAN OSCPUCyclesStarted;
+#endif
+
+INT32U OSCPUCyclesGet (void)
+{
+#if ALT_TIMESTAMP_CLK_BASE != none_BASE
+    alt_timestamp_type  ts;
+
+
+    if (OSCPUCyclesStarted == OS_FALSE) {       /* The timer is initialized after OSInit()            */
+        alt_timestamp_start();
+        OSCPUCyclesStarted = OS_TRUE;
+    }
+    ts = alt_timestamp();
+    if (ts == 0) {                              /* Ran its full period and stopped                    */
+        OSCPUCyclesBase += 0xFFFFFFFFL;
+        alt_timestamp_start();
+    }
+    return (OSCPUCyclesBase + (INT32U)ts);
+#else
+    return (alt_avalon_timer_sc_time());
+#endif
+}
+
+INT32U OSCPUCyclesFreq (void)
+{
+#if ALT_TIMESTAMP_CLK_BASE != none_BASE
+    return (alt_timestamp_freq());
+#else
+    return (alt_avalon_timer_sc_freq());
+#endif
+}
+#endif
+
 /*
 *********************************************************************************************************
 *                                               TICK HOOK
@@ -207,6 +289,69 @@ void OSTimeTickHook (void)
 #endif
 }
 
+/*
+*********************************************************************************************************
+*                                         TICKLESS IDLE HOOKS
+*
+* Description: OSTimeTickNextHook() returns the number of ticks until OSTimeTickHook() has work to do,
+*              that is until it signals a timer that expires.  OSTimeTickSkipHook() is called for ticks
+*              that passed without calling OSTimeTickHook().  See OSTimeTickNext() and OSTimeTickSkip().
+*
+*              OSTimeTickSyncHook() is called on interrupt entry (see os/alt_hooks.h), and OSTimeTickRearmHook()
+*              when an alarm or a timer has been started.  They let the system clock account for the ticks of
+*              an idle period that have passed, and bring its interrupt forward to a new first expiry.
+*
+* Note(s)    : 1) Interrupts are disabled during the calls to OSTimeTickNextHook() and OSTimeTickSkipHook().
+*********************************************************************************************************
+*/
+#if OS_TICKLESS_EN > 0
+INT32U OSTimeTickNextHook (void)
+{
+#if OS_TMR_EN > 0
+    INT32U  signals;
+    INT32U  period = OS_TICKS_PER_SEC / OS_TMR_CFG_TICKS_PER_SEC;
+#endif
+
+#ifdef ALT_INICHE
+    return (1);                        /* The Interniche timer needs every tick */
+#endif
+
+#if OS_TMR_EN > 0
+    signals = OSTmrSignalNext();
+    if (signals > (0xFFFFFFFFL - period) / period) {
+        return (0xFFFFFFFFL);
+    }
+    return ((period - OSTmrCtr) + (signals - 1) * period);
+#else
+    return (0xFFFFFFFFL);
+#endif
+}
+
+void OSTimeTickSkipHook (INT32U ticks)
+{
+#if OS_TMR_EN > 0
+    INT32U  period = OS_TICKS_PER_SEC / OS_TMR_CFG_TICKS_PER_SEC;
+
+
+    ticks   += OSTmrCtr;
+    OSTmrSignalSkip(ticks / period);   /* None of the signals left out expires a timer             */
+    OSTmrCtr = (INT16U)(ticks % period);
+#else
+    ticks = ticks;                     /* Prevent compiler warning                                 */
+#endif
+}
+
+void OSTimeTickSyncHook (void)
+{
+    alt_avalon_timer_sc_sync();
+}
+
+void OSTimeTickRearmHook (void)
+{
+    alt_avalon_timer_sc_rearm();
+}
+#endif
+
 void OSInitHookBegin(void)
 {
 #if OS_TMR_EN > 0
@@ -220,6 +365,9 @@ void OSInitHookEnd(void)
 
 void OSTaskIdleHook(void)
 {
+#if OS_TICKLESS_EN > 0
+    alt_avalon_timer_sc_idle();        /* Hold off the tick interrupt up to the next tick with work */
+#endif
 }
 
 void OSTCBInitHook(OS_TCB *ptcb)
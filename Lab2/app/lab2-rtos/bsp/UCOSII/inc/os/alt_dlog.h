@@ -0,0 +1,169 @@
+#ifndef __ALT_DLOG_H__
+#define __ALT_DLOG_H__
+
+/******************************************************************************
+*                                                                             *
+* Deferred binary logging for uC/OS-II.                                       *
+*                                                                             *
+******************************************************************************/
+
+/*
+ * printf() from a periodic task formats its arguments, takes the newlib
+ * locks and waits for the JTAG UART, all on the time of the task. The
+ * macros below only store a format id, the current tick and up to four
+ * integer arguments in a ring of the calling task:
+ *
+ * ALT_DLOG_RING - Create a ring of a given number of 32 bit words.
+ * ALT_DLOG0 ... ALT_DLOG4 - Store a record with 0 to 4 arguments.
+ *
+ * A ring has a single writer, i.e. one task (or one ISR), and no lock: the
+ * writer only advances the head and the drain task only the tail. When the
+ * ring is full the record is counted as lost instead of waiting.
+ *
+ * alt_dlog_init() creates the drain task, which empties the rings every
+ * ALT_DLOG_PERIOD ticks and writes the records to stdout as binary frames,
+ * preceded by the format string the first time an id is used. The frames
+ * start with a NUL byte, so they can be mixed with ordinary text output.
+ * Each frame is written with one call and the scheduler locked, so text
+ * printed by a higher priority task never lands inside a frame; a frame
+ * may still split a line a lower priority task was printing.
+ * app/host/tools/dlog2txt.c turns the frames back into text, e.g.
+ *
+ *   nios2-terminal | dlog2txt
+ *
+ * Only integer conversions (%d, %u, %x, %c, ...) can be used in the
+ * formats, as the arguments are passed as 32 bit words. A format must fit
+ * in 255 characters, and there can be up to 256 formats.
+ *
+ * Example:
+ *
+ * enum { LOG_SPEED };
+ * static const char* const formats[] = { "Speed: %d m/s\n" };
+ *
+ * ALT_DLOG_RING(speed_log, 64)
+ *
+ * alt_dlog_init (formats, 1, DLOG_PRIO);
+ * alt_dlog_register (&speed_log);
+ * ...
+ * ALT_DLOG1 (speed_log, LOG_SPEED, speed);
+ */
+
+#include "alt_types.h"
+#include "sys/alt_alarm.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/*
+ * Stack size of the drain task (in OS_STK units), and the number of ticks
+ * between two passes over the rings.
+ */
+
+#ifndef ALT_DLOG_STK_SIZE
+#define ALT_DLOG_STK_SIZE 1024
+#endif
+
+#ifndef ALT_DLOG_PERIOD
+#define ALT_DLOG_PERIOD   10
+#endif
+
+/*
+ * Frame types, following the NUL byte:
+ *
+ * 'D' id len <len characters>          - format string of 'id'
+ * 'L' id n <tick> <arg 0> ... <arg n-1> - record, 32 bit values
+ * 'X' <count>                           - records lost, 32 bit count
+ *
+ * All 32 bit values are little endian.
+ */
+
+#define ALT_DLOG_FRAME_DEF  'D'
+#define ALT_DLOG_FRAME_LOG  'L'
+#define ALT_DLOG_FRAME_LOST 'X'
+
+typedef struct alt_dlog_ring_s alt_dlog_ring;
+
+struct alt_dlog_ring_s
+{
+  alt_dlog_ring*   next;        /* list of registered rings              */
+  alt_u32*         buf;
+  alt_u32          mask;        /* number of words - 1                   */
+  volatile alt_u32 head;        /* words written, moved by the writer    */
+  volatile alt_u32 tail;        /* words read, moved by the drain task   */
+  volatile alt_u32 lost;        /* records that did not fit              */
+  alt_u32          lost_sent;   /* value of 'lost' last reported         */
+};
+
+/*
+ * The size must be a power of two. As for ALT_SEM, the semi-colon is part
+ * of the macro.
+ */
+
+#define ALT_DLOG_RING(ring, words)                                         \
+  typedef char ring##_size_check[((words) & ((words) - 1)) ? -1 : 1];      \
+  static alt_u32 ring##_buf[words];                                        \
+  alt_dlog_ring ring = { NULL, ring##_buf, (words) - 1, 0, 0, 0, 0 };
+
+/*
+ * Keeps the compiler from moving the stores to a record past the store that
+ * publishes it. Both sides run on the same CPU, so nothing else is needed.
+ */
+
+#define ALT_DLOG_BARRIER() __asm__ __volatile__ ("" : : : "memory")
+
+static ALT_INLINE void ALT_ALWAYS_INLINE alt_dlog_put (alt_dlog_ring* ring,
+                                                       alt_u32 id, alt_u32 n,
+                                                       alt_u32 a0, alt_u32 a1,
+                                                       alt_u32 a2, alt_u32 a3)
+{
+  alt_u32* buf  = ring->buf;
+  alt_u32  mask = ring->mask;
+  alt_u32  head = ring->head;
+
+  if (head - ring->tail + 2 + n > mask + 1)
+  {
+    ring->lost++;
+    return;
+  }
+
+  buf[head & mask]       = (id << 8) | n;
+  buf[(head + 1) & mask] = alt_nticks ();
+  if (n > 0) buf[(head + 2) & mask] = a0;
+  if (n > 1) buf[(head + 3) & mask] = a1;
+  if (n > 2) buf[(head + 4) & mask] = a2;
+  if (n > 3) buf[(head + 5) & mask] = a3;
+
+  ALT_DLOG_BARRIER ();
+  ring->head = head + 2 + n;
+}
+
+#define ALT_DLOG0(ring, id)                                                \
+  alt_dlog_put (&(ring), (id), 0, 0, 0, 0, 0)
+#define ALT_DLOG1(ring, id, a0)                                            \
+  alt_dlog_put (&(ring), (id), 1, (alt_u32) (a0), 0, 0, 0)
+#define ALT_DLOG2(ring, id, a0, a1)                                        \
+  alt_dlog_put (&(ring), (id), 2, (alt_u32) (a0), (alt_u32) (a1), 0, 0)
+#define ALT_DLOG3(ring, id, a0, a1, a2)                                    \
+  alt_dlog_put (&(ring), (id), 3, (alt_u32) (a0), (alt_u32) (a1),         \
+                (alt_u32) (a2), 0)
+#define ALT_DLOG4(ring, id, a0, a1, a2, a3)                                \
+  alt_dlog_put (&(ring), (id), 4, (alt_u32) (a0), (alt_u32) (a1),         \
+                (alt_u32) (a2), (alt_u32) (a3))
+
+/*
+ * alt_dlog_init() sets the format table and creates the drain task at the
+ * given priority; it returns the error code of OSTaskCreateExt().
+ * alt_dlog_register() adds a ring to the ones the drain task empties.
+ */
+
+extern int  alt_dlog_init     (const char* const* formats, alt_u32 count,
+                               alt_u8 prio);
+extern void alt_dlog_register (alt_dlog_ring* ring);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __ALT_DLOG_H__ */
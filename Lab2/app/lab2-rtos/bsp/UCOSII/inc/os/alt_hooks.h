@@ -40,6 +40,7 @@
 #ifndef ALT_ASM_SRC
 
 #include "includes.h"
+#include "os/alt_slab.h"
 
 /*
  * Semaphores used to protect the heap and environment
@@ -53,13 +54,35 @@ extern OS_EVENT *alt_heapsem;
  */
 
 #define ALT_OS_TIME_TICK OSTimeTick
+#if ALT_SLAB_EN > 0
+#define ALT_OS_INIT()    OSInit();                     \
+                         alt_envsem  = OSSemCreate(1); \
+                         alt_heapsem = OSSemCreate(1); \
+                         alt_slab_init()
+#else
 #define ALT_OS_INIT()    OSInit();                     \
                          alt_envsem  = OSSemCreate(1); \
                          alt_heapsem = OSSemCreate(1)
+#endif
 #define ALT_OS_STOP()    OSRunning = OS_FALSE
-#define ALT_OS_INT_ENTER OSIntEnter
 #define ALT_OS_INT_EXIT  OSIntExit
 
+/*
+ * Used by the system clock driver to hold off the tick interrupt while the
+ * idle task runs, see alt_tick_next() and alt_tick_skip(). An interrupt
+ * first brings the time up to date, and an alarm started during an idle
+ * period may bring the tick interrupt forward.
+ */
+
+#if OS_TICKLESS_EN > 0
+#define ALT_OS_INT_ENTER()     do { OSTimeTickSyncHook(); OSIntEnter(); } while (0)
+#define ALT_OS_TIME_TICK_NEXT  OSTimeTickNext
+#define ALT_OS_TIME_TICK_SKIP  OSTimeTickSkip
+#define ALT_OS_TIME_TICK_REARM OSTimeTickRearmHook
+#else
+#define ALT_OS_INT_ENTER       OSIntEnter
+#endif
+
 #endif /* ALT_ASM_SRC */
 
 /* These macros are used by the VIC funnel assembly code */
@@ -0,0 +1,146 @@
+/******************************************************************************
+*                                                                             *
+* Debounced PIO inputs for uC/OS-II: edge capture ISR and debounce alarm.     *
+*                                                                             *
+* See os/alt_input.h for the API and the state machine.                       *
+*                                                                             *
+******************************************************************************/
+
+#include <stddef.h>
+
+#include "includes.h"
+#include "altera_avalon_pio_regs.h"
+#include "sys/alt_irq.h"
+#include "os/alt_input.h"
+
+static alt_u32 alt_input_read (alt_input* input)
+{
+  return (IORD_ALTERA_AVALON_PIO_DATA (input->base) ^ input->invert) &
+         input->mask;
+}
+
+/*
+ * Debounce alarm, called on every system clock tick while a change is being
+ * debounced, or while an input that raises no interrupt on release is
+ * active.
+ */
+
+static alt_u32 alt_input_debounce (void* context)
+{
+  alt_input* input  = (alt_input*) context;
+  alt_u32    sample = alt_input_read (input);
+  alt_u32    changed;
+  INT8U      err;
+
+  if (sample != input->sample)
+  {
+    input->sample = sample;
+    input->stable = 0;
+    return 1;
+  }
+
+  if (input->stable < input->settle)
+  {
+    input->stable++;
+    return 1;
+  }
+
+  changed = sample ^ input->state;
+  if (changed)
+  {
+    input->state = sample;
+    OSFlagPost (input->flags, (OS_FLAGS) changed, OS_FLAG_SET, &err);
+  }
+
+  if (input->edge == ALT_INPUT_EDGE_ACTIVE && sample)
+  {
+    return 1;
+  }
+
+  input->running = 0;
+  return 0;
+}
+
+static void alt_input_start (alt_input* input)
+{
+  input->stable = 0;
+
+  if (!input->running)
+  {
+    input->running = 1;
+    alt_alarm_start (&input->alarm, 0, alt_input_debounce, input);
+  }
+}
+
+/*
+ * Edge capture ISR. Writing the mask clears the captured edges both on a
+ * PIO with and without the bit clearing edge register.
+ */
+
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+static void alt_input_irq (void* context)
+#else
+static void alt_input_irq (void* context, alt_u32 id)
+#endif
+{
+  alt_input* input = (alt_input*) context;
+
+  IOWR_ALTERA_AVALON_PIO_EDGE_CAP (input->base, input->mask);
+
+  alt_input_start (input);
+}
+
+int alt_input_open (alt_input* input, alt_u32 base, alt_u32 ic_id,
+                    alt_u32 irq, alt_u32 mask, alt_u32 invert, int edge)
+{
+  alt_u32         ticks;
+  alt_irq_context context;
+  INT8U           err;
+
+  ticks = alt_ticks_per_second () * ALT_INPUT_DEBOUNCE_MS / 1000;
+
+  input->base    = base;
+  input->mask    = mask & ((1u << (OS_FLAGS_NBITS - 1) << 1) - 1);
+  input->invert  = invert;
+  input->edge    = edge;
+  input->settle  = ticks ? ticks : 1;
+  input->running = 0;
+  input->state   = alt_input_read (input);
+  input->sample  = input->state;
+
+  input->flags = OSFlagCreate (0, &err);
+  if (input->flags == NULL)
+  {
+    return -1;
+  }
+
+  IOWR_ALTERA_AVALON_PIO_EDGE_CAP (base, input->mask);
+  IOWR_ALTERA_AVALON_PIO_IRQ_MASK (base, input->mask);
+
+#ifdef ALT_ENHANCED_INTERRUPT_API_PRESENT
+  if (alt_ic_isr_register (ic_id, irq, alt_input_irq, input, NULL) < 0)
+#else
+  if (alt_irq_register (irq, input, alt_input_irq) < 0)
+#endif
+  {
+    return -1;
+  }
+
+  /* an input held at start-up has to be sampled until it is released */
+
+  context = alt_irq_disable_all ();
+  if (edge == ALT_INPUT_EDGE_ACTIVE && input->state)
+  {
+    alt_input_start (input);
+  }
+  alt_irq_enable_all (context);
+
+  return 0;
+}
+
+OS_FLAGS alt_input_wait (alt_input* input, OS_FLAGS which, INT16U timeout,
+                         INT8U* perr)
+{
+  return OSFlagPend (input->flags, which,
+                     OS_FLAG_WAIT_SET_ANY + OS_FLAG_CONSUME, timeout, perr);
+}
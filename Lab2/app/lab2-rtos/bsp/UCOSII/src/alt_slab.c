@@ -0,0 +1,200 @@
+/******************************************************************************
+*                                                                             *
+* Size class slab allocator for uC/OS-II: partitions and malloc() family.     *
+*                                                                             *
+* See os/alt_slab.h for the size classes and how requests are served.         *
+*                                                                             *
+******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef ALT_HOST_PORT
+#include <reent.h>
+#endif
+
+#include "includes.h"
+#include "alt_types.h"
+#include "os/alt_slab.h"
+
+#if ALT_SLAB_EN > 0
+
+/* class c takes ALT_SLAB_BLOCKS blocks of ALT_SLAB_MIN << c bytes */
+
+#define ALT_SLAB_END(c) \
+  ((alt_u32) ALT_SLAB_BLOCKS * ALT_SLAB_MIN * ((1u << (c)) - 1))
+
+#define ALT_SLAB_ARENA  ALT_SLAB_END (ALT_SLAB_CLASSES)
+
+static alt_u8  alt_slab_arena[ALT_SLAB_ARENA] __attribute__ ((aligned (16)));
+
+static OS_MEM* alt_slab_parts[ALT_SLAB_CLASSES];
+
+/*
+ * The classes are looked up in tables rather than searched for, as the
+ * branches of a search mispredict on sizes that keep changing:
+ *
+ *  - alt_slab_fit[] is the class for a size, by (size - 1) / ALT_SLAB_MIN,
+ *  - alt_slab_region[] the class of an address in the arena, by its offset
+ *    in units of the size of the region of the smallest class.
+ */
+
+static alt_u8  alt_slab_fit[ALT_SLAB_MAX / ALT_SLAB_MIN];
+static alt_u8  alt_slab_region[(1 << ALT_SLAB_CLASSES) - 1];
+
+void alt_slab_init (void)
+{
+  INT8U err;
+  int   c;
+  int   i;
+
+  for (c = 0; c < ALT_SLAB_CLASSES; c++)
+  {
+    for (i = (1 << c) - 1; i < (2 << c) - 1; i++)
+    {
+      alt_slab_region[i] = c;
+    }
+    for (i = c ? 1 << (c - 1) : 0; i < 1 << c; i++)
+    {
+      alt_slab_fit[i] = c;
+    }
+    alt_slab_parts[c] = OSMemCreate (&alt_slab_arena[ALT_SLAB_END (c)],
+                                     ALT_SLAB_BLOCKS, ALT_SLAB_MIN << c, &err);
+  }
+}
+
+void* alt_slab_alloc (size_t size)
+{
+  void*  ptr;
+  INT8U  err;
+  int    c;
+
+  if (size - 1 >= ALT_SLAB_MAX)         /* also sends malloc(0) to the heap */
+  {
+    return NULL;
+  }
+
+  for (c = alt_slab_fit[(size - 1) / ALT_SLAB_MIN];
+       c < ALT_SLAB_CLASSES && alt_slab_parts[c]; c++)
+  {
+    ptr = OSMemGet (alt_slab_parts[c], &err);
+    if (err == OS_ERR_NONE)
+    {
+      return ptr;
+    }
+  }
+  return NULL;
+}
+
+/*
+ * Class of 'ptr', or -1 if it is not in the arena.
+ */
+
+static int alt_slab_class (void* ptr)
+{
+  /* Compared before the offset is taken, as the offset of a pointer far
+   * from the arena could be truncated into range on a 64 bit host */
+  if ((alt_u8*) ptr < alt_slab_arena ||
+      (alt_u8*) ptr >= alt_slab_arena + ALT_SLAB_ARENA)
+  {
+    return -1;
+  }
+  return alt_slab_region[((alt_u8*) ptr - alt_slab_arena) / ALT_SLAB_END (1)];
+}
+
+size_t alt_slab_size (void* ptr)
+{
+  int c = alt_slab_class (ptr);
+
+  return c < 0 ? 0 : (size_t) ALT_SLAB_MIN << c;
+}
+
+int alt_slab_free (void* ptr)
+{
+  int c = alt_slab_class (ptr);
+
+  if (c < 0)
+  {
+    return 0;
+  }
+
+  OSMemPut (alt_slab_parts[c], ptr);
+  return 1;
+}
+
+void* alt_slab_realloc (void* ptr, size_t size)
+{
+  size_t old_size = alt_slab_size (ptr);
+  void*  new_ptr;
+
+  if (size <= old_size)
+  {
+    return ptr;
+  }
+
+  new_ptr = malloc (size);
+  if (new_ptr)
+  {
+    memcpy (new_ptr, ptr, old_size);
+    alt_slab_free (ptr);
+  }
+  return new_ptr;
+}
+
+OS_MEM* alt_slab_partition (int c)
+{
+  return alt_slab_parts[c];
+}
+
+/*
+ * The malloc() family on the board, in front of newlib's reentrant heap
+ * functions. On the host the --wrap functions of alt_libc_lock.c take their
+ * place.
+ */
+
+#ifndef ALT_HOST_PORT
+
+void* malloc (size_t size)
+{
+  void* ptr = alt_slab_alloc (size);
+
+  return ptr ? ptr : _malloc_r (_REENT, size);
+}
+
+void free (void* ptr)
+{
+  if (!alt_slab_free (ptr))
+  {
+    _free_r (_REENT, ptr);
+  }
+}
+
+void* calloc (size_t n, size_t size)
+{
+  void* ptr;
+
+  if (size && n > (size_t) -1 / size)
+  {
+    return NULL;
+  }
+
+  ptr = malloc (n * size);
+  if (ptr)
+  {
+    memset (ptr, 0, n * size);
+  }
+  return ptr;
+}
+
+void* realloc (void* ptr, size_t size)
+{
+  if (alt_slab_size (ptr))
+  {
+    return alt_slab_realloc (ptr, size);
+  }
+  return _realloc_r (_REENT, ptr, size);
+}
+
+#endif /* ALT_HOST_PORT */
+
+#endif /* ALT_SLAB_EN */
@@ -0,0 +1,251 @@
+/******************************************************************************
+*                                                                             *
+* Stack profiling for uC/OS-II: samples the deepest stack use of the tasks    *
+* and prints a header with their stack sizes.                                 *
+*                                                                             *
+* See os/alt_stkprof.h for how the sizes and the placement are chosen.        *
+*                                                                             *
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "includes.h"
+#include "alt_types.h"
+#include "os/alt_stkprof.h"
+
+typedef struct
+{
+  alt_u8      prio;
+  const char* name;
+  alt_u32     used;             /* deepest use seen, in OS_STK words */
+} alt_stkprof_entry;
+
+static alt_stkprof_entry alt_stkprof_tasks[ALT_STKPROF_TASKS];
+static int               alt_stkprof_ntasks;
+
+/* The header is formatted first and printed at once, so that the output of
+ * other tasks cannot end up in the middle of it. */
+static char              alt_stkprof_buf[4096];
+
+int alt_stkprof_add (alt_u8 prio, const char* name)
+{
+  if (alt_stkprof_ntasks == ALT_STKPROF_TASKS)
+  {
+    return -1;
+  }
+
+  alt_stkprof_tasks[alt_stkprof_ntasks].prio = prio;
+  alt_stkprof_tasks[alt_stkprof_ntasks].name = name;
+  alt_stkprof_tasks[alt_stkprof_ntasks].used = 0;
+  alt_stkprof_ntasks++;
+  return 0;
+}
+
+void alt_stkprof_sample (void)
+{
+  OS_STK_DATA data;
+  alt_u32     used;
+  int         i;
+
+  for (i = 0; i < alt_stkprof_ntasks; i++)
+  {
+    if (OSTaskStkChk (alt_stkprof_tasks[i].prio, &data) == OS_ERR_NONE)
+    {
+      used = data.OSUsed / sizeof (OS_STK);
+      if (used > alt_stkprof_tasks[i].used)
+      {
+        alt_stkprof_tasks[i].used = used;
+      }
+    }
+  }
+}
+
+/*
+ * Stack size for 'used' words: the margin on top, rounded up to 8 words.
+ */
+
+static alt_u32 alt_stkprof_size (alt_u32 used)
+{
+  alt_u32 size = used + (used * ALT_STKPROF_MARGIN + 99) / 100;
+
+  size = (size + 7) & ~7;
+  return size < ALT_STKPROF_MIN ? ALT_STKPROF_MIN : size;
+}
+
+/*
+ * Prints the two lines of each task, highest priority first as the tasks
+ * are registered in any order. With 'board' the stacks keep at least
+ * ALT_STKPROF_UNCHECKED words and go in the fast section while they fit;
+ * returns the bytes placed there.
+ */
+
+static alt_u32 alt_stkprof_tasks_print (char** pp, char* end, int width,
+                                        const char* prefix, int board,
+                                        int unchecked)
+{
+  alt_stkprof_entry* task;
+  char*              p    = *pp;
+  alt_u32            fast = 0;
+  alt_u32            used;
+  alt_u32            bytes;
+  char               macro[64];
+  int                prio;
+  int                i;
+
+#define ALT_STKPROF_PRINT(...) \
+  p += snprintf (p, p < end ? end - p : 0, __VA_ARGS__)
+
+  for (prio = 0; prio <= OS_LOWEST_PRIO; prio++)
+  {
+    for (i = 0; i < alt_stkprof_ntasks; i++)
+    {
+      task = &alt_stkprof_tasks[i];
+      if (task->prio != prio)
+      {
+        continue;
+      }
+
+      used  = task->used * sizeof (OS_STK);
+      bytes = alt_stkprof_size (task->used) * sizeof (OS_STK);
+      if (unchecked && bytes < ALT_STKPROF_UNCHECKED * sizeof (OS_STK))
+      {
+        bytes = ALT_STKPROF_UNCHECKED * sizeof (OS_STK);
+      }
+      snprintf (macro, sizeof (macro), "%s_STACKSIZE", task->name);
+      if (unchecked)
+      {
+        ALT_STKPROF_PRINT ("#define %-*s %5lu  /* %lu bytes used on the host, "
+                           "+%lu %% */\n", width, macro,
+                           (unsigned long) (bytes / sizeof (OS_STK)),
+                           (unsigned long) used,
+                           (unsigned long) ((bytes - used) * 100 /
+                                            (used ? used : 1)));
+      }
+      else
+      {
+        ALT_STKPROF_PRINT ("#define %-*s %5lu  /* %lu bytes used */\n",
+                           width, macro,
+                           (unsigned long) (bytes / sizeof (OS_STK)),
+                           (unsigned long) used);
+      }
+      snprintf (macro, sizeof (macro), "%s_STACK_SECTION", task->name);
+      if (board && fast + bytes <= ALT_STKPROF_FAST_SIZE)
+      {
+        fast += bytes;
+        ALT_STKPROF_PRINT ("#define %-*s %s_STACKS_FAST\n", width, macro,
+                           prefix);
+      }
+      else
+      {
+        ALT_STKPROF_PRINT ("#define %s\n", macro);
+      }
+    }
+  }
+
+#undef ALT_STKPROF_PRINT
+
+  *pp = p;
+  return fast;
+}
+
+static void alt_stkprof_report (alt_u32 ticks, const char* prefix)
+{
+  char*   p    = alt_stkprof_buf;
+  char*   end  = alt_stkprof_buf + sizeof (alt_stkprof_buf);
+  alt_u32 fast;
+  int     width = 0;
+  int     i;
+
+  for (i = 0; i < alt_stkprof_ntasks; i++)
+  {
+    if ((int) strlen (alt_stkprof_tasks[i].name) > width)
+    {
+      width = strlen (alt_stkprof_tasks[i].name);
+    }
+  }
+  width += sizeof ("_STACK_SECTION") - 1;
+
+#define ALT_STKPROF_PRINT(...) \
+  p += snprintf (p, p < end ? end - p : 0, __VA_ARGS__)
+
+  ALT_STKPROF_PRINT (
+    "/* Generated by alt_stkprof after %lu ticks %s, do not edit.\n"
+    " *\n"
+    " * Stack sizes in OS_STK words: the deepest use seen plus %d %%, rounded\n"
+    " * up to 8 words and at least %d words. Stacks that fit in %d bytes, by\n"
+    " * priority, go in %s.\n",
+    (unsigned long) ticks,
+#ifdef ALT_HOST_PORT
+    "on the host port",
+#else
+    "on the board",
+#endif
+    ALT_STKPROF_MARGIN, ALT_STKPROF_MIN, ALT_STKPROF_FAST_SIZE,
+    ALT_STKPROF_FAST_SECTION);
+
+#ifdef ALT_HOST_PORT
+  /* x86-64 frames say little about the Nios II ones: the board keeps the
+   * stacks it had until the profile is run there. */
+  ALT_STKPROF_PRINT (
+    " *\n"
+    " * The profile has not been run on the board, so there every stack\n"
+    " * keeps at least %d words until a board run replaces this header.\n"
+    " * The comments of the board sizes give their margin over the deepest\n"
+    " * use on the host.\n"
+    " */\n\n"
+    "#ifndef __%s_STACKS_H__\n"
+    "#define __%s_STACKS_H__\n\n"
+    "#ifdef ALT_HOST_PORT\n\n",
+    ALT_STKPROF_UNCHECKED, prefix, prefix);
+  alt_stkprof_tasks_print (&p, end, width, prefix, 0, 0);
+  ALT_STKPROF_PRINT (
+    "\n#else /* !ALT_HOST_PORT */\n\n"
+    "#define %s_STACKS_FAST __attribute__ ((section (\"%s\")))\n\n",
+    prefix, ALT_STKPROF_FAST_SECTION);
+  fast = alt_stkprof_tasks_print (&p, end, width, prefix, 1, 1);
+  ALT_STKPROF_PRINT ("\n/* %lu bytes in %s */\n\n"
+                     "#endif /* ALT_HOST_PORT */\n",
+                     (unsigned long) fast, ALT_STKPROF_FAST_SECTION);
+#else
+  ALT_STKPROF_PRINT (
+    " */\n\n"
+    "#ifndef __%s_STACKS_H__\n"
+    "#define __%s_STACKS_H__\n\n"
+    "#ifdef ALT_HOST_PORT\n"
+    "#define %s_STACKS_FAST\n"
+    "#else\n"
+    "#define %s_STACKS_FAST __attribute__ ((section (\"%s\")))\n"
+    "#endif\n\n",
+    prefix, prefix, prefix, prefix, ALT_STKPROF_FAST_SECTION);
+  fast = alt_stkprof_tasks_print (&p, end, width, prefix, 1, 0);
+  ALT_STKPROF_PRINT ("\n/* %lu bytes in %s */\n",
+                     (unsigned long) fast, ALT_STKPROF_FAST_SECTION);
+#endif
+
+  ALT_STKPROF_PRINT ("\n#endif /* __%s_STACKS_H__ */\n", prefix);
+
+#undef ALT_STKPROF_PRINT
+
+  printf ("%s", alt_stkprof_buf);
+  fflush (stdout);
+}
+
+void alt_stkprof_run (alt_u32 ticks, const char* prefix)
+{
+  alt_u32 t;
+
+  for (t = 0; t < ticks; t += ALT_STKPROF_PERIOD)
+  {
+    OSTimeDly (ALT_STKPROF_PERIOD);
+    alt_stkprof_sample ();
+  }
+
+  alt_stkprof_report (ticks, prefix);
+#ifdef ALT_HOST_PORT
+  exit (0);
+#else
+  OSTaskDel (OS_PRIO_SELF);
+#endif
+}
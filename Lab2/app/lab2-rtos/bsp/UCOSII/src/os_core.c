@@ -77,6 +77,10 @@ static  void  OS_InitTCBList(void);
 
 static  void  OS_SchedNew(void);
 
+#if OS_RDY_BITMAP_EN > 0
+static  INT8U  OS_PrioFind(OS_PRIO map);
+#endif
+
 /*$PAGE*/
 /*
 *********************************************************************************************************
@@ -458,7 +462,7 @@ INT16U  OSEventPendMulti (OS_EVENT **pevents_pend, OS_EVENT **pevents_rdy, void
     OSTCBCur->OSTCBStat     |= events_stat  |           /* Resource not available, ...                 */
                                OS_STAT_MULTI;           /* ... pend on multiple events                 */
     OSTCBCur->OSTCBStatPend  = OS_STAT_PEND_OK;
-    OSTCBCur->OSTCBDly       = timeout;                 /* Store pend timeout in TCB                   */
+    OS_TimeDlyInsert(OSTCBCur, timeout);                /* Store pend timeout in TCB                   */
     OS_EventTaskWaitMulti(pevents_pend);                /* Suspend task until events or timeout occurs */
 
     OS_EXIT_CRITICAL();
@@ -557,6 +561,10 @@ void  OSInit (void)
 
     OS_InitMisc();                                               /* Initialize miscellaneous variables       */
 
+#if OS_TRACE_EN > 0
+    OS_TraceInit();                                              /* Empty the event trace                    */
+#endif
+
     OS_InitRdyList();                                            /* Initialize the Ready List                */
 
     OS_InitTCBList();                                            /* Initialize the free list of OS_TCBs      */
@@ -575,6 +583,10 @@ void  OSInit (void)
     OS_QInit();                                                  /* Initialize the message queue structures  */
 #endif
 
+#if (OS_REG_EN > 0) && (OS_MAX_REGS > 0)
+    OS_RegInit();                                                /* Initialize the free list of registers    */
+#endif
+
     OS_InitTaskIdle();                                           /* Create the Idle Task                     */
 #if OS_TASK_STAT_EN > 0
     OS_InitTaskStat();                                           /* Create the Statistic Task                */
@@ -625,6 +637,7 @@ void  OSIntEnter (void)
         if (OSIntNesting < 255u) {
             OSIntNesting++;                      /* Increment ISR nesting level                        */
         }
+        OS_TRACE(OS_TRACE_INT_ENTER, OSIntNesting);
         OS_EXIT_CRITICAL();
     }
 }
@@ -661,6 +674,7 @@ void  OSIntExit (void)
         if (OSIntNesting > 0) {                            /* Prevent OSIntNesting from wrapping       */
             OSIntNesting--;
         }
+        OS_TRACE(OS_TRACE_INT_EXIT, OSIntNesting);
         if (OSIntNesting == 0) {                           /* Reschedule only if all ISRs complete ... */
             if (OSLockNesting == 0) {                      /* ... and not locked.                      */
                 OS_SchedNew();
@@ -670,6 +684,7 @@ void  OSIntExit (void)
                     OSTCBHighRdy->OSTCBCtxSwCtr++;         /* Inc. # of context switches to this task  */
 #endif
                     OSCtxSwCtr++;                          /* Keep track of the number of ctx switches */
+                    OS_TRACE(OS_TRACE_TASK_SW, OSPrioHighRdy);
                     OSIntCtxSw();                          /* Perform interrupt level ctx switch       */
                 }
             }
@@ -789,6 +804,10 @@ void  OSStart (void)
         OSPrioCur     = OSPrioHighRdy;
         OSTCBHighRdy  = OSTCBPrioTbl[OSPrioHighRdy]; /* Point to highest priority task ready to run    */
         OSTCBCur      = OSTCBHighRdy;
+#if OS_TRACE_EN > 0
+        OSTrace.OSTraceFreq = OSCPUCyclesFreq();     /* Drivers are initialized by now                 */
+        OS_TRACE(OS_TRACE_TASK_SW, OSPrioHighRdy);
+#endif
         OSStartHighRdy();                            /* Execute target specific code to start task     */
     }
 }
@@ -810,6 +829,10 @@ void  OSStart (void)
 * Arguments  : none
 *
 * Returns    : none
+*
+* Note(s)    : 1) With OS_TASK_STAT_CYCLES_EN the statistics task measures the time the idle task ran
+*                 instead, so there is nothing to calibrate.  OSStatInit() then returns at once, after
+*                 clearing OSCPUUsagePeak and OSCPUUsageHist[].
 *********************************************************************************************************
 */
 
@@ -822,6 +845,13 @@ void  OSStatInit (void)
 
 
 
+#if OS_TASK_STAT_CYCLES
+    OS_ENTER_CRITICAL();
+    OSCPUUsagePeak = 0;
+    OS_MemClr((INT8U *)&OSCPUUsageHist[0], sizeof(OSCPUUsageHist));
+    OSStatRdy      = OS_TRUE;
+    OS_EXIT_CRITICAL();
+#else
     OSTimeDly(2);                                /* Synchronize with clock tick                        */
     OS_ENTER_CRITICAL();
     OSIdleCtr    = 0L;                           /* Clear idle counter                                 */
@@ -831,6 +861,7 @@ void  OSStatInit (void)
     OSIdleCtrMax = OSIdleCtr;                    /* Store maximum idle counter count in 1/10 second    */
     OSStatRdy    = OS_TRUE;
     OS_EXIT_CRITICAL();
+#endif
 }
 #endif
 /*$PAGE*/
@@ -845,6 +876,9 @@ void  OSStatInit (void)
 * Arguments  : none
 *
 * Returns    : none
+*
+* Note(s)    : 1) With OS_TIME_DLY_LIST_EN, only the tasks whose delay or timeout expires on this tick are
+*                 visited, so the cost of a tick no longer grows with the number of tasks.
 *********************************************************************************************************
 */
 
@@ -867,6 +901,9 @@ void  OSTimeTick (void)
     OS_ENTER_CRITICAL();                                   /* Update the 32-bit tick counter               */
     OSTime++;
     OS_EXIT_CRITICAL();
+#endif
+#if (OS_MEM_EN > 0) && (OS_MAX_MEM_PART > 0) && (OS_MEM_STATS_EN > 0)
+    OS_MemTick(1);                                         /* Sample the blocks used in the partitions     */
 #endif
     if (OSRunning == OS_TRUE) {
 #if OS_TICK_STEP_EN > 0
@@ -893,6 +930,33 @@ void  OSTimeTick (void)
             return;
         }
 #endif
+#if OS_TIME_DLY_LIST_EN > 0
+        OS_ENTER_CRITICAL();
+        OSTickCtr++;
+        ptcb = OSTCBDlyList;                               /* Delayed tasks are sorted by expiry, so only  */
+        while (ptcb != (OS_TCB *)0) {                      /* ... the head of the list has to be checked   */
+            if ((INT32S)(ptcb->OSTCBDlyTick - OSTickCtr) > 0) {
+                break;                                     /* Neither this task nor any later one expires  */
+            }
+            OS_TimeDlyRemove(ptcb);                        /* Delay has expired                            */
+                                                           /* Check for timeout                            */
+            if ((ptcb->OSTCBStat & OS_STAT_PEND_ANY) != OS_STAT_RDY) {
+                ptcb->OSTCBStat  &= ~(INT8U)OS_STAT_PEND_ANY;          /* Yes, Clear status flag   */
+                ptcb->OSTCBStatPend = OS_STAT_PEND_TO;                 /* Indicate PEND timeout    */
+            } else {
+                ptcb->OSTCBStatPend = OS_STAT_PEND_OK;
+            }
+
+            if ((ptcb->OSTCBStat & OS_STAT_SUSPEND) == OS_STAT_RDY) {  /* Is task suspended?       */
+                OSRdyGrp               |= ptcb->OSTCBBitY;             /* No,  Make ready          */
+                OSRdyTbl[ptcb->OSTCBY] |= ptcb->OSTCBBitX;
+            }
+            OS_EXIT_CRITICAL();                            /* Let interrupts in between two tasks          */
+            OS_ENTER_CRITICAL();
+            ptcb = OSTCBDlyList;
+        }
+        OS_EXIT_CRITICAL();
+#else
         ptcb = OSTCBList;                                  /* Point at first TCB in TCB list               */
         while (ptcb->OSTCBPrio != OS_TASK_IDLE_PRIO) {     /* Go through all TCBs in TCB list              */
             OS_ENTER_CRITICAL();
@@ -915,8 +979,121 @@ void  OSTimeTick (void)
             ptcb = ptcb->OSTCBNext;                        /* Point at next TCB in TCB list                */
             OS_EXIT_CRITICAL();
         }
+#endif
+    }
+}
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                   FIND THE NEXT TICK THAT HAS WORK TO DO
+*
+* Description: This function is used by a tickless idle implementation to find out for how many ticks the
+*              tick interrupt may be held off.  That is the number of ticks until the first delay (or pend
+*              timeout) expires, or until the port needs OSTimeTickHook() to run, as reported by
+*              OSTimeTickNextHook(), whichever comes first.
+*
+* Arguments  : none
+*
+* Returns    : The number of ticks until the next tick that OSTimeTick() has to process, at least 1.
+*              0xFFFFFFFF means that nothing is waiting for time to pass.
+*
+* Note(s)    : 1) Interrupts must be disabled when calling this function.
+*              2) Every tick has to be processed while uC/OS-View is stepping the tick.
+*********************************************************************************************************
+*/
+
+#if OS_TICKLESS_EN > 0
+INT32U  OSTimeTickNext (void)
+{
+    OS_TCB  *ptcb;
+    INT32U   next;
+
+
+    if (OSRunning == OS_FALSE) {
+        return (1);
+    }
+#if OS_TICK_STEP_EN > 0
+    if (OSTickStepState != OS_TICK_STEP_DIS) {
+        return (1);
+    }
+#endif
+    next = OSTimeTickNextHook();
+#if OS_TIME_DLY_LIST_EN > 0
+    ptcb = OSTCBDlyList;                                   /* The head of the list expires first           */
+    if (ptcb != (OS_TCB *)0) {
+        if ((INT32U)(ptcb->OSTCBDlyTick - OSTickCtr) < next) {
+            next = ptcb->OSTCBDlyTick - OSTickCtr;
+        }
     }
+#else
+    ptcb = OSTCBList;                                      /* Find the shortest delay of all tasks         */
+    while (ptcb->OSTCBPrio != OS_TASK_IDLE_PRIO) {
+        if ((ptcb->OSTCBDly != 0) && ((INT32U)ptcb->OSTCBDly < next)) {
+            next = ptcb->OSTCBDly;
+        }
+        ptcb = ptcb->OSTCBNext;
+    }
+#endif
+    if (next == 0) {
+        next = 1;
+    }
+    return (next);
 }
+#endif
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                        ACCOUNT FOR SKIPPED TICKS
+*
+* Description: This function is called by a tickless idle implementation after the CPU wakes up, for the
+*              ticks that passed without a tick interrupt.  The system time and all delays advance as if
+*              OSTimeTick() had been called 'ticks' times.
+*
+* Arguments  : ticks     is the number of ticks skipped.  It must be less than the value OSTimeTickNext()
+*                        returned when the tick interrupt was held off, so that no delay expires within
+*                        them.  The tick that ends the idle period is processed by OSTimeTick() as usual.
+*
+* Returns    : none
+*
+* Note(s)    : 1) Interrupts must be disabled when calling this function.
+*********************************************************************************************************
+*/
+
+#if OS_TICKLESS_EN > 0
+void  OSTimeTickSkip (INT32U ticks)
+{
+#if OS_TIME_DLY_LIST_EN == 0
+    OS_TCB  *ptcb;
+#endif
+
+
+    if (ticks == 0) {
+        return;
+    }
+    OSTimeTickSkipHook(ticks);
+#if OS_TIME_GET_SET_EN > 0
+    OSTime += ticks;
+#endif
+#if (OS_MEM_EN > 0) && (OS_MAX_MEM_PART > 0) && (OS_MEM_STATS_EN > 0)
+    OS_MemTick(ticks);
+#endif
+    if (OSRunning == OS_TRUE) {
+#if OS_TIME_DLY_LIST_EN > 0
+        OSTickCtr += ticks;                                /* Delays are relative to OSTickCtr             */
+#else
+        ptcb = OSTCBList;
+        while (ptcb->OSTCBPrio != OS_TASK_IDLE_PRIO) {
+            if (ptcb->OSTCBDly != 0) {
+                ptcb->OSTCBDly -= (INT16U)ticks;
+            }
+            ptcb = ptcb->OSTCBNext;
+        }
+#endif
+    }
+}
+#endif
 
 /*$PAGE*/
 /*
@@ -992,12 +1169,16 @@ INT8U  OS_EventTaskRdy (OS_EVENT *pevent, void *pmsg, INT8U msk, INT8U pend_stat
     INT8U    y;
     INT8U    x;
     INT8U    prio;
-#if OS_LOWEST_PRIO > 63
+#if (OS_RDY_BITMAP_EN == 0) && (OS_LOWEST_PRIO > 63)
     INT16U  *ptbl;
 #endif
 
 
-#if OS_LOWEST_PRIO <= 63
+#if OS_RDY_BITMAP_EN > 0
+    y    = OS_PrioFind(pevent->OSEventGrp);             /* Find HPT waiting for message                */
+    x    = OS_PrioFind(pevent->OSEventTbl[y]);
+    prio = (INT8U)((y << OS_PRIO_SHIFT) + x);           /* Find priority of task getting the msg       */
+#elif OS_LOWEST_PRIO <= 63
     y    = OSUnMapTbl[pevent->OSEventGrp];              /* Find HPT waiting for message                */
     x    = OSUnMapTbl[pevent->OSEventTbl[y]];
     prio = (INT8U)((y << 3) + x);                       /* Find priority of task getting the msg       */
@@ -1017,7 +1198,7 @@ INT8U  OS_EventTaskRdy (OS_EVENT *pevent, void *pmsg, INT8U msk, INT8U pend_stat
 #endif
 
     ptcb                  =  OSTCBPrioTbl[prio];        /* Point to this task's OS_TCB                 */
-    ptcb->OSTCBDly        =  0;                         /* Prevent OSTimeTick() from readying task     */
+    OS_TimeDlyRemove(ptcb);                             /* Prevent OSTimeTick() from readying task     */
 #if ((OS_Q_EN > 0) && (OS_MAX_QS > 0)) || (OS_MBOX_EN > 0)
     ptcb->OSTCBMsg        =  pmsg;                      /* Send message directly to waiting task       */
 #else
@@ -1171,13 +1352,8 @@ void  OS_EventTaskRemoveMulti (OS_TCB    *ptcb,
     OS_EVENT **pevents;
     OS_EVENT  *pevent;
     INT8U      y;
-#if (OS_LOWEST_PRIO <= 63)
-    INT8U      bity;
-    INT8U      bitx;
-#else
-    INT16U     bity;
-    INT16U     bitx;
-#endif
+    OS_PRIO    bity;
+    OS_PRIO    bitx;
 
 
     y       =  ptcb->OSTCBY;
@@ -1212,20 +1388,8 @@ void  OS_EventTaskRemoveMulti (OS_TCB    *ptcb,
 #if (OS_EVENT_EN)
 void  OS_EventWaitListInit (OS_EVENT *pevent)
 {
-#if OS_LOWEST_PRIO <= 63
-    INT8U  *ptbl;
-#else
-    INT16U *ptbl;
-#endif
-    INT8U   i;
-
-
     pevent->OSEventGrp = 0;                      /* No task waiting on event                           */
-    ptbl               = &pevent->OSEventTbl[0];
-
-    for (i = 0; i < OS_EVENT_TBL_SIZE; i++) {
-        *ptbl++ = 0;
-    }
+    OS_MemClr((INT8U *)&pevent->OSEventTbl[0], sizeof(pevent->OSEventTbl));
 }
 #endif
 /*$PAGE*/
@@ -1302,6 +1466,11 @@ static  void  OS_InitMisc (void)
     OSTime        = 0L;                                    /* Clear the 32-bit system clock            */
 #endif
 
+#if OS_TIME_DLY_LIST_EN > 0
+    OSTickCtr     = 0L;                                    /* Clear the tick counter                   */
+    OSTCBDlyList  = (OS_TCB *)0;                           /* No task is delayed                       */
+#endif
+
     OSIntNesting  = 0;                                     /* Clear the interrupt nesting counter      */
     OSLockNesting = 0;                                     /* Clear the scheduling lock counter        */
 
@@ -1317,6 +1486,17 @@ static  void  OS_InitMisc (void)
     OSIdleCtrMax  = 0L;
     OSStatRdy     = OS_FALSE;                              /* Statistic task is not ready              */
 #endif
+
+#if OS_TASK_STAT_CYCLES
+    OSCPUUsageFine = 0;
+    OSCPUUsagePeak = 0;
+    OS_MemClr((INT8U *)&OSCPUUsageHist[0], sizeof(OSCPUUsageHist));
+#endif
+
+#if OS_TASK_CPU_USAGE_EN
+    OS_MemClr((INT8U *)&OSCyclesWin[0], sizeof(OSCyclesWin));  /* Start the CPU usage window at 0      */
+    OSCyclesWinIx = 0;
+#endif
 }
 /*$PAGE*/
 /*
@@ -1334,19 +1514,8 @@ static  void  OS_InitMisc (void)
 
 static  void  OS_InitRdyList (void)
 {
-    INT8U    i;
-#if OS_LOWEST_PRIO <= 63
-    INT8U   *prdytbl;
-#else
-    INT16U  *prdytbl;
-#endif
-
-
     OSRdyGrp      = 0;                                     /* Clear the ready list                     */
-    prdytbl       = &OSRdyTbl[0];
-    for (i = 0; i < OS_RDY_TBL_SIZE; i++) {
-        *prdytbl++ = 0;
-    }
+    OS_MemClr((INT8U *)&OSRdyTbl[0], sizeof(OSRdyTbl));
 
     OSPrioCur     = 0;
     OSPrioHighRdy = 0;
@@ -1545,17 +1714,47 @@ static  void  OS_InitTCBList (void)
 * Notes      : 1) This function is INTERNAL to uC/OS-II and your application should not call it.
 *              2) Note that we can only clear up to 64K bytes of RAM.  This is not an issue because none
 *                 of the uses of this function gets close to this limit.
-*              3) The clear is done one byte at a time since this will work on any processor irrespective
-*                 of the alignment of the destination.
+*              3) With OS_MEM_WORD_EN the bytes up to the first 32 bit boundary are cleared one at a time,
+*                 then whole words, 4 per iteration, and then the bytes left.  The port can provide a
+*                 faster clear as OS_CPU_MEM_CLR() in OS_CPU.H.  Otherwise the clear is done one byte at a
+*                 time since this will work on any processor irrespective of the alignment of the
+*                 destination.
 *********************************************************************************************************
 */
 
 void  OS_MemClr (INT8U *pdest, INT16U size)
 {
+#if (OS_MEM_WORD_EN > 0) && defined(OS_CPU_MEM_CLR)
+    OS_CPU_MEM_CLR(pdest, size);
+#else
+#if OS_MEM_WORD_EN > 0
+    INT32U  *pword;
+
+
+    while (size > 0 && ((INT32U)(long)pdest & 3) != 0) {   /* Clear up to the first word boundary      */
+        *pdest++ = (INT8U)0;
+        size--;
+    }
+    pword = (INT32U *)pdest;
+    while (size >= 16) {                                   /* Clear 4 words at a time                  */
+        pword[0]  = 0L;
+        pword[1]  = 0L;
+        pword[2]  = 0L;
+        pword[3]  = 0L;
+        pword    += 4;
+        size     -= 16;
+    }
+    while (size >= 4) {
+        *pword++  = 0L;
+        size     -= 4;
+    }
+    pdest = (INT8U *)pword;
+#endif
     while (size > 0) {
         *pdest++ = (INT8U)0;
         size--;
     }
+#endif
 }
 /*$PAGE*/
 /*
@@ -1577,17 +1776,53 @@ void  OS_MemClr (INT8U *pdest, INT16U size)
 *                 no provision to handle overlapping memory copy.  However, that's not a problem since this
 *                 is not a situation that will happen.
 *              2) Note that we can only copy up to 64K bytes of RAM
-*              3) The copy is done one byte at a time since this will work on any processor irrespective
-*                 of the alignment of the source and destination.
+*              3) With OS_MEM_WORD_EN, if the source and the destination are as far from a 32 bit boundary,
+*                 the bytes up to it are copied one at a time, then whole words, 4 per iteration, and then
+*                 the bytes left.  The port can provide a faster copy as OS_CPU_MEM_COPY() in OS_CPU.H.
+*                 Otherwise the copy is done one byte at a time since this will work on any processor
+*                 irrespective of the alignment of the source and destination.
 *********************************************************************************************************
 */
 
 void  OS_MemCopy (INT8U *pdest, INT8U *psrc, INT16U size)
 {
+#if (OS_MEM_WORD_EN > 0) && defined(OS_CPU_MEM_COPY)
+    OS_CPU_MEM_COPY(pdest, psrc, size);
+#else
+#if OS_MEM_WORD_EN > 0
+    INT32U  *pword;
+    INT32U  *pwsrc;
+
+
+    if ((((INT32U)(long)pdest ^ (INT32U)(long)psrc) & 3) == 0) {  /* Same offset from a word boundary */
+        while (size > 0 && ((INT32U)(long)pdest & 3) != 0) {
+            *pdest++ = *psrc++;
+            size--;
+        }
+        pword = (INT32U *)pdest;
+        pwsrc = (INT32U *)psrc;
+        while (size >= 16) {                               /* Copy 4 words at a time                   */
+            pword[0]  = pwsrc[0];
+            pword[1]  = pwsrc[1];
+            pword[2]  = pwsrc[2];
+            pword[3]  = pwsrc[3];
+            pword    += 4;
+            pwsrc    += 4;
+            size     -= 16;
+        }
+        while (size >= 4) {
+            *pword++  = *pwsrc++;
+            size     -= 4;
+        }
+        pdest = (INT8U *)pword;
+        psrc  = (INT8U *)pwsrc;
+    }
+#endif
     while (size > 0) {
         *pdest++ = *psrc++;
         size--;
     }
+#endif
 }
 /*$PAGE*/
 /*
@@ -1625,6 +1860,7 @@ void  OS_Sched (void)
                 OSTCBHighRdy->OSTCBCtxSwCtr++;         /* Inc. # of context switches to this task      */
 #endif
                 OSCtxSwCtr++;                          /* Increment context switch counter             */
+                OS_TRACE(OS_TRACE_TASK_SW, OSPrioHighRdy);
                 OS_TASK_SW();                          /* Perform a context switch                     */
             }
         }
@@ -1651,7 +1887,15 @@ void  OS_Sched (void)
 
 static  void  OS_SchedNew (void)
 {
-#if OS_LOWEST_PRIO <= 63                         /* See if we support up to 64 tasks                   */
+#if (OS_RDY_BITMAP_EN > 0) && (OS_LOWEST_PRIO <= 31)   /* One ready table entry holds all priorities   */
+    OSPrioHighRdy = OS_PrioFind(OSRdyTbl[0]);
+#elif OS_RDY_BITMAP_EN > 0                       /* 32 priorities per ready table entry                */
+    INT8U   y;
+
+
+    y             = OS_PrioFind(OSRdyGrp);
+    OSPrioHighRdy = (INT8U)((y << OS_PRIO_SHIFT) + OS_PrioFind(OSRdyTbl[y]));
+#elif OS_LOWEST_PRIO <= 63                       /* See if we support up to 64 tasks                   */
     INT8U   y;
 
 
@@ -1676,6 +1920,47 @@ static  void  OS_SchedNew (void)
 #endif
 }
 
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                              FIND THE HIGHEST PRIORITY IN A READY LIST ENTRY
+*
+* Description: This function returns the position of the lowest bit set in an entry of the 32 bit ready
+*              table, ready group or event wait list, i.e. the highest priority it holds.
+*
+* Arguments  : map       is the entry to search.  It must not be 0.
+*
+* Returns    : the bit position, 0..31
+*
+* Notes      : 1) This function is INTERNAL to uC/OS-II and your application should not call it.
+*              2) The port can define OS_CPU_CTZ() in OS_CPU.H if the CPU counts trailing zeros in
+*                 hardware.  Otherwise the entry is narrowed down to a byte and looked up in OSUnMapTbl[].
+*********************************************************************************************************
+*/
+
+#if OS_RDY_BITMAP_EN > 0
+static  INT8U  OS_PrioFind (OS_PRIO map)
+{
+#ifdef OS_CPU_CTZ
+    return ((INT8U)OS_CPU_CTZ(map));
+#else
+    INT8U  n;
+
+
+    n = 0;
+    if ((map & 0xFFFFu) == 0) {                      /* Highest priority in the upper half?             */
+        map >>= 16;
+        n     = 16;
+    }
+    if ((map & 0xFFu) == 0) {                        /* ... in the upper byte of what is left?          */
+        map >>= 8;
+        n    += 8;
+    }
+    return ((INT8U)(n + OSUnMapTbl[map & 0xFFu]));
+#endif
+}
+#endif
+
 /*$PAGE*/
 /*
 *********************************************************************************************************
@@ -1802,6 +2087,9 @@ void  OS_TaskIdle (void *p_arg)
 *              2) You can disable this task by setting the configuration #define OS_TASK_STAT_EN to 0.
 *              3) You MUST have at least a delay of 2/10 seconds to allow for the system to establish the
 *                 maximum value for the idle counter.
+*              4) With OS_TASK_STAT_CYCLES_EN the usage is instead computed by OS_TaskStatIdle() from the
+*                 cycles the idle task ran, and notes 2) and 3) do not apply: the task starts measuring
+*                 at once, whether or not OSStatInit() is called.
 *********************************************************************************************************
 */
 
@@ -1815,6 +2103,15 @@ void  OS_TaskStat (void *p_arg)
 
 
     (void)p_arg;                                 /* Prevent compiler warning for not using 'p_arg'     */
+#if OS_TASK_STAT_CYCLES
+    OS_ENTER_CRITICAL();
+    OSStatCycles     = OSCPUCyclesGet();         /* Start the first period                             */
+    OSStatIdleCycles = OSTCBPrioTbl[OS_TASK_IDLE_PRIO]->OSTCBCyclesTot;
+    OS_EXIT_CRITICAL();
+    for (;;) {
+        OSTimeDly(OS_TICKS_PER_SEC / 10);        /* Let the idle task run for the next 1/10 second     */
+        OS_TaskStatIdle();                       /* Compute the CPU usage                              */
+#else
     while (OSStatRdy == OS_FALSE) {
         OSTimeDly(2 * OS_TICKS_PER_SEC / 10);    /* Wait until statistic task is ready                 */
     }
@@ -1829,12 +2126,89 @@ void  OS_TaskStat (void *p_arg)
         OSIdleCtr    = 0L;                       /* Reset the idle counter for the next second         */
         OS_EXIT_CRITICAL();
         OSCPUUsage   = (INT8U)(100L - OSIdleCtrRun / OSIdleCtrMax);
+#endif
+#if OS_TASK_CPU_USAGE_EN
+        OS_TaskStatCycles();                     /* Compute the CPU usage of each task                 */
+#endif
         OSTaskStatHook();                        /* Invoke user definable hook                         */
 #if (OS_TASK_STAT_STK_CHK_EN > 0) && (OS_TASK_CREATE_EXT_EN > 0)
         OS_TaskStatStkChk();                     /* Check the stacks for each task                     */
 #endif
+#if OS_TASK_STAT_CYCLES == 0
         OSTimeDly(OS_TICKS_PER_SEC / 10);        /* Accumulate OSIdleCtr for the next 1/10 second      */
+#endif
+    }
+}
+#endif
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                     COMPUTE THE CPU USAGE FROM IDLE TIME
+*
+* Description: This function is called by OS_TaskStat() when OS_TASK_STAT_CYCLES_EN is set, to compute
+*              the CPU usage over the last statistic task period from the cycles the idle task has been
+*              running, which OSTaskSwHook() accumulates in its OSTCBCyclesTot:
+*
+*                                            idle task cycles in the period
+*                 OSCPUUsageFine = 10000 * (1 - ------------------------------)     (units are 0.01 %)
+*                                                 cycles in the period
+*
+*              OSCPUUsage is OSCPUUsageFine in %, OSCPUUsagePeak the highest value of OSCPUUsageFine
+*              and OSCPUUsageHist[] counts the periods by their usage, in OS_TASK_STAT_HIST_SIZE bands
+*              of equal width.  A period of 100 % usage is counted in the highest band.
+*
+* Arguments  : none
+*
+* Returns    : none
+*
+* Notes      : 1) Interrupts serviced while the idle task runs are counted as idle time, as they are by
+*                 OSIdleCtr.
+*              2) The cycle counts are 32 bit and may wrap, so a period must be shorter than the time
+*                 it takes OSCPUCyclesGet() to wrap.
+*********************************************************************************************************
+*/
+
+#if OS_TASK_STAT_CYCLES
+void  OS_TaskStatIdle (void)
+{
+    INT32U     cycles;
+    INT32U     idle;
+    INT32U     scale;
+    INT16U     usage;
+    INT16U     band;
+#if OS_CRITICAL_METHOD == 3                      /* Allocate storage for CPU status register           */
+    OS_CPU_SR  cpu_sr = 0;
+#endif
+
+
+
+    OS_ENTER_CRITICAL();
+    cycles           = OSCPUCyclesGet();
+    idle             = OSTCBPrioTbl[OS_TASK_IDLE_PRIO]->OSTCBCyclesTot;
+    scale            = cycles - OSStatCycles;    /* Cycles in the period                               */
+    idle            -= OSStatIdleCycles;
+    OSStatCycles     = cycles;
+    OSStatIdleCycles = idle + OSStatIdleCycles;
+    OS_EXIT_CRITICAL();
+    scale /= 10000L;                             /* Cycles per 0.01 % of the period                    */
+    if (scale == 0L) {
+        scale = 1L;
+    }
+    idle /= scale;
+    usage = (idle < 10000L) ? (INT16U)(10000L - idle) : 0;
+    band  = (INT16U)((INT32U)usage * OS_TASK_STAT_HIST_SIZE / 10000L);
+    if (band >= OS_TASK_STAT_HIST_SIZE) {
+        band = OS_TASK_STAT_HIST_SIZE - 1;
+    }
+
+    OS_ENTER_CRITICAL();
+    OSCPUUsageFine = usage;
+    OSCPUUsage     = (INT8U)(usage / 100);
+    if (usage > OSCPUUsagePeak) {
+        OSCPUUsagePeak = usage;
     }
+    OSCPUUsageHist[band]++;
+    OS_EXIT_CRITICAL();
 }
 #endif
 /*$PAGE*/
@@ -1882,6 +2256,91 @@ void  OS_TaskStatStkChk (void)
 /*$PAGE*/
 /*
 *********************************************************************************************************
+*                                     COMPUTE THE CPU USAGE OF EACH TASK
+*
+* Description: This function is called by OS_TaskStat() to compute the CPU usage of each task over the
+*              last OS_TASK_PROFILE_WIN statistic task periods, from the cycles accumulated in
+*              OSTCBCyclesTot by OSTaskSwHook().  For every period the cycle counter and each task's
+*              OSTCBCyclesTot are recorded, and the usage is the share of the cycles since the oldest
+*              record that the task has been running:
+*
+*                                        OSTCBCyclesTot - OSTCBCyclesWin[oldest]
+*                 OSTCBCPUUsage = 10000 * ---------------------------------------     (units are 0.01 %)
+*                                          OSCPUCyclesGet() - OSCyclesWin[oldest]
+*
+*              The records are taken in one critical section, which leaves the cycles each task ran in
+*              the window in OSTCBCyclesRun.  The divisions are done after it, for each task that exists.
+*
+* Arguments  : none
+*
+* Returns    : none
+*
+* Notes      : 1) The cycle counts are 32 bit and may wrap, so the window must be shorter than the time
+*                 it takes OSCPUCyclesGet() to wrap.
+*              2) A task created within the window is accounted as if it had existed, but not run,
+*                 since the start of the window.
+*              3) As in OS_TaskStatStkChk(), the usage is stored outside of a critical section.  A task
+*                 created meanwhile gets a usage of 0.
+*********************************************************************************************************
+*/
+
+#if OS_TASK_CPU_USAGE_EN
+void  OS_TaskStatCycles (void)
+{
+    OS_TCB    *ptcb;
+    INT32U     cycles;
+    INT32U     tot;
+    INT32U     scale;
+    INT32U     usage;
+    INT8U      ix;
+    INT8U      prio;
+#if OS_CRITICAL_METHOD == 3                      /* Allocate storage for CPU status register           */
+    OS_CPU_SR  cpu_sr = 0;
+#endif
+
+
+
+    OS_ENTER_CRITICAL();
+    cycles = OSCPUCyclesGet();
+    ix     = OSCyclesWinIx;
+    scale  = cycles - OSCyclesWin[ix];           /* Cycles in the window                               */
+    ptcb   = OSTCBList;
+    while (ptcb != (OS_TCB *)0) {
+        tot = ptcb->OSTCBCyclesTot;
+        if (ptcb == OSTCBCur) {                  /* Include the time this task has been running so far */
+            tot += cycles - ptcb->OSTCBCyclesStart;
+        }
+        ptcb->OSTCBCyclesRun     = tot - ptcb->OSTCBCyclesWin[ix];
+        ptcb->OSTCBCyclesWin[ix] = tot;
+        ptcb                     = ptcb->OSTCBNext;
+    }
+    OSCyclesWin[ix] = cycles;
+    ix++;
+    if (ix >= OS_TASK_PROFILE_WIN) {
+        ix = 0;
+    }
+    OSCyclesWinIx   = ix;
+    OS_EXIT_CRITICAL();
+
+    scale /= 10000L;                             /* Cycles per 0.01 % of the window                    */
+    if (scale == 0L) {
+        scale = 1L;
+    }
+    for (prio = 0; prio <= OS_TASK_IDLE_PRIO; prio++) {
+        ptcb = OSTCBPrioTbl[prio];
+        if ((ptcb != (OS_TCB *)0) && (ptcb != OS_TCB_RESERVED)) {
+            usage = ptcb->OSTCBCyclesRun / scale;
+            if (usage > 10000L) {
+                usage = 10000L;
+            }
+            ptcb->OSTCBCPUUsage = (INT16U)usage;
+        }
+    }
+}
+#endif
+/*$PAGE*/
+/*
+*********************************************************************************************************
 *                                            INITIALIZE TCB
 *
 * Description: This function is internal to uC/OS-II and is used to initialize a Task Control Block when
@@ -1961,17 +2420,10 @@ INT8U  OS_TCBInit (INT8U prio, OS_STK *ptos, OS_STK *pbos, INT16U id, INT32U stk
         ptcb->OSTCBDelReq        = OS_ERR_NONE;
 #endif
 
-#if OS_LOWEST_PRIO <= 63
-        ptcb->OSTCBY             = (INT8U)(prio >> 3);          /* Pre-compute X, Y, BitX and BitY     */
-        ptcb->OSTCBX             = (INT8U)(prio & 0x07);
-        ptcb->OSTCBBitY          = (INT8U)(1 << ptcb->OSTCBY);
-        ptcb->OSTCBBitX          = (INT8U)(1 << ptcb->OSTCBX);
-#else
-        ptcb->OSTCBY             = (INT8U)((prio >> 4) & 0xFF); /* Pre-compute X, Y, BitX and BitY     */
-        ptcb->OSTCBX             = (INT8U) (prio & 0x0F);
-        ptcb->OSTCBBitY          = (INT16U)(1 << ptcb->OSTCBY);
-        ptcb->OSTCBBitX          = (INT16U)(1 << ptcb->OSTCBX);
-#endif
+        ptcb->OSTCBY             = (INT8U)(prio >> OS_PRIO_SHIFT);  /* Pre-compute X, Y, BitX and BitY */
+        ptcb->OSTCBX             = (INT8U)(prio &  OS_PRIO_MASK);
+        ptcb->OSTCBBitY          = (OS_PRIO)(1u << ptcb->OSTCBY);
+        ptcb->OSTCBBitX          = (OS_PRIO)(1u << ptcb->OSTCBX);
 
 #if (OS_EVENT_EN)
         ptcb->OSTCBEventPtr      = (OS_EVENT  *)0;         /* Task is not pending on an  event         */
@@ -1992,8 +2444,17 @@ INT8U  OS_TCBInit (INT8U prio, OS_STK *ptos, OS_STK *pbos, INT16U id, INT32U stk
         ptcb->OSTCBCtxSwCtr    = 0L;                       /* Initialize profiling variables           */
         ptcb->OSTCBCyclesStart = 0L;
         ptcb->OSTCBCyclesTot   = 0L;
+#if OS_TASK_CPU_USAGE_EN
+        OS_MemClr((INT8U *)&ptcb->OSTCBCyclesWin[0], sizeof(ptcb->OSTCBCyclesWin));
+        ptcb->OSTCBCyclesRun   = 0L;
+        ptcb->OSTCBCPUUsage    = 0;
+#endif
         ptcb->OSTCBStkBase     = (OS_STK *)0;
         ptcb->OSTCBStkUsed     = 0L;
+#if OS_TASK_STK_WATERMARK_EN > 0
+        ptcb->OSTCBStkFree     = 0L;
+        ptcb->OSTCBStkChkCtr   = 0xFFFFFFFFL;              /* Not checked yet, the task has 0 switches */
+#endif
 #endif
 
 #if OS_TASK_NAME_SIZE > 1
@@ -2022,3 +2483,93 @@ INT8U  OS_TCBInit (INT8U prio, OS_STK *ptos, OS_STK *pbos, INT16U id, INT32U stk
     OS_EXIT_CRITICAL();
     return (OS_ERR_TASK_NO_MORE_TCB);
 }
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                  INSERT A TASK IN THE DELAYED TASK LIST
+*
+* Description: This function is called by OSTimeDly() and by the services that pend with a timeout to
+*              delay a task for 'ticks' clock ticks.  With OS_TIME_DLY_LIST_EN, the task is inserted in
+*              OSTCBDlyList, which is kept sorted by the tick at which each delay expires.  Tasks that
+*              expire on the same tick are kept in the order they were delayed.
+*
+* Arguments  : ptcb      is a pointer to the task's TCB.  The task must not be delayed already.
+*
+*              ticks     is the number of clock ticks to delay the task for.  0 means no delay (or pend
+*                        forever), and leaves the task out of the list.
+*
+* Returns    : none
+*
+* Note(s)    : 1) This function assumes that interrupts are disabled.
+*              2) This function is INTERNAL to uC/OS-II and your application should not call it.
+*********************************************************************************************************
+*/
+
+void  OS_TimeDlyInsert (OS_TCB *ptcb, INT16U ticks)
+{
+#if OS_TIME_DLY_LIST_EN > 0
+    OS_TCB  *pprev;
+    OS_TCB  *pnext;
+#endif
+
+
+    ptcb->OSTCBDly = ticks;
+#if OS_TIME_DLY_LIST_EN > 0
+    if (ticks == 0) {
+        return;
+    }
+    ptcb->OSTCBDlyTick = OSTickCtr + ticks;
+    pprev = (OS_TCB *)0;
+    pnext = OSTCBDlyList;
+    while (pnext != (OS_TCB *)0) {                         /* Find first task expiring after this one  */
+        if ((INT32S)(pnext->OSTCBDlyTick - ptcb->OSTCBDlyTick) > 0) {
+            break;
+        }
+        pprev = pnext;
+        pnext = pnext->OSTCBDlyNext;
+    }
+    ptcb->OSTCBDlyPrev = pprev;                            /* Link between 'pprev' and 'pnext'         */
+    ptcb->OSTCBDlyNext = pnext;
+    if (pnext != (OS_TCB *)0) {
+        pnext->OSTCBDlyPrev = ptcb;
+    }
+    if (pprev != (OS_TCB *)0) {
+        pprev->OSTCBDlyNext = ptcb;
+    } else {
+        OSTCBDlyList        = ptcb;
+    }
+#endif
+}
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                 REMOVE A TASK FROM THE DELAYED TASK LIST
+*
+* Description: This function is called when a task's delay is cancelled or has expired, i.e. whenever
+*              OSTCBDly is cleared.  The task is unlinked from OSTCBDlyList in constant time.
+*
+* Arguments  : ptcb      is a pointer to the task's TCB.  The task does not need to be delayed.
+*
+* Returns    : none
+*
+* Note(s)    : 1) This function assumes that interrupts are disabled.
+*              2) This function is INTERNAL to uC/OS-II and your application should not call it.
+*********************************************************************************************************
+*/
+
+void  OS_TimeDlyRemove (OS_TCB *ptcb)
+{
+#if OS_TIME_DLY_LIST_EN > 0
+    if (ptcb->OSTCBDly != 0) {                             /* Only delayed tasks are in the list       */
+        if (ptcb->OSTCBDlyNext != (OS_TCB *)0) {
+            ptcb->OSTCBDlyNext->OSTCBDlyPrev = ptcb->OSTCBDlyPrev;
+        }
+        if (ptcb->OSTCBDlyPrev != (OS_TCB *)0) {
+            ptcb->OSTCBDlyPrev->OSTCBDlyNext = ptcb->OSTCBDlyNext;
+        } else {
+            OSTCBDlyList                     = ptcb->OSTCBDlyNext;
+        }
+    }
+#endif
+    ptcb->OSTCBDly = 0;
+}
@@ -993,7 +993,7 @@ static  void  OS_FlagBlock (OS_FLAG_GRP *pgrp, OS_FLAG_NODE *pnode, OS_FLAGS fla
 
     OSTCBCur->OSTCBStat      |= OS_STAT_FLAG;
     OSTCBCur->OSTCBStatPend   = OS_STAT_PEND_OK;
-    OSTCBCur->OSTCBDly        = timeout;              /* Store timeout in task's TCB                   */
+    OS_TimeDlyInsert(OSTCBCur, timeout);              /* Store timeout in task's TCB                   */
 #if OS_TASK_DEL_EN > 0
     OSTCBCur->OSTCBFlagNode   = pnode;                /* TCB to link to node                           */
 #endif
@@ -1105,7 +1105,7 @@ static  BOOLEAN  OS_FlagTaskRdy (OS_FLAG_NODE *pnode, OS_FLAGS flags_rdy)
 
 
     ptcb                 = (OS_TCB *)pnode->OSFlagNodeTCB; /* Point to TCB of waiting task             */
-    ptcb->OSTCBDly       = 0;
+    OS_TimeDlyRemove(ptcb);
     ptcb->OSTCBFlagsRdy  = flags_rdy;
     ptcb->OSTCBStat     &= ~(INT8U)OS_STAT_FLAG;
     ptcb->OSTCBStatPend  = OS_STAT_PEND_OK;
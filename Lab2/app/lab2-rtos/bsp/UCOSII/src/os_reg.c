@@ -0,0 +1,228 @@
+/******************************************************************************
+*                                                                             *
+* State registers for uC/OS-II: the latest value of a piece of state, written *
+* by one task and read by others without a pend.                              *
+*                                                                             *
+* See OS_REG_EN in os_cfg.h and OSRegCreate() below.                          *
+*                                                                             *
+******************************************************************************/
+
+#ifndef  OS_MASTER_FILE
+#include <ucos_ii.h>
+#endif
+
+#if (OS_REG_EN > 0) && (OS_MAX_REGS > 0)
+/*
+*********************************************************************************************************
+*                                                 NOTES
+*
+* A state register holds the latest value of a quantity, e.g. a velocity or the state of the pedals.
+* Writers replace the whole value; readers always get the last complete value written and never wait
+* for it.  Unlike a mailbox, reading does not consume the value, so any number of tasks can read it,
+* and nothing has to be posted again for a reader that comes back before the next write.
+*
+* The register is a sequence lock:
+*
+*   - OSRegWrite() makes the sequence counter odd, copies the value in and makes the counter even
+*     again, all with interrupts disabled so that writers from tasks and ISRs are serialized and a
+*     reader never finds a write half done on this CPU.
+*
+*   - OSRegRead() copies the value out without disabling interrupts or locking the scheduler.  If
+*     the counter changed during the copy, a write preempted it and the copy is done again.
+*
+* The value is copied with interrupts disabled on the write side, so registers are meant for small
+* values (a few words).
+*********************************************************************************************************
+*/
+
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                        CREATE A STATE REGISTER
+*
+* Description: This function creates a state register holding a value of 'size' bytes.
+*
+* Arguments  : pdata     is a pointer to the storage of the value, which must stay allocated as long as
+*                        the register is used.  Its contents are the initial value of the register.
+*
+*              size      is the size (in bytes) of the value.
+*
+*              perr      is a pointer to an error code which will be returned to your application:
+*                           OS_ERR_NONE              if the call was successful.
+*                           OS_ERR_PDATA_NULL        if 'pdata' is a NULL pointer.
+*                           OS_ERR_REG_INVALID_SIZE  if 'size' is 0.
+*                           OS_ERR_REG_DEPLETED      if there are no more state registers available.
+*                                                    You will need to increase OS_MAX_REGS.
+*
+* Returns    : != (OS_REG *)0  is a pointer to the state register created.
+*              == (OS_REG *)0  if no register was created.
+*********************************************************************************************************
+*/
+
+OS_REG  *OSRegCreate (void *pdata, INT16U size, INT8U *perr)
+{
+    OS_REG    *preg;
+#if OS_CRITICAL_METHOD == 3                      /* Allocate storage for CPU status register           */
+    OS_CPU_SR  cpu_sr = 0;
+#endif
+
+
+
+#if OS_ARG_CHK_EN > 0
+    if (perr == (INT8U *)0) {                    /* Validate 'perr'                                    */
+        return ((OS_REG *)0);
+    }
+    if (pdata == (void *)0) {                    /* Must point to the storage of the value             */
+        *perr = OS_ERR_PDATA_NULL;
+        return ((OS_REG *)0);
+    }
+    if (size == 0) {                             /* Must hold at least one byte                        */
+        *perr = OS_ERR_REG_INVALID_SIZE;
+        return ((OS_REG *)0);
+    }
+#endif
+    OS_ENTER_CRITICAL();
+    preg = OSRegFreeList;                        /* Get next free state register                       */
+    if (OSRegFreeList != (OS_REG *)0) {          /* See if pool of free registers was empty            */
+        OSRegFreeList = (OS_REG *)OSRegFreeList->OSRegData;
+    }
+    OS_EXIT_CRITICAL();
+    if (preg == (OS_REG *)0) {
+        *perr = OS_ERR_REG_DEPLETED;
+        return ((OS_REG *)0);
+    }
+    preg->OSRegData = pdata;
+    preg->OSRegSize = size;
+    preg->OSRegSeq  = 0;
+    *perr           = OS_ERR_NONE;
+    return (preg);
+}
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                        READ A STATE REGISTER
+*
+* Description: This function copies the latest value written to a state register.  It never waits and
+*              can be called from tasks and ISRs.
+*
+* Arguments  : preg      is a pointer to the state register.
+*
+*              pdata     is a pointer to where the value is copied, which must hold the 'size' bytes
+*                        given to OSRegCreate().
+*
+*              perr      is a pointer to an error code which will be returned to your application:
+*                           OS_ERR_NONE              if the call was successful.
+*                           OS_ERR_REG_INVALID_PREG  if 'preg' is a NULL pointer.
+*                           OS_ERR_PDATA_NULL        if 'pdata' is a NULL pointer.
+*
+* Returns    : The number of writes done to the register so far, so that a reader can tell whether
+*              the value was written again since its last read.
+*
+* Note(s)    : 1) The copy is done again if a write preempted it, which can only happen a bounded number
+*                 of times as long as the register is not written on every tick.
+*********************************************************************************************************
+*/
+
+INT32U  OSRegRead (OS_REG *preg, void *pdata, INT8U *perr)
+{
+    INT32U  seq;
+
+
+
+#if OS_ARG_CHK_EN > 0
+    if (perr == (INT8U *)0) {                    /* Validate 'perr'                                    */
+        return (0);
+    }
+    if (preg == (OS_REG *)0) {                   /* Validate 'preg'                                    */
+        *perr = OS_ERR_REG_INVALID_PREG;
+        return (0);
+    }
+    if (pdata == (void *)0) {                    /* Validate 'pdata'                                   */
+        *perr = OS_ERR_PDATA_NULL;
+        return (0);
+    }
+#endif
+    do {
+        seq = preg->OSRegSeq;
+        OS_CPU_MEM_BARRIER();                    /* Read the counter before the value ...              */
+        OS_MemCopy((INT8U *)pdata, (INT8U *)preg->OSRegData, preg->OSRegSize);
+        OS_CPU_MEM_BARRIER();                    /* ... and the value before the counter again         */
+    } while (((seq & 1) != 0) || (seq != preg->OSRegSeq));
+    *perr = OS_ERR_NONE;
+    return (seq >> 1);
+}
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                        WRITE A STATE REGISTER
+*
+* Description: This function replaces the value of a state register.  It can be called from tasks and
+*              ISRs.  No task is made ready, so it never causes a context switch.
+*
+* Arguments  : preg      is a pointer to the state register.
+*
+*              pdata     is a pointer to the new value, 'size' bytes as given to OSRegCreate().
+*
+* Returns    : OS_ERR_NONE              if the call was successful.
+*              OS_ERR_REG_INVALID_PREG  if 'preg' is a NULL pointer.
+*              OS_ERR_PDATA_NULL        if 'pdata' is a NULL pointer.
+*********************************************************************************************************
+*/
+
+INT8U  OSRegWrite (OS_REG *preg, void *pdata)
+{
+#if OS_CRITICAL_METHOD == 3                      /* Allocate storage for CPU status register           */
+    OS_CPU_SR  cpu_sr = 0;
+#endif
+
+
+
+#if OS_ARG_CHK_EN > 0
+    if (preg == (OS_REG *)0) {                   /* Validate 'preg'                                    */
+        return (OS_ERR_REG_INVALID_PREG);
+    }
+    if (pdata == (void *)0) {                    /* Validate 'pdata'                                   */
+        return (OS_ERR_PDATA_NULL);
+    }
+#endif
+    OS_ENTER_CRITICAL();
+    preg->OSRegSeq++;                            /* Odd: a write is going on                           */
+    OS_CPU_MEM_BARRIER();
+    OS_MemCopy((INT8U *)preg->OSRegData, (INT8U *)pdata, preg->OSRegSize);
+    OS_CPU_MEM_BARRIER();
+    preg->OSRegSeq++;                            /* Even: the value is complete                        */
+    OS_EXIT_CRITICAL();
+    return (OS_ERR_NONE);
+}
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                 INITIALIZE THE STATE REGISTER MANAGER
+*
+* Description: This function is called by OSInit() to initialize the free list of state registers.
+*
+* Arguments  : none
+*
+* Returns    : none
+*
+* Note(s)    : 1) This function is INTERNAL to uC/OS-II and your application should not call it.
+*********************************************************************************************************
+*/
+
+void  OS_RegInit (void)
+{
+    OS_REG  *preg;
+    INT16U   i;
+
+
+
+    OS_MemClr((INT8U *)&OSRegTbl[0], sizeof(OSRegTbl));  /* Clear the state register table            */
+    preg = &OSRegTbl[0];
+    for (i = 0; i < (OS_MAX_REGS - 1); i++) {             /* Init. list of free state registers        */
+        preg->OSRegData = (void *)&OSRegTbl[i+1];
+        preg++;
+    }
+    preg->OSRegData = (void *)0;                          /* Initialize last node                      */
+    OSRegFreeList   = &OSRegTbl[0];                       /* Point to beginning of free list           */
+}
+#endif                                                    /* OS_REG_EN                                 */
@@ -317,7 +317,8 @@ void  OSSemPend (OS_EVENT *pevent, INT16U timeout, INT8U *perr)
                                                       /* Otherwise, must wait until event occurs       */
     OSTCBCur->OSTCBStat     |= OS_STAT_SEM;           /* Resource not available, pend on semaphore     */
     OSTCBCur->OSTCBStatPend  = OS_STAT_PEND_OK;
-    OSTCBCur->OSTCBDly       = timeout;               /* Store pend timeout in TCB                     */
+    OS_TimeDlyInsert(OSTCBCur, timeout);              /* Store pend timeout in TCB                     */
+    OS_TRACE_EVENT(OS_TRACE_SEM_PEND, pevent);
     OS_EventTaskWait(pevent);                         /* Suspend task until event or timeout occurs    */
     OS_EXIT_CRITICAL();
     OS_Sched();                                       /* Find next highest priority task ready         */
@@ -467,6 +468,7 @@ INT8U  OSSemPost (OS_EVENT *pevent)
         return (OS_ERR_EVENT_TYPE);
     }
     OS_ENTER_CRITICAL();
+    OS_TRACE_EVENT(OS_TRACE_SEM_POST, pevent);
     if (pevent->OSEventGrp != 0) {                    /* See if any task waiting for semaphore         */
                                                       /* Ready HPT waiting on event                    */
         (void)OS_EventTaskRdy(pevent, (void *)0, OS_STAT_SEM, OS_STAT_PEND_OK);
@@ -506,13 +508,8 @@ INT8U  OSSemPost (OS_EVENT *pevent)
 #if OS_SEM_QUERY_EN > 0
 INT8U  OSSemQuery (OS_EVENT *pevent, OS_SEM_DATA *p_sem_data)
 {
-#if OS_LOWEST_PRIO <= 63
-    INT8U     *psrc;
-    INT8U     *pdest;
-#else
-    INT16U    *psrc;
-    INT16U    *pdest;
-#endif
+    OS_PRIO   *psrc;
+    OS_PRIO   *pdest;
     INT8U      i;
 #if OS_CRITICAL_METHOD == 3                                /* Allocate storage for CPU status register */
     OS_CPU_SR  cpu_sr = 0;
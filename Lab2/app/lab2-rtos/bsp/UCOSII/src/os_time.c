@@ -60,7 +60,7 @@ void  OSTimeDly (INT16U ticks)
         if (OSRdyTbl[y] == 0) {
             OSRdyGrp &= ~OSTCBCur->OSTCBBitY;
         }
-        OSTCBCur->OSTCBDly = ticks;              /* Load ticks in TCB                                  */
+        OS_TimeDlyInsert(OSTCBCur, ticks);       /* Load ticks in TCB                                  */
         OS_EXIT_CRITICAL();
         OS_Sched();                              /* Find next task to run!                             */
     }
@@ -191,7 +191,7 @@ INT8U  OSTimeDlyResume (INT8U prio)
         return (OS_ERR_TIME_NOT_DLY);                          /* Indicate that task was not delayed   */
     }
 
-    ptcb->OSTCBDly = 0;                                        /* Clear the time delay                 */
+    OS_TimeDlyRemove(ptcb);                                    /* Clear the time delay                 */
     if ((ptcb->OSTCBStat & OS_STAT_PEND_ANY) != OS_STAT_RDY) {
         ptcb->OSTCBStat     &= ~OS_STAT_PEND_ANY;              /* Yes, Clear status flag               */
         ptcb->OSTCBStatPend  =  OS_STAT_PEND_TO;               /* Indicate PEND timeout                */
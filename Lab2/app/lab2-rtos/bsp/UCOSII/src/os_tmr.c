@@ -46,6 +46,14 @@
 #define  OS_TMR_LINK_DLY       0
 #define  OS_TMR_LINK_PERIODIC  1
 
+#define  OS_TMR_WHEEL_MASK     (OS_TMR_CFG_WHEEL_SIZE  - 1)    /* Wheel sizes are powers of 2, so a mask selects ...  */
+#define  OS_TMR_WHEEL2_MASK    (OS_TMR_CFG_WHEEL2_SIZE - 1)    /* ... the spoke of a time, without a division         */
+
+                                                               /* Turn of the wheel that contains 'time'.  A turn ... */
+                                                               /* ... is OS_TMR_CFG_WHEEL_SIZE consecutive values ... */
+                                                               /* ... of OSTmrTime; the division compiles to a shift  */
+#define  OS_TMR_TURN(time)     ((INT32U)(time) / OS_TMR_CFG_WHEEL_SIZE)
+
 /*
 ************************************************************************************************************************
 *                                                  LOCAL PROTOTYPES
@@ -58,6 +66,12 @@ static  void     OSTmr_Free          (OS_TMR *ptmr);
 static  void     OSTmr_InitTask      (void);
 static  void     OSTmr_Link          (OS_TMR *ptmr, INT8U type);
 static  void     OSTmr_Unlink        (OS_TMR *ptmr);
+static  OS_TMR_WHEEL  *OSTmr_Spoke   (INT32U match);
+static  void     OSTmr_Insert        (OS_TMR_WHEEL *pspoke, OS_TMR *ptmr);
+static  void     OSTmr_Remove        (OS_TMR_WHEEL *pspoke, OS_TMR *ptmr);
+#if OS_TMR_CFG_WHEEL2_SIZE > 0
+static  void     OSTmr_Cascade       (void);
+#endif
 static  void     OSTmr_Lock          (void);
 static  void     OSTmr_Unlock        (void);
 static  void     OSTmr_Task          (void   *p_arg);
@@ -548,6 +562,9 @@ BOOLEAN  OSTmrStart (OS_TMR   *ptmr,
              OSTmr_Unlink(ptmr);                            /* ... Stop the timer                                     */
              OSTmr_Link(ptmr, OS_TMR_LINK_DLY);             /* ... Link timer to timer wheel                          */
              OSTmr_Unlock();
+#if OS_TICKLESS_EN > 0
+             OSTimeTickRearmHook();                         /* ... It may expire before an idle period ends           */
+#endif
              *perr = OS_ERR_NONE;
              return (OS_TRUE);
 
@@ -555,6 +572,9 @@ BOOLEAN  OSTmrStart (OS_TMR   *ptmr,
         case OS_TMR_STATE_COMPLETED:
              OSTmr_Link(ptmr, OS_TMR_LINK_DLY);             /* ... Link timer to timer wheel                          */
              OSTmr_Unlock();
+#if OS_TICKLESS_EN > 0
+             OSTimeTickRearmHook();                         /* ... It may expire before an idle period ends           */
+#endif
              *perr = OS_ERR_NONE;
              return (OS_TRUE);
 
@@ -718,6 +738,97 @@ INT8U  OSTmrSignal (void)
 }
 #endif
 
+/*$PAGE*/
+/*
+************************************************************************************************************************
+*                                     FIND THE NEXT SIGNAL THAT EXPIRES A TIMER
+*
+* Description: This function is called by a tickless idle implementation (see OSTimeTickNextHook()) to find out how many
+*              times OSTmrSignal() has to be called before OSTmr_Task() finds a timer that expires.
+*
+* Arguments  : none
+*
+* Returns    : The number of signals until the first running timer expires, at least 1.  0xFFFFFFFF means that no
+*              timer is running.
+*
+* Note(s)    : 1) This function must only be called by the idle task with interrupts disabled.  All other tasks are
+*                 then waiting, so neither OSTmr_Task() nor any OSTmr...() call can be updating the timer wheel.
+************************************************************************************************************************
+*/
+
+#if OS_TMR_EN > 0 && OS_TICKLESS_EN > 0
+INT32U  OSTmrSignalNext (void)
+{
+    OS_TMR  *ptmr;
+    INT32U   next;
+    INT32U   remain;
+    INT16U   spoke;
+
+
+    next = 0xFFFFFFFFL;
+    for (spoke = 0; spoke < OS_TMR_CFG_WHEEL_SIZE; spoke++) {  /* Spokes are sorted, the first timer expires first  */
+        ptmr = OSTmrWheelTbl[spoke].OSTmrFirst;
+        if (ptmr != (OS_TMR *)0) {
+            remain = ptmr->OSTmrMatch - OSTmrTime;
+            if (remain < next) {
+                next = remain;
+            }
+        }
+    }
+#if OS_TMR_CFG_WHEEL2_SIZE > 0
+    for (spoke = 0; spoke < OS_TMR_CFG_WHEEL2_SIZE; spoke++) {
+        ptmr = OSTmrWheel2Tbl[spoke].OSTmrFirst;
+        if (ptmr != (OS_TMR *)0) {
+            remain = ptmr->OSTmrMatch - OSTmrTime;
+            if (remain < next) {
+                next = remain;
+            }
+        }
+    }
+#endif
+    if (next == 0) {
+        next = 1;
+    }
+    return (next);
+}
+#endif
+
+/*$PAGE*/
+/*
+************************************************************************************************************************
+*                                              ACCOUNT FOR SKIPPED SIGNALS
+*
+* Description: This function is called by a tickless idle implementation (see OSTimeTickSkipHook()) for the calls to
+*              OSTmrSignal() that were left out while the tick interrupt was held off.  The timer time advances as if
+*              OSTmr_Task() had run for each of them.
+*
+* Arguments  : signals   is the number of signals left out.  It must be less than the value returned by
+*                        OSTmrSignalNext(), so that no timer expires within them.
+*
+* Returns    : none
+*
+* Note(s)    : 1) Interrupts must be disabled, and no task but the idle task may have run since OSTmrSignalNext().
+************************************************************************************************************************
+*/
+
+#if OS_TMR_EN > 0 && OS_TICKLESS_EN > 0
+void  OSTmrSignalSkip (INT32U signals)
+{
+#if OS_TMR_CFG_WHEEL2_SIZE > 0
+    INT32U  turn;
+
+
+    turn       = OS_TMR_TURN(OSTmrTime);
+    OSTmrTime += signals;
+    if (OS_TMR_TURN(OSTmrTime) != turn) {                        /* No timer expired in the turns skipped, so only    */
+        OSTmr_Cascade();                                         /* ... the current one has to be moved in            */
+    }
+#else
+    OSTmrTime += signals;
+#endif
+}
+#endif
+
 /*$PAGE*/
 /*
 ************************************************************************************************************************
@@ -813,6 +924,9 @@ void  OSTmr_Init (void)
 
     OS_MemClr((INT8U *)&OSTmrTbl[0],      sizeof(OSTmrTbl));            /* Clear all the TMRs                         */
     OS_MemClr((INT8U *)&OSTmrWheelTbl[0], sizeof(OSTmrWheelTbl));       /* Clear the timer wheel                      */
+#if OS_TMR_CFG_WHEEL2_SIZE > 0
+    OS_MemClr((INT8U *)&OSTmrWheel2Tbl[0], sizeof(OSTmrWheel2Tbl));     /* Clear the second timer wheel               */
+#endif
 
     ptmr1 = &OSTmrTbl[0];
     ptmr2 = &OSTmrTbl[1];
@@ -933,8 +1047,8 @@ static  void  OSTmr_InitTask (void)
 ************************************************************************************************************************
 *                                         INSERT A TIMER INTO THE TIMER WHEEL
 *
-* Description: This function is called to insert the timer into the timer wheel.  The timer is always inserted at the
-*              beginning of the list.
+* Description: This function is called to insert the timer into the timer wheel.  The timer is inserted in its spoke
+*              in order of match time (see OSTmr_Insert()).
 *
 * Arguments  : ptmr          Is a pointer to the timer to insert.
 *
@@ -949,11 +1063,6 @@ static  void  OSTmr_InitTask (void)
 #if OS_TMR_EN > 0
 static  void  OSTmr_Link (OS_TMR *ptmr, INT8U type)
 {
-    OS_TMR       *ptmr1;
-    OS_TMR_WHEEL *pspoke;
-    INT16U        spoke;
-
-
     ptmr->OSTmrState = OS_TMR_STATE_RUNNING;
     if (type == OS_TMR_LINK_PERIODIC) {                            /* Determine when timer will expire                */
         ptmr->OSTmrMatch = ptmr->OSTmrPeriod + OSTmrTime;
@@ -964,21 +1073,7 @@ static  void  OSTmr_Link (OS_TMR *ptmr, INT8U type)
             ptmr->OSTmrMatch = ptmr->OSTmrDly    + OSTmrTime;
         }
     }
-    spoke  = (INT16U)(ptmr->OSTmrMatch % OS_TMR_CFG_WHEEL_SIZE);
-    pspoke = &OSTmrWheelTbl[spoke];
-
-    if (pspoke->OSTmrFirst == (OS_TMR *)0) {                       /* Link into timer wheel                           */
-        pspoke->OSTmrFirst   = ptmr;
-        ptmr->OSTmrNext      = (OS_TMR *)0;
-        pspoke->OSTmrEntries = 1;
-    } else {
-        ptmr1                = pspoke->OSTmrFirst;                 /* Point to first timer in the spoke               */
-        pspoke->OSTmrFirst   = ptmr;
-        ptmr->OSTmrNext      = (void *)ptmr1;
-        ptmr1->OSTmrPrev     = (void *)ptmr;
-        pspoke->OSTmrEntries++;
-    }
-    ptmr->OSTmrPrev = (void *)0;                                   /* Timer always inserted as first node in list     */
+    OSTmr_Insert(OSTmr_Spoke(ptmr->OSTmrMatch), ptmr);             /* Link into timer wheel                           */
 }
 #endif
 
@@ -998,36 +1093,147 @@ static  void  OSTmr_Link (OS_TMR *ptmr, INT8U type)
 #if OS_TMR_EN > 0
 static  void  OSTmr_Unlink (OS_TMR *ptmr)
 {
-    OS_TMR        *ptmr1;
-    OS_TMR        *ptmr2;
-    OS_TMR_WHEEL  *pspoke;
-    INT16U         spoke;
+    OSTmr_Remove(OSTmr_Spoke(ptmr->OSTmrMatch), ptmr);
+    ptmr->OSTmrState = OS_TMR_STATE_STOPPED;
+}
+#endif
 
+/*$PAGE*/
+/*
+************************************************************************************************************************
+*                                          FIND THE SPOKE OF A RUNNING TIMER
+*
+* Description: This function returns the spoke that holds a running timer.  A timer that expires in the current turn
+*              of the wheel is on spoke 'match & OS_TMR_WHEEL_MASK'.  With a second wheel (OS_TMR_CFG_WHEEL2_SIZE > 0),
+*              a timer that expires in a later turn waits on the spoke of the second wheel for that turn, until
+*              OSTmr_Cascade() moves it to the first wheel as the turn begins.
+*
+* Arguments  : match         Is the value of OSTmrTime at which the timer expires.
+*
+* Returns    : a pointer to the spoke
+************************************************************************************************************************
+*/
 
-    spoke  = (INT16U)(ptmr->OSTmrMatch % OS_TMR_CFG_WHEEL_SIZE);
-    pspoke = &OSTmrWheelTbl[spoke];
+#if OS_TMR_EN > 0
+static  OS_TMR_WHEEL  *OSTmr_Spoke (INT32U match)
+{
+#if OS_TMR_CFG_WHEEL2_SIZE > 0
+    if (OS_TMR_TURN(match) != OS_TMR_TURN(OSTmrTime)) {
+        return (&OSTmrWheel2Tbl[OS_TMR_TURN(match) & OS_TMR_WHEEL2_MASK]);
+    }
+#endif
+    return (&OSTmrWheelTbl[match & OS_TMR_WHEEL_MASK]);
+}
+#endif
+
+/*$PAGE*/
+/*
+************************************************************************************************************************
+*                                         INSERT/REMOVE A TIMER IN/FROM A SPOKE
+*
+* Description: These functions maintain the list of timers of a spoke.  The list is sorted by match time, so that the
+*              timers that expire first are at its beginning.  Match times are compared modulo 2^32.  A timer is inserted
+*              in front of those with the same match time, so these expire in the reverse order of insertion, as they
+*              always did.
+*
+* Arguments  : pspoke        Is a pointer to the spoke.
+*
+*              ptmr          Is a pointer to the timer to insert or remove.
+*
+* Returns    : none
+************************************************************************************************************************
+*/
+
+#if OS_TMR_EN > 0
+static  void  OSTmr_Insert (OS_TMR_WHEEL *pspoke, OS_TMR *ptmr)
+{
+    OS_TMR  *ptmr1;
+    OS_TMR  *ptmr2;
 
-    if (pspoke->OSTmrFirst == ptmr) {                       /* See if timer to remove is at the beginning of list     */
-        ptmr1              = (OS_TMR *)ptmr->OSTmrNext;
-        pspoke->OSTmrFirst = (OS_TMR *)ptmr1;
-        if (ptmr1 != (OS_TMR *)0) {
-            ptmr1->OSTmrPrev = (void *)0;
+
+    ptmr1 = (OS_TMR *)0;                                           /* Find the timers before and after 'ptmr'         */
+    ptmr2 = pspoke->OSTmrFirst;
+    while (ptmr2 != (OS_TMR *)0) {
+        if ((INT32S)(ptmr2->OSTmrMatch - ptmr->OSTmrMatch) >= 0) {
+            break;
         }
+        ptmr1 = ptmr2;
+        ptmr2 = (OS_TMR *)ptmr2->OSTmrNext;
+    }
+    ptmr->OSTmrPrev = (void *)ptmr1;                               /* Link between 'ptmr1' and 'ptmr2'                */
+    ptmr->OSTmrNext = (void *)ptmr2;
+    if (ptmr2 != (OS_TMR *)0) {
+        ptmr2->OSTmrPrev = (void *)ptmr;
+    }
+    if (ptmr1 != (OS_TMR *)0) {
+        ptmr1->OSTmrNext   = (void *)ptmr;
     } else {
-        ptmr1            = (OS_TMR *)ptmr->OSTmrPrev;       /* Remove timer from somewhere in the list                */
-        ptmr2            = (OS_TMR *)ptmr->OSTmrNext;
-        ptmr1->OSTmrNext = ptmr2;
-        if (ptmr2 != (OS_TMR *)0) {
-            ptmr2->OSTmrPrev = (void *)ptmr1;
-        }
+        pspoke->OSTmrFirst = ptmr;
     }
-    ptmr->OSTmrState = OS_TMR_STATE_STOPPED;
-    ptmr->OSTmrNext  = (void *)0;
-    ptmr->OSTmrPrev  = (void *)0;
+    pspoke->OSTmrEntries++;
+}
+#endif
+
+
+
+#if OS_TMR_EN > 0
+static  void  OSTmr_Remove (OS_TMR_WHEEL *pspoke, OS_TMR *ptmr)
+{
+    OS_TMR  *ptmr1;
+    OS_TMR  *ptmr2;
+
+
+    ptmr1 = (OS_TMR *)ptmr->OSTmrPrev;
+    ptmr2 = (OS_TMR *)ptmr->OSTmrNext;
+    if (ptmr1 != (OS_TMR *)0) {
+        ptmr1->OSTmrNext   = (void *)ptmr2;
+    } else {
+        pspoke->OSTmrFirst = ptmr2;                                /* Timer was at the beginning of the list          */
+    }
+    if (ptmr2 != (OS_TMR *)0) {
+        ptmr2->OSTmrPrev = (void *)ptmr1;
+    }
+    ptmr->OSTmrNext = (void *)0;
+    ptmr->OSTmrPrev = (void *)0;
     pspoke->OSTmrEntries--;
 }
 #endif
 
+/*$PAGE*/
+/*
+************************************************************************************************************************
+*                                 MOVE THE TIMERS OF A NEW TURN FROM THE SECOND WHEEL
+*
+* Description: This function is called when OSTmrTime enters a new turn of the wheel.  The timers of the second wheel
+*              that expire in this turn are moved to the first wheel.  They are at the beginning of their spoke, ahead
+*              of the timers waiting for a later turn that maps to the same spoke.
+*
+* Arguments  : none
+*
+* Returns    : none
+************************************************************************************************************************
+*/
+
+#if OS_TMR_EN > 0 && OS_TMR_CFG_WHEEL2_SIZE > 0
+static  void  OSTmr_Cascade (void)
+{
+    OS_TMR        *ptmr;
+    OS_TMR_WHEEL  *pspoke2;
+
+
+    pspoke2 = &OSTmrWheel2Tbl[OS_TMR_TURN(OSTmrTime) & OS_TMR_WHEEL2_MASK];
+    ptmr    = pspoke2->OSTmrFirst;
+    while (ptmr != (OS_TMR *)0) {
+        if (OS_TMR_TURN(ptmr->OSTmrMatch) != OS_TMR_TURN(OSTmrTime)) {
+            break;                                                 /* All other timers wait for a later turn          */
+        }
+        OSTmr_Remove(pspoke2, ptmr);
+        OSTmr_Insert(&OSTmrWheelTbl[ptmr->OSTmrMatch & OS_TMR_WHEEL_MASK], ptmr);
+        ptmr = pspoke2->OSTmrFirst;
+    }
+}
+#endif
+
 /*$PAGE*/
 /*
 ************************************************************************************************************************
@@ -1079,10 +1285,8 @@ static  void  OSTmr_Task (void *p_arg)
 {
     INT8U            err;
     OS_TMR          *ptmr;
-    OS_TMR          *ptmr_next;
     OS_TMR_CALLBACK  pfnct;
     OS_TMR_WHEEL    *pspoke;
-    INT16U           spoke;
 
 
     (void)p_arg;                                                 /* Not using 'p_arg', prevent compiler warning       */
@@ -1090,25 +1294,29 @@ static  void  OSTmr_Task (void *p_arg)
         OSSemPend(OSTmrSemSignal, 0, &err);                      /* Wait for signal indicating time to update timers  */
         OSTmr_Lock();
         OSTmrTime++;                                             /* Increment the current time                        */
-        spoke  = (INT16U)(OSTmrTime % OS_TMR_CFG_WHEEL_SIZE);    /* Position on current timer wheel entry             */
-        pspoke = &OSTmrWheelTbl[spoke];
+#if OS_TMR_CFG_WHEEL2_SIZE > 0
+        if ((OSTmrTime & OS_TMR_WHEEL_MASK) == 0) {              /* A new turn of the wheel begins                    */
+            OSTmr_Cascade();
+        }
+#endif
+        pspoke = &OSTmrWheelTbl[OSTmrTime & OS_TMR_WHEEL_MASK];  /* Position on current timer wheel entry             */
         ptmr   = pspoke->OSTmrFirst;
-        while (ptmr != (OS_TMR *)0) {
-            ptmr_next = (OS_TMR *)ptmr->OSTmrNext;               /* Point to next timer to update because current ... */
-                                                                 /* ... timer could get unlinked from the wheel.      */
-            if (OSTmrTime == ptmr->OSTmrMatch) {                 /* Process each timer that expires                   */
-                pfnct = ptmr->OSTmrCallback;                     /* Execute callback function if available            */
-                if (pfnct != (OS_TMR_CALLBACK)0) {
-                    (*pfnct)((void *)ptmr, ptmr->OSTmrCallbackArg);
-                }
-                OSTmr_Unlink(ptmr);                              /* Remove from current wheel spoke                   */
-                if (ptmr->OSTmrOpt == OS_TMR_OPT_PERIODIC) {
-                    OSTmr_Link(ptmr, OS_TMR_LINK_PERIODIC);      /* Recalculate new position of timer in wheel        */
-                } else {
-                    ptmr->OSTmrState = OS_TMR_STATE_COMPLETED;   /* Indicate that the timer has completed             */
-                }
+        while (ptmr != (OS_TMR *)0) {                            /* The spoke is sorted, so stop at the first timer   */
+            if (OSTmrTime != ptmr->OSTmrMatch) {                 /* ... that does not expire                          */
+                break;
+            }
+            OS_TRACE(OS_TRACE_TMR_EXPIRE, ptmr - &OSTmrTbl[0]);
+            pfnct = ptmr->OSTmrCallback;                         /* Execute callback function if available            */
+            if (pfnct != (OS_TMR_CALLBACK)0) {
+                (*pfnct)((void *)ptmr, ptmr->OSTmrCallbackArg);
+            }
+            OSTmr_Unlink(ptmr);                                  /* Remove from current wheel spoke                   */
+            if (ptmr->OSTmrOpt == OS_TMR_OPT_PERIODIC) {
+                OSTmr_Link(ptmr, OS_TMR_LINK_PERIODIC);          /* Recalculate new position of timer in wheel        */
+            } else {
+                ptmr->OSTmrState = OS_TMR_STATE_COMPLETED;       /* Indicate that the timer has completed             */
             }
-            ptmr = ptmr_next;
+            ptmr = pspoke->OSTmrFirst;                           /* The next timer is now at the beginning            */
         }
         OSTmr_Unlock();
     }
@@ -0,0 +1,83 @@
+/******************************************************************************
+*                                                                             *
+* Kernel event trace for uC/OS-II: records context switches, interrupts,      *
+* posts, pends and timer expiries in the OSTrace ring buffer.                 *
+*                                                                             *
+* See OS_TRACE_EN in os_cfg.h and host/tools/trace2json.c for the decoder.    *
+*                                                                             *
+******************************************************************************/
+
+#ifndef  OS_MASTER_FILE
+#include <ucos_ii.h>
+#endif
+
+#if OS_TRACE_EN > 0
+/*
+*********************************************************************************************************
+*                                       INITIALIZE THE EVENT TRACE
+*
+* Description: This function is called by OSInit() to empty the trace ring buffer and fill in its header.
+*              The frequency of the time stamps is only known once the device drivers have been
+*              initialized, so it is filled in by OSStart().
+*
+* Arguments  : none
+*
+* Returns    : none
+*
+* Note(s)    : 1) This function is INTERNAL to uC/OS-II and your application should not call it.
+*********************************************************************************************************
+*/
+
+void  OS_TraceInit (void)
+{
+    OS_MemClr((INT8U *)&OSTrace, sizeof(OSTrace));
+    OSTrace.OSTraceMagic      = OS_TRACE_MAGIC;
+    OSTrace.OSTraceSize       = OS_TRACE_BUF_SIZE;
+    OSTrace.OSTraceLowestPrio = OS_LOWEST_PRIO;
+#if OS_TMR_EN > 0
+    OSTrace.OSTraceTmrPrio    = OS_TASK_TMR_PRIO;
+#else
+    OSTrace.OSTraceTmrPrio    = 0xFFFFu;
+#endif
+}
+/*$PAGE*/
+/*
+*********************************************************************************************************
+*                                          RECORD A KERNEL EVENT
+*
+* Description: This function is called through the OS_TRACE() macro by the kernel services to append an
+*              event to the trace ring buffer.  Once the buffer is full the oldest record is overwritten,
+*              so a dump always holds the last OS_TRACE_BUF_SIZE events.
+*
+* Arguments  : type      is the event type (see OS_TRACE_xxx in UCOS_II.H)
+*
+*              arg       is the event argument, which depends on the type
+*
+* Returns    : none
+*
+* Note(s)    : 1) This function is INTERNAL to uC/OS-II and your application should not call it.
+*              2) The record is claimed and filled with interrupts disabled, which is a few instructions
+*                 plus OSCPUCyclesGet() and nests within the critical sections of the callers.  ISRs and
+*                 tasks can therefore record events without a lock.
+*********************************************************************************************************
+*/
+
+void  OS_TraceRec (INT8U type, INT16U arg)
+{
+    OS_TRACE_REC  *prec;
+#if OS_CRITICAL_METHOD == 3                      /* Allocate storage for CPU status register           */
+    OS_CPU_SR      cpu_sr = 0;
+#endif
+
+
+
+    OS_ENTER_CRITICAL();
+    prec              = &OSTrace.OSTraceTbl[OSTrace.OSTraceCtr & (OS_TRACE_BUF_SIZE - 1)];
+    OSTrace.OSTraceCtr++;
+    prec->OSTraceTime = OSCPUCyclesGet();
+    prec->OSTraceType = type;
+    prec->OSTracePrio = OSPrioCur;
+    prec->OSTraceArg  = arg;
+    OS_EXIT_CRITICAL();
+}
+#endif                                           /* OS_TRACE_EN                                        */
@@ -41,6 +41,144 @@
 #include "alt_types.h"
 #include "sys/alt_log_printf.h"
 
+/*
+ * State of the system clock, used to hold off the tick interrupt while the
+ * system is idle (see alt_avalon_timer_sc_idle()).
+ *
+ * "alt_avalon_timer_sc_cycles" is the number of timer cycles per tick,
+ * "alt_avalon_timer_sc_period" the value the counter was last started with,
+ * "alt_avalon_timer_sc_load" the time (see alt_avalon_timer_sc_time()) at
+ * which the counter was last started or reloaded by a timeout,
+ * "alt_avalon_timer_sc_skip" the number of ticks held off by the period
+ * currently running, "alt_avalon_timer_sc_reload" is set while the
+ * period register does not hold one tick, and "alt_avalon_timer_sc_late" is
+ * the number of cycles by which the counter times out after the ticks it 
+ * stands for.
+ */
+
+static void*   alt_avalon_timer_sc_base   = NULL;
+static alt_u32 alt_avalon_timer_sc_cycles = 0;
+static alt_u32 alt_avalon_timer_sc_period = 0;
+static alt_u32 alt_avalon_timer_sc_load   = 0;
+static alt_u32 alt_avalon_timer_sc_skip   = 0;
+static alt_u32 alt_avalon_timer_sc_reload = 0;
+static alt_u32 alt_avalon_timer_sc_late   = 0;
+
+/*
+ * alt_avalon_timer_sc_snapshot() returns the current value of the counter,
+ * i.e. one less than the number of cycles until it times out.
+ */
+
+static alt_u32 alt_avalon_timer_sc_snapshot (void* base)
+{
+  IOWR_ALTERA_AVALON_TIMER_SNAPL (base, 0);
+
+  return (IORD_ALTERA_AVALON_TIMER_SNAPL (base) & 
+          ALTERA_AVALON_TIMER_SNAPL_MSK) |
+         ((IORD_ALTERA_AVALON_TIMER_SNAPH (base) & 
+           ALTERA_AVALON_TIMER_SNAPH_MSK) << 16);
+}
+
+/*
+ * alt_avalon_timer_sc_start() restarts the counter to time out "period" + 1
+ * cycles after the snapshot "count", which was taken before the counter 
+ * timed out. It is called with interrupts disabled.
+ *
+ * Writing the period registers stops the counter, and it only runs again 
+ * once it is started, so the cycles from a snapshot taken here to the start 
+ * are not counted. They are ALT_AVALON_TIMER_SC_RESTART_CYCLES, and are 
+ * added to the time, together with the cycles since "count". They are taken
+ * off the new period as well, so that it still times out on its tick; a 
+ * period too short for that times out late. With "periodic" set the period
+ * is loaded as it is instead, to keep one tick per period, and the ticks 
+ * fall behind by the lost cycles, until the next idle period makes up for 
+ * them. Either way the clock does not drift however often the counter is 
+ * restarted.
+ */
+
+static void alt_avalon_timer_sc_start (void* base, alt_u32 count, 
+                                       alt_u32 period, int periodic)
+{
+  alt_u32 old    = alt_avalon_timer_sc_period;
+  alt_u32 latest = alt_avalon_timer_sc_snapshot (base);
+  alt_u32 lost   = count - latest + ALT_AVALON_TIMER_SC_RESTART_CYCLES;
+  alt_u32 now    = alt_avalon_timer_sc_load + (old - count);
+
+  /* the counter timed out since "count" and was reloaded */
+  if (latest > count)
+  {
+    lost += old + 1;
+  }
+
+  if (periodic)
+  {
+    alt_avalon_timer_sc_late += lost;
+  }
+  else
+  {
+    alt_avalon_timer_sc_late = period < lost ? lost - period : 0;
+    period = period < lost ? 0 : period - lost;
+  }
+  now += lost;
+
+  alt_avalon_timer_sc_period = period;
+
+  IOWR_ALTERA_AVALON_TIMER_PERIODL (base, 
+            period & ALTERA_AVALON_TIMER_PERIODL_MSK);
+  IOWR_ALTERA_AVALON_TIMER_PERIODH (base, 
+            (period >> 16) & ALTERA_AVALON_TIMER_PERIODH_MSK);
+  IOWR_ALTERA_AVALON_TIMER_CONTROL (base, 
+            ALTERA_AVALON_TIMER_CONTROL_ITO_MSK  |
+            ALTERA_AVALON_TIMER_CONTROL_CONT_MSK |
+            ALTERA_AVALON_TIMER_CONTROL_START_MSK);
+
+  /* 
+   * If it timed out before it was stopped, the interrupt handler adds a 
+   * full period for that timeout, which has already been counted here.
+   */
+  alt_avalon_timer_sc_load = now;
+  if (IORD_ALTERA_AVALON_TIMER_STATUS (base) & 
+      ALTERA_AVALON_TIMER_STATUS_TO_MSK)
+  {
+    alt_avalon_timer_sc_load -= period + 1;
+  }
+}
+
+/*
+ * alt_avalon_timer_sc_running() takes a snapshot of the counter and
+ * returns non-zero if the counter had not timed out by then, so that the
+ * snapshot belongs to the period that was started last.
+ */
+
+static int alt_avalon_timer_sc_running (void* base, alt_u32* count)
+{
+  *count = alt_avalon_timer_sc_snapshot (base);
+
+  return !(IORD_ALTERA_AVALON_TIMER_STATUS (base) & 
+           ALTERA_AVALON_TIMER_STATUS_TO_MSK);
+}
+
+/*
+ * alt_avalon_timer_sc_fold() accounts for the ticks of an idle period that
+ * have passed by the snapshot "count", so that alt_nticks() is up to date
+ * while the period runs on. It is called with interrupts disabled, while a
+ * period holds off ticks and has not timed out.
+ */
+
+static void alt_avalon_timer_sc_fold (alt_u32 count, alt_u32 cycles)
+{
+  alt_u32 passed;
+
+  /* ticks are due every "cycles" cycles before the counter times out */
+
+  passed = alt_avalon_timer_sc_skip - count / cycles;
+  if (passed)
+  {
+    alt_tick_skip (passed);
+    alt_avalon_timer_sc_skip -= passed;
+  }
+}
+
 /* 
  * alt_avalon_timer_sc_irq() is the interrupt handler used for the system 
  * clock. This is called periodically when a timer interrupt occurs. The 
@@ -57,9 +195,15 @@ static void alt_avalon_timer_sc_irq (void* base, alt_u32 id)
 #endif
 {
   alt_irq_context cpu_sr;
+  alt_u32         count;
   
-  /* clear the interrupt */
+  /* 
+   * clear the interrupt. The counter was reloaded by the timeout, a full
+   * period after it was loaded before.
+   */
+  cpu_sr = alt_irq_disable_all();
   IOWR_ALTERA_AVALON_TIMER_STATUS (base, 0);
+  alt_avalon_timer_sc_load += alt_avalon_timer_sc_period + 1;
   
   /* 
    * Dummy read to ensure IRQ is negated before the ISR returns.
@@ -68,6 +212,21 @@ static void alt_avalon_timer_sc_irq (void* base, alt_u32 id)
    */
   IORD_ALTERA_AVALON_TIMER_CONTROL (base);
 
+  /* 
+   * Go back to one tick per period after an idle period. The ticks fall
+   * behind by the cycles since the timeout, i.e. the interrupt latency, and
+   * by those of the restart; the next idle period makes up for them.
+   */
+  if (alt_avalon_timer_sc_reload && 
+      alt_avalon_timer_sc_running (base, &count))
+  {
+    alt_avalon_timer_sc_late += alt_avalon_timer_sc_period - count;
+    alt_avalon_timer_sc_start (base, count, alt_avalon_timer_sc_cycles - 1, 
+                               1);
+    alt_avalon_timer_sc_reload = 0;
+  }
+  alt_irq_enable_all(cpu_sr);
+
   /* ALT_LOG - see altera_hal/HAL/inc/sys/alt_log_printf.h */
   ALT_LOG_SYS_CLK_HEARTBEAT();
 
@@ -76,6 +235,11 @@ static void alt_avalon_timer_sc_irq (void* base, alt_u32 id)
    * during this time to safely support ISR preemption
    */
   cpu_sr = alt_irq_disable_all();
+  if (alt_avalon_timer_sc_skip)
+  {
+    alt_tick_skip (alt_avalon_timer_sc_skip);
+    alt_avalon_timer_sc_skip = 0;
+  }
   alt_tick ();
   alt_irq_enable_all(cpu_sr);
 }
@@ -93,6 +257,16 @@ void alt_avalon_timer_sc_init (void* base, alt_u32 irq_controller_id,
   
   alt_sysclk_init (freq);
   
+  /* remember the tick period, as loaded from SOPC builder */
+
+  alt_avalon_timer_sc_base   = base;
+  alt_avalon_timer_sc_cycles = 
+    ((IORD_ALTERA_AVALON_TIMER_PERIODL (base) & 
+      ALTERA_AVALON_TIMER_PERIODL_MSK) |
+     ((IORD_ALTERA_AVALON_TIMER_PERIODH (base) & 
+       ALTERA_AVALON_TIMER_PERIODH_MSK) << 16)) + 1;
+  alt_avalon_timer_sc_period = alt_avalon_timer_sc_cycles - 1;
+
   /* set to free running mode */
   
   IOWR_ALTERA_AVALON_TIMER_CONTROL (base, 
@@ -108,3 +282,225 @@ void alt_avalon_timer_sc_init (void* base, alt_u32 irq_controller_id,
   alt_irq_register (irq, base, alt_avalon_timer_sc_irq);
 #endif  
 }
+
+/*
+ * alt_avalon_timer_sc_idle() is called by the idle task to hold off the tick
+ * interrupt until the next tick that has work to do, as returned by
+ * alt_tick_next(). The counter is restarted with a period that runs up to
+ * that tick, and the ticks in between are accounted for by
+ * alt_tick_skip() when it times out, or when alt_avalon_timer_sc_wake() is
+ * called because another interrupt has made a task ready.
+ *
+ * This requires a writable period (no fixed period in SOPC builder). The
+ * period is limited to what the 32 bit counter can hold. Interrupt handlers
+ * that run during an idle period see the time as it was when it started,
+ * unless the operating system calls alt_avalon_timer_sc_sync() on interrupt
+ * entry, and an alarm they start only brings the tick interrupt forward
+ * through alt_avalon_timer_sc_rearm().
+ */
+
+void alt_avalon_timer_sc_idle (void)
+{
+  void*           base   = alt_avalon_timer_sc_base;
+  alt_u32         cycles = alt_avalon_timer_sc_cycles;
+  alt_u32         nticks;
+  alt_u32         count;
+  alt_irq_context cpu_sr;
+
+  cpu_sr = alt_irq_disable_all();
+
+  if (base && !alt_avalon_timer_sc_reload)
+  {
+    nticks = alt_tick_next ();
+    if (nticks > 0xffffffff / cycles)
+    {
+      nticks = 0xffffffff / cycles;
+    }
+
+    /* 
+     * No idle period while the interrupt of a timeout is pending. The next
+     * tick is due "alt_avalon_timer_sc_late" cycles before the counter 
+     * times out.
+     */
+    if (nticks > 1 && alt_avalon_timer_sc_running (base, &count))
+    {
+      alt_avalon_timer_sc_start (base, count, 
+                                 count + (nticks - 1) * cycles - 
+                                 alt_avalon_timer_sc_late, 0);
+      alt_avalon_timer_sc_skip   = nticks - 1;
+      alt_avalon_timer_sc_reload = 1;
+
+      /* 
+       * If the counter timed out before it was stopped, the pending 
+       * interrupt is for the tick that was due and none was skipped.
+       */
+      if (IORD_ALTERA_AVALON_TIMER_STATUS (base) & 
+          ALTERA_AVALON_TIMER_STATUS_TO_MSK)
+      {
+        alt_avalon_timer_sc_skip = 0;
+      }
+    }
+  }
+
+  alt_irq_enable_all(cpu_sr);
+}
+
+/*
+ * alt_avalon_timer_sc_wake() ends an idle period before the counter times
+ * out. It is called when the idle task is switched out. The ticks that have
+ * passed are accounted for now, and the counter is restarted to time out on
+ * the next tick.
+ */
+
+void alt_avalon_timer_sc_wake (void)
+{
+  void*           base   = alt_avalon_timer_sc_base;
+  alt_u32         cycles = alt_avalon_timer_sc_cycles;
+  alt_u32         count;
+  alt_irq_context cpu_sr;
+
+  cpu_sr = alt_irq_disable_all();
+
+  if (alt_avalon_timer_sc_skip && 
+      alt_avalon_timer_sc_running (base, &count))
+  {
+    alt_avalon_timer_sc_fold (count, cycles);
+    alt_avalon_timer_sc_skip = 0;
+    alt_avalon_timer_sc_start (base, count, count % cycles, 0);
+  }
+
+  alt_irq_enable_all(cpu_sr);
+}
+
+/*
+ * alt_avalon_timer_sc_sync() is called on interrupt entry. During an idle
+ * period it accounts for the ticks that have passed, so that interrupt
+ * handlers see the current time. It only reads the counter, which keeps 
+ * running, so unlike a restart it loses no cycles.
+ */
+
+void alt_avalon_timer_sc_sync (void)
+{
+  void*           base = alt_avalon_timer_sc_base;
+  alt_u32         count;
+  alt_irq_context cpu_sr;
+
+  if (!alt_avalon_timer_sc_skip)
+  {
+    return;
+  }
+
+  cpu_sr = alt_irq_disable_all();
+
+  if (alt_avalon_timer_sc_skip && 
+      alt_avalon_timer_sc_running (base, &count))
+  {
+    alt_avalon_timer_sc_fold (count, alt_avalon_timer_sc_cycles);
+  }
+
+  alt_irq_enable_all(cpu_sr);
+}
+
+/*
+ * alt_avalon_timer_sc_rearm() is called when an alarm or a timer has been
+ * started. If that happens during an idle period, e.g. in an interrupt
+ * handler, and alt_tick_next() now comes before the end of the period, the
+ * counter is restarted to time out on that tick instead.
+ */
+
+void alt_avalon_timer_sc_rearm (void)
+{
+  void*           base   = alt_avalon_timer_sc_base;
+  alt_u32         cycles = alt_avalon_timer_sc_cycles;
+  alt_u32         nticks;
+  alt_u32         count;
+  alt_irq_context cpu_sr;
+
+  cpu_sr = alt_irq_disable_all();
+
+  if (alt_avalon_timer_sc_skip && 
+      alt_avalon_timer_sc_running (base, &count))
+  {
+    alt_avalon_timer_sc_fold (count, cycles);
+    nticks = alt_tick_next ();
+
+    /* 
+     * The period ends "alt_avalon_timer_sc_skip" + 1 ticks from now. If a
+     * tick is skipped the counter is at least one tick from its timeout,
+     * so it cannot time out while it is restarted.
+     */
+    if (nticks <= alt_avalon_timer_sc_skip)
+    {
+      alt_avalon_timer_sc_start (base, count, 
+                                 count % cycles + (nticks - 1) * cycles, 
+                                 0);
+      alt_avalon_timer_sc_skip = nticks - 1;
+    }
+  }
+
+  alt_irq_enable_all(cpu_sr);
+}
+
+/*
+ * alt_avalon_timer_sc_time() returns the number of timer cycles since the
+ * system clock was started, modulo 2^32. It serves as a cycle counter on
+ * systems without a timestamp timer, e.g. for OSTaskSwHook().
+ *
+ * The time is the cycles the counter has counted since it was last loaded,
+ * plus the time of that load, which the interrupt handler and
+ * alt_avalon_timer_sc_start() keep up to date by additions only. Reading it
+ * takes no multiply or divide, which the Nios II of the lab does in
+ * software. A timeout whose interrupt is still pending is counted as well,
+ * so the time also moves on while interrupts are disabled.
+ */
+
+alt_u32 alt_avalon_timer_sc_time (void)
+{
+  void*           base   = alt_avalon_timer_sc_base;
+  alt_u32         status;
+  alt_u32         count;
+  alt_u32         time;
+  alt_irq_context cpu_sr;
+
+  if (!base)
+  {
+    return 0;
+  }
+
+  cpu_sr = alt_irq_disable_all();
+
+  /* read the counter again if it timed out while it was being read */
+  do
+  {
+    status = IORD_ALTERA_AVALON_TIMER_STATUS (base) & 
+             ALTERA_AVALON_TIMER_STATUS_TO_MSK;
+    count  = alt_avalon_timer_sc_snapshot (base);
+  } 
+  while (status != (IORD_ALTERA_AVALON_TIMER_STATUS (base) & 
+                    ALTERA_AVALON_TIMER_STATUS_TO_MSK));
+
+  time = alt_avalon_timer_sc_load + (alt_avalon_timer_sc_period - count);
+
+  if (status)
+  {
+    /* 
+     * The counter timed out a full period after it was loaded, and has been
+     * running again from the start of its period since.
+     */
+    time += alt_avalon_timer_sc_period + 1;
+  }
+
+  alt_irq_enable_all(cpu_sr);
+
+  return time;
+}
+
+/*
+ * alt_avalon_timer_sc_freq() returns the rate at which the time returned by
+ * alt_avalon_timer_sc_time() advances, i.e. the clock of the timer.
+ */
+
+alt_u32 alt_avalon_timer_sc_freq (void)
+{
+  return alt_avalon_timer_sc_cycles * alt_ticks_per_second ();
+}
@@ -21,10 +21,18 @@ JDI_FILE=../../hardware/DE2-pre-built/IL2206_DE2_Nios2.jdi
 # SOF_FILE=../../hardware/DE2-115-pre-built/IL2206_DE2_115_Nios2.sof
 # JDI_FILE=../../hardware/DE2-115-pre-built/IL2206_DE2_115_Nios2.jdi
 
-APP_NAME=hello_ucosii
+# The lab application by default; the kernel benchmark with
+#   APP_NAME=kernel_bench SRC_PATH=./bench ./run-de2-35.sh
+APP_NAME=${APP_NAME:-hello_ucosii}
 CPU_NAME=nios2
 BSP_PATH=../../bsp/il2206-pre-built-ucosii
-SRC_PATH=./src
+SRC_PATH=${SRC_PATH:-./src}
+
+# Kernel extensions that are in the BSP folder but not in the ucosii
+# software package. nios2-bsp regenerates the BSP makefile from the
+# package, so they are compiled with the application instead.
+EXT_PATH=bsp/UCOSII/src
+EXT_SRCS="alt_dlog.c alt_input.c alt_slab.c alt_stkprof.c os_reg.c os_trace.c"
 
 # Project internal folders
 mkdir -p gen
@@ -43,6 +51,7 @@ nios2-bsp ucosii ../bsp ../$CORE_FILE \
 	  --cpu-name $CPU_NAME \
 	  --default_sections_mapping sram \
 	  --set hal.sys_clk_timer timer_0 \
+	  --set hal.timestamp_timer timer_1 \
 	  --set hal.make.bsp_cflags_debug -g \
 	  --set hal.make.bsp_cflags_optimization -Os \
 	  --set hal.enable_sopc_sysid_check 1 \
@@ -52,6 +61,7 @@ nios2-app-generate-makefile \
     --bsp-dir ../bsp \
     --elf-name ../bin/$APP_NAME.elf \
     --src-dir ../$SRC_PATH \
+    --src-files $(for f in $EXT_SRCS; do echo ../$EXT_PATH/$f; done) \
     --set APP_CFLAGS_OPTIMIZATION -O0
 
 make | tee -a log.txt 